@@ -0,0 +1,175 @@
+#include "Arduino.h"
+#include "native_hal.h"
+#include <time.h>
+#include <unistd.h>
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+HardwareSerial Serial;
+EspClass ESP;
+
+// --- Clock ---
+
+static bool virtualTime = false;
+static uint64_t skewUs = 0;
+
+static uint64_t monotonicUs() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000ULL + (uint64_t)ts.tv_nsec / 1000ULL;
+}
+
+static uint64_t bootUs() {
+  static const uint64_t start = monotonicUs();
+  return start;
+}
+
+static uint64_t uptimeUs() {
+  uint64_t boot = bootUs();  // first call latches the boot instant
+  return monotonicUs() - boot + skewUs;
+}
+
+unsigned long millis() {
+  return (unsigned long)(uptimeUs() / 1000ULL);
+}
+
+unsigned long micros() {
+  return (unsigned long)uptimeUs();
+}
+
+void delay(uint32_t ms) {
+  if (virtualTime) {
+    skewUs += (uint64_t)ms * 1000ULL;
+    return;
+  }
+  usleep((useconds_t)ms * 1000);
+}
+
+void delayMicroseconds(uint32_t us) {
+  if (virtualTime) {
+    skewUs += us;
+    return;
+  }
+  usleep(us);
+}
+
+void yield() {}
+
+void halSetVirtualTime(bool enabled) {
+  bootUs();
+  virtualTime = enabled;
+}
+
+bool halVirtualTime() {
+  return virtualTime;
+}
+
+void halAdvanceMillis(unsigned long ms) {
+  skewUs += (uint64_t)ms * 1000ULL;
+}
+
+// --- Random ---
+
+long random(long howbig) {
+  if (howbig <= 0) return 0;
+  return ::random() % howbig;
+}
+
+long random(long howsmall, long howbig) {
+  if (howsmall >= howbig) return howsmall;
+  return random(howbig - howsmall) + howsmall;
+}
+
+void randomSeed(unsigned long seed) {
+  if (seed != 0) srandom((unsigned)seed);
+}
+
+// --- Serial ---
+
+static bool serialEnabled = true;
+
+void halSetSerialEnabled(bool enabled) {
+  serialEnabled = enabled;
+}
+
+size_t HardwareSerial::write(uint8_t c) {
+  if (!serialEnabled) return 1;
+  return fputc(c, stdout) == EOF ? 0 : 1;
+}
+
+size_t HardwareSerial::write(const uint8_t* buffer, size_t size) {
+  if (!serialEnabled) return size;
+  return fwrite(buffer, 1, size, stdout);
+}
+
+void HardwareSerial::flush() {
+  fflush(stdout);
+}
+
+// --- Heap model ---
+// ESP32-C3 reports ~320 KB of heap at boot; the host process heap is far larger,
+// so report the configured size minus what this process has malloc'd since start.
+
+static uint32_t heapSize = 327680;
+static uint32_t minFreeHeap = UINT32_MAX;
+
+static size_t hostHeapInUse() {
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+  return mallinfo2().uordblks;
+#elif defined(__GLIBC__)
+  return (size_t)(unsigned)mallinfo().uordblks;
+#else
+  return 0;
+#endif
+}
+
+static size_t heapBaseline() {
+  static const size_t baseline = hostHeapInUse();
+  return baseline;
+}
+
+void halSetHeapSize(uint32_t bytes) {
+  heapSize = bytes;
+  minFreeHeap = UINT32_MAX;
+}
+
+uint32_t EspClass::getHeapSize() {
+  return heapSize;
+}
+
+uint32_t EspClass::getFreeHeap() {
+  size_t base = heapBaseline();
+  size_t used = hostHeapInUse();
+  size_t grown = used > base ? used - base : 0;
+  uint32_t freeBytes = grown >= heapSize ? 0 : heapSize - (uint32_t)grown;
+  if (freeBytes < minFreeHeap) minFreeHeap = freeBytes;
+  return freeBytes;
+}
+
+uint32_t EspClass::getMinFreeHeap() {
+  uint32_t current = getFreeHeap();
+  return minFreeHeap < current ? minFreeHeap : current;
+}
+
+uint32_t EspClass::getMaxAllocHeap() {
+  // No fragmentation model: the whole free heap is one block
+  return getFreeHeap();
+}
+
+// --- Restart ---
+
+static void (*restartHandler)() = nullptr;
+
+void halSetRestartHandler(void (*handler)()) {
+  restartHandler = handler;
+}
+
+void EspClass::restart() {
+  fflush(stdout);
+  if (restartHandler) {
+    restartHandler();
+  }
+  fprintf(stderr, "[HAL] ESP.restart() after %lu ms, exiting with status %d\n", millis(), HAL_EXIT_RESTART);
+  exit(HAL_EXIT_RESTART);
+}
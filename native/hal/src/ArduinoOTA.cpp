@@ -0,0 +1,5 @@
+#include "ArduinoOTA.h"
+#include "ESPmDNS.h"
+
+ArduinoOTAClass ArduinoOTA;
+MDNSResponder MDNS;
@@ -0,0 +1,49 @@
+#ifndef NATIVE_ARDUINOOTA_H
+#define NATIVE_ARDUINOOTA_H
+
+#include <functional>
+#include "Arduino.h"
+#include "Update.h"
+
+typedef enum {
+  OTA_AUTH_ERROR,
+  OTA_BEGIN_ERROR,
+  OTA_CONNECT_ERROR,
+  OTA_RECEIVE_ERROR,
+  OTA_END_ERROR
+} ota_error_t;
+
+// espota is not served off-target; callbacks are stored but never fire
+class ArduinoOTAClass {
+ public:
+  typedef std::function<void(void)> THandlerFunction;
+  typedef std::function<void(ota_error_t)> THandlerFunction_Error;
+  typedef std::function<void(unsigned int, unsigned int)> THandlerFunction_Progress;
+
+  ArduinoOTAClass& setPort(uint16_t) { return *this; }
+  ArduinoOTAClass& setHostname(const char* hostname) { hostname_ = hostname ? hostname : ""; return *this; }
+  String getHostname() const { return hostname_; }
+  ArduinoOTAClass& setPassword(const char*) { return *this; }
+  ArduinoOTAClass& setPasswordHash(const char*) { return *this; }
+  ArduinoOTAClass& setRebootOnSuccess(bool) { return *this; }
+  ArduinoOTAClass& setMdnsEnabled(bool) { return *this; }
+  ArduinoOTAClass& onStart(THandlerFunction fn) { onStart_ = fn; return *this; }
+  ArduinoOTAClass& onEnd(THandlerFunction fn) { onEnd_ = fn; return *this; }
+  ArduinoOTAClass& onError(THandlerFunction_Error fn) { onError_ = fn; return *this; }
+  ArduinoOTAClass& onProgress(THandlerFunction_Progress fn) { onProgress_ = fn; return *this; }
+  void begin() {}
+  void end() {}
+  void handle() {}
+  int getCommand() const { return U_FLASH; }
+
+ private:
+  String hostname_;
+  THandlerFunction onStart_;
+  THandlerFunction onEnd_;
+  THandlerFunction_Error onError_;
+  THandlerFunction_Progress onProgress_;
+};
+
+extern ArduinoOTAClass ArduinoOTA;
+
+#endif
@@ -0,0 +1,19 @@
+#ifndef NATIVE_ESPMDNS_H
+#define NATIVE_ESPMDNS_H
+
+#include "Arduino.h"
+
+// No multicast responder off-target; registrations always succeed
+class MDNSResponder {
+ public:
+  bool begin(const char*) { return true; }
+  void end() {}
+  bool addService(const char*, const char*, uint16_t) { return true; }
+  bool addService(const String&, const String&, uint16_t) { return true; }
+  bool addServiceTxt(const char*, const char*, const char*, const char*) { return true; }
+  void enableArduino(uint16_t = 3232, bool = false) {}
+};
+
+extern MDNSResponder MDNS;
+
+#endif
@@ -0,0 +1,29 @@
+#ifndef NATIVE_ESP_H
+#define NATIVE_ESP_H
+
+#include <stdint.h>
+
+class EspClass {
+ public:
+  uint32_t getHeapSize();
+  uint32_t getFreeHeap();
+  uint32_t getMinFreeHeap();
+  uint32_t getMaxAllocHeap();
+  uint32_t getPsramSize() { return 0; }
+
+  const char* getChipModel() { return "ESP32-C3 (native)"; }
+  uint8_t getChipRevision() { return 3; }
+  uint8_t getChipCores() { return 1; }
+  uint32_t getCpuFreqMHz() { return 160; }
+  const char* getSdkVersion() { return "native"; }
+  uint32_t getFlashChipSize() { return 4u * 1024u * 1024u; }
+  uint32_t getSketchSize() { return 1024u * 1024u; }
+  uint32_t getFreeSketchSpace() { return 0x140000u; }
+  uint64_t getEfuseMac() { return 0x0000AABBCCDDEEFFULL; }
+
+  [[noreturn]] void restart();
+};
+
+extern EspClass ESP;
+
+#endif
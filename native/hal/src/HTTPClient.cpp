@@ -0,0 +1,200 @@
+#include "HTTPClient.h"
+
+bool HTTPClient::begin(WiFiClient& client, const String& url) {
+  end();
+  client_ = &client;
+
+  int schemeEnd = url.indexOf("://");
+  if (schemeEnd < 0) return false;
+  String scheme = url.substring(0, schemeEnd);
+  secure_ = scheme == "https";
+  if (!secure_ && scheme != "http") return false;
+  port_ = secure_ ? 443 : 80;
+
+  String rest = url.substring(schemeEnd + 3);
+  int slash = rest.indexOf('/');
+  String hostPort = slash < 0 ? rest : rest.substring(0, slash);
+  uri_ = slash < 0 ? String("/") : rest.substring(slash);
+
+  int colon = hostPort.indexOf(':');
+  if (colon >= 0) {
+    host_ = hostPort.substring(0, colon);
+    port_ = (uint16_t)hostPort.substring(colon + 1).toInt();
+  } else {
+    host_ = hostPort;
+  }
+  return host_.length() > 0;
+}
+
+bool HTTPClient::begin(const String& url) {
+  return begin(ownClient_, url);
+}
+
+void HTTPClient::end() {
+  if (client_ != nullptr && (!reuse_ || chunked_ || contentLength_ < 0)) {
+    client_->stop();
+  }
+  headers_ = "";
+  contentLength_ = -1;
+  chunked_ = false;
+  code_ = 0;
+}
+
+void HTTPClient::addHeader(const String& name, const String& value) {
+  headers_ += name;
+  headers_ += ": ";
+  headers_ += value;
+  headers_ += "\r\n";
+}
+
+int HTTPClient::GET() {
+  return sendRequest("GET");
+}
+
+int HTTPClient::POST(const String& payload) {
+  return sendRequest("POST", reinterpret_cast<const uint8_t*>(payload.c_str()), payload.length());
+}
+
+int HTTPClient::POST(const uint8_t* payload, size_t size) {
+  return sendRequest("POST", payload, size);
+}
+
+int HTTPClient::sendRequest(const char* method, const uint8_t* payload, size_t size) {
+  if (client_ == nullptr) return HTTPC_ERROR_NOT_CONNECTED;
+  if (!client_->connected()) {
+    if (!client_->connect(host_.c_str(), port_, connectTimeoutMs_)) {
+      return HTTPC_ERROR_CONNECTION_REFUSED;
+    }
+  }
+  client_->Stream::setTimeout(timeoutMs_);
+
+  String request;
+  request.reserve(128 + headers_.length());
+  request += method;
+  request += " ";
+  request += uri_;
+  request += " HTTP/1.1\r\nHost: ";
+  request += host_;
+  if (port_ != 80 && port_ != 443) {
+    request += ":";
+    request += String(port_);
+  }
+  request += "\r\nUser-Agent: ";
+  request += userAgent_;
+  request += reuse_ ? "\r\nConnection: keep-alive\r\n" : "\r\nConnection: close\r\n";
+  if (payload != nullptr || strcmp(method, "POST") == 0) {
+    request += "Content-Length: ";
+    request += String((unsigned)size);
+    request += "\r\n";
+  }
+  request += headers_;
+  request += "\r\n";
+
+  if (client_->write(reinterpret_cast<const uint8_t*>(request.c_str()), request.length()) != request.length()) {
+    return HTTPC_ERROR_SEND_HEADER_FAILED;
+  }
+  if (size > 0 && client_->write(payload, size) != size) {
+    return HTTPC_ERROR_SEND_PAYLOAD_FAILED;
+  }
+  return handleHeaderResponse();
+}
+
+bool HTTPClient::readLine(String& line) {
+  line = "";
+  unsigned long start = millis();
+  while (millis() - start < timeoutMs_) {
+    if (client_->available() <= 0) {
+      if (!client_->connected()) return false;
+      delayMicroseconds(200);
+      continue;
+    }
+    int c = client_->read();
+    if (c < 0) continue;
+    if (c == '\n') {
+      if (line.endsWith("\r")) line.remove(line.length() - 1);
+      return true;
+    }
+    line += (char)c;
+    start = millis();
+  }
+  return false;
+}
+
+int HTTPClient::handleHeaderResponse() {
+  String line;
+  if (!readLine(line)) {
+    return client_->connected() ? HTTPC_ERROR_READ_TIMEOUT : HTTPC_ERROR_CONNECTION_LOST;
+  }
+  if (!line.startsWith("HTTP/1.")) return HTTPC_ERROR_NO_HTTP_SERVER;
+  int space = line.indexOf(' ');
+  code_ = line.substring(space + 1).toInt();
+
+  contentLength_ = -1;
+  chunked_ = false;
+  while (readLine(line) && line.length() > 0) {
+    String lower = line;
+    lower.toLowerCase();
+    if (lower.startsWith("content-length:")) {
+      contentLength_ = line.substring(15).toInt();
+    } else if (lower.startsWith("transfer-encoding:") && lower.indexOf("chunked") >= 0) {
+      chunked_ = true;
+    } else if (lower.startsWith("connection:") && lower.indexOf("close") >= 0) {
+      reuse_ = false;
+    }
+  }
+  return code_ > 0 ? code_ : HTTPC_ERROR_NO_HTTP_SERVER;
+}
+
+String HTTPClient::getString() {
+  String body;
+  if (client_ == nullptr || code_ <= 0) return body;
+
+  if (chunked_) {
+    String line;
+    while (readLine(line)) {
+      long chunk = strtol(line.c_str(), nullptr, 16);
+      if (chunk <= 0) {
+        readLine(line);
+        break;
+      }
+      char buf[256];
+      while (chunk > 0) {
+        size_t want = (size_t)std::min<long>(chunk, sizeof(buf));
+        size_t got = client_->Stream::readBytes(buf, want);
+        if (got == 0) return body;
+        body.concat(buf, got);
+        chunk -= (long)got;
+      }
+      readLine(line);
+    }
+    return body;
+  }
+
+  char buf[256];
+  long remaining = contentLength_;
+  while (remaining != 0) {
+    size_t want = remaining < 0 ? sizeof(buf) : (size_t)std::min<long>(remaining, sizeof(buf));
+    size_t got = client_->Stream::readBytes(buf, want);
+    if (got == 0) break;
+    body.concat(buf, got);
+    if (remaining > 0) remaining -= (long)got;
+  }
+  return body;
+}
+
+String HTTPClient::errorToString(int error) {
+  switch (error) {
+    case HTTPC_ERROR_CONNECTION_REFUSED: return F("connection refused");
+    case HTTPC_ERROR_SEND_HEADER_FAILED: return F("send header failed");
+    case HTTPC_ERROR_SEND_PAYLOAD_FAILED: return F("send payload failed");
+    case HTTPC_ERROR_NOT_CONNECTED: return F("not connected");
+    case HTTPC_ERROR_CONNECTION_LOST: return F("connection lost");
+    case HTTPC_ERROR_NO_STREAM: return F("no stream");
+    case HTTPC_ERROR_NO_HTTP_SERVER: return F("no HTTP server");
+    case HTTPC_ERROR_TOO_LESS_RAM: return F("too less ram");
+    case HTTPC_ERROR_ENCODING: return F("Transfer-Encoding not supported");
+    case HTTPC_ERROR_STREAM_WRITE: return F("Stream write error");
+    case HTTPC_ERROR_READ_TIMEOUT: return F("read Timeout");
+    default: return String();
+  }
+}
@@ -0,0 +1,70 @@
+#ifndef NATIVE_HTTPCLIENT_H
+#define NATIVE_HTTPCLIENT_H
+
+#include <vector>
+#include "Arduino.h"
+#include "WiFiClient.h"
+
+#define HTTPC_ERROR_CONNECTION_REFUSED (-1)
+#define HTTPC_ERROR_SEND_HEADER_FAILED (-2)
+#define HTTPC_ERROR_SEND_PAYLOAD_FAILED (-3)
+#define HTTPC_ERROR_NOT_CONNECTED (-4)
+#define HTTPC_ERROR_CONNECTION_LOST (-5)
+#define HTTPC_ERROR_NO_STREAM (-6)
+#define HTTPC_ERROR_NO_HTTP_SERVER (-7)
+#define HTTPC_ERROR_TOO_LESS_RAM (-8)
+#define HTTPC_ERROR_ENCODING (-9)
+#define HTTPC_ERROR_STREAM_WRITE (-10)
+#define HTTPC_ERROR_READ_TIMEOUT (-11)
+
+#define HTTPC_DEFAULT_TCP_TIMEOUT 5000
+
+// Blocking HTTP/1.1 client with the same surface and error codes as the
+// ESP32 core. Plain http only; https URLs resolve but the TLS client refuses
+// to connect.
+class HTTPClient {
+ public:
+  HTTPClient() {}
+  ~HTTPClient() { end(); }
+
+  bool begin(WiFiClient& client, const String& url);
+  bool begin(const String& url);
+  void end();
+
+  void setTimeout(uint16_t timeoutMs) { timeoutMs_ = timeoutMs; }
+  void setConnectTimeout(int32_t timeoutMs) { connectTimeoutMs_ = timeoutMs; }
+  void setReuse(bool reuse) { reuse_ = reuse; }
+  void setUserAgent(const String& userAgent) { userAgent_ = userAgent; }
+  void addHeader(const String& name, const String& value);
+
+  int GET();
+  int POST(const String& payload);
+  int POST(const uint8_t* payload, size_t size);
+  int sendRequest(const char* method, const uint8_t* payload = nullptr, size_t size = 0);
+
+  int getSize() const { return contentLength_; }
+  String getString();
+  WiFiClient* getStreamPtr() { return client_; }
+  static String errorToString(int error);
+
+ private:
+  bool readLine(String& line);
+  int handleHeaderResponse();
+
+  WiFiClient ownClient_;
+  WiFiClient* client_ = nullptr;
+  String host_;
+  String uri_;
+  uint16_t port_ = 80;
+  bool secure_ = false;
+  bool reuse_ = true;
+  uint16_t timeoutMs_ = HTTPC_DEFAULT_TCP_TIMEOUT;
+  int32_t connectTimeoutMs_ = HTTPC_DEFAULT_TCP_TIMEOUT;
+  String userAgent_ = "ESP32HTTPClient";
+  String headers_;
+  int contentLength_ = -1;
+  bool chunked_ = false;
+  int code_ = 0;
+};
+
+#endif
@@ -0,0 +1,46 @@
+#include "IPAddress.h"
+#include <stdio.h>
+#include <string.h>
+
+IPAddress::IPAddress(uint32_t address) {
+  memcpy(bytes_, &address, sizeof(bytes_));
+}
+
+IPAddress::operator uint32_t() const {
+  uint32_t address;
+  memcpy(&address, bytes_, sizeof(address));
+  return address;
+}
+
+bool IPAddress::fromString(const char* address) {
+  if (address == nullptr) return false;
+  uint16_t acc = 0;
+  uint8_t dots = 0;
+  bool digit = false;
+  uint8_t parsed[4];
+  for (const char* p = address; *p; p++) {
+    char c = *p;
+    if (c >= '0' && c <= '9') {
+      acc = acc * 10 + (c - '0');
+      if (acc > 255) return false;
+      digit = true;
+    } else if (c == '.') {
+      if (!digit || dots == 3) return false;
+      parsed[dots++] = (uint8_t)acc;
+      acc = 0;
+      digit = false;
+    } else {
+      return false;
+    }
+  }
+  if (dots != 3 || !digit) return false;
+  parsed[3] = (uint8_t)acc;
+  memcpy(bytes_, parsed, sizeof(bytes_));
+  return true;
+}
+
+String IPAddress::toString() const {
+  char buf[16];
+  snprintf(buf, sizeof(buf), "%u.%u.%u.%u", bytes_[0], bytes_[1], bytes_[2], bytes_[3]);
+  return String(buf);
+}
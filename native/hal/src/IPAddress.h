@@ -0,0 +1,34 @@
+#ifndef NATIVE_IPADDRESS_H
+#define NATIVE_IPADDRESS_H
+
+#include <stdint.h>
+#include "WString.h"
+
+// IPv4 only. The uint32_t form keeps the bytes in network order, like the
+// ESP32 core, so it can be assigned straight to sockaddr_in.sin_addr.s_addr.
+class IPAddress {
+ public:
+  IPAddress() : IPAddress((uint32_t)0) {}
+  IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d) {
+    bytes_[0] = a;
+    bytes_[1] = b;
+    bytes_[2] = c;
+    bytes_[3] = d;
+  }
+  IPAddress(uint32_t address);
+
+  operator uint32_t() const;
+  bool operator==(const IPAddress& other) const { return (uint32_t)*this == (uint32_t)other; }
+  bool operator!=(const IPAddress& other) const { return !(*this == other); }
+  uint8_t operator[](int index) const { return bytes_[index & 3]; }
+  uint8_t& operator[](int index) { return bytes_[index & 3]; }
+
+  bool fromString(const char* address);
+  bool fromString(const String& address) { return fromString(address.c_str()); }
+  String toString() const;
+
+ private:
+  uint8_t bytes_[4];
+};
+
+#endif
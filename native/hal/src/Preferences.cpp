@@ -0,0 +1,201 @@
+#include "Preferences.h"
+#include "native_hal.h"
+#include <map>
+#include <stdio.h>
+#include <string>
+
+namespace {
+
+struct NvsEntry {
+  char type;
+  std::string bytes;
+};
+
+typedef std::map<std::string, NvsEntry> NvsNamespace;
+
+std::map<std::string, NvsNamespace>& store() {
+  static std::map<std::string, NvsNamespace> s;
+  return s;
+}
+
+HalNvsStats stats = {0, 0, 0, 0, 0};
+
+const size_t NVS_KEY_NAME_MAX = 15;
+const size_t NVS_TOTAL_ENTRIES = 630;  // 0x6000 partition: 3 usable pages x 126 entries, rounded
+
+bool validName(const char* name) {
+  return name != nullptr && name[0] != '\0' && strlen(name) <= NVS_KEY_NAME_MAX;
+}
+
+size_t usedEntries() {
+  size_t used = 0;
+  for (const auto& ns : store()) {
+    used += 1;  // namespace index entry
+    for (const auto& kv : ns.second) {
+      // Strings and blobs span one header entry plus one per 32 bytes of data
+      used += (kv.second.type == 'Z' || kv.second.type == 'B') ? 1 + (kv.second.bytes.size() + 31) / 32 : 1;
+    }
+  }
+  return used;
+}
+
+}  // namespace
+
+const HalNvsStats& halNvsStats() {
+  return stats;
+}
+
+void halNvsResetStats() {
+  stats = HalNvsStats{0, 0, 0, 0, 0};
+}
+
+void halNvsErase() {
+  store().clear();
+}
+
+// One line per entry: namespace, key, type tag and hex-encoded value
+bool halNvsSave(const char* path) {
+  FILE* f = fopen(path, "w");
+  if (f == nullptr) return false;
+  for (const auto& ns : store()) {
+    for (const auto& kv : ns.second) {
+      fprintf(f, "%s %s %c ", ns.first.c_str(), kv.first.c_str(), kv.second.type);
+      for (unsigned char c : kv.second.bytes) fprintf(f, "%02x", c);
+      fputc('\n', f);
+    }
+  }
+  fclose(f);
+  return true;
+}
+
+bool halNvsLoad(const char* path) {
+  FILE* f = fopen(path, "r");
+  if (f == nullptr) return false;
+  char ns[32], key[32], type;
+  char hex[8192];
+  while (fscanf(f, "%31s %31s %c %8191s", ns, key, &type, hex) >= 3) {
+    NvsEntry entry{type, std::string()};
+    for (size_t i = 0; hex[i] && hex[i + 1]; i += 2) {
+      unsigned int byte;
+      sscanf(hex + i, "%2x", &byte);
+      entry.bytes.push_back((char)byte);
+    }
+    store()[ns][key] = entry;
+    hex[0] = '\0';
+  }
+  fclose(f);
+  return true;
+}
+
+bool Preferences::begin(const char* name, bool readOnly, const char* partitionLabel) {
+  (void)partitionLabel;
+  if (open_ || !validName(name)) return false;
+  auto& s = store();
+  if (s.find(name) == s.end()) {
+    // nvs_open(NVS_READONLY) fails with ESP_ERR_NVS_NOT_FOUND for a new namespace
+    if (readOnly) return false;
+    s[name];
+  }
+  ns_ = name;
+  readOnly_ = readOnly;
+  open_ = true;
+  stats.opens++;
+  return true;
+}
+
+void Preferences::end() {
+  open_ = false;
+}
+
+bool Preferences::clear() {
+  if (!open_ || readOnly_) return false;
+  store()[ns_].clear();
+  stats.erases++;
+  return true;
+}
+
+bool Preferences::remove(const char* key) {
+  if (!open_ || readOnly_ || !validName(key)) return false;
+  if (store()[ns_].erase(key) == 0) return false;
+  stats.erases++;
+  return true;
+}
+
+bool Preferences::isKey(const char* key) {
+  if (!open_ || !validName(key)) return false;
+  const auto& ns = store()[ns_];
+  return ns.find(key) != ns.end();
+}
+
+size_t Preferences::freeEntries() {
+  size_t used = usedEntries();
+  return used >= NVS_TOTAL_ENTRIES ? 0 : NVS_TOTAL_ENTRIES - used;
+}
+
+size_t Preferences::putRaw(const char* key, char type, const void* value, size_t len) {
+  if (!open_ || readOnly_ || !validName(key) || value == nullptr) return 0;
+  NvsEntry entry{type, std::string(static_cast<const char*>(value), len)};
+  auto& ns = store()[ns_];
+  auto it = ns.find(key);
+  if (it != ns.end() && it->second.type == entry.type && it->second.bytes == entry.bytes) {
+    // nvs_set_* skips the flash write when the stored value is identical
+    stats.unchangedWrites++;
+    return len;
+  }
+  ns[key] = entry;
+  stats.writes++;
+  return len;
+}
+
+bool Preferences::getRaw(const char* key, char type, void* out, size_t len) {
+  if (!open_ || !validName(key)) return false;
+  stats.reads++;
+  const auto& ns = store()[ns_];
+  auto it = ns.find(key);
+  if (it == ns.end() || it->second.type != type || it->second.bytes.size() != len) return false;
+  memcpy(out, it->second.bytes.data(), len);
+  return true;
+}
+
+size_t Preferences::putString(const char* key, const char* value) {
+  if (value == nullptr) return 0;
+  size_t len = strlen(value);
+  return putRaw(key, 'Z', value, len) == len ? len : 0;
+}
+
+size_t Preferences::getString(const char* key, char* value, size_t maxLen) {
+  if (!open_ || !validName(key)) return 0;
+  stats.reads++;
+  const auto& ns = store()[ns_];
+  auto it = ns.find(key);
+  if (it == ns.end() || it->second.type != 'Z') return 0;
+  size_t len = it->second.bytes.size() + 1;
+  if (value == nullptr) return len;
+  if (len > maxLen) return 0;
+  memcpy(value, it->second.bytes.c_str(), len);
+  return len;
+}
+
+String Preferences::getString(const char* key, String defaultValue) {
+  if (!open_ || !validName(key)) return defaultValue;
+  stats.reads++;
+  const auto& ns = store()[ns_];
+  auto it = ns.find(key);
+  if (it == ns.end() || it->second.type != 'Z') return defaultValue;
+  return String(it->second.bytes.c_str());
+}
+
+size_t Preferences::getBytesLength(const char* key) {
+  if (!open_ || !validName(key)) return 0;
+  const auto& ns = store()[ns_];
+  auto it = ns.find(key);
+  return (it == ns.end() || it->second.type != 'B') ? 0 : it->second.bytes.size();
+}
+
+size_t Preferences::getBytes(const char* key, void* buf, size_t maxLen) {
+  size_t len = getBytesLength(key);
+  if (len == 0 || buf == nullptr || len > maxLen) return 0;
+  stats.reads++;
+  memcpy(buf, store()[ns_][key].bytes.data(), len);
+  return len;
+}
@@ -0,0 +1,74 @@
+#ifndef NATIVE_PREFERENCES_H
+#define NATIVE_PREFERENCES_H
+
+#include "Arduino.h"
+
+// In-memory NVS with the ESP32 Preferences API. Values are typed like real
+// NVS (a getInt on a key stored with putULong returns the default), names are
+// capped at 15 characters, and read-only handles reject writes. Every open,
+// read and changed write is counted in halNvsStats() so flash traffic can be
+// measured off-target.
+class Preferences {
+ public:
+  Preferences() {}
+  ~Preferences() { end(); }
+
+  bool begin(const char* name, bool readOnly = false, const char* partitionLabel = nullptr);
+  void end();
+
+  bool clear();
+  bool remove(const char* key);
+  bool isKey(const char* key);
+  size_t freeEntries();
+
+  size_t putChar(const char* key, int8_t value) { return putRaw(key, 'c', &value, sizeof(value)); }
+  size_t putUChar(const char* key, uint8_t value) { return putRaw(key, 'C', &value, sizeof(value)); }
+  size_t putShort(const char* key, int16_t value) { return putRaw(key, 's', &value, sizeof(value)); }
+  size_t putUShort(const char* key, uint16_t value) { return putRaw(key, 'S', &value, sizeof(value)); }
+  size_t putInt(const char* key, int32_t value) { return putRaw(key, 'i', &value, sizeof(value)); }
+  size_t putUInt(const char* key, uint32_t value) { return putRaw(key, 'I', &value, sizeof(value)); }
+  size_t putLong(const char* key, int32_t value) { return putRaw(key, 'i', &value, sizeof(value)); }
+  size_t putULong(const char* key, uint32_t value) { return putRaw(key, 'I', &value, sizeof(value)); }
+  size_t putLong64(const char* key, int64_t value) { return putRaw(key, 'q', &value, sizeof(value)); }
+  size_t putULong64(const char* key, uint64_t value) { return putRaw(key, 'Q', &value, sizeof(value)); }
+  size_t putFloat(const char* key, float value) { return putRaw(key, 'B', &value, sizeof(value)); }
+  size_t putDouble(const char* key, double value) { return putRaw(key, 'B', &value, sizeof(value)); }
+  size_t putBool(const char* key, bool value) { return putUChar(key, value ? 1 : 0); }
+  size_t putString(const char* key, const char* value);
+  size_t putString(const char* key, const String& value) { return putString(key, value.c_str()); }
+  size_t putBytes(const char* key, const void* value, size_t len) { return putRaw(key, 'B', value, len); }
+
+  int8_t getChar(const char* key, int8_t defaultValue = 0) { return getScalar(key, 'c', defaultValue); }
+  uint8_t getUChar(const char* key, uint8_t defaultValue = 0) { return getScalar(key, 'C', defaultValue); }
+  int16_t getShort(const char* key, int16_t defaultValue = 0) { return getScalar(key, 's', defaultValue); }
+  uint16_t getUShort(const char* key, uint16_t defaultValue = 0) { return getScalar(key, 'S', defaultValue); }
+  int32_t getInt(const char* key, int32_t defaultValue = 0) { return getScalar(key, 'i', defaultValue); }
+  uint32_t getUInt(const char* key, uint32_t defaultValue = 0) { return getScalar(key, 'I', defaultValue); }
+  int32_t getLong(const char* key, int32_t defaultValue = 0) { return getScalar(key, 'i', defaultValue); }
+  uint32_t getULong(const char* key, uint32_t defaultValue = 0) { return getScalar(key, 'I', defaultValue); }
+  int64_t getLong64(const char* key, int64_t defaultValue = 0) { return getScalar(key, 'q', defaultValue); }
+  uint64_t getULong64(const char* key, uint64_t defaultValue = 0) { return getScalar(key, 'Q', defaultValue); }
+  float getFloat(const char* key, float defaultValue = NAN) { return getScalar(key, 'B', defaultValue); }
+  double getDouble(const char* key, double defaultValue = NAN) { return getScalar(key, 'B', defaultValue); }
+  bool getBool(const char* key, bool defaultValue = false) { return getUChar(key, defaultValue ? 1 : 0) != 0; }
+  size_t getString(const char* key, char* value, size_t maxLen);
+  String getString(const char* key, String defaultValue = String());
+  size_t getBytesLength(const char* key);
+  size_t getBytes(const char* key, void* buf, size_t maxLen);
+
+ private:
+  size_t putRaw(const char* key, char type, const void* value, size_t len);
+  bool getRaw(const char* key, char type, void* out, size_t len);
+
+  template <typename T>
+  T getScalar(const char* key, char type, T defaultValue) {
+    T value;
+    return getRaw(key, type, &value, sizeof(value)) ? value : defaultValue;
+  }
+
+  std::string ns_;
+  bool open_ = false;
+  bool readOnly_ = false;
+};
+
+#endif
@@ -0,0 +1,327 @@
+#include "PubSubClient.h"
+#include "hal_internal.h"
+#include "native_hal.h"
+#include <deque>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct Session {
+  PubSubClient* client;
+  std::vector<std::string> filters;
+  std::string willTopic;
+  std::string willMessage;
+  bool willRetain;
+  bool open;
+};
+
+struct Message {
+  int session;  // -1 = every matching session
+  std::string topic;
+  std::string payload;
+};
+
+struct Broker {
+  bool up = true;
+  bool trace = false;
+  std::vector<Session> sessions;
+  std::map<std::string, std::string> retained;
+  std::map<std::string, std::string> last;
+  std::deque<Message> inbound;
+  HalMqttStats stats = {0, 0, 0, 0, 0};
+};
+
+Broker& broker() {
+  static Broker b;
+  return b;
+}
+
+// MQTT topic filter matching: '+' spans one level, a trailing '#' the rest
+bool topicMatches(const std::string& filter, const std::string& topic) {
+  size_t f = 0, t = 0;
+  while (f < filter.size()) {
+    if (filter[f] == '#') return true;
+    if (filter[f] == '+') {
+      while (t < topic.size() && topic[t] != '/') t++;
+      f++;
+      continue;
+    }
+    if (t >= topic.size() || filter[f] != topic[t]) return false;
+    f++;
+    t++;
+  }
+  return t == topic.size();
+}
+
+void queueForSubscribers(const std::string& topic, const std::string& payload) {
+  Broker& b = broker();
+  for (size_t i = 0; i < b.sessions.size(); i++) {
+    if (!b.sessions[i].open) continue;
+    for (const auto& filter : b.sessions[i].filters) {
+      if (topicMatches(filter, topic)) {
+        b.inbound.push_back(Message{(int)i, topic, payload});
+        break;
+      }
+    }
+  }
+}
+
+}  // namespace
+
+void halMqttSetBrokerUp(bool up) {
+  Broker& b = broker();
+  b.up = up;
+  if (up) return;
+  // Broker loss: publish each client's will and drop the sessions
+  for (auto& s : b.sessions) {
+    if (!s.open) continue;
+    s.open = false;
+    if (!s.willTopic.empty()) {
+      b.last[s.willTopic] = s.willMessage;
+      if (s.willRetain) b.retained[s.willTopic] = s.willMessage;
+    }
+  }
+}
+
+void halMqttSetTrace(bool enabled) {
+  broker().trace = enabled;
+}
+
+void halMqttInject(const char* topic, const char* payload) {
+  queueForSubscribers(topic, payload);
+}
+
+const HalMqttStats& halMqttStats() {
+  return broker().stats;
+}
+
+void halMqttResetStats() {
+  broker().stats = HalMqttStats{0, 0, 0, 0, 0};
+}
+
+const char* halMqttLastPayload(const char* topic) {
+  const auto& last = broker().last;
+  auto it = last.find(topic);
+  return it == last.end() ? nullptr : it->second.c_str();
+}
+
+PubSubClient::~PubSubClient() {
+  disconnect();
+}
+
+PubSubClient& PubSubClient::setServer(IPAddress ip, uint16_t port) {
+  host_ = ip.toString().c_str();
+  port_ = port;
+  return *this;
+}
+
+PubSubClient& PubSubClient::setServer(const char* domain, uint16_t port) {
+  host_ = domain ? domain : "";
+  port_ = port;
+  return *this;
+}
+
+PubSubClient& PubSubClient::setCallback(MQTT_CALLBACK_SIGNATURE) {
+  callback_ = callback;
+  return *this;
+}
+
+bool PubSubClient::setBufferSize(uint16_t size) {
+  if (size == 0) return false;
+  bufferSize_ = size;
+  return true;
+}
+
+bool PubSubClient::connect(const char* id) {
+  return connectCommon(id, nullptr, false, nullptr);
+}
+
+bool PubSubClient::connect(const char* id, const char* user, const char* pass) {
+  (void)user;
+  (void)pass;
+  return connectCommon(id, nullptr, false, nullptr);
+}
+
+bool PubSubClient::connect(const char* id, const char* willTopic, uint8_t willQos, bool willRetain,
+                           const char* willMessage) {
+  (void)willQos;
+  return connectCommon(id, willTopic, willRetain, willMessage);
+}
+
+bool PubSubClient::connect(const char* id, const char* user, const char* pass, const char* willTopic,
+                           uint8_t willQos, bool willRetain, const char* willMessage, bool cleanSession) {
+  (void)user;
+  (void)pass;
+  (void)willQos;
+  (void)cleanSession;
+  return connectCommon(id, willTopic, willRetain, willMessage);
+}
+
+bool PubSubClient::connectCommon(const char* id, const char* willTopic, bool willRetain, const char* willMessage) {
+  if (connected()) return true;
+  Broker& b = broker();
+  if (id == nullptr || id[0] == '\0') {
+    state_ = MQTT_CONNECT_BAD_CLIENT_ID;
+    return false;
+  }
+  if (!halWiFiIsUp() || !b.up || host_.empty()) {
+    state_ = MQTT_CONNECT_FAILED;
+    return false;
+  }
+  Session s;
+  s.client = this;
+  s.willTopic = willTopic ? willTopic : "";
+  s.willMessage = willMessage ? willMessage : "";
+  s.willRetain = willRetain;
+  s.open = true;
+  b.sessions.push_back(s);
+  sessionId_ = (int)b.sessions.size() - 1;
+  b.stats.connects++;
+  state_ = MQTT_CONNECTED;
+  return true;
+}
+
+void PubSubClient::disconnect() {
+  Broker& b = broker();
+  if (sessionId_ >= 0 && sessionId_ < (int)b.sessions.size()) {
+    b.sessions[sessionId_].open = false;
+  }
+  sessionId_ = -1;
+  streaming_ = false;
+  state_ = MQTT_DISCONNECTED;
+}
+
+bool PubSubClient::connected() {
+  if (sessionId_ < 0) return false;
+  Broker& b = broker();
+  if (!b.up || !halWiFiIsUp() || !b.sessions[sessionId_].open) {
+    b.sessions[sessionId_].open = false;
+    sessionId_ = -1;
+    state_ = MQTT_CONNECTION_LOST;
+    return false;
+  }
+  return true;
+}
+
+bool PubSubClient::deliverPublish(const std::string& topic, const std::string& payload, bool retained) {
+  Broker& b = broker();
+  b.stats.publishes++;
+  b.stats.publishBytes += topic.size() + payload.size();
+  b.last[topic] = payload;
+  if (retained) {
+    if (payload.empty()) {
+      b.retained.erase(topic);
+    } else {
+      b.retained[topic] = payload;
+    }
+  }
+  if (b.trace) {
+    ::printf("[MQTT] %s%s = %s\n", topic.c_str(), retained ? " (retained)" : "", payload.c_str());
+  }
+  queueForSubscribers(topic, payload);
+  return true;
+}
+
+bool PubSubClient::publish(const char* topic, const char* payload) {
+  return publish(topic, payload, false);
+}
+
+bool PubSubClient::publish(const char* topic, const char* payload, bool retained) {
+  return publish(topic, reinterpret_cast<const uint8_t*>(payload), payload ? strlen(payload) : 0, retained);
+}
+
+bool PubSubClient::publish(const char* topic, const uint8_t* payload, unsigned int plength) {
+  return publish(topic, payload, plength, false);
+}
+
+bool PubSubClient::publish(const char* topic, const uint8_t* payload, unsigned int plength, bool retained) {
+  if (!connected() || topic == nullptr) return false;
+  // Same bound as PubSubClient::publish(): fixed header + topic length prefix + topic + payload
+  if ((size_t)bufferSize_ < MQTT_MAX_HEADER_SIZE + 2 + strlen(topic) + plength) {
+    broker().stats.oversizeRejected++;
+    return false;
+  }
+  return deliverPublish(topic, std::string(reinterpret_cast<const char*>(payload), plength), retained);
+}
+
+bool PubSubClient::beginPublish(const char* topic, unsigned int plength, bool retained) {
+  if (!connected() || topic == nullptr) return false;
+  streaming_ = true;
+  streamRetained_ = retained;
+  streamExpected_ = plength;
+  streamTopic_ = topic;
+  streamPayload_.clear();
+  streamPayload_.reserve(plength);
+  return true;
+}
+
+size_t PubSubClient::write(uint8_t data) {
+  return write(&data, 1);
+}
+
+size_t PubSubClient::write(const uint8_t* buffer, size_t size) {
+  if (!streaming_ || !connected()) return 0;
+  streamPayload_.append(reinterpret_cast<const char*>(buffer), size);
+  return size;
+}
+
+int PubSubClient::endPublish() {
+  if (!streaming_) return 0;
+  streaming_ = false;
+  // A length mismatch corrupts the packet on a real socket; the broker drops it
+  if (streamPayload_.size() != streamExpected_) {
+    fprintf(stderr, "[HAL] MQTT beginPublish(%s) announced %u bytes, wrote %zu\n", streamTopic_.c_str(),
+            streamExpected_, streamPayload_.size());
+    return 0;
+  }
+  return deliverPublish(streamTopic_, streamPayload_, streamRetained_) ? 1 : 0;
+}
+
+bool PubSubClient::subscribe(const char* topic, uint8_t qos) {
+  (void)qos;
+  if (!connected() || topic == nullptr || strlen(topic) + 9 > bufferSize_) return false;
+  Broker& b = broker();
+  b.sessions[sessionId_].filters.push_back(topic);
+  for (const auto& kv : b.retained) {
+    if (topicMatches(topic, kv.first)) b.inbound.push_back(Message{sessionId_, kv.first, kv.second});
+  }
+  return true;
+}
+
+bool PubSubClient::unsubscribe(const char* topic) {
+  if (!connected() || topic == nullptr) return false;
+  auto& filters = broker().sessions[sessionId_].filters;
+  for (size_t i = 0; i < filters.size(); i++) {
+    if (filters[i] == topic) {
+      filters.erase(filters.begin() + (long)i);
+      return true;
+    }
+  }
+  return true;
+}
+
+bool PubSubClient::loop() {
+  if (!connected()) return false;
+  // Like the real client, at most one inbound packet is handled per loop()
+  Broker& b = broker();
+  for (auto it = b.inbound.begin(); it != b.inbound.end(); ++it) {
+    if (it->session != sessionId_) continue;
+    Message msg = *it;
+    b.inbound.erase(it);
+    if ((size_t)bufferSize_ < MQTT_MAX_HEADER_SIZE + 2 + msg.topic.size() + msg.payload.size()) {
+      return true;  // too large for our buffer: silently dropped, as on target
+    }
+    if (callback_) {
+      std::vector<char> topic(msg.topic.begin(), msg.topic.end());
+      topic.push_back('\0');
+      std::vector<uint8_t> payload(msg.payload.begin(), msg.payload.end());
+      payload.push_back(0);
+      b.stats.delivered++;
+      callback_(topic.data(), payload.data(), (unsigned int)msg.payload.size());
+    }
+    break;
+  }
+  return true;
+}
@@ -0,0 +1,97 @@
+#ifndef NATIVE_PUBSUBCLIENT_H
+#define NATIVE_PUBSUBCLIENT_H
+
+#include <functional>
+#include <string>
+#include "Arduino.h"
+#include "Client.h"
+#include "IPAddress.h"
+
+#define MQTT_VERSION_3_1_1 4
+#define MQTT_MAX_PACKET_SIZE 256
+#define MQTT_KEEPALIVE 15
+#define MQTT_SOCKET_TIMEOUT 15
+#define MQTT_MAX_HEADER_SIZE 5
+
+#define MQTT_CONNECTION_TIMEOUT (-4)
+#define MQTT_CONNECTION_LOST (-3)
+#define MQTT_CONNECT_FAILED (-2)
+#define MQTT_DISCONNECTED (-1)
+#define MQTT_CONNECTED 0
+#define MQTT_CONNECT_BAD_PROTOCOL 1
+#define MQTT_CONNECT_BAD_CLIENT_ID 2
+#define MQTT_CONNECT_UNAVAILABLE 3
+#define MQTT_CONNECT_BAD_CREDENTIALS 4
+#define MQTT_CONNECT_UNAUTHORIZED 5
+
+#define MQTT_CALLBACK_SIGNATURE std::function<void(char*, uint8_t*, unsigned int)> callback
+
+// PubSubClient talking to an in-process broker instead of a socket. Packet
+// size limits match the real library (publishes larger than the buffer are
+// refused), subscriptions honour + and # wildcards, and retained messages are
+// replayed on subscribe. The harness injects inbound commands with
+// halMqttInject(); they are delivered from loop() like real traffic.
+class PubSubClient : public Print {
+ public:
+  PubSubClient() {}
+  explicit PubSubClient(Client& client) { setClient(client); }
+  ~PubSubClient();
+
+  PubSubClient& setServer(IPAddress ip, uint16_t port);
+  PubSubClient& setServer(const char* domain, uint16_t port);
+  PubSubClient& setCallback(MQTT_CALLBACK_SIGNATURE);
+  PubSubClient& setClient(Client& client) { client_ = &client; return *this; }
+  PubSubClient& setKeepAlive(uint16_t keepAlive) { keepAlive_ = keepAlive; return *this; }
+  PubSubClient& setSocketTimeout(uint16_t timeout) { socketTimeout_ = timeout; return *this; }
+  bool setBufferSize(uint16_t size);
+  uint16_t getBufferSize() const { return bufferSize_; }
+
+  bool connect(const char* id);
+  bool connect(const char* id, const char* user, const char* pass);
+  bool connect(const char* id, const char* willTopic, uint8_t willQos, bool willRetain, const char* willMessage);
+  bool connect(const char* id, const char* user, const char* pass, const char* willTopic, uint8_t willQos,
+               bool willRetain, const char* willMessage, bool cleanSession = true);
+  void disconnect();
+
+  bool publish(const char* topic, const char* payload);
+  bool publish(const char* topic, const char* payload, bool retained);
+  bool publish(const char* topic, const uint8_t* payload, unsigned int plength);
+  bool publish(const char* topic, const uint8_t* payload, unsigned int plength, bool retained);
+  bool publish_P(const char* topic, const char* payload, bool retained) { return publish(topic, payload, retained); }
+
+  // Streaming publish: the length is announced up front, then written in pieces
+  bool beginPublish(const char* topic, unsigned int plength, bool retained);
+  int endPublish();
+  size_t write(uint8_t data) override;
+  size_t write(const uint8_t* buffer, size_t size) override;
+  using Print::write;
+
+  bool subscribe(const char* topic, uint8_t qos = 0);
+  bool unsubscribe(const char* topic);
+  bool loop();
+  bool connected();
+  int state() const { return state_; }
+
+ private:
+  bool connectCommon(const char* id, const char* willTopic, bool willRetain, const char* willMessage);
+  bool deliverPublish(const std::string& topic, const std::string& payload, bool retained);
+
+  Client* client_ = nullptr;
+  std::function<void(char*, uint8_t*, unsigned int)> callback_;
+  std::string host_;
+  uint16_t port_ = 1883;
+  uint16_t keepAlive_ = MQTT_KEEPALIVE;
+  uint16_t socketTimeout_ = MQTT_SOCKET_TIMEOUT;
+  uint16_t bufferSize_ = MQTT_MAX_PACKET_SIZE;
+  int state_ = MQTT_DISCONNECTED;
+  int sessionId_ = -1;
+
+  // In-flight beginPublish() state
+  bool streaming_ = false;
+  bool streamRetained_ = false;
+  unsigned int streamExpected_ = 0;
+  std::string streamTopic_;
+  std::string streamPayload_;
+};
+
+#endif
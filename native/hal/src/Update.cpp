@@ -0,0 +1,60 @@
+#include "Update.h"
+#include "esp_ota_ops.h"
+
+UpdateClass Update;
+
+#define UPDATE_ERROR_WRITE 1
+#define UPDATE_ERROR_SPACE 4
+#define UPDATE_ERROR_SIZE 5
+#define UPDATE_ERROR_ABORT 8
+#define UPDATE_ERROR_BAD_ARGUMENT 9
+
+bool UpdateClass::begin(size_t size, int command) {
+  if (partition_ != nullptr || command != U_FLASH || size == 0) {
+    error_ = UPDATE_ERROR_BAD_ARGUMENT;
+    return false;
+  }
+  const esp_partition_t* next = esp_ota_get_next_update_partition(nullptr);
+  if (size == UPDATE_SIZE_UNKNOWN) size = next->size;
+  if (size > next->size) {
+    error_ = UPDATE_ERROR_SPACE;
+    return false;
+  }
+  // The updater erases as it goes; erasing up front is equivalent here
+  esp_partition_erase_range(next, 0, (size + 4095) & ~(size_t)4095);
+  partition_ = next;
+  size_ = size;
+  written_ = 0;
+  error_ = 0;
+  return true;
+}
+
+size_t UpdateClass::write(uint8_t* data, size_t len) {
+  if (partition_ == nullptr || hasError()) return 0;
+  if (len > size_ - written_) {
+    error_ = UPDATE_ERROR_SPACE;
+    return 0;
+  }
+  if (esp_partition_write(partition_, written_, data, len) != ESP_OK) {
+    error_ = UPDATE_ERROR_WRITE;
+    return 0;
+  }
+  written_ += len;
+  return len;
+}
+
+bool UpdateClass::end(bool evenIfRemaining) {
+  if (partition_ == nullptr || hasError()) return false;
+  if (written_ < size_ && !evenIfRemaining) {
+    error_ = UPDATE_ERROR_SIZE;
+    return false;
+  }
+  bool ok = esp_ota_set_boot_partition(partition_) == ESP_OK;
+  partition_ = nullptr;
+  return ok;
+}
+
+void UpdateClass::abort() {
+  partition_ = nullptr;
+  error_ = UPDATE_ERROR_ABORT;
+}
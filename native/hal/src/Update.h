@@ -0,0 +1,36 @@
+#ifndef NATIVE_UPDATE_H
+#define NATIVE_UPDATE_H
+
+#include "Arduino.h"
+#include "esp_partition.h"
+
+#define U_FLASH 0
+#define U_SPIFFS 100
+#define UPDATE_SIZE_UNKNOWN 0xFFFFFFFF
+
+// Streams an image into the inactive in-memory app slot; end(true) makes it
+// the boot partition, as the ESP32 Updater does.
+class UpdateClass {
+ public:
+  bool begin(size_t size = UPDATE_SIZE_UNKNOWN, int command = U_FLASH);
+  size_t write(uint8_t* data, size_t len);
+  bool end(bool evenIfRemaining = false);
+  void abort();
+  bool isRunning() const { return partition_ != nullptr; }
+  bool hasError() const { return error_ != 0; }
+  uint8_t getError() const { return error_; }
+  size_t progress() const { return written_; }
+  size_t size() const { return size_; }
+  size_t remaining() const { return size_ - written_; }
+  void printError(Print& out) { out.printf("Update error %u\r\n", error_); }
+
+ private:
+  const esp_partition_t* partition_ = nullptr;
+  size_t size_ = 0;
+  size_t written_ = 0;
+  uint8_t error_ = 0;
+};
+
+extern UpdateClass Update;
+
+#endif
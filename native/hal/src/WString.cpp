@@ -0,0 +1,212 @@
+#include "WString.h"
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static std::string formatInteger(unsigned long long value, bool negative, unsigned char base) {
+  if (base < 2 || base > 36) base = 10;
+  char buf[72];
+  int pos = sizeof(buf) - 1;
+  buf[pos] = '\0';
+  do {
+    unsigned digit = (unsigned)(value % base);
+    buf[--pos] = (char)(digit < 10 ? '0' + digit : 'a' + digit - 10);
+    value /= base;
+  } while (value != 0 && pos > 1);
+  if (negative) buf[--pos] = '-';
+  return std::string(buf + pos);
+}
+
+static std::string formatSigned(long long value, unsigned char base) {
+  // Arduino only prints a minus sign in base 10; other bases show the bit pattern
+  if (base == 10 && value < 0) {
+    return formatInteger(0ULL - (unsigned long long)value, true, base);
+  }
+  return formatInteger((unsigned long long)value, false, base);
+}
+
+static std::string formatFloat(double value, unsigned int decimalPlaces) {
+  char buf[64];
+  snprintf(buf, sizeof(buf), "%.*f", (int)decimalPlaces, value);
+  return std::string(buf);
+}
+
+String::String(const char* cstr) : buf_(cstr ? cstr : "") {}
+String::String(const char* cstr, size_t length) : buf_(cstr ? std::string(cstr, length) : std::string()) {}
+String::String(const __FlashStringHelper* str) : buf_(str ? reinterpret_cast<const char*>(str) : "") {}
+String::String(char c) : buf_(1, c) {}
+String::String(unsigned char value, unsigned char base) : buf_(formatInteger(value, false, base)) {}
+String::String(int value, unsigned char base) : buf_(formatSigned(value, base)) {}
+String::String(unsigned int value, unsigned char base) : buf_(formatInteger(value, false, base)) {}
+String::String(long value, unsigned char base) : buf_(formatSigned(value, base)) {}
+String::String(unsigned long value, unsigned char base) : buf_(formatInteger(value, false, base)) {}
+String::String(long long value, unsigned char base) : buf_(formatSigned(value, base)) {}
+String::String(unsigned long long value, unsigned char base) : buf_(formatInteger(value, false, base)) {}
+String::String(float value, unsigned int decimalPlaces) : buf_(formatFloat(value, decimalPlaces)) {}
+String::String(double value, unsigned int decimalPlaces) : buf_(formatFloat(value, decimalPlaces)) {}
+
+String& String::operator=(const char* cstr) {
+  buf_ = cstr ? cstr : "";
+  return *this;
+}
+
+bool String::reserve(unsigned int size) {
+  buf_.reserve(size);
+  return true;
+}
+
+bool String::concat(const String& str) { buf_ += str.buf_; return true; }
+bool String::concat(const char* cstr) { if (!cstr) return false; buf_ += cstr; return true; }
+bool String::concat(const char* cstr, unsigned int length) { if (!cstr) return false; buf_.append(cstr, length); return true; }
+bool String::concat(char c) { buf_ += c; return true; }
+bool String::concat(unsigned char num) { buf_ += formatInteger(num, false, 10); return true; }
+bool String::concat(int num) { buf_ += formatSigned(num, 10); return true; }
+bool String::concat(unsigned int num) { buf_ += formatInteger(num, false, 10); return true; }
+bool String::concat(long num) { buf_ += formatSigned(num, 10); return true; }
+bool String::concat(unsigned long num) { buf_ += formatInteger(num, false, 10); return true; }
+bool String::concat(long long num) { buf_ += formatSigned(num, 10); return true; }
+bool String::concat(unsigned long long num) { buf_ += formatInteger(num, false, 10); return true; }
+bool String::concat(float num) { buf_ += formatFloat(num, 2); return true; }
+bool String::concat(double num) { buf_ += formatFloat(num, 2); return true; }
+bool String::concat(const __FlashStringHelper* str) { return concat(reinterpret_cast<const char*>(str)); }
+
+int String::compareTo(const String& s) const { return buf_.compare(s.buf_); }
+bool String::equals(const char* cstr) const { return cstr ? buf_ == cstr : buf_.empty(); }
+
+bool String::equalsIgnoreCase(const String& s) const {
+  if (buf_.size() != s.buf_.size()) return false;
+  for (size_t i = 0; i < buf_.size(); i++) {
+    if (tolower((unsigned char)buf_[i]) != tolower((unsigned char)s.buf_[i])) return false;
+  }
+  return true;
+}
+
+bool String::startsWith(const String& prefix) const { return startsWith(prefix, 0); }
+
+bool String::startsWith(const String& prefix, unsigned int offset) const {
+  if (offset > buf_.size() || prefix.buf_.size() > buf_.size() - offset) return false;
+  return buf_.compare(offset, prefix.buf_.size(), prefix.buf_) == 0;
+}
+
+bool String::endsWith(const String& suffix) const {
+  if (suffix.buf_.size() > buf_.size()) return false;
+  return buf_.compare(buf_.size() - suffix.buf_.size(), suffix.buf_.size(), suffix.buf_) == 0;
+}
+
+char String::charAt(unsigned int index) const { return index < buf_.size() ? buf_[index] : '\0'; }
+
+void String::setCharAt(unsigned int index, char c) {
+  if (index < buf_.size()) buf_[index] = c;
+}
+
+char& String::operator[](unsigned int index) {
+  static char dummy;
+  if (index >= buf_.size()) {
+    dummy = '\0';
+    return dummy;
+  }
+  return buf_[index];
+}
+
+void String::getBytes(unsigned char* buf, unsigned int bufsize, unsigned int index) const {
+  if (!buf || bufsize == 0) return;
+  if (index >= buf_.size()) {
+    buf[0] = 0;
+    return;
+  }
+  size_t n = buf_.size() - index;
+  if (n > bufsize - 1) n = bufsize - 1;
+  memcpy(buf, buf_.data() + index, n);
+  buf[n] = 0;
+}
+
+void String::toCharArray(char* buf, unsigned int bufsize, unsigned int index) const {
+  getBytes(reinterpret_cast<unsigned char*>(buf), bufsize, index);
+}
+
+int String::indexOf(char ch, unsigned int fromIndex) const {
+  size_t pos = buf_.find(ch, fromIndex);
+  return pos == std::string::npos ? -1 : (int)pos;
+}
+
+int String::indexOf(const String& str, unsigned int fromIndex) const {
+  size_t pos = buf_.find(str.buf_, fromIndex);
+  return pos == std::string::npos ? -1 : (int)pos;
+}
+
+int String::lastIndexOf(char ch) const {
+  size_t pos = buf_.rfind(ch);
+  return pos == std::string::npos ? -1 : (int)pos;
+}
+
+int String::lastIndexOf(const String& str) const {
+  size_t pos = buf_.rfind(str.buf_);
+  return pos == std::string::npos ? -1 : (int)pos;
+}
+
+String String::substring(unsigned int beginIndex) const { return substring(beginIndex, length()); }
+
+String String::substring(unsigned int beginIndex, unsigned int endIndex) const {
+  if (beginIndex > endIndex) {
+    unsigned int tmp = beginIndex;
+    beginIndex = endIndex;
+    endIndex = tmp;
+  }
+  if (beginIndex >= buf_.size()) return String();
+  if (endIndex > buf_.size()) endIndex = (unsigned int)buf_.size();
+  return String(buf_.data() + beginIndex, endIndex - beginIndex);
+}
+
+void String::replace(char find, char replace) {
+  for (char& c : buf_) {
+    if (c == find) c = replace;
+  }
+}
+
+void String::replace(const String& find, const String& replace) {
+  if (find.buf_.empty()) return;
+  size_t pos = 0;
+  while ((pos = buf_.find(find.buf_, pos)) != std::string::npos) {
+    buf_.replace(pos, find.buf_.size(), replace.buf_);
+    pos += replace.buf_.size();
+  }
+}
+
+void String::remove(unsigned int index) { remove(index, (unsigned int)-1); }
+
+void String::remove(unsigned int index, unsigned int count) {
+  if (index >= buf_.size()) return;
+  buf_.erase(index, count);
+}
+
+void String::toLowerCase() {
+  for (char& c : buf_) c = (char)tolower((unsigned char)c);
+}
+
+void String::toUpperCase() {
+  for (char& c : buf_) c = (char)toupper((unsigned char)c);
+}
+
+void String::trim() {
+  size_t first = 0;
+  while (first < buf_.size() && isspace((unsigned char)buf_[first])) first++;
+  size_t last = buf_.size();
+  while (last > first && isspace((unsigned char)buf_[last - 1])) last--;
+  buf_ = buf_.substr(first, last - first);
+}
+
+long String::toInt() const { return strtol(buf_.c_str(), nullptr, 10); }
+float String::toFloat() const { return (float)atof(buf_.c_str()); }
+double String::toDouble() const { return atof(buf_.c_str()); }
+
+String operator+(const String& lhs, const String& rhs) { String r(lhs); r.concat(rhs); return r; }
+String operator+(const String& lhs, const char* rhs) { String r(lhs); r.concat(rhs); return r; }
+String operator+(const char* lhs, const String& rhs) { String r(lhs); r.concat(rhs); return r; }
+String operator+(const String& lhs, char rhs) { String r(lhs); r.concat(rhs); return r; }
+String operator+(const String& lhs, int rhs) { String r(lhs); r.concat(rhs); return r; }
+String operator+(const String& lhs, unsigned int rhs) { String r(lhs); r.concat(rhs); return r; }
+String operator+(const String& lhs, long rhs) { String r(lhs); r.concat(rhs); return r; }
+String operator+(const String& lhs, unsigned long rhs) { String r(lhs); r.concat(rhs); return r; }
+String operator+(const String& lhs, float rhs) { String r(lhs); r.concat(rhs); return r; }
+String operator+(const String& lhs, double rhs) { String r(lhs); r.concat(rhs); return r; }
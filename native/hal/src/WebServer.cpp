@@ -0,0 +1,257 @@
+#include "WebServer.h"
+
+static const unsigned long REQUEST_TIMEOUT_MS = 2000;
+static const size_t MAX_BODY_BYTES = 16384;
+
+static const char* statusText(int code) {
+  switch (code) {
+    case 200: return "OK";
+    case 201: return "Created";
+    case 204: return "No Content";
+    case 301: return "Moved Permanently";
+    case 302: return "Found";
+    case 304: return "Not Modified";
+    case 400: return "Bad Request";
+    case 401: return "Unauthorized";
+    case 403: return "Forbidden";
+    case 404: return "Not Found";
+    case 405: return "Method Not Allowed";
+    case 413: return "Payload Too Large";
+    case 429: return "Too Many Requests";
+    case 500: return "Internal Server Error";
+    case 503: return "Service Unavailable";
+    default: return "";
+  }
+}
+
+static HTTPMethod parseMethod(const String& m) {
+  if (m == "GET") return HTTP_GET;
+  if (m == "HEAD") return HTTP_HEAD;
+  if (m == "POST") return HTTP_POST;
+  if (m == "PUT") return HTTP_PUT;
+  if (m == "PATCH") return HTTP_PATCH;
+  if (m == "DELETE") return HTTP_DELETE;
+  if (m == "OPTIONS") return HTTP_OPTIONS;
+  return HTTP_ANY;
+}
+
+static String urlDecode(const String& in) {
+  String out;
+  out.reserve(in.length());
+  for (unsigned int i = 0; i < in.length(); i++) {
+    char c = in[i];
+    if (c == '+') {
+      out += ' ';
+    } else if (c == '%' && i + 2 < in.length()) {
+      char hex[3] = {in[i + 1], in[i + 2], 0};
+      out += (char)strtol(hex, nullptr, 16);
+      i += 2;
+    } else {
+      out += c;
+    }
+  }
+  return out;
+}
+
+void WebServer::on(const String& uri, HTTPMethod method, THandlerFunction handler) {
+  routes_.push_back(Route{uri, method, handler});
+}
+
+void WebServer::on(const String& uri, HTTPMethod method, THandlerFunction handler, THandlerFunction upload) {
+  (void)upload;
+  on(uri, method, handler);
+}
+
+void WebServer::handleClient() {
+  client_ = server_.available();
+  if (!client_) return;
+
+  if (readRequest()) {
+    bool handled = false;
+    for (const auto& route : routes_) {
+      if (route.uri == uri_ && (route.method == HTTP_ANY || route.method == method_)) {
+        route.handler();
+        handled = true;
+        break;
+      }
+    }
+    if (!handled) {
+      if (notFound_) {
+        notFound_();
+      } else {
+        send(404, "text/plain", String("Not found: ") + uri_);
+      }
+    }
+    finishResponse();
+  }
+  client_.stop();
+}
+
+bool WebServer::readRequest() {
+  args_.clear();
+  headers_.clear();
+  pendingHeaders_ = "";
+  contentLength_ = CONTENT_LENGTH_NOT_SET;
+  chunked_ = false;
+  headersSent_ = false;
+
+  client_.Stream::setTimeout(REQUEST_TIMEOUT_MS);
+  String line = client_.readStringUntil('\n');
+  line.trim();
+  int sp1 = line.indexOf(' ');
+  int sp2 = line.indexOf(' ', sp1 + 1);
+  if (sp1 <= 0 || sp2 <= sp1) return false;
+
+  method_ = parseMethod(line.substring(0, sp1));
+  String url = line.substring(sp1 + 1, sp2);
+  int q = url.indexOf('?');
+  uri_ = q >= 0 ? url.substring(0, q) : url;
+
+  size_t bodyLength = 0;
+  String contentType;
+  while (true) {
+    line = client_.readStringUntil('\n');
+    line.trim();
+    if (line.length() == 0) break;
+    int colon = line.indexOf(':');
+    if (colon <= 0) continue;
+    String name = line.substring(0, colon);
+    String value = line.substring(colon + 1);
+    value.trim();
+    if (name.equalsIgnoreCase("Content-Length")) bodyLength = (size_t)value.toInt();
+    if (name.equalsIgnoreCase("Content-Type")) contentType = value;
+    headers_.push_back(KeyValue{name, value});
+  }
+
+  if (q >= 0) parseArgs(url.substring(q + 1));
+
+  if (bodyLength > 0 && bodyLength <= MAX_BODY_BYTES) {
+    std::vector<char> body(bodyLength);
+    size_t got = client_.Stream::readBytes(body.data(), bodyLength);
+    String plain;
+    plain.concat(body.data(), got);
+    if (contentType.startsWith("application/x-www-form-urlencoded")) parseArgs(plain);
+    args_.push_back(KeyValue{"plain", plain});
+  }
+  return true;
+}
+
+void WebServer::parseArgs(const String& query) {
+  int start = 0;
+  while (start < (int)query.length()) {
+    int amp = query.indexOf('&', start);
+    if (amp < 0) amp = query.length();
+    String pair = query.substring(start, amp);
+    int eq = pair.indexOf('=');
+    if (pair.length() > 0) {
+      if (eq >= 0) {
+        args_.push_back(KeyValue{urlDecode(pair.substring(0, eq)), urlDecode(pair.substring(eq + 1))});
+      } else {
+        args_.push_back(KeyValue{urlDecode(pair), String()});
+      }
+    }
+    start = amp + 1;
+  }
+}
+
+String WebServer::arg(const String& name) const {
+  for (const auto& kv : args_) {
+    if (kv.key == name) return kv.value;
+  }
+  return String();
+}
+
+String WebServer::arg(int i) const {
+  return (i >= 0 && i < (int)args_.size()) ? args_[i].value : String();
+}
+
+String WebServer::argName(int i) const {
+  return (i >= 0 && i < (int)args_.size()) ? args_[i].key : String();
+}
+
+bool WebServer::hasArg(const String& name) const {
+  for (const auto& kv : args_) {
+    if (kv.key == name) return true;
+  }
+  return false;
+}
+
+void WebServer::collectHeaders(const char* headerKeys[], size_t count) {
+  collectKeys_.clear();
+  for (size_t i = 0; i < count; i++) collectKeys_.push_back(headerKeys[i]);
+}
+
+String WebServer::header(const String& name) const {
+  for (const auto& kv : headers_) {
+    if (kv.key.equalsIgnoreCase(name)) return kv.value;
+  }
+  return String();
+}
+
+bool WebServer::hasHeader(const String& name) const {
+  for (const auto& kv : headers_) {
+    if (kv.key.equalsIgnoreCase(name)) return true;
+  }
+  return false;
+}
+
+void WebServer::sendHeader(const String& name, const String& value, bool first) {
+  String line = name + ": " + value + "\r\n";
+  pendingHeaders_ = first ? line + pendingHeaders_ : pendingHeaders_ + line;
+}
+
+void WebServer::writeHeaders(int code, const char* contentType, size_t length) {
+  String head = String("HTTP/1.1 ") + String(code) + " " + statusText(code) + "\r\n";
+  if (contentType != nullptr && contentType[0] != '\0') {
+    head += String("Content-Type: ") + contentType + "\r\n";
+  }
+  if (contentLength_ != CONTENT_LENGTH_NOT_SET) length = contentLength_;
+  if (length == CONTENT_LENGTH_UNKNOWN) {
+    chunked_ = true;
+    head += "Transfer-Encoding: chunked\r\n";
+  } else {
+    head += String("Content-Length: ") + String((unsigned long)length) + "\r\n";
+  }
+  head += pendingHeaders_;
+  head += "Connection: close\r\n\r\n";
+  client_.write(reinterpret_cast<const uint8_t*>(head.c_str()), head.length());
+  pendingHeaders_ = "";
+  headersSent_ = true;
+}
+
+void WebServer::send(int code, const char* contentType, const String& content) {
+  send(code, contentType, content.c_str(), content.length());
+}
+
+void WebServer::send(int code, const char* contentType, const char* content, size_t length) {
+  if (headersSent_) return;
+  writeHeaders(code, contentType, length);
+  if (method_ == HTTP_HEAD || content == nullptr) return;
+  if (chunked_) {
+    if (length != CONTENT_LENGTH_UNKNOWN && length > 0) sendContent(content, length);
+  } else if (length > 0) {
+    client_.write(reinterpret_cast<const uint8_t*>(content), length);
+  }
+}
+
+void WebServer::sendContent(const char* content, size_t length) {
+  if (!headersSent_ || method_ == HTTP_HEAD) return;
+  if (!chunked_) {
+    client_.write(reinterpret_cast<const uint8_t*>(content), length);
+    return;
+  }
+  char size[12];
+  snprintf(size, sizeof(size), "%zx\r\n", length);
+  client_.write(reinterpret_cast<const uint8_t*>(size), strlen(size));
+  if (length > 0) client_.write(reinterpret_cast<const uint8_t*>(content), length);
+  client_.write(reinterpret_cast<const uint8_t*>("\r\n"), 2);
+  if (length == 0) chunked_ = false;  // terminator sent
+}
+
+void WebServer::finishResponse() {
+  if (!headersSent_) {
+    return;  // as the core: the handler wrote to client() directly, or sent nothing
+  }
+  if (chunked_ && method_ != HTTP_HEAD) sendContent("", 0);
+  client_.flush();
+}
@@ -0,0 +1,105 @@
+#ifndef NATIVE_WEBSERVER_H
+#define NATIVE_WEBSERVER_H
+
+#include <functional>
+#include <vector>
+#include "Arduino.h"
+#include "WiFiServer.h"
+
+enum HTTPMethod {
+  HTTP_DELETE = 0,
+  HTTP_GET = 1,
+  HTTP_HEAD = 2,
+  HTTP_POST = 3,
+  HTTP_PUT = 4,
+  HTTP_OPTIONS = 6,
+  HTTP_PATCH = 28,
+  HTTP_ANY = 255
+};
+
+#define CONTENT_LENGTH_UNKNOWN ((size_t)-1)
+#define CONTENT_LENGTH_NOT_SET ((size_t)-2)
+
+// Synchronous WebServer with the ESP32 core's API, served on loopback (see
+// halMapPort). One request per handleClient() call; the connection closes
+// after each response, as the core does without keep-alive. Streamed
+// responses (CONTENT_LENGTH_UNKNOWN) use chunked encoding.
+class WebServer {
+ public:
+  typedef std::function<void(void)> THandlerFunction;
+
+  explicit WebServer(int port = 80) : server_((uint16_t)port) {}
+
+  void begin() { server_.begin(); }
+  void begin(uint16_t port) { server_.begin(port); }
+  void stop() { server_.end(); }
+  void close() { server_.end(); }
+  void handleClient();
+
+  void on(const String& uri, THandlerFunction handler) { on(uri, HTTP_ANY, handler); }
+  void on(const String& uri, HTTPMethod method, THandlerFunction handler);
+  void on(const String& uri, HTTPMethod method, THandlerFunction handler, THandlerFunction upload);
+  void onNotFound(THandlerFunction handler) { notFound_ = handler; }
+
+  String uri() const { return uri_; }
+  HTTPMethod method() const { return method_; }
+  WiFiClient& client() { return client_; }
+
+  String arg(const String& name) const;
+  String arg(int i) const;
+  String argName(int i) const;
+  int args() const { return (int)args_.size(); }
+  bool hasArg(const String& name) const;
+
+  void collectHeaders(const char* headerKeys[], size_t count);
+  String header(const String& name) const;
+  bool hasHeader(const String& name) const;
+  String hostHeader() const { return header("Host"); }
+
+  void send(int code, const char* contentType = nullptr, const String& content = String(""));
+  void send(int code, const String& contentType, const String& content) {
+    send(code, contentType.c_str(), content);
+  }
+  void send(int code, const char* contentType, const char* content) { send(code, contentType, String(content)); }
+  void send(int code, const char* contentType, const char* content, size_t length);
+  void send_P(int code, PGM_P contentType, PGM_P content) { send(code, contentType, content); }
+  void send_P(int code, PGM_P contentType, PGM_P content, size_t length) { send(code, contentType, content, length); }
+  void sendHeader(const String& name, const String& value, bool first = false);
+  void setContentLength(size_t length) { contentLength_ = length; }
+  void sendContent(const String& content) { sendContent(content.c_str(), content.length()); }
+  void sendContent(const char* content, size_t length);
+  void sendContent_P(PGM_P content) { sendContent(content, strlen(content)); }
+
+ private:
+  struct Route {
+    String uri;
+    HTTPMethod method;
+    THandlerFunction handler;
+  };
+  struct KeyValue {
+    String key;
+    String value;
+  };
+
+  bool readRequest();
+  void parseArgs(const String& query);
+  void writeHeaders(int code, const char* contentType, size_t length);
+  void finishResponse();
+
+  WiFiServer server_;
+  WiFiClient client_;
+  std::vector<Route> routes_;
+  THandlerFunction notFound_;
+
+  String uri_;
+  HTTPMethod method_ = HTTP_GET;
+  std::vector<KeyValue> args_;
+  std::vector<KeyValue> headers_;
+  std::vector<String> collectKeys_;
+  String pendingHeaders_;
+  size_t contentLength_ = CONTENT_LENGTH_NOT_SET;
+  bool chunked_ = false;
+  bool headersSent_ = false;
+};
+
+#endif
@@ -0,0 +1,76 @@
+#include "WiFi.h"
+#include "hal_internal.h"
+#include "native_hal.h"
+#include <set>
+#include <string>
+
+WiFiClass WiFi;
+
+static std::set<std::string> unreachableSsids;
+
+void halSetWiFiLinkUp(bool up) {
+  WiFi.halSetLinkUp(up);
+}
+
+void halSetWiFiRssi(int8_t rssi) {
+  WiFi.halSetRssi(rssi);
+}
+
+void halSetWiFiSsidReachable(const char* ssid, bool reachable) {
+  if (reachable) {
+    unreachableSsids.erase(ssid);
+  } else {
+    unreachableSsids.insert(ssid);
+  }
+}
+
+bool halWiFiIsUp() {
+  return WiFi.isUp();
+}
+
+wl_status_t WiFiClass::begin(const char* ssid, const char* passphrase) {
+  (void)passphrase;
+  if (mode_ == WIFI_OFF) mode_ = WIFI_STA;
+  ssid_ = ssid ? ssid : "";
+  associated_ = !ssid_.empty() && unreachableSsids.count(ssid_) == 0;
+  if (associated_) everAssociated_ = true;
+  return status();
+}
+
+bool WiFiClass::disconnect(bool wifioff, bool eraseap) {
+  (void)eraseap;
+  associated_ = false;
+  if (wifioff) mode_ = WIFI_OFF;
+  return true;
+}
+
+bool WiFiClass::mode(wifi_mode_t m) {
+  mode_ = m;
+  if (m == WIFI_OFF) associated_ = false;
+  return true;
+}
+
+bool WiFiClass::config(IPAddress localIP, IPAddress gateway, IPAddress subnet, IPAddress dns1, IPAddress dns2) {
+  (void)localIP;
+  (void)gateway;
+  (void)subnet;
+  dns_[0] = dns1;
+  dns_[1] = dns2;
+  return true;
+}
+
+wl_status_t WiFiClass::status() {
+  if (mode_ == WIFI_OFF) return WL_DISCONNECTED;
+  // A station whose SSID became unreachable drops off, like a real AP loss
+  if (associated_ && unreachableSsids.count(ssid_) != 0) associated_ = false;
+  if (isUp()) return WL_CONNECTED;
+  if (!ssid_.empty() && unreachableSsids.count(ssid_) != 0) return WL_NO_SSID_AVAIL;
+  return everAssociated_ ? WL_CONNECTION_LOST : WL_DISCONNECTED;
+}
+
+int WiFiClass::hostByName(const char* host, IPAddress& result) {
+  uint32_t addr;
+  if (!isUp() || !halResolveHost(host, addr)) return 0;
+  result = IPAddress(addr);
+  return 1;
+}
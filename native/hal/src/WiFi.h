@@ -0,0 +1,73 @@
+#ifndef NATIVE_WIFI_H
+#define NATIVE_WIFI_H
+
+#include "Arduino.h"
+#include "IPAddress.h"
+#include "WiFiClient.h"
+#include "WiFiServer.h"
+
+typedef enum {
+  WL_NO_SHIELD = 255,
+  WL_IDLE_STATUS = 0,
+  WL_NO_SSID_AVAIL = 1,
+  WL_SCAN_COMPLETED = 2,
+  WL_CONNECTED = 3,
+  WL_CONNECT_FAILED = 4,
+  WL_CONNECTION_LOST = 5,
+  WL_DISCONNECTED = 6
+} wl_status_t;
+
+typedef enum {
+  WIFI_OFF = 0,
+  WIFI_STA = 1,
+  WIFI_AP = 2,
+  WIFI_AP_STA = 3
+} wifi_mode_t;
+
+// Station that "associates" instantly with any SSID the harness marks reachable.
+// Addresses are loopback so sockets opened by firmware code reach local stand-ins.
+class WiFiClass {
+ public:
+  wl_status_t begin(const char* ssid, const char* passphrase = nullptr);
+  bool disconnect(bool wifioff = false, bool eraseap = false);
+  bool mode(wifi_mode_t m);
+  wifi_mode_t getMode() const { return mode_; }
+  bool config(IPAddress localIP, IPAddress gateway, IPAddress subnet,
+              IPAddress dns1 = IPAddress(), IPAddress dns2 = IPAddress());
+  wl_status_t status();
+  bool isConnected() { return status() == WL_CONNECTED; }
+  bool setAutoReconnect(bool autoReconnect) { autoReconnect_ = autoReconnect; return true; }
+  bool setSleep(bool) { return true; }
+  bool setHostname(const char* name) { hostname_ = name ? name : ""; return true; }
+  const char* getHostname() const { return hostname_.c_str(); }
+
+  IPAddress localIP() const { return isUp() ? IPAddress(127, 0, 0, 1) : IPAddress(); }
+  IPAddress gatewayIP() const { return isUp() ? IPAddress(127, 0, 0, 1) : IPAddress(); }
+  IPAddress subnetMask() const { return isUp() ? IPAddress(255, 0, 0, 0) : IPAddress(); }
+  IPAddress dnsIP(uint8_t index = 0) const { return index < 2 ? dns_[index] : IPAddress(); }
+  int8_t RSSI() const { return isUp() ? rssi_ : 0; }
+  String SSID() const { return isUp() ? String(ssid_.c_str()) : String(); }
+  String macAddress() const { return String("02:00:00:C3:00:01"); }
+  String BSSIDstr() const { return String("02:00:00:00:00:01"); }
+  int hostByName(const char* host, IPAddress& result);
+
+  // Harness hooks (see native_hal.h)
+  void halSetLinkUp(bool up) { linkUp_ = up; }
+  void halSetRssi(int8_t rssi) { rssi_ = rssi; }
+  bool isUp() const { return associated_ && linkUp_; }
+
+ private:
+  wifi_mode_t mode_ = WIFI_OFF;
+  bool associated_ = false;
+  bool linkUp_ = true;
+  bool everAssociated_ = false;
+  bool autoReconnect_ = true;
+  int8_t rssi_ = -55;
+  std::string ssid_;
+  std::string hostname_ = "esp32-native";
+  IPAddress dns_[2] = {IPAddress(127, 0, 0, 53), IPAddress()};
+};
+
+extern WiFiClass WiFi;
+
+#endif
@@ -0,0 +1,221 @@
+#include "WiFiClient.h"
+#include "hal_internal.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+struct WiFiClient::Socket {
+  explicit Socket(int f) : fd(f) {}
+  ~Socket() {
+    if (fd >= 0) close(fd);
+  }
+  int fd;
+};
+
+bool halResolveHost(const char* host, uint32_t& addrOut) {
+  if (host == nullptr || host[0] == '\0') return false;
+  IPAddress literal;
+  if (literal.fromString(host)) {
+    addrOut = (uint32_t)literal;
+    return true;
+  }
+  struct addrinfo hints;
+  memset(&hints, 0, sizeof(hints));
+  hints.ai_family = AF_INET;
+  hints.ai_socktype = SOCK_STREAM;
+  struct addrinfo* res = nullptr;
+  if (getaddrinfo(host, nullptr, &hints, &res) != 0 || res == nullptr) {
+    return false;
+  }
+  addrOut = reinterpret_cast<struct sockaddr_in*>(res->ai_addr)->sin_addr.s_addr;
+  freeaddrinfo(res);
+  return true;
+}
+
+int halTcpConnect(uint32_t addr, uint16_t port, int32_t timeoutMs) {
+  if (!halWiFiIsUp()) return -1;
+  int fd = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+  if (fd < 0) return -1;
+  int flags = fcntl(fd, F_GETFL, 0);
+  fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+
+  struct sockaddr_in sa;
+  memset(&sa, 0, sizeof(sa));
+  sa.sin_family = AF_INET;
+  sa.sin_port = htons(port);
+  sa.sin_addr.s_addr = addr;
+  int r = ::connect(fd, reinterpret_cast<struct sockaddr*>(&sa), sizeof(sa));
+  if (r != 0 && errno != EINPROGRESS) {
+    close(fd);
+    return -1;
+  }
+  if (r != 0) {
+    struct pollfd pfd = {fd, POLLOUT, 0};
+    if (poll(&pfd, 1, timeoutMs) <= 0) {
+      close(fd);
+      return -1;
+    }
+    int err = 0;
+    socklen_t len = sizeof(err);
+    getsockopt(fd, SOL_SOCKET, SO_ERROR, &err, &len);
+    if (err != 0) {
+      close(fd);
+      return -1;
+    }
+  }
+  fcntl(fd, F_SETFL, flags);
+  return fd;
+}
+
+WiFiClient::WiFiClient() {}
+
+WiFiClient::WiFiClient(int fd) : sock_(fd >= 0 ? std::make_shared<Socket>(fd) : nullptr) {}
+
+int WiFiClient::connect(IPAddress ip, uint16_t port) {
+  return connect(ip, port, 3000);
+}
+
+int WiFiClient::connect(IPAddress ip, uint16_t port, int32_t timeoutMs) {
+  stop();
+  int fd = halTcpConnect((uint32_t)ip, port, timeoutMs);
+  if (fd < 0) return 0;
+  sock_ = std::make_shared<Socket>(fd);
+  return 1;
+}
+
+int WiFiClient::connect(const char* host, uint16_t port) {
+  return connect(host, port, 3000);
+}
+
+int WiFiClient::connect(const char* host, uint16_t port, int32_t timeoutMs) {
+  uint32_t addr;
+  if (!halWiFiIsUp() || !halResolveHost(host, addr)) return 0;
+  return connect(IPAddress(addr), port, timeoutMs);
+}
+
+int WiFiClient::fd() const {
+  return sock_ ? sock_->fd : -1;
+}
+
+size_t WiFiClient::write(uint8_t data) {
+  return write(&data, 1);
+}
+
+size_t WiFiClient::write(const uint8_t* buf, size_t size) {
+  int s = fd();
+  if (s < 0) return 0;
+  size_t sent = 0;
+  while (sent < size) {
+    ssize_t n = send(s, buf + sent, size - sent, MSG_NOSIGNAL);
+    if (n > 0) {
+      sent += (size_t)n;
+      continue;
+    }
+    if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) {
+      struct pollfd pfd = {s, POLLOUT, 0};
+      if (poll(&pfd, 1, (int)timeoutMs_) <= 0) break;
+      continue;
+    }
+    break;
+  }
+  return sent;
+}
+
+int WiFiClient::available() {
+  int s = fd();
+  if (s < 0) return 0;
+  int count = 0;
+  if (ioctl(s, FIONREAD, &count) < 0) return 0;
+  return count;
+}
+
+int WiFiClient::read() {
+  uint8_t c;
+  return read(&c, 1) == 1 ? c : -1;
+}
+
+int WiFiClient::read(uint8_t* buf, size_t size) {
+  int s = fd();
+  if (s < 0) return -1;
+  ssize_t n = recv(s, buf, size, MSG_DONTWAIT);
+  return n > 0 ? (int)n : -1;
+}
+
+int WiFiClient::peek() {
+  int s = fd();
+  if (s < 0) return -1;
+  uint8_t c;
+  return recv(s, &c, 1, MSG_PEEK | MSG_DONTWAIT) == 1 ? c : -1;
+}
+
+void WiFiClient::stop() {
+  sock_.reset();
+}
+
+uint8_t WiFiClient::connected() {
+  int s = fd();
+  if (s < 0) return 0;
+  uint8_t c;
+  ssize_t n = recv(s, &c, 1, MSG_PEEK | MSG_DONTWAIT);
+  if (n > 0) return 1;
+  if (n == 0) return 0;  // orderly shutdown by the peer
+  return (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) ? 1 : 0;
+}
+
+int WiFiClient::setTimeout(uint32_t seconds) {
+  Stream::setTimeout(seconds * 1000UL);
+  return 0;
+}
+
+int WiFiClient::setNoDelay(bool nodelay) {
+  int s = fd();
+  if (s < 0) return -1;
+  int flag = nodelay ? 1 : 0;
+  return setsockopt(s, IPPROTO_TCP, TCP_NODELAY, &flag, sizeof(flag));
+}
+
+static bool socketAddress(int fd, bool peer, IPAddress& ip, uint16_t& port) {
+  struct sockaddr_in sa;
+  socklen_t len = sizeof(sa);
+  int r = peer ? getpeername(fd, reinterpret_cast<struct sockaddr*>(&sa), &len)
+               : getsockname(fd, reinterpret_cast<struct sockaddr*>(&sa), &len);
+  if (fd < 0 || r != 0) return false;
+  ip = IPAddress((uint32_t)sa.sin_addr.s_addr);
+  port = ntohs(sa.sin_port);
+  return true;
+}
+
+IPAddress WiFiClient::remoteIP() const {
+  IPAddress ip;
+  uint16_t port;
+  socketAddress(fd(), true, ip, port);
+  return ip;
+}
+
+uint16_t WiFiClient::remotePort() const {
+  IPAddress ip;
+  uint16_t port = 0;
+  socketAddress(fd(), true, ip, port);
+  return port;
+}
+
+IPAddress WiFiClient::localIP() const {
+  IPAddress ip;
+  uint16_t port;
+  socketAddress(fd(), false, ip, port);
+  return ip;
+}
+
+uint16_t WiFiClient::localPort() const {
+  IPAddress ip;
+  uint16_t port = 0;
+  socketAddress(fd(), false, ip, port);
+  return port;
+}
@@ -0,0 +1,49 @@
+#ifndef NATIVE_WIFICLIENT_H
+#define NATIVE_WIFICLIENT_H
+
+#include <memory>
+#include "Arduino.h"
+#include "Client.h"
+
+// TCP client over a real host socket. Copies share the socket, like the ESP32
+// core, and the last copy closes it.
+class WiFiClient : public Client {
+ public:
+  WiFiClient();
+  explicit WiFiClient(int fd);
+
+  int connect(IPAddress ip, uint16_t port) override;
+  int connect(IPAddress ip, uint16_t port, int32_t timeoutMs);
+  int connect(const char* host, uint16_t port) override;
+  int connect(const char* host, uint16_t port, int32_t timeoutMs);
+
+  size_t write(uint8_t data) override;
+  size_t write(const uint8_t* buf, size_t size) override;
+  using Print::write;
+  int available() override;
+  int read() override;
+  int read(uint8_t* buf, size_t size) override;
+  int peek() override;
+  void flush() override {}
+  void stop() override;
+  uint8_t connected() override;
+  operator bool() override { return connected(); }
+  bool operator==(const WiFiClient& other) const { return fd() == other.fd(); }
+  bool operator!=(const WiFiClient& other) const { return !(*this == other); }
+
+  // ESP32 core semantics: seconds, not milliseconds
+  int setTimeout(uint32_t seconds);
+  int setNoDelay(bool nodelay);
+  int fd() const;
+
+  IPAddress remoteIP() const;
+  uint16_t remotePort() const;
+  IPAddress localIP() const;
+  uint16_t localPort() const;
+
+ private:
+  struct Socket;
+  std::shared_ptr<Socket> sock_;
+};
+
+#endif
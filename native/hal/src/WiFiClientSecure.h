@@ -0,0 +1,17 @@
+#ifndef NATIVE_WIFICLIENTSECURE_H
+#define NATIVE_WIFICLIENTSECURE_H
+
+#include "WiFiClient.h"
+
+// TLS is not emulated: connects always fail, so HTTPS callers take their
+// error paths (e.g. Pushover alerts are logged as failed, not sent).
+class WiFiClientSecure : public WiFiClient {
+ public:
+  void setInsecure() {}
+  void setCACert(const char*) {}
+  void setHandshakeTimeout(unsigned long) {}
+  int connect(IPAddress, uint16_t) override { return 0; }
+  int connect(const char*, uint16_t) override { return 0; }
+};
+
+#endif
@@ -0,0 +1,86 @@
+#include "WiFiServer.h"
+#include "native_hal.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+static uint16_t portOffset = 10000;
+
+void halSetPortOffset(uint16_t offset) {
+  portOffset = offset;
+}
+
+uint16_t halMapPort(uint16_t devicePort) {
+  return devicePort < 1024 ? (uint16_t)(devicePort + portOffset) : devicePort;
+}
+
+WiFiServer::WiFiServer(uint16_t port, uint8_t maxClients) : port_(port), maxClients_(maxClients) {}
+
+WiFiServer::~WiFiServer() {
+  end();
+}
+
+void WiFiServer::begin(uint16_t port) {
+  if (port != 0) port_ = port;
+  end();
+
+  int fd = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+  if (fd < 0) return;
+  int one = 1;
+  setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+  struct sockaddr_in sa;
+  memset(&sa, 0, sizeof(sa));
+  sa.sin_family = AF_INET;
+  sa.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  sa.sin_port = htons(halMapPort(port_));
+  if (bind(fd, reinterpret_cast<struct sockaddr*>(&sa), sizeof(sa)) != 0 || listen(fd, maxClients_) != 0) {
+    fprintf(stderr, "[HAL] WiFiServer: cannot listen on 127.0.0.1:%u (%s)\n", halMapPort(port_), strerror(errno));
+    ::close(fd);
+    return;
+  }
+  fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+
+  socklen_t len = sizeof(sa);
+  getsockname(fd, reinterpret_cast<struct sockaddr*>(&sa), &len);
+  hostPort_ = ntohs(sa.sin_port);
+  listenFd_ = fd;
+  fprintf(stderr, "[HAL] WiFiServer :%u -> 127.0.0.1:%u\n", port_, hostPort_);
+}
+
+void WiFiServer::end() {
+  if (pendingFd_ >= 0) {
+    ::close(pendingFd_);
+    pendingFd_ = -1;
+  }
+  if (listenFd_ >= 0) {
+    ::close(listenFd_);
+    listenFd_ = -1;
+  }
+}
+
+bool WiFiServer::hasClient() {
+  if (pendingFd_ >= 0) return true;
+  if (listenFd_ < 0) return false;
+  int fd = ::accept(listenFd_, nullptr, nullptr);
+  if (fd < 0) return false;
+  // Accepted sockets inherit O_NONBLOCK on some platforms; clients expect blocking writes
+  fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) & ~O_NONBLOCK);
+  if (noDelay_) {
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+  }
+  pendingFd_ = fd;
+  return true;
+}
+
+WiFiClient WiFiServer::available() {
+  if (!hasClient()) return WiFiClient();
+  int fd = pendingFd_;
+  pendingFd_ = -1;
+  return WiFiClient(fd);
+}
@@ -0,0 +1,36 @@
+#ifndef NATIVE_WIFISERVER_H
+#define NATIVE_WIFISERVER_H
+
+#include "Arduino.h"
+#include "WiFiClient.h"
+
+// Listens on 127.0.0.1 at halMapPort(port) so privileged device ports work unprivileged
+class WiFiServer {
+ public:
+  explicit WiFiServer(uint16_t port = 80, uint8_t maxClients = 4);
+  ~WiFiServer();
+
+  void begin(uint16_t port = 0);
+  void end();
+  void stop() { end(); }
+  void close() { end(); }
+  bool hasClient();
+  WiFiClient available();
+  WiFiClient accept() { return available(); }
+  void setNoDelay(bool nodelay) { noDelay_ = nodelay; }
+  operator bool() const { return listenFd_ >= 0; }
+
+  uint16_t port() const { return port_; }
+  uint16_t hostPort() const { return hostPort_; }
+  int fd() const { return listenFd_; }
+
+ private:
+  uint16_t port_;
+  uint16_t hostPort_ = 0;
+  uint8_t maxClients_;
+  int listenFd_ = -1;
+  int pendingFd_ = -1;
+  bool noDelay_ = false;
+};
+
+#endif
@@ -0,0 +1,111 @@
+#include "esp_ota_ops.h"
+#include "Arduino.h"
+#include <vector>
+
+namespace {
+
+const uint32_t APP_SLOT_SIZE = 0x140000;
+
+esp_partition_t partitions[2] = {
+  {nullptr, ESP_PARTITION_TYPE_APP, ESP_PARTITION_SUBTYPE_APP_OTA_0, 0x10000, APP_SLOT_SIZE, "app0", false},
+  {nullptr, ESP_PARTITION_TYPE_APP, ESP_PARTITION_SUBTYPE_APP_OTA_1, 0x150000, APP_SLOT_SIZE, "app1", false},
+};
+
+int runningSlot = 0;
+int bootSlot = 0;
+
+// Lazily allocated and erased to 0xFF, like fresh flash
+std::vector<uint8_t>& flash(const esp_partition_t* p) {
+  static std::vector<uint8_t> slots[2];
+  std::vector<uint8_t>& slot = slots[p == &partitions[1] ? 1 : 0];
+  if (slot.empty()) slot.assign(p->size, 0xFF);
+  return slot;
+}
+
+bool known(const esp_partition_t* p) {
+  return p == &partitions[0] || p == &partitions[1];
+}
+
+}  // namespace
+
+extern "C" const char* esp_err_to_name(esp_err_t code) {
+  switch (code) {
+    case ESP_OK: return "ESP_OK";
+    case ESP_FAIL: return "ESP_FAIL";
+    case ESP_ERR_NO_MEM: return "ESP_ERR_NO_MEM";
+    case ESP_ERR_INVALID_ARG: return "ESP_ERR_INVALID_ARG";
+    case ESP_ERR_INVALID_STATE: return "ESP_ERR_INVALID_STATE";
+    case ESP_ERR_INVALID_SIZE: return "ESP_ERR_INVALID_SIZE";
+    case ESP_ERR_NOT_FOUND: return "ESP_ERR_NOT_FOUND";
+    case ESP_ERR_NOT_SUPPORTED: return "ESP_ERR_NOT_SUPPORTED";
+    case ESP_ERR_OTA_PARTITION_CONFLICT: return "ESP_ERR_OTA_PARTITION_CONFLICT";
+    case ESP_ERR_OTA_SELECT_INFO_INVALID: return "ESP_ERR_OTA_SELECT_INFO_INVALID";
+    case ESP_ERR_OTA_VALIDATE_FAILED: return "ESP_ERR_OTA_VALIDATE_FAILED";
+    case ESP_ERR_OTA_ROLLBACK_FAILED: return "ESP_ERR_OTA_ROLLBACK_FAILED";
+    default: return "UNKNOWN ERROR";
+  }
+}
+
+esp_err_t esp_partition_read(const esp_partition_t* partition, size_t src_offset, void* dst, size_t size) {
+  if (!known(partition) || dst == nullptr) return ESP_ERR_INVALID_ARG;
+  if (src_offset > partition->size || size > partition->size - src_offset) return ESP_ERR_INVALID_SIZE;
+  memcpy(dst, flash(partition).data() + src_offset, size);
+  return ESP_OK;
+}
+
+esp_err_t esp_partition_write(const esp_partition_t* partition, size_t dst_offset, const void* src, size_t size) {
+  if (!known(partition) || src == nullptr) return ESP_ERR_INVALID_ARG;
+  if (dst_offset > partition->size || size > partition->size - dst_offset) return ESP_ERR_INVALID_SIZE;
+  // NOR flash can only clear bits; an un-erased region keeps stale ones
+  uint8_t* out = flash(partition).data() + dst_offset;
+  const uint8_t* in = static_cast<const uint8_t*>(src);
+  for (size_t i = 0; i < size; i++) out[i] &= in[i];
+  return ESP_OK;
+}
+
+esp_err_t esp_partition_erase_range(const esp_partition_t* partition, size_t offset, size_t size) {
+  if (!known(partition)) return ESP_ERR_INVALID_ARG;
+  if ((offset | size) % 4096 != 0) return ESP_ERR_INVALID_SIZE;
+  if (offset > partition->size || size > partition->size - offset) return ESP_ERR_INVALID_SIZE;
+  memset(flash(partition).data() + offset, 0xFF, size);
+  return ESP_OK;
+}
+
+const esp_partition_t* esp_partition_find_first(esp_partition_type_t type, esp_partition_subtype_t subtype,
+                                                const char* label) {
+  for (const auto& p : partitions) {
+    if (p.type != type) continue;
+    if (subtype != ESP_PARTITION_SUBTYPE_ANY && p.subtype != subtype) continue;
+    if (label != nullptr && strcmp(label, p.label) != 0) continue;
+    return &p;
+  }
+  return nullptr;
+}
+
+const esp_partition_t* esp_ota_get_running_partition(void) {
+  return &partitions[runningSlot];
+}
+
+const esp_partition_t* esp_ota_get_boot_partition(void) {
+  return &partitions[bootSlot];
+}
+
+const esp_partition_t* esp_ota_get_next_update_partition(const esp_partition_t* start_from) {
+  if (start_from == nullptr) start_from = esp_ota_get_running_partition();
+  return start_from == &partitions[0] ? &partitions[1] : &partitions[0];
+}
+
+esp_err_t esp_ota_set_boot_partition(const esp_partition_t* partition) {
+  if (!known(partition)) return ESP_ERR_INVALID_ARG;
+  bootSlot = partition == &partitions[1] ? 1 : 0;
+  return ESP_OK;
+}
+
+esp_err_t esp_ota_mark_app_valid_cancel_rollback(void) {
+  return ESP_OK;
+}
+
+esp_err_t esp_ota_mark_app_invalid_rollback_and_reboot(void) {
+  bootSlot = runningSlot == 0 ? 1 : 0;
+  ESP.restart();
+}
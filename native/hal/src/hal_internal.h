@@ -0,0 +1,17 @@
+#ifndef NATIVE_HAL_INTERNAL_H
+#define NATIVE_HAL_INTERNAL_H
+
+#include <stdint.h>
+
+// Shared between the stand-ins; not part of the Arduino API.
+
+// True while the fake station is associated (sockets fail otherwise)
+bool halWiFiIsUp();
+
+// Resolve a hostname or dotted quad to a network-order IPv4 address
+bool halResolveHost(const char* host, uint32_t& addrOut);
+
+// Blocking connect with a timeout; returns the socket or -1
+int halTcpConnect(uint32_t addr, uint16_t port, int32_t timeoutMs);
+
+#endif
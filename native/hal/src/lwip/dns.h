@@ -0,0 +1,36 @@
+#ifndef NATIVE_LWIP_DNS_H
+#define NATIVE_LWIP_DNS_H
+
+#include <stdint.h>
+
+typedef int8_t err_t;
+#define ERR_OK 0
+#define ERR_MEM (-1)
+#define ERR_INPROGRESS (-5)
+#define ERR_VAL (-6)
+#define ERR_ARG (-16)
+
+typedef struct ip4_addr {
+  uint32_t addr;  // network byte order
+} ip4_addr_t;
+
+typedef struct {
+  union {
+    ip4_addr_t ip4;
+  } u_addr;
+  uint8_t type;
+} ip_addr_t;
+
+#define IPADDR_TYPE_V4 0U
+#define ip_2_ip4(ipaddr) (&((ipaddr)->u_addr.ip4))
+#define ip4_addr_get_u32(src_ipaddr) ((src_ipaddr)->addr)
+
+typedef void (*dns_found_callback)(const char* name, const ip_addr_t* ipaddr, void* callback_arg);
+
+// Resolves on the calling thread via getaddrinfo. Success returns ERR_OK with
+// addr filled (the lwIP cache-hit path); failure reports through the callback
+// with a null address and returns ERR_INPROGRESS, which is the sequence a
+// caller sees when the lwIP query times out.
+err_t dns_gethostbyname(const char* hostname, ip_addr_t* addr, dns_found_callback found, void* callback_arg);
+
+#endif
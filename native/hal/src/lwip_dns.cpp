@@ -0,0 +1,14 @@
+#include "lwip/dns.h"
+#include "hal_internal.h"
+
+err_t dns_gethostbyname(const char* hostname, ip_addr_t* addr, dns_found_callback found, void* callback_arg) {
+  if (hostname == nullptr || addr == nullptr) return ERR_ARG;
+  uint32_t resolved;
+  if (halWiFiIsUp() && halResolveHost(hostname, resolved)) {
+    addr->u_addr.ip4.addr = resolved;
+    addr->type = IPADDR_TYPE_V4;
+    return ERR_OK;
+  }
+  if (found != nullptr) found(hostname, nullptr, callback_arg);
+  return ERR_INPROGRESS;
+}
@@ -0,0 +1,70 @@
+#ifndef NATIVE_HAL_H
+#define NATIVE_HAL_H
+
+#include <stdint.h>
+
+// Controls for the host-side stand-ins. Firmware code never includes this;
+// the simulator entry point and the benchmarks in native/sim use it to shape
+// the fake environment.
+
+// --- Clock ---
+// In virtual-time mode delay() advances millis()/micros() instead of sleeping,
+// so hours of scheduler time pass in seconds of wall time.
+void halSetVirtualTime(bool enabled);
+bool halVirtualTime();
+void halAdvanceMillis(unsigned long ms);
+
+// --- Lifecycle ---
+// ESP.restart() flushes stdout and exits with this status unless a handler is set
+#define HAL_EXIT_RESTART 3
+void halSetRestartHandler(void (*handler)());
+
+// --- Console ---
+// Serial goes to stdout; benchmarks silence it so the formatting cost stays
+// in the measurement but terminal I/O does not
+void halSetSerialEnabled(bool enabled);
+
+// --- Heap model ---
+// ESP.getFreeHeap() = configured size minus bytes malloc'd since start-up
+void halSetHeapSize(uint32_t bytes);
+
+// --- WiFi ---
+void halSetWiFiLinkUp(bool up);             // drop/restore the association
+void halSetWiFiRssi(int8_t rssi);
+void halSetWiFiSsidReachable(const char* ssid, bool reachable);
+
+// --- Sockets ---
+// Device ports below 1024 are served on loopback at port + offset (default 10000)
+void halSetPortOffset(uint16_t offset);
+uint16_t halMapPort(uint16_t devicePort);
+
+// --- NVS (Preferences) ---
+struct HalNvsStats {
+  unsigned long opens;
+  unsigned long reads;
+  unsigned long writes;           // puts that changed a stored value (flash writes on target)
+  unsigned long unchangedWrites;  // puts that matched the stored value
+  unsigned long erases;           // remove() / clear()
+};
+const HalNvsStats& halNvsStats();
+void halNvsResetStats();
+bool halNvsLoad(const char* path);  // optional file backing so state survives a simulated reboot
+bool halNvsSave(const char* path);
+void halNvsErase();
+
+// --- MQTT broker (in-memory) ---
+struct HalMqttStats {
+  unsigned long connects;
+  unsigned long publishes;
+  unsigned long publishBytes;
+  unsigned long oversizeRejected;  // publishes the real PubSubClient would drop (buffer too small)
+  unsigned long delivered;         // injected messages handed to the client callback
+};
+void halMqttSetBrokerUp(bool up);
+void halMqttSetTrace(bool enabled);  // echo every publish to stdout
+void halMqttInject(const char* topic, const char* payload);
+const HalMqttStats& halMqttStats();
+void halMqttResetStats();
+const char* halMqttLastPayload(const char* topic);  // nullptr if never published
+
+#endif
@@ -0,0 +1,417 @@
+#include "native_bench.h"
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <WiFi.h>
+#include <chrono>
+#include <esp_ota_ops.h>
+#include "config.h"
+#include "heartbeat.h"
+#include "history.h"
+#include "json_stream.h"
+#include "log_ring.h"
+#include "loop_perf.h"
+#include "native_hal.h"
+#include "network_metrics.h"
+#include "ota_crypto.h"
+#include "prometheus.h"
+#include "stub_http_server.h"
+#include "telnet.h"
+
+#ifdef ENABLE_MQTT
+#include "mqtt_manager.h"
+#endif
+
+void loop();
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+const double MIN_BENCH_SECONDS = 0.3;
+
+struct BenchResult {
+  unsigned long iterations;
+  double seconds;
+};
+
+bool selected(const char* filter, const char* name) {
+  return filter == nullptr || filter[0] == '\0' || strncmp(name, filter, strlen(filter)) == 0;
+}
+
+// Runs fn until at least MIN_BENCH_SECONDS of wall time (or maxIterations) has passed
+template <typename Fn>
+BenchResult measure(Fn fn, unsigned long maxIterations = 1000000) {
+  fn();  // warm-up: first-call allocations and lazy init stay out of the numbers
+  BenchResult r = {0, 0.0};
+  Clock::time_point start = Clock::now();
+  while (r.iterations < maxIterations) {
+    fn();
+    r.iterations++;
+    if ((r.iterations & 0x0F) == 0 || r.iterations < 16) {
+      r.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+      if (r.seconds >= MIN_BENCH_SECONDS) break;
+    }
+  }
+  r.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+  return r;
+}
+
+void report(const char* name, const BenchResult& r, const char* extra = "") {
+  double nsPerOp = r.iterations ? r.seconds * 1e9 / (double)r.iterations : 0.0;
+  printf("%-22s %10lu iters %12.0f ns/op %s\n", name, r.iterations, nsPerOp, extra);
+}
+
+void benchJson(const char* filter, int& count) {
+#ifdef ENABLE_MQTT
+  if (selected(filter, "json.status")) {
+    size_t bytes = 0;
+    // Same two passes as publishJson(): size for beginPublish(), then stream
+    class DiscardPrint : public BufferedStreamPrint {
+     protected:
+      bool sink(const uint8_t*, size_t) override { return true; }
+    };
+    BenchResult r = measure([&]() {
+      JsonDocument doc;
+      fillDeviceStatusJSON(doc);
+      bytes = measureJson(doc);
+      DiscardPrint out;
+      serializeJson(doc, out);
+      out.flushBuffer();
+    });
+    char extra[48];
+    snprintf(extra, sizeof(extra), "(%zu bytes)", bytes);
+    report("json.status", r, extra);
+    count++;
+  }
+#endif
+  if (selected(filter, "json.perf")) {
+    static char out[4096];
+    size_t bytes = 0;
+    BenchResult r = measure([&]() {
+      JsonDocument doc;
+      fillPerfJSON(doc);
+      bytes = serializeJson(doc, out, sizeof(out));
+    });
+    char extra[48];
+    snprintf(extra, sizeof(extra), "(%zu bytes)", bytes);
+    report("json.perf", r, extra);
+    count++;
+  }
+}
+
+// Counts bytes instead of sending them: the cost is the writer, not the socket
+class CountingPrint : public BufferedStreamPrint {
+ public:
+  size_t bytes = 0;
+
+ protected:
+  bool sink(const uint8_t*, size_t size) override {
+    bytes += size;
+    return true;
+  }
+};
+
+void benchMetrics(const char* filter, int& count) {
+#ifdef ENABLE_WEBSERVER
+  if (!selected(filter, "metrics.prom")) return;
+  size_t bytes = 0;
+  BenchResult r = measure([&]() {
+    CountingPrint out;
+    writePrometheusMetrics(out);
+    out.flushBuffer();
+    bytes = out.bytes;
+  });
+  char extra[48];
+  snprintf(extra, sizeof(extra), "(%zu bytes)", bytes);
+  report("metrics.prom", r, extra);
+  count++;
+#else
+  (void)filter;
+  (void)count;
+#endif
+}
+
+void benchLog(const char* filter, int& count) {
+  if (!selected(filter, "log.telnet")) return;
+#ifdef ENABLE_MQTT
+  // Measure the forwarding path too: skip past the reconnect back-off and connect
+  for (int attempt = 0; attempt < 3 && !isMQTTConnected(); attempt++) {
+    halAdvanceMillis(60000);
+    connectToMQTT();
+  }
+#endif
+  unsigned long publishesBefore = halMqttStats().publishes;
+  BenchResult r = measure([]() {
+    telnetPrintf("[%10lu ms] [BENCH] log line with a number %d and a string %s\r\n", millis(), 42, "payload");
+  }, 200000);
+  char extra[64];
+  snprintf(extra, sizeof(extra), "(%lu MQTT publishes)", halMqttStats().publishes - publishesBefore);
+  report("log.telnet", r, extra);
+  count++;
+
+#ifdef ENABLE_MQTT
+  if (!selected(filter, "log.mqtt")) return;
+  // One flush window under a burst: a full ring of lines becomes one message
+  unsigned long batchesBefore = getMQTTLogStats().batches;
+  publishesBefore = halMqttStats().publishes;
+  BenchResult b = measure([]() {
+    for (int i = 0; i < LOG_RING_SLOTS; i++) {
+      telnetPrintf("[%10lu ms] [BENCH] burst line %d\r\n", millis(), i);
+    }
+    halAdvanceMillis(2000);
+    publishTelnetLog();
+  }, 2000);
+  const MQTTLogStats& stats = getMQTTLogStats();
+  snprintf(extra, sizeof(extra), "(%lu batches, %lu publishes, %lu dropped)",
+           stats.batches - batchesBefore, halMqttStats().publishes - publishesBefore, stats.dropped);
+  report("log.mqtt", b, extra);
+  count++;
+#endif
+}
+
+void benchOta(const char* filter, int& count) {
+  if (!selected(filter, "ota.sha256")) return;
+  const size_t imageBytes = 1024 * 1024;
+  const esp_partition_t* part = esp_ota_get_next_update_partition(nullptr);
+  esp_partition_erase_range(part, 0, imageBytes);
+  uint8_t block[4096];
+  for (size_t off = 0; off < imageBytes; off += sizeof(block)) {
+    for (size_t i = 0; i < sizeof(block); i++) block[i] = (uint8_t)((off + i) * 31);
+    esp_partition_write(part, off, block, sizeof(block));
+  }
+  uint8_t hash[32];
+  bool ok = true;
+  BenchResult r = measure([&]() { ok = ok && otaSha256Partition(part, 0, imageBytes, hash); }, 1000);
+  char extra[48];
+  double mbPerSec = r.seconds > 0 ? (double)r.iterations * imageBytes / (1024.0 * 1024.0) / r.seconds : 0.0;
+  snprintf(extra, sizeof(extra), "(%.1f MB/s%s)", mbPerSec, ok ? "" : ", FAILED");
+  report("ota.sha256", r, extra);
+  count++;
+}
+
+void benchNet(const char* filter, int& count) {
+  if (selected(filter, "net.heartbeat")) {
+    BenchResult r = measure([]() {
+      startHeartbeat();
+      while (isHeartbeatInFlight()) handleHeartbeat();
+    }, 5000);
+    char extra[48];
+    snprintf(extra, sizeof(extra), "(last code %d)", lastHeartbeatResponseCode);
+    report("net.heartbeat", r, extra);
+    count++;
+  }
+  if (selected(filter, "net.probe")) {
+    BenchResult r = measure([]() { probeNetworkQuality(); }, 500);
+    char extra[64];
+    snprintf(extra, sizeof(extra), "(%u/%u ok per probe)", networkProbeSuccessCount, networkProbeAttemptCount);
+    report("net.probe", r, extra);
+    count++;
+  }
+  if (selected(filter, "net.probe_keepalive")) {
+    bool wasKeepAlive = networkProbeKeepAlive;
+    networkProbeKeepAlive = true;
+    BenchResult r = measure([]() { probeNetworkQuality(); }, 500);
+    networkProbeKeepAlive = wasKeepAlive;
+    char extra[64];
+    snprintf(extra, sizeof(extra), "(%u/%u ok, setup %.1f ms)", networkProbeSuccessCount,
+             networkProbeAttemptCount, networkConnectSetupMs);
+    report("net.probe_keepalive", r, extra);
+    count++;
+  }
+  if (selected(filter, "net.probe_icmp")) {
+    // Same sample count as an echo burst to the loopback
+    char target[sizeof(networkProbeTarget)];
+    strncpy(target, networkProbeTarget, sizeof(target));
+    strncpy(networkProbeTarget, "icmp://127.0.0.1", sizeof(networkProbeTarget));
+    BenchResult r = measure([]() { probeNetworkQuality(); }, 500);
+    strncpy(networkProbeTarget, target, sizeof(networkProbeTarget));
+    char extra[64];
+    snprintf(extra, sizeof(extra), "(%u/%u replies, rtt %.2f-%.2f ms)", networkProbeSuccessCount,
+             networkProbeAttemptCount, networkRttMinMs, networkRttMaxMs);
+    report("net.probe_icmp", r, extra);
+    count++;
+  }
+  if (selected(filter, "net.probe_tcp")) {
+    // TCP handshakes alone, to the host and port of the HTTP probe target
+    char target[sizeof(networkProbeTarget)];
+    strncpy(target, networkProbeTarget, sizeof(target));
+    const char* host = strstr(target, "://");
+    host = host ? host + 3 : target;
+    snprintf(networkProbeTarget, sizeof(networkProbeTarget), "tcp://%.*s", (int)strcspn(host, "/"), host);
+    BenchResult r = measure([]() { probeNetworkQuality(); }, 500);
+    strncpy(networkProbeTarget, target, sizeof(networkProbeTarget));
+    char extra[64];
+    snprintf(extra, sizeof(extra), "(%u/%u connects, rtt %.2f-%.2f ms)", networkProbeSuccessCount,
+             networkProbeAttemptCount, networkRttMinMs, networkRttMaxMs);
+    report("net.probe_tcp", r, extra);
+    count++;
+  }
+}
+
+// One synthetic 30 s sample of every metric: noisy RSSI and heap, latency and
+// jitter that move with each 60 s probe, the rest steady
+void appendHistoryRow(uint32_t sec, uint32_t& rng) {
+  auto noise = [&rng](int32_t span) {
+    rng = rng * 1664525u + 1013904223u;
+    return (int32_t)((rng >> 16) % (uint32_t)(2 * span + 1)) - span;
+  };
+  static int32_t latency = 250, jitter = 40;
+  if ((sec / 30) % 2 == 0) {
+    latency = 250 + noise(60);
+    jitter = 40 + noise(20);
+  }
+  historyAppend(HIST_RSSI, sec, -60 + noise(3));
+  historyAppend(HIST_FREE_HEAP, sec, 3000 + noise(3));
+  historyAppend(HIST_LATENCY, sec, latency);
+  historyAppend(HIST_JITTER, sec, jitter);
+  historyAppend(HIST_PROBE_LOSS, sec, noise(50) == 0 ? 25 : 0);
+  historyAppend(HIST_HEARTBEAT_CODE, sec, 200);
+  historyAppend(HIST_DNS_UP, sec, 1);
+  historyAppend(HIST_MQTT_UP, sec, 1);
+}
+
+void benchHistory(const char* filter, int& count) {
+  const uint32_t rowsPerDay = 24UL * 3600UL / (HISTORY_SAMPLE_INTERVAL_MS / 1000UL);
+  uint32_t sec = 0;
+  uint32_t rng = 1;
+  if (selected(filter, "history.day")) {
+    // A day of samples per iteration; the store keeps what fits
+    BenchResult r = measure([&]() {
+      for (uint32_t i = 0; i < rowsPerDay; i++, sec += 30) appendHistoryRow(sec, rng);
+    }, 200);
+    uint32_t newestOldest = 0;
+    for (uint8_t m = 0; m < HIST_METRIC_COUNT; m++) {
+      if (historyOldestSec(m) > newestOldest) newestOldest = historyOldestSec(m);
+    }
+    const HistoryStats& stats = getHistoryStats();
+    char extra[80];
+    snprintf(extra, sizeof(extra), "(%u/%u blocks, %zu bytes, %.1f h held)", stats.blocksInUse,
+             (unsigned)HISTORY_BLOCK_COUNT, stats.bytes, (sec - 30 - newestOldest) / 3600.0);
+    report("history.day", r, extra);
+    count++;
+  }
+  if (selected(filter, "history.query")) {
+    if (sec == 0) {
+      for (uint32_t i = 0; i < rowsPerDay; i++, sec += 30) appendHistoryRow(sec, rng);
+    }
+    uint32_t samples = 0;
+    BenchResult r = measure([&]() {
+      samples = historyForEach(HIST_LATENCY, 0, [](uint32_t, int32_t, void*) {}, nullptr);
+    }, 100000);
+    char extra[48];
+    snprintf(extra, sizeof(extra), "(%lu latency samples decoded)", (unsigned long)samples);
+    report("history.query", r, extra);
+    count++;
+  }
+  if (selected(filter, "history.roundtrip")) {
+    // Six hours of known samples read back exactly: noise, steady runs,
+    // unknown readings, full-range jumps, and late or early samples
+    static const uint32_t ROWS = 720;
+    static uint32_t secs[ROWS];
+    static int32_t values[HIST_METRIC_COUNT][ROWS];
+    sec += 3600;
+    uint32_t since = sec;
+    for (uint32_t i = 0; i < ROWS; i++) {
+      rng = rng * 1664525u + 1013904223u;
+      secs[i] = sec;
+      values[HIST_RSSI][i] = -60 + (int32_t)(rng >> 29);
+      values[HIST_FREE_HEAP][i] = 3000 + (int32_t)(i / 100);
+      values[HIST_LATENCY][i] = i % 50 < 5 ? HISTORY_UNKNOWN : (int32_t)(rng >> 20);
+      values[HIST_JITTER][i] = (int32_t)rng;
+      values[HIST_PROBE_LOSS][i] = i % 97 == 0 ? 25 : 0;
+      values[HIST_HEARTBEAT_CODE][i] = i < 300 ? 200 : -1;
+      values[HIST_DNS_UP][i] = 1;
+      values[HIST_MQTT_UP][i] = i % 240 < 120 ? 1 : 0;
+      for (uint8_t m = 0; m < HIST_METRIC_COUNT; m++) historyAppend(m, sec, values[m][i]);
+      sec += i % 61 == 60 ? 300 : (i % 13 == 12 ? 31 : 30);
+    }
+    struct Check {
+      uint8_t metric;
+      uint32_t index;
+      uint32_t mismatches;
+    } check = {0, 0, 0};
+    BenchResult r = measure([&]() {
+      check.mismatches = 0;
+      for (check.metric = 0; check.metric < HIST_METRIC_COUNT; check.metric++) {
+        check.index = 0;
+        historyForEach(check.metric, since, [](uint32_t t, int32_t value, void* ctx) {
+          Check& c = *static_cast<Check*>(ctx);
+          if (c.index >= ROWS || secs[c.index] != t || values[c.metric][c.index] != value) c.mismatches++;
+          c.index++;
+        }, &check);
+        if (check.index != ROWS) check.mismatches++;
+      }
+    }, 1000);
+    char extra[64];
+    snprintf(extra, sizeof(extra), "(%lu samples%s)", (unsigned long)ROWS * HIST_METRIC_COUNT,
+             check.mismatches == 0 ? " identical" : ", FAILED");
+    report("history.roundtrip", r, extra);
+    count++;
+  }
+  if (selected(filter, "history.week")) {
+    // Fill the hourly tier; the raw store only keeps the last day of it
+    if (sec < 7UL * 24UL * 3600UL) {
+      for (uint32_t i = 0; i < 7 * rowsPerDay; i++, sec += 30) appendHistoryRow(sec, rng);
+    }
+    uint32_t since = sec - 7UL * 24UL * 3600UL;
+    size_t bytes = 0;
+    BenchResult r = measure([&]() {
+      CountingPrint out;
+      writeHistoryJSON(out, HIST_LATENCY, since, 3600);
+      out.flushBuffer();
+      bytes = out.bytes;
+    }, 100000);
+    char extra[80];
+    snprintf(extra, sizeof(extra), "(source %s, %zu bytes, %zu rollup bytes)",
+             historySourceName(historyPickSource(HIST_LATENCY, since, 3600)), bytes,
+             getHistoryStats().rollupBytes);
+    report("history.week", r, extra);
+    count++;
+  }
+  if (selected(filter, "history.day_view")) {
+    // A day of 15-minute rows, after a week: served by the 15m tier
+    if (sec < 7UL * 24UL * 3600UL) {
+      for (uint32_t i = 0; i < 7 * rowsPerDay; i++, sec += 30) appendHistoryRow(sec, rng);
+    }
+    uint32_t since = sec - 24UL * 3600UL;
+    size_t bytes = 0;
+    BenchResult r = measure([&]() {
+      CountingPrint out;
+      writeHistoryJSON(out, HIST_LATENCY, since, 900);
+      out.flushBuffer();
+      bytes = out.bytes;
+    }, 100000);
+    char extra[80];
+    snprintf(extra, sizeof(extra), "(source %s, %zu bytes)",
+             historySourceName(historyPickSource(HIST_LATENCY, since, 900)), bytes);
+    report("history.day_view", r, extra);
+    count++;
+  }
+}
+
+void benchLoop(const char* filter, int& count) {
+  if (!selected(filter, "loop.iteration")) return;
+  bool wasVirtual = halVirtualTime();
+  halSetVirtualTime(true);  // loop() ends in delay(); keep the sleep out of the numbers
+  BenchResult r = measure([]() { loop(); }, 200000);
+  halSetVirtualTime(wasVirtual);
+  report("loop.iteration", r, "(virtual time)");
+  count++;
+}
+
+}  // namespace
+
+int runBenchmarks(const char* filter) {
+  int count = 0;
+  halSetSerialEnabled(false);
+  benchJson(filter, count);
+  benchMetrics(filter, count);
+  benchLog(filter, count);
+  benchOta(filter, count);
+  benchNet(filter, count);
+  benchHistory(filter, count);
+  benchLoop(filter, count);
+  halSetSerialEnabled(true);
+  fflush(stdout);
+  return count;
+}
@@ -0,0 +1,10 @@
+#ifndef NATIVE_BENCH_H
+#define NATIVE_BENCH_H
+
+// Host-side micro-benchmarks for firmware hot paths. Each one runs the real
+// firmware code against the HAL stand-ins after setup() has brought the
+// device up. filter selects benchmarks by name prefix (nullptr = all).
+// Returns the number of benchmarks run.
+int runBenchmarks(const char* filter);
+
+#endif
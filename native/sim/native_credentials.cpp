@@ -0,0 +1,13 @@
+#include "credentials.h"
+
+// Stand-in secrets for the native build. Weak so a real src/credentials.cpp,
+// when present, takes precedence at link time.
+__attribute__((weak)) const char* WIFI_SSID = "native-sim";
+__attribute__((weak)) const char* WIFI_PASSWORD = "native-sim";
+__attribute__((weak)) const char* WIFI_SSID_SECONDARY = "native-sim-secondary";
+__attribute__((weak)) const char* WIFI_PASSWORD_SECONDARY = "native-sim";
+__attribute__((weak)) const char* OTA_PASSWORD = "native";
+__attribute__((weak)) const char* PUSHOVER_TOKEN = "";
+__attribute__((weak)) const char* PUSHOVER_USER = "";
+__attribute__((weak)) const char* MQTT_USER = "";
+__attribute__((weak)) const char* MQTT_PASSWORD = "";
@@ -0,0 +1,122 @@
+// Entry point for the native (host) build: runs the firmware's setup()/loop()
+// against the HAL stand-ins in native/hal, or the benchmarks in native_bench.
+//
+//   .pio/build/native/program [options]
+//     --bench[=prefix]   run benchmarks (all, or those whose name starts with prefix)
+//     --run-ms N         stop after N ms of device time (default: run until killed)
+//     --virtual-time     delay() advances the clock instead of sleeping
+//     --nvs FILE         load NVS from FILE at start, save it on exit/restart
+//     --mqtt-trace       print every MQTT publish
+//     --wifi-down        make every configured SSID unreachable
+//     --no-stub          keep the configured heartbeat/probe URLs instead of
+//                        pointing them at the local stub server
+
+#include <Arduino.h>
+#include <signal.h>
+#include <stdlib.h>
+#include "config.h"
+#include "native_bench.h"
+#include "native_hal.h"
+#include "network_metrics.h"
+#include "stub_http_server.h"
+
+void setup();
+void loop();
+
+static const char* nvsPath = nullptr;
+static volatile sig_atomic_t stopRequested = 0;
+static char stubHeartbeatUrl[64];
+static char stubProbeUrl[64];
+
+static void saveNvs() {
+  if (nvsPath != nullptr && !halNvsSave(nvsPath)) {
+    fprintf(stderr, "[SIM] Could not save NVS to %s\n", nvsPath);
+  }
+}
+
+static void onSignal(int) {
+  stopRequested = 1;
+}
+
+static void onRestart() {
+  saveNvs();
+  stubHttpStop();  // a joinable std::thread at exit() aborts the process
+  fprintf(stderr, "[SIM] ESP.restart() - exiting with status %d\n", HAL_EXIT_RESTART);
+}
+
+static void usage(const char* argv0) {
+  fprintf(stderr,
+          "usage: %s [--bench[=prefix]] [--run-ms N] [--virtual-time] [--nvs FILE]\n"
+          "          [--mqtt-trace] [--wifi-down] [--no-stub]\n",
+          argv0);
+}
+
+int main(int argc, char** argv) {
+  bool bench = false;
+  const char* benchFilter = nullptr;
+  long runMs = -1;
+  bool useStub = true;
+
+  for (int i = 1; i < argc; i++) {
+    const char* a = argv[i];
+    if (strcmp(a, "--bench") == 0) {
+      bench = true;
+    } else if (strncmp(a, "--bench=", 8) == 0) {
+      bench = true;
+      benchFilter = a + 8;
+    } else if (strcmp(a, "--run-ms") == 0 && i + 1 < argc) {
+      runMs = atol(argv[++i]);
+    } else if (strcmp(a, "--virtual-time") == 0) {
+      halSetVirtualTime(true);
+    } else if (strcmp(a, "--nvs") == 0 && i + 1 < argc) {
+      nvsPath = argv[++i];
+    } else if (strcmp(a, "--mqtt-trace") == 0) {
+      halMqttSetTrace(true);
+    } else if (strcmp(a, "--wifi-down") == 0) {
+      halSetWiFiSsidReachable(ssid, false);
+      halSetWiFiSsidReachable(ssidSecondary, false);
+    } else if (strcmp(a, "--no-stub") == 0) {
+      useStub = false;
+    } else {
+      usage(argv[0]);
+      return 2;
+    }
+  }
+
+  setvbuf(stdout, nullptr, _IOLBF, 0);  // keep Serial and [HAL] stderr lines in order
+  if (nvsPath != nullptr) halNvsLoad(nvsPath);
+  halSetRestartHandler(onRestart);
+  signal(SIGINT, onSignal);
+  signal(SIGTERM, onSignal);
+
+  uint16_t stubPort = useStub ? stubHttpStart() : 0;
+  if (stubPort != 0) {
+    snprintf(stubHeartbeatUrl, sizeof(stubHeartbeatUrl), "http://127.0.0.1:%u/heartbeat/native", stubPort);
+    snprintf(stubProbeUrl, sizeof(stubProbeUrl), "http://127.0.0.1:%u/generate_204", stubPort);
+    apiEndpoint = stubHeartbeatUrl;
+  }
+
+  if (bench) halSetSerialEnabled(false);
+  setup();
+  if (stubPort != 0) {
+    // The probe config loads lazily on first use; load it now so the override sticks
+    loadNetworkMetricsConfigFromStorage();
+    strncpy(networkProbeTarget, stubProbeUrl, sizeof(networkProbeTarget) - 1);
+    networkProbeTarget[sizeof(networkProbeTarget) - 1] = '\0';
+  }
+
+  int status = 0;
+  if (bench) {
+    status = runBenchmarks(benchFilter) > 0 ? 0 : 1;
+  } else {
+    unsigned long start = millis();
+    while (!stopRequested && (runMs < 0 || (long)(millis() - start) < runMs)) {
+      loop();
+    }
+  }
+
+  stubHttpStop();
+  saveNvs();
+  fflush(stdout);
+  return status;
+}
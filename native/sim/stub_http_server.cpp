@@ -0,0 +1,88 @@
+#include "stub_http_server.h"
+#include <arpa/inet.h>
+#include <atomic>
+#include <netinet/in.h>
+#include <poll.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+
+static int listenFd = -1;
+static std::thread worker;
+static std::atomic<bool> running(false);
+static std::atomic<unsigned long> requests(0);
+
+// Serves requests until the client closes, goes idle, or does not ask for
+// keep-alive
+static void serveConnection(int fd) {
+  bool keepAlive = true;
+  while (keepAlive) {
+    char buf[1024];
+    size_t have = 0;
+    // Read until the end of the request head; bodies are not expected
+    while (have < sizeof(buf) - 1) {
+      struct pollfd pfd = {fd, POLLIN, 0};
+      if (poll(&pfd, 1, 2000) <= 0) break;
+      ssize_t n = recv(fd, buf + have, sizeof(buf) - 1 - have, 0);
+      if (n <= 0) break;
+      have += (size_t)n;
+      buf[have] = '\0';
+      if (strstr(buf, "\r\n\r\n") != nullptr) break;
+    }
+    if (have == 0) break;
+    keepAlive = strstr(buf, "Connection: keep-alive") != nullptr;
+    char response[160];
+    int len = snprintf(response, sizeof(response),
+                       "HTTP/1.1 200 OK\r\nContent-Type: application/json\r\nContent-Length: 15\r\n"
+                       "Connection: %s\r\n\r\n{\"status\":\"ok\"}",
+                       keepAlive ? "keep-alive" : "close");
+    send(fd, response, (size_t)len, MSG_NOSIGNAL);
+    requests++;
+  }
+  close(fd);
+}
+
+uint16_t stubHttpStart() {
+  if (running) return 0;
+  listenFd = socket(AF_INET, SOCK_STREAM, 0);
+  if (listenFd < 0) return 0;
+  int one = 1;
+  setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+  struct sockaddr_in sa;
+  memset(&sa, 0, sizeof(sa));
+  sa.sin_family = AF_INET;
+  sa.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  sa.sin_port = 0;
+  socklen_t len = sizeof(sa);
+  if (bind(listenFd, reinterpret_cast<struct sockaddr*>(&sa), sizeof(sa)) != 0 || listen(listenFd, 16) != 0 ||
+      getsockname(listenFd, reinterpret_cast<struct sockaddr*>(&sa), &len) != 0) {
+    close(listenFd);
+    listenFd = -1;
+    return 0;
+  }
+
+  running = true;
+  worker = std::thread([]() {
+    while (running) {
+      struct pollfd pfd = {listenFd, POLLIN, 0};
+      if (poll(&pfd, 1, 100) <= 0) continue;
+      int fd = accept(listenFd, nullptr, nullptr);
+      if (fd >= 0) serveConnection(fd);
+    }
+  });
+  return ntohs(sa.sin_port);
+}
+
+void stubHttpStop() {
+  if (!running) return;
+  running = false;
+  worker.join();
+  close(listenFd);
+  listenFd = -1;
+}
+
+unsigned long stubHttpRequests() {
+  return requests;
+}
@@ -0,0 +1,13 @@
+#ifndef NATIVE_STUB_HTTP_SERVER_H
+#define NATIVE_STUB_HTTP_SERVER_H
+
+#include <stdint.h>
+
+// Loopback HTTP server on its own thread that answers every request with
+// "200 OK" (keeping the connection when the request asks). Stands in for the notification API and the probe target so the
+// heartbeat and network metrics exercise real sockets without a LAN.
+uint16_t stubHttpStart();  // returns the ephemeral port (0 on failure)
+void stubHttpStop();
+unsigned long stubHttpRequests();
+
+#endif
@@ -0,0 +1,131 @@
+try:
+    from SCons.Script import Import
+    Import("env")  # provided by PlatformIO
+except ImportError:
+    env = None
+
+import gzip, hashlib, os, re, sys
+
+# Embed the dashboard in the firmware as pre-gzipped, content-hashed blobs.
+# Writes web_assets_data.h (included by src/web_assets.cpp) with one flash
+# array per asset. app.js and style.css are renamed to app.<hash>.js /
+# style.<hash>.css so they can be cached forever; index.html and sw.js keep
+# their names, are rewritten to point at the hashed files, and are
+# revalidated by ETag.
+#
+# PlatformIO runs this before every build. Standalone:
+#   python3 scripts/embed_web_assets.py <output_dir>
+
+HASHED = ['app.js', 'style.css']
+PLAIN = ['index.html', 'sw.js', 'manifest.json', 'offline.html', 'icon-192.svg']
+
+CONTENT_TYPES = {
+    '.html': 'text/html',
+    '.js': 'application/javascript',
+    '.css': 'text/css',
+    '.json': 'application/manifest+json',
+    '.svg': 'image/svg+xml',
+}
+
+
+def short_hash(data):
+    return hashlib.sha256(data).hexdigest()[:8]
+
+
+def hashed_name(name, data):
+    stem, ext = os.path.splitext(name)
+    return f"{stem}.{short_hash(data)}{ext}"
+
+
+def build_assets(web_dir):
+    sources = {}
+    for name in HASHED + PLAIN:
+        with open(os.path.join(web_dir, name), 'rb') as f:
+            sources[name] = f.read()
+
+    renames = {name: hashed_name(name, sources[name]) for name in HASHED}
+    build_id = short_hash(b''.join(sources[n] for n in HASHED + PLAIN))
+
+    def rewrite(text):
+        for old, new in renames.items():
+            text = re.sub(r"(['\"])/" + re.escape(old) + r"\1", r"\1/" + new + r"\1", text)
+        return text
+
+    index = rewrite(sources['index.html'].decode('utf-8'))
+    # Tells app.js it is served by the device itself (same-origin API)
+    index = index.replace('<head>', '<head>\n    <meta name="device-hosted" content="1">', 1)
+    sources['index.html'] = index.encode('utf-8')
+
+    sw = rewrite(sources['sw.js'].decode('utf-8'))
+    sw = re.sub(r"(const CACHE_NAME = '[^']*)'", r"\1-" + build_id + "'", sw, count=1)
+    sources['sw.js'] = sw.encode('utf-8')
+
+    assets = []
+    for name in HASHED + PLAIN:
+        path = '/' + renames.get(name, name)
+        # mtime=0 keeps the output (and the ETag) identical across builds
+        body = gzip.compress(sources[name], compresslevel=9, mtime=0)
+        assets.append({
+            'path': path,
+            'type': CONTENT_TYPES[os.path.splitext(name)[1]],
+            'body': body,
+            'etag': '"' + hashlib.sha256(body).hexdigest()[:16] + '"',
+            'immutable': name in HASHED,
+            'raw_size': len(sources[name]),
+        })
+    return assets
+
+
+def write_header(assets, out_path):
+    lines = [
+        '// Generated by scripts/embed_web_assets.py from web/ -- do not edit',
+        '#ifndef WEB_ASSETS_DATA_H',
+        '#define WEB_ASSETS_DATA_H',
+        '',
+    ]
+    for i, a in enumerate(assets):
+        lines.append(f"// {a['path']}: {a['raw_size']} -> {len(a['body'])} bytes gzipped")
+        lines.append(f"static const uint8_t WEB_ASSET_{i}[] PROGMEM = {{")
+        body = a['body']
+        for off in range(0, len(body), 20):
+            lines.append('  ' + ','.join(str(b) for b in body[off:off + 20]) + ',')
+        lines.append('};')
+        lines.append('')
+    lines.append('static const WebAsset WEB_ASSETS[] = {')
+    for i, a in enumerate(assets):
+        immutable = 'true' if a['immutable'] else 'false'
+        etag = a['etag'].replace('"', '\\"')
+        lines.append(f"  {{\"{a['path']}\", \"{a['type']}\", WEB_ASSET_{i}, sizeof(WEB_ASSET_{i}), "
+                     f"\"{etag}\", {immutable}}},")
+    lines.append('};')
+    lines.append('')
+    lines.append('#endif')
+    content = '\n'.join(lines) + '\n'
+
+    # Leave the file alone when nothing changed, so it does not force a rebuild
+    if os.path.exists(out_path):
+        with open(out_path) as f:
+            if f.read() == content:
+                return False
+    os.makedirs(os.path.dirname(out_path), exist_ok=True)
+    with open(out_path, 'w') as f:
+        f.write(content)
+    return True
+
+
+def generate(project_dir, out_dir):
+    assets = build_assets(os.path.join(project_dir, 'web'))
+    changed = write_header(assets, os.path.join(out_dir, 'web_assets_data.h'))
+    total = sum(len(a['body']) for a in assets)
+    state = 'updated' if changed else 'unchanged'
+    print(f"[INFO] Web assets: {len(assets)} files, {total} bytes gzipped ({state})")
+
+
+if env is not None:
+    out_dir = os.path.join(env.subst("$BUILD_DIR"), "web_assets")
+    generate(env.subst("$PROJECT_DIR"), out_dir)
+    env.Append(CPPPATH=[out_dir])
+elif __name__ == '__main__':
+    if len(sys.argv) != 2:
+        sys.exit('usage: embed_web_assets.py <output_dir>')
+    generate(os.path.join(os.path.dirname(os.path.abspath(__file__)), '..'), sys.argv[1])
@@ -0,0 +1,524 @@
+#include "async_http.h"
+#include <IPAddress.h>
+#include <lwip/sockets.h>
+#include <lwip/dns.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <string.h>
+#include <strings.h>
+#include <stdlib.h>
+
+static void enterPhase(AsyncHttpRequest& req, AsyncHttpPhase phase) {
+  req.phase = phase;
+  req.phaseStartMs = millis();
+}
+
+static void closeSocket(AsyncHttpRequest& req) {
+  if (req.sock >= 0) {
+    close(req.sock);
+    req.sock = -1;
+  }
+}
+
+static AsyncHttpPhase fail(AsyncHttpRequest& req, int code) {
+  closeSocket(req);
+  req.statusCode = code;
+  req.failedPhase = req.phase;
+  req.timings.totalMs = millis() - req.startMs;
+  req.phase = AHTTP_FAILED;
+  return req.phase;
+}
+
+// delimited: the response's own framing marked its end. Otherwise the
+// server closed to mark it, and the connection is gone.
+static AsyncHttpPhase finish(AsyncHttpRequest& req, bool delimited) {
+  unsigned long now = millis();
+  req.timings.drainMs = now - req.phaseStartMs;
+  req.timings.totalMs = now - req.startMs;
+  if (!req.keepAlive || req.serverClose || !delimited) {
+    closeSocket(req);
+  }
+  req.failedPhase = AHTTP_IDLE;
+  req.phase = AHTTP_DONE;
+  return req.phase;
+}
+
+// Split "http://host[:port][/path]" (or "tcp://host:port" for a
+// connect-only request) into the request fields
+static bool parseUrl(AsyncHttpRequest& req, const char* url) {
+  const char* scheme = req.connectOnly ? "tcp://" : "http://";
+  size_t schemeLen = strlen(scheme);
+  if (url == nullptr || strncmp(url, scheme, schemeLen) != 0) return false;
+  const char* hostStart = url + schemeLen;
+  const char* hostEnd = hostStart;
+  while (*hostEnd && *hostEnd != ':' && *hostEnd != '/') hostEnd++;
+  size_t hostLen = hostEnd - hostStart;
+  if (hostLen == 0 || hostLen >= sizeof(req.host)) return false;
+  memcpy(req.host, hostStart, hostLen);
+  req.host[hostLen] = '\0';
+
+  req.port = 80;
+  const char* pathStart = hostEnd;
+  if (*hostEnd == ':') {
+    long port = strtol(hostEnd + 1, (char**)&pathStart, 10);
+    if (port <= 0 || port > 65535) return false;
+    req.port = (uint16_t)port;
+  } else if (req.connectOnly) {
+    return false;  // no default port to connect to
+  }
+  if (req.connectOnly) {
+    return *pathStart == '\0';
+  }
+  if (*pathStart == '\0') {
+    strcpy(req.path, "/");
+  } else {
+    if (*pathStart != '/' || strlen(pathStart) >= sizeof(req.path)) return false;
+    strcpy(req.path, pathStart);
+  }
+  return true;
+}
+
+// lwIP DNS completion (runs in the tcpip task). A lookup is never
+// cancelled, so the answer may arrive after its request timed out and the
+// struct was reused: drop it unless it is for the lookup still waiting.
+static void dnsFoundCallback(const char* name, const ip_addr_t* ipaddr, void* arg) {
+  AsyncHttpRequest* req = static_cast<AsyncHttpRequest*>(arg);
+  if (req->phase != AHTTP_RESOLVE || req->dnsDone || name == nullptr || strcmp(name, req->host) != 0) {
+    return;
+  }
+  req->addr = ipaddr ? ip4_addr_get_u32(ip_2_ip4(ipaddr)) : 0;
+  req->dnsDone = true;
+}
+
+// Per-request state, shared by a new connection and a reused one
+static void resetExchange(AsyncHttpRequest& req, unsigned long timeoutMs) {
+  memset(&req.timings, 0, sizeof(req.timings));
+  req.ioLen = 0;
+  req.sent = 0;
+  req.serverClose = false;
+  req.firstByte = false;
+  req.statusParsed = false;
+  req.contentLength = -1;
+  req.chunked = false;
+  req.chunkState = 0;
+  req.chunkLeft = 0;
+  req.bodyBytes = 0;
+  req.statusCode = 0;
+  req.bodyPreview[0] = '\0';
+  req.timeoutMs = timeoutMs;
+  req.startMs = millis();
+}
+
+static bool buildRequest(AsyncHttpRequest& req) {
+  int n = snprintf(req.io, sizeof(req.io),
+                   "GET %s HTTP/1.1\r\nHost: %s\r\nUser-Agent: ESP32-Monitor\r\nConnection: %s\r\n\r\n",
+                   req.path, req.host, req.keepAlive ? "keep-alive" : "close");
+  req.ioLen = (n > 0 && (size_t)n < sizeof(req.io)) ? (size_t)n : 0;
+  req.sent = 0;
+  return req.ioLen > 0;
+}
+
+static bool beginRequest(AsyncHttpRequest& req, const char* url, unsigned long timeoutMs, bool connectOnly) {
+  // Idle requests have already released their socket; a finished keep-alive
+  // one may still hold it
+  if (req.phase != AHTTP_IDLE) {
+    closeSocket(req);
+  }
+  req.sock = -1;
+  req.addr = 0;
+  req.dnsDone = false;
+  req.connectOnly = connectOnly;
+  req.keepAlive = false;
+  resetExchange(req, timeoutMs);
+  req.host[0] = '\0';  // no late answer for the previous host matches
+  enterPhase(req, AHTTP_RESOLVE);
+
+  if (!parseUrl(req, url)) {
+    fail(req, AHTTP_ERR_INVALID_URL);
+    return false;
+  }
+
+  IPAddress literal;
+  if (literal.fromString(req.host)) {
+    req.addr = (uint32_t)literal;
+    req.dnsDone = true;
+    return true;
+  }
+
+  ip_addr_t cached;
+  err_t err = dns_gethostbyname(req.host, &cached, dnsFoundCallback, &req);
+  if (err == ERR_OK) {
+    req.addr = ip4_addr_get_u32(ip_2_ip4(&cached));
+    req.dnsDone = true;
+  } else if (err != ERR_INPROGRESS) {
+    fail(req, AHTTP_ERR_CONNECTION_REFUSED);
+    return false;
+  }
+  return true;
+}
+
+bool asyncHttpBegin(AsyncHttpRequest& req, const char* url, unsigned long timeoutMs) {
+  return beginRequest(req, url, timeoutMs, false);
+}
+
+bool asyncHttpBeginConnect(AsyncHttpRequest& req, const char* url, unsigned long timeoutMs) {
+  return beginRequest(req, url, timeoutMs, true);
+}
+
+bool asyncHttpBeginKeepAlive(AsyncHttpRequest& req, const char* url, unsigned long timeoutMs) {
+  bool ok = asyncHttpBegin(req, url, timeoutMs);
+  req.keepAlive = true;
+  return ok;
+}
+
+bool asyncHttpReuse(AsyncHttpRequest& req, unsigned long timeoutMs) {
+  if (!asyncHttpConnected(req)) {
+    return false;
+  }
+  resetExchange(req, timeoutMs);
+  if (!buildRequest(req)) {
+    return false;
+  }
+  enterPhase(req, AHTTP_SEND);
+  return true;
+}
+
+bool asyncHttpConnected(const AsyncHttpRequest& req) {
+  return req.phase == AHTTP_DONE && req.sock >= 0;
+}
+
+static AsyncHttpPhase stepResolve(AsyncHttpRequest& req) {
+  if (!req.dnsDone) {
+    return req.phase;
+  }
+  if (req.addr == 0) {
+    return fail(req, AHTTP_ERR_CONNECTION_REFUSED);
+  }
+  req.timings.resolveMs = millis() - req.phaseStartMs;
+
+  req.sock = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+  if (req.sock < 0) {
+    return fail(req, AHTTP_ERR_CONNECTION_REFUSED);
+  }
+  fcntl(req.sock, F_SETFL, fcntl(req.sock, F_GETFL, 0) | O_NONBLOCK);
+
+  struct sockaddr_in sa;
+  memset(&sa, 0, sizeof(sa));
+  sa.sin_family = AF_INET;
+  sa.sin_port = htons(req.port);
+  sa.sin_addr.s_addr = req.addr;
+
+  enterPhase(req, AHTTP_CONNECT);
+  int r = connect(req.sock, (struct sockaddr*)&sa, sizeof(sa));
+  if (r != 0 && errno != EINPROGRESS) {
+    return fail(req, AHTTP_ERR_CONNECTION_REFUSED);
+  }
+  return req.phase;
+}
+
+static AsyncHttpPhase stepConnect(AsyncHttpRequest& req) {
+  fd_set wfds;
+  FD_ZERO(&wfds);
+  FD_SET(req.sock, &wfds);
+  struct timeval tv = {0, 0};
+  int ready = select(req.sock + 1, nullptr, &wfds, nullptr, &tv);
+  if (ready < 0) {
+    return fail(req, AHTTP_ERR_CONNECTION_REFUSED);
+  }
+  if (ready == 0) {
+    return req.phase;
+  }
+
+  int soErr = 0;
+  socklen_t len = sizeof(soErr);
+  getsockopt(req.sock, SOL_SOCKET, SO_ERROR, &soErr, &len);
+  if (soErr != 0) {
+    return fail(req, AHTTP_ERR_CONNECTION_REFUSED);
+  }
+  req.timings.connectMs = millis() - req.phaseStartMs;
+
+  if (req.connectOnly) {
+    closeSocket(req);
+    req.timings.totalMs = req.timings.resolveMs + req.timings.connectMs;
+    req.failedPhase = AHTTP_IDLE;
+    req.phase = AHTTP_DONE;
+    return req.phase;
+  }
+  if (!buildRequest(req)) {
+    return fail(req, AHTTP_ERR_INVALID_URL);
+  }
+  enterPhase(req, AHTTP_SEND);
+  return req.phase;
+}
+
+static AsyncHttpPhase stepSend(AsyncHttpRequest& req) {
+  ssize_t n = send(req.sock, req.io + req.sent, req.ioLen - req.sent, MSG_DONTWAIT);
+  if (n < 0) {
+    if (errno == EAGAIN || errno == EWOULDBLOCK) {
+      return req.phase;
+    }
+    return fail(req, AHTTP_ERR_SEND_FAILED);
+  }
+  req.sent += (size_t)n;
+  if (req.sent < req.ioLen) {
+    return req.phase;
+  }
+  req.timings.sendMs = millis() - req.phaseStartMs;
+  req.ioLen = 0;
+  enterPhase(req, AHTTP_AWAIT_HEADERS);
+  return req.phase;
+}
+
+// Handle one complete header line held in req.io. Returns false on a
+// malformed status line.
+static bool processHeaderLine(AsyncHttpRequest& req) {
+  req.io[req.ioLen] = '\0';
+  if (!req.statusParsed) {
+    // "HTTP/1.x NNN reason"
+    if (strncmp(req.io, "HTTP/", 5) != 0) return false;
+    const char* sp = strchr(req.io, ' ');
+    if (sp == nullptr) return false;
+    int code = atoi(sp + 1);
+    if (code < 100 || code > 999) return false;
+    req.statusCode = code;
+    req.statusParsed = true;
+  } else if (strncasecmp(req.io, "Content-Length:", 15) == 0) {
+    req.contentLength = atol(req.io + 15);
+  } else if (strncasecmp(req.io, "Connection:", 11) == 0) {
+    const char* value = req.io + 11;
+    while (*value == ' ') value++;
+    req.serverClose = strncasecmp(value, "close", 5) == 0;
+  } else if (strncasecmp(req.io, "Transfer-Encoding:", 18) == 0) {
+    // "chunked" is always the last coding listed
+    size_t len = req.ioLen;
+    while (len > 18 && req.io[len - 1] == ' ') len--;
+    req.chunked = len >= 18 + 7 && strncasecmp(req.io + len - 7, "chunked", 7) == 0;
+  }
+  return true;
+}
+
+// Responses that never carry a body, whatever their headers say
+static bool bodiless(int code) {
+  return code == 204 || code == 304;
+}
+
+static void captureBody(AsyncHttpRequest& req, const char* data, size_t len) {
+  size_t have = strlen(req.bodyPreview);
+  size_t room = sizeof(req.bodyPreview) - 1 - have;
+  size_t take = len < room ? len : room;
+  memcpy(req.bodyPreview + have, data, take);
+  req.bodyPreview[have + take] = '\0';
+  req.bodyBytes += len;
+}
+
+// Chunked body framing: "<hex size>[;ext]\r\n<data>\r\n" per chunk, then a
+// zero-size chunk and trailer lines up to a blank one
+enum ChunkState : uint8_t {
+  CHUNK_SIZE = 0,  // hex digits of the size
+  CHUNK_EXT,       // rest of the size line
+  CHUNK_DATA,
+  CHUNK_DATA_END,  // CRLF after the data
+  CHUNK_TRAILER,   // after the last chunk; ioLen counts the line's bytes
+  CHUNK_END
+};
+
+// Decode len bytes of chunked body into the preview, setting *used to the
+// bytes that belonged to the body. Returns false on a malformed size line.
+static bool decodeChunked(AsyncHttpRequest& req, const char* data, size_t len, size_t* used) {
+  size_t i = 0;
+  while (i < len && req.chunkState != CHUNK_END) {
+    char c = data[i];
+    switch (req.chunkState) {
+      case CHUNK_SIZE: {
+        int digit = (c >= '0' && c <= '9') ? c - '0'
+                  : (c >= 'a' && c <= 'f') ? c - 'a' + 10
+                  : (c >= 'A' && c <= 'F') ? c - 'A' + 10 : -1;
+        if (digit >= 0) {
+          if (req.chunkLeft > (SIZE_MAX >> 4)) return false;
+          req.chunkLeft = (req.chunkLeft << 4) | (size_t)digit;
+          i++;
+          break;
+        }
+        req.chunkState = CHUNK_EXT;
+        break;  // c is looked at again as part of the rest of the line
+      }
+      case CHUNK_EXT:
+        i++;
+        if (c != '\n') break;
+        if (req.chunkLeft > 0) {
+          req.chunkState = CHUNK_DATA;
+        } else {
+          req.chunkState = CHUNK_TRAILER;
+          req.ioLen = 0;
+        }
+        break;
+      case CHUNK_DATA: {
+        size_t take = len - i < req.chunkLeft ? len - i : req.chunkLeft;
+        captureBody(req, data + i, take);
+        i += take;
+        req.chunkLeft -= take;
+        if (req.chunkLeft == 0) req.chunkState = CHUNK_DATA_END;
+        break;
+      }
+      case CHUNK_DATA_END:
+        i++;
+        if (c == '\n') req.chunkState = CHUNK_SIZE;
+        break;
+      case CHUNK_TRAILER:
+        i++;
+        if (c == '\r') break;
+        if (c != '\n') {
+          req.ioLen++;
+        } else if (req.ioLen == 0) {
+          req.chunkState = CHUNK_END;
+        } else {
+          req.ioLen = 0;
+        }
+        break;
+    }
+  }
+  *used = i;
+  return true;
+}
+
+static AsyncHttpPhase stepReceive(AsyncHttpRequest& req) {
+  char buf[128];
+  ssize_t n = recv(req.sock, buf, sizeof(buf), MSG_DONTWAIT);
+  if (n < 0) {
+    if (errno == EAGAIN || errno == EWOULDBLOCK) {
+      return req.phase;
+    }
+    return fail(req, AHTTP_ERR_CONNECTION_LOST);
+  }
+
+  if (n == 0) {
+    // Peer closed: fine once headers are in (Connection: close), otherwise a failure
+    if (req.phase == AHTTP_DRAIN) {
+      return finish(req, false);
+    }
+    return fail(req, req.statusParsed ? AHTTP_ERR_CONNECTION_LOST : AHTTP_ERR_NO_HTTP_SERVER);
+  }
+
+  if (!req.firstByte) {
+    req.firstByte = true;
+    req.timings.firstByteMs = millis() - req.phaseStartMs;
+  }
+
+  size_t i = 0;
+  if (req.phase == AHTTP_AWAIT_HEADERS) {
+    for (; i < (size_t)n; i++) {
+      char c = buf[i];
+      if (c == '\r') continue;
+      if (c != '\n') {
+        // Long header lines are truncated; only the prefix matters here
+        if (req.ioLen < sizeof(req.io) - 1) {
+          req.io[req.ioLen++] = c;
+        }
+        continue;
+      }
+      if (req.ioLen == 0 && req.statusParsed) {
+        // Blank line: end of headers. An interim 1xx response is followed
+        // by the real one.
+        if (req.statusCode < 200) {
+          req.statusParsed = false;
+          req.contentLength = -1;
+          req.chunked = false;
+          req.serverClose = false;
+          continue;
+        }
+        req.timings.awaitHeadersMs = millis() - req.phaseStartMs;
+        enterPhase(req, AHTTP_DRAIN);
+        i++;
+        break;
+      }
+      if (!processHeaderLine(req)) {
+        return fail(req, AHTTP_ERR_NO_HTTP_SERVER);
+      }
+      req.ioLen = 0;
+    }
+  }
+
+  if (req.phase != AHTTP_DRAIN) {
+    return req.phase;
+  }
+  // Bytes after the end of a bodiless response belong to no request
+  // (nothing is pipelined), so they are dropped with it
+  if (bodiless(req.statusCode)) {
+    return finish(req, i == (size_t)n);
+  }
+  if (req.chunked) {
+    size_t used = 0;
+    if (!decodeChunked(req, buf + i, (size_t)n - i, &used)) {
+      return fail(req, AHTTP_ERR_NO_HTTP_SERVER);
+    }
+    return req.chunkState == CHUNK_END ? finish(req, i + used == (size_t)n) : req.phase;
+  }
+  if (i < (size_t)n) {
+    captureBody(req, buf + i, (size_t)n - i);
+  }
+  if (req.contentLength >= 0 && req.bodyBytes >= (size_t)req.contentLength) {
+    return finish(req, req.bodyBytes == (size_t)req.contentLength);
+  }
+  return req.phase;
+}
+
+AsyncHttpPhase asyncHttpStep(AsyncHttpRequest& req) {
+  if (!asyncHttpBusy(req)) {
+    return req.phase;
+  }
+
+  if (millis() - req.startMs >= req.timeoutMs) {
+    bool connecting = (req.phase == AHTTP_RESOLVE || req.phase == AHTTP_CONNECT);
+    return fail(req, connecting ? AHTTP_ERR_CONNECTION_REFUSED : AHTTP_ERR_READ_TIMEOUT);
+  }
+
+  switch (req.phase) {
+    case AHTTP_RESOLVE:       return stepResolve(req);
+    case AHTTP_CONNECT:       return stepConnect(req);
+    case AHTTP_SEND:          return stepSend(req);
+    case AHTTP_AWAIT_HEADERS:
+    case AHTTP_DRAIN:         return stepReceive(req);
+    default:                  return req.phase;
+  }
+}
+
+bool asyncHttpBusy(const AsyncHttpRequest& req) {
+  return req.phase != AHTTP_IDLE && req.phase != AHTTP_DONE && req.phase != AHTTP_FAILED;
+}
+
+void asyncHttpAbort(AsyncHttpRequest& req) {
+  // An idle request holds no socket; a zero-initialised one has sock 0,
+  // which must not be closed
+  if (req.phase == AHTTP_IDLE) {
+    return;
+  }
+  closeSocket(req);
+  req.phase = AHTTP_IDLE;
+}
+
+const char* asyncHttpPhaseName(AsyncHttpPhase phase) {
+  switch (phase) {
+    case AHTTP_IDLE:          return "idle";
+    case AHTTP_RESOLVE:       return "resolve";
+    case AHTTP_CONNECT:       return "connect";
+    case AHTTP_SEND:          return "send";
+    case AHTTP_AWAIT_HEADERS: return "await_headers";
+    case AHTTP_DRAIN:         return "drain";
+    case AHTTP_DONE:          return "done";
+    case AHTTP_FAILED:        return "failed";
+  }
+  return "unknown";
+}
+
+const char* asyncHttpErrorString(int code) {
+  switch (code) {
+    case AHTTP_ERR_CONNECTION_REFUSED: return "connection refused";
+    case AHTTP_ERR_SEND_FAILED:        return "send failed";
+    case AHTTP_ERR_CONNECTION_LOST:    return "connection lost";
+    case AHTTP_ERR_NO_HTTP_SERVER:     return "no HTTP server";
+    case AHTTP_ERR_READ_TIMEOUT:       return "read timeout";
+    case AHTTP_ERR_INVALID_URL:        return "invalid URL";
+  }
+  return "unknown error";
+}
@@ -0,0 +1,116 @@
+#ifndef ASYNC_HTTP_H
+#define ASYNC_HTTP_H
+
+#include <Arduino.h>
+
+// Non-blocking HTTP/1.1 GET over a raw socket, advanced one step per call
+// from loop(). Every phase is timed separately so a slow resolver, a slow TCP
+// handshake and a slow origin can be told apart. Plain http:// only, plus a
+// connect-only mode (tcp://host:port) that stops once the handshake is done.
+
+enum AsyncHttpPhase : uint8_t {
+  AHTTP_IDLE = 0,
+  AHTTP_RESOLVE,
+  AHTTP_CONNECT,
+  AHTTP_SEND,
+  AHTTP_AWAIT_HEADERS,
+  AHTTP_DRAIN,
+  AHTTP_DONE,
+  AHTTP_FAILED
+};
+
+// Negative result codes deliberately match HTTPClient's HTTPC_ERROR_* values
+// so existing checks on stored response codes keep working.
+#define AHTTP_ERR_CONNECTION_REFUSED (-1)
+#define AHTTP_ERR_SEND_FAILED        (-2)
+#define AHTTP_ERR_CONNECTION_LOST    (-5)
+#define AHTTP_ERR_NO_HTTP_SERVER     (-7)
+#define AHTTP_ERR_READ_TIMEOUT       (-11)
+#define AHTTP_ERR_INVALID_URL        (-100)
+
+#define AHTTP_HOST_MAX 64
+#define AHTTP_PATH_MAX 128
+#define AHTTP_PREVIEW_MAX 64
+
+struct AsyncHttpTimings {
+  unsigned long resolveMs;
+  unsigned long connectMs;
+  unsigned long sendMs;
+  unsigned long firstByteMs;     // request written -> first response byte
+  unsigned long awaitHeadersMs;  // request written -> end of response headers
+  unsigned long drainMs;
+  unsigned long totalMs;
+};
+
+struct AsyncHttpRequest {
+  // Target
+  char host[AHTTP_HOST_MAX];
+  char path[AHTTP_PATH_MAX];
+  uint16_t port;
+  unsigned long timeoutMs;
+
+  // State machine
+  AsyncHttpPhase phase;
+  AsyncHttpPhase failedPhase;    // phase active when the request failed
+  int sock;
+  uint32_t addr;                 // resolved IPv4, network byte order
+  volatile bool dnsDone;         // set from the lwIP DNS callback
+  unsigned long startMs;
+  unsigned long phaseStartMs;
+  char io[AHTTP_HOST_MAX + AHTTP_PATH_MAX + 96];  // request text, then header line
+  size_t ioLen;
+  size_t sent;
+  bool connectOnly;              // tcp:// target: done once connected, nothing sent
+  bool keepAlive;                // ask to keep the connection for asyncHttpReuse()
+  bool serverClose;              // response said "Connection: close"
+  bool firstByte;                // any response byte seen
+  bool statusParsed;
+  long contentLength;            // -1 when the server did not send one
+  bool chunked;                  // Transfer-Encoding: chunked
+  uint8_t chunkState;            // where the chunk decoder is in the framing
+  size_t chunkLeft;              // chunk size being read, then its bytes still due
+  size_t bodyBytes;              // body bytes received (decoded when chunked)
+
+  // Result
+  int statusCode;                // HTTP status (>0) or AHTTP_ERR_* (<0)
+  AsyncHttpTimings timings;
+  char bodyPreview[AHTTP_PREVIEW_MAX];
+};
+
+// Parse url and start resolving. Returns false (and sets AHTTP_FAILED with
+// AHTTP_ERR_INVALID_URL) if the URL is not a usable http:// URL.
+bool asyncHttpBegin(AsyncHttpRequest& req, const char* url, unsigned long timeoutMs);
+
+// As asyncHttpBegin, but the request asks for a persistent connection. When
+// the response allows it (its end known from Content-Length, chunked framing
+// or a bodiless 204/304; no "Connection: close"), the socket stays open after
+// AHTTP_DONE for asyncHttpReuse().
+bool asyncHttpBeginKeepAlive(AsyncHttpRequest& req, const char* url, unsigned long timeoutMs);
+
+// Send the same GET again on the connection a finished keep-alive request
+// left open, starting at AHTTP_SEND (resolve and connect time 0). Returns
+// false when there is no open connection; begin a new request instead.
+bool asyncHttpReuse(AsyncHttpRequest& req, unsigned long timeoutMs);
+
+// Open a TCP connection to "tcp://host:port" and close it again. The request
+// is AHTTP_DONE (statusCode 0) once the handshake completes; only the resolve
+// and connect timings are set, and totalMs is their sum.
+bool asyncHttpBeginConnect(AsyncHttpRequest& req, const char* url, unsigned long timeoutMs);
+
+// True while a finished request still holds its connection
+bool asyncHttpConnected(const AsyncHttpRequest& req);
+
+// Advance the request by at most one non-blocking socket operation.
+// Returns the phase after the step; AHTTP_DONE / AHTTP_FAILED are terminal.
+AsyncHttpPhase asyncHttpStep(AsyncHttpRequest& req);
+
+// True while a request is between begin and a terminal phase
+bool asyncHttpBusy(const AsyncHttpRequest& req);
+
+// Close the socket (a kept-alive one too) and return to AHTTP_IDLE
+void asyncHttpAbort(AsyncHttpRequest& req);
+
+const char* asyncHttpPhaseName(AsyncHttpPhase phase);
+const char* asyncHttpErrorString(int code);
+
+#endif
@@ -22,6 +22,7 @@ extern const char* heartbeatBaseUrl;   // no trailing slash
 extern const char* heartbeatDeviceId;  // path segment for notification-api
 extern const char* heartbeatPath;      // optional full path override (e.g. "/health")
 const char* getHeartbeatEndpoint();    // resolved URL used for the periodic GET
+extern const char* apiEndpoint;        // heartbeat URL currently used by heartbeat.cpp
 
 // Device / OTA
 extern const char* otaPassword;
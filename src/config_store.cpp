@@ -0,0 +1,257 @@
+#include "config_store.h"
+#include <Preferences.h>
+#include <string.h>
+
+DeviceConfig deviceConfig;
+
+static const char* const SECTION_NAMESPACES[CFG_SECTION_COUNT] = {
+  "firmware", "ota_rollback", "system", "dns_cfg", "net_metrics"
+};
+
+static uint8_t dirtyMask = 0;
+static unsigned long firstDirtyMs = 0;  // when the oldest unflushed change was made
+static unsigned long lastDirtyMs = 0;   // when the newest one was made
+static ConfigStoreStats stats = {0, 0, 0, 0, 0, 0};
+
+static void copyString(char* dst, size_t dstSize, const String& src) {
+  strncpy(dst, src.c_str(), dstSize - 1);
+  dst[dstSize - 1] = '\0';
+}
+
+// Empty strings / zero timestamps are stored as absent keys, as before
+static void putOrRemove(Preferences& prefs, const char* key, const char* value) {
+  if (value[0] != '\0') {
+    prefs.putString(key, value);
+  } else if (prefs.isKey(key)) {
+    prefs.remove(key);
+  }
+}
+
+static void putOrRemove(Preferences& prefs, const char* key, unsigned long value) {
+  if (value != 0) {
+    prefs.putULong(key, value);
+  } else if (prefs.isKey(key)) {
+    prefs.remove(key);
+  }
+}
+
+static void loadSection(ConfigSection section, Preferences& prefs) {
+  switch (section) {
+    case CFG_FIRMWARE: {
+      FirmwareState& f = deviceConfig.firmware;
+      copyString(f.lastVersion, sizeof(f.lastVersion), prefs.getString("lastVersion", ""));
+      f.updateTime = prefs.getULong("updateTime", 0);
+      copyString(f.updateFrom, sizeof(f.updateFrom), prefs.getString("updateFrom", ""));
+      break;
+    }
+    case CFG_OTA_ROLLBACK: {
+      OtaRollbackState& r = deviceConfig.rollback;
+      r.bootFailCount = prefs.getInt("boot_fail_count", 0);
+      copyString(r.lastRollbackFrom, sizeof(r.lastRollbackFrom), prefs.getString("last_rollback_from", ""));
+      r.rollbackTime = prefs.getULong("rollback_time", 0);
+      break;
+    }
+    case CFG_SYSTEM: {
+      SystemState& s = deviceConfig.system;
+      copyString(s.lastReboot, sizeof(s.lastReboot), prefs.getString("last_reboot", ""));
+      s.rebootTime = prefs.getULong("reboot_time", 0);
+      break;
+    }
+    case CFG_DNS: {
+      DnsConfig& d = deviceConfig.dns;
+      d.stored = true;
+      d.failureThresholdMs = prefs.getULong("fail_thr", 0);
+      d.alertIntervalMs = prefs.getULong("alert_int", 0);
+      d.recoveryThresholdMs = prefs.getULong("rec_thr", 0);
+      d.minFailureForRecoveryMs = prefs.getULong("min_rec", 0);
+      break;
+    }
+    case CFG_NET_METRICS: {
+      NetMetricsConfig& n = deviceConfig.net;
+      n.stored = true;
+      copyString(n.probeTarget, sizeof(n.probeTarget), prefs.getString("probe_tgt", ""));
+      n.intervalMs = prefs.getULong("interval", 0);
+      n.samples = prefs.getUChar("samples", 0);
+      n.timeoutMs = prefs.getULong("timeout", 0);
+      n.keepAlive = prefs.getUChar("keepalive", 0);
+      n.spacingMs = prefs.getUShort("spacing", 0);
+      for (uint8_t i = 0; i < CONFIG_PROBE_TARGETS; i++) {
+        NetProbeTargetConfig& t = n.targets[i];
+        char key[12];
+        snprintf(key, sizeof(key), "t%u_url", i);
+        copyString(t.url, sizeof(t.url), prefs.getString(key, ""));
+        snprintf(key, sizeof(key), "t%u_name", i);
+        copyString(t.name, sizeof(t.name), prefs.getString(key, ""));
+        snprintf(key, sizeof(key), "t%u_int", i);
+        t.intervalMs = prefs.getULong(key, 0);
+        snprintf(key, sizeof(key), "t%u_smp", i);
+        t.samples = prefs.getUChar(key, 0);
+        snprintf(key, sizeof(key), "t%u_tmo", i);
+        t.timeoutMs = prefs.getULong(key, 0);
+      }
+      break;
+    }
+    default:
+      break;
+  }
+}
+
+static void writeSection(ConfigSection section, Preferences& prefs) {
+  switch (section) {
+    case CFG_FIRMWARE: {
+      const FirmwareState& f = deviceConfig.firmware;
+      putOrRemove(prefs, "lastVersion", f.lastVersion);
+      putOrRemove(prefs, "updateTime", f.updateTime);
+      putOrRemove(prefs, "updateFrom", f.updateFrom);
+      break;
+    }
+    case CFG_OTA_ROLLBACK: {
+      const OtaRollbackState& r = deviceConfig.rollback;
+      prefs.putInt("boot_fail_count", r.bootFailCount);
+      putOrRemove(prefs, "last_rollback_from", r.lastRollbackFrom);
+      putOrRemove(prefs, "rollback_time", r.rollbackTime);
+      break;
+    }
+    case CFG_SYSTEM: {
+      const SystemState& s = deviceConfig.system;
+      putOrRemove(prefs, "last_reboot", s.lastReboot);
+      putOrRemove(prefs, "reboot_time", s.rebootTime);
+      // Remote reboot requests are events now; drop keys older firmware left
+      if (prefs.isKey("reboot_flag")) prefs.remove("reboot_flag");
+      if (prefs.isKey("reboot_reason")) prefs.remove("reboot_reason");
+      break;
+    }
+    case CFG_DNS: {
+      const DnsConfig& d = deviceConfig.dns;
+      prefs.putULong("fail_thr", d.failureThresholdMs);
+      prefs.putULong("alert_int", d.alertIntervalMs);
+      prefs.putULong("rec_thr", d.recoveryThresholdMs);
+      prefs.putULong("min_rec", d.minFailureForRecoveryMs);
+      break;
+    }
+    case CFG_NET_METRICS: {
+      const NetMetricsConfig& n = deviceConfig.net;
+      prefs.putString("probe_tgt", n.probeTarget);
+      prefs.putULong("interval", n.intervalMs);
+      prefs.putUChar("samples", n.samples);
+      prefs.putULong("timeout", n.timeoutMs);
+      prefs.putUChar("keepalive", n.keepAlive);
+      prefs.putUShort("spacing", n.spacingMs);
+      for (uint8_t i = 0; i < CONFIG_PROBE_TARGETS; i++) {
+        const NetProbeTargetConfig& t = n.targets[i];
+        char key[12];
+        snprintf(key, sizeof(key), "t%u_url", i);
+        putOrRemove(prefs, key, t.url);
+        snprintf(key, sizeof(key), "t%u_name", i);
+        putOrRemove(prefs, key, t.name);
+        snprintf(key, sizeof(key), "t%u_int", i);
+        putOrRemove(prefs, key, t.intervalMs);
+        snprintf(key, sizeof(key), "t%u_smp", i);
+        prefs.putUChar(key, t.samples);
+        snprintf(key, sizeof(key), "t%u_tmo", i);
+        putOrRemove(prefs, key, t.timeoutMs);
+      }
+      break;
+    }
+    default:
+      break;
+  }
+}
+
+bool configStoreBegin() {
+  memset(&deviceConfig, 0, sizeof(deviceConfig));
+  dirtyMask = 0;
+
+  // A read-only open fails for namespaces that were never written; that
+  // section keeps its zeroed defaults (stored = false).
+  bool nvsOk = false;
+  for (uint8_t i = 0; i < CFG_SECTION_COUNT; i++) {
+    Preferences prefs;
+    if (!prefs.begin(SECTION_NAMESPACES[i], true)) {
+      continue;
+    }
+    nvsOk = true;
+    loadSection((ConfigSection)i, prefs);
+    prefs.end();
+    stats.loads++;
+  }
+
+  if (!nvsOk) {
+    // Either a blank NVS (first boot) or an unusable one: probe with a RW open
+    Preferences probe;
+    nvsOk = probe.begin(SECTION_NAMESPACES[CFG_FIRMWARE], false);
+    if (nvsOk) probe.end();
+  }
+
+  Serial.printf("[%10lu ms] [CFG] Loaded %lu of %u config sections from NVS\r\n",
+                millis(), stats.loads, (unsigned)CFG_SECTION_COUNT);
+  return nvsOk;
+}
+
+void configStoreMarkDirty(ConfigSection section) {
+  if (section >= CFG_SECTION_COUNT) return;
+  unsigned long now = millis();
+  if (dirtyMask == 0) {
+    firstDirtyMs = now;
+  } else {
+    stats.coalesced++;
+  }
+  dirtyMask |= (uint8_t)(1U << section);
+  lastDirtyMs = now;
+}
+
+void configStoreFlush() {
+  if (dirtyMask == 0) return;
+
+  uint8_t written = 0;
+  for (uint8_t i = 0; i < CFG_SECTION_COUNT; i++) {
+    uint8_t bit = (uint8_t)(1U << i);
+    if ((dirtyMask & bit) == 0) continue;
+
+    Preferences prefs;
+    if (!prefs.begin(SECTION_NAMESPACES[i], false)) {
+      // Keep the section dirty; the next flush retries it
+      stats.failures++;
+      Serial.printf("[%10lu ms] [CFG] Failed to open NVS namespace '%s' for writing\r\n",
+                    millis(), SECTION_NAMESPACES[i]);
+      continue;
+    }
+    writeSection((ConfigSection)i, prefs);
+    prefs.end();
+    dirtyMask &= (uint8_t)~bit;
+    if (i == CFG_DNS) deviceConfig.dns.stored = true;
+    if (i == CFG_NET_METRICS) deviceConfig.net.stored = true;
+    written++;
+  }
+
+  if (written > 0) {
+    stats.flushes++;
+    stats.sectionWrites += written;
+    stats.lastFlushMs = millis();
+  }
+  // Failed sections restart their debounce window instead of retrying every poll
+  if (dirtyMask != 0) {
+    firstDirtyMs = lastDirtyMs = millis();
+  }
+}
+
+void handleConfigStore() {
+  if (dirtyMask == 0) return;
+  unsigned long now = millis();
+  if (now - lastDirtyMs >= CONFIG_FLUSH_DEBOUNCE_MS ||
+      now - firstDirtyMs >= CONFIG_FLUSH_MAX_DELAY_MS) {
+    configStoreFlush();
+  }
+}
+
+bool configStoreDirty() {
+  return dirtyMask != 0;
+}
+
+const char* configSectionName(ConfigSection section) {
+  return section < CFG_SECTION_COUNT ? SECTION_NAMESPACES[section] : "unknown";
+}
+
+const ConfigStoreStats& getConfigStoreStats() {
+  return stats;
+}
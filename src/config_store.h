@@ -0,0 +1,118 @@
+#ifndef CONFIG_STORE_H
+#define CONFIG_STORE_H
+
+#include <Arduino.h>
+
+// RAM-cached persistent configuration and state.
+// Everything the firmware keeps in NVS is loaded once at boot into
+// deviceConfig. Modules read the struct directly. To change it, modules edit
+// the struct and call configStoreMarkDirty(). A debounced write-behind task
+// then flushes each dirty section with one NVS session. Sections keep the
+// legacy namespaces and keys, so values stored by older firmware load
+// unchanged.
+
+enum ConfigSection : uint8_t {
+  CFG_FIRMWARE = 0,   // "firmware": version tracking
+  CFG_OTA_ROLLBACK,   // "ota_rollback": boot failure counter, rollback markers
+  CFG_SYSTEM,         // "system": last reboot reason
+  CFG_DNS,            // "dns_cfg": DNS alert timing
+  CFG_NET_METRICS,    // "net_metrics": latency probe settings
+  CFG_SECTION_COUNT
+};
+
+// Flush once changes have been quiet for the debounce window, and never hold
+// a change in RAM longer than the max delay.
+#define CONFIG_FLUSH_DEBOUNCE_MS 2000
+#define CONFIG_FLUSH_MAX_DELAY_MS 10000
+#define CONFIG_FLUSH_POLL_MS 500
+
+#define CONFIG_VERSION_LEN 24
+#define CONFIG_REASON_LEN 64
+#define CONFIG_URL_LEN 128
+#define CONFIG_PROBE_NAME_LEN 16
+#define CONFIG_PROBE_TARGETS 3   // extra probe targets besides the primary one
+
+struct FirmwareState {
+  char lastVersion[CONFIG_VERSION_LEN];
+  unsigned long updateTime;          // boot-relative ms of the last detected update
+  char updateFrom[CONFIG_VERSION_LEN];
+};
+
+struct OtaRollbackState {
+  int bootFailCount;
+  char lastRollbackFrom[CONFIG_VERSION_LEN];  // "" = no pending rollback report
+  unsigned long rollbackTime;
+};
+
+struct SystemState {
+  char lastReboot[CONFIG_REASON_LEN];    // reason recorded by rebootDevice()
+  unsigned long rebootTime;
+};
+
+struct DnsConfig {
+  bool stored;  // false = namespace absent, defaults in use
+  unsigned long failureThresholdMs;
+  unsigned long alertIntervalMs;
+  unsigned long recoveryThresholdMs;
+  unsigned long minFailureForRecoveryMs;
+};
+
+// An extra probe target; kept packed at the front of the table, and
+// url "" ends it
+struct NetProbeTargetConfig {
+  char name[CONFIG_PROBE_NAME_LEN];
+  char url[CONFIG_URL_LEN];
+  unsigned long intervalMs;
+  uint8_t samples;
+  unsigned long timeoutMs;
+};
+
+struct NetMetricsConfig {
+  bool stored;
+  char probeTarget[CONFIG_URL_LEN];  // "" = not stored
+  unsigned long intervalMs;          // 0 = not stored
+  uint8_t samples;
+  unsigned long timeoutMs;
+  uint8_t keepAlive;                 // 1 = persistent-connection probe mode
+  uint16_t spacingMs;                // 0 = not stored
+  NetProbeTargetConfig targets[CONFIG_PROBE_TARGETS];
+};
+
+struct DeviceConfig {
+  FirmwareState firmware;
+  OtaRollbackState rollback;
+  SystemState system;
+  DnsConfig dns;
+  NetMetricsConfig net;
+};
+
+struct ConfigStoreStats {
+  unsigned long loads;          // NVS namespaces read (boot only)
+  unsigned long flushes;        // write-behind flushes that wrote something
+  unsigned long sectionWrites;  // NVS sessions opened for writing
+  unsigned long coalesced;      // markDirty calls absorbed into an already-pending flush
+  unsigned long failures;       // sections that could not be opened for writing
+  unsigned long lastFlushMs;
+};
+
+extern DeviceConfig deviceConfig;
+
+// Load every section from NVS. Call once, early in setup(). Returns false
+// when NVS could not be initialized, in which case defaults are in use.
+bool configStoreBegin();
+
+// Record that a section changed in RAM; it will be written behind
+void configStoreMarkDirty(ConfigSection section);
+
+// Write all dirty sections now (before reboot/rollback, or for state that must
+// survive a crash such as the boot failure counter)
+void configStoreFlush();
+
+// Scheduled task: flush once the debounce window has elapsed
+void handleConfigStore();
+
+bool configStoreDirty();
+const char* configSectionName(ConfigSection section);  // NVS namespace
+const ConfigStoreStats& getConfigStoreStats();
+
+#endif
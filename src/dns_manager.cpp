@@ -1,9 +1,10 @@
 #include "dns_manager.h"
 #include "config.h"
 #include "notifications.h"
+#include "config_store.h"
+#include "event_bus.h"
 #include <WiFi.h>
 #include <HTTPClient.h>
-#include <Preferences.h>
 
 // Global variables for DNS failure tracking
 bool dnsFailureReported = false;           // Prevent spam notifications
@@ -31,6 +32,27 @@ const unsigned long DNS_DEFAULT_RECOVERY_THRESHOLD_MS = 5UL * 60UL * 1000UL;
 const unsigned long DNS_DEFAULT_MIN_FAILURE_FOR_RECOVERY_MS = 60UL * 1000UL;
 
 static bool dnsConfigLoaded = false;
+static bool dnsUsingFallback = false;
+static DNSOutageStats outageStats = {0, 0, 0, 0};
+static unsigned long outageStartMs = 0;
+
+// Update the overall DNS state; subscribers only hear about transitions
+static void setDNSWorking(bool working, bool usingFallback) {
+  bool changed = (working != isDNSWorking) || (usingFallback != dnsUsingFallback);
+  if (!working && isDNSWorking) {
+    outageStartMs = millis();
+  } else if (working && !isDNSWorking) {
+    unsigned long duration = millis() - outageStartMs;
+    outageStats.outages++;
+    outageStats.lastOutageMs = duration;
+    outageStats.totalOutageMs += duration;
+  }
+  isDNSWorking = working;
+  dnsUsingFallback = usingFallback;
+  if (changed) {
+    eventPublishDnsState(working, usingFallback);
+  }
+}
 
 // Minimum failure duration rationale:
 // Very short DNS hiccups (<60s) are treated as micro blips and will NOT trigger the
@@ -62,7 +84,7 @@ bool testDNSServerConnectivity(const char* testUrl) {
 // Handle successful DNS resolution - send recovery notification if needed
 void handleSuccessfulDNSResolution() {
   Serial.printf("[%10lu ms] [DNS] DNS resolution working (Primary: %s)\r\n", millis(), primaryDNS.toString().c_str());
-  isDNSWorking = true;
+  setDNSWorking(true, false);
   lastDNSCheck = millis();
   dnsFailureStartTime = 0;
   
@@ -236,7 +258,7 @@ void sendDNSDownAlert(unsigned long downTimeMs) {
 void handlePrimaryDNSFailureWithFallback() {
   Serial.printf("[%10lu ms] [DNS] Fallback DNS working\r\n", millis());
   // Primary failed but overall DNS is assumed working via fallback
-  isDNSWorking = true;
+  setDNSWorking(true, true);
   lastDNSCheck = millis();
   
   unsigned long currentTime = millis();
@@ -263,7 +285,7 @@ void handlePrimaryDNSFailureWithFallback() {
 void handleCompleteDNSFailure() {
   Serial.printf("[%10lu ms] [DNS] Both primary and fallback DNS failed!\r\n", millis());
   // Mark overall DNS as down
-  isDNSWorking = false;
+  setDNSWorking(false, false);
   lastDNSCheck = millis();
   if (dnsFailureStartTime == 0) {
     dnsFailureStartTime = lastDNSCheck;
@@ -358,18 +380,9 @@ void updateDNSConfig(unsigned long failureThresholdMs,
   if (changed) {
     Serial.printf("[DNS] Updated config: failureThreshold=%lu ms, alertInterval=%lu ms, recoveryThreshold=%lu ms, minFailureForRecovery=%lu ms\r\n",
                   dnsFailureThresholdMs, dnsAlertIntervalMs, dnsRecoveryThresholdMs, dnsMinFailureDurationForRecoveryMs);
-    // Persist
-    Preferences prefs;
-    if (prefs.begin("dns_cfg", false)) {
-      prefs.putULong("fail_thr", dnsFailureThresholdMs);
-      prefs.putULong("alert_int", dnsAlertIntervalMs);
-      prefs.putULong("rec_thr", dnsRecoveryThresholdMs);
-      prefs.putULong("min_rec", dnsMinFailureDurationForRecoveryMs);
-      prefs.end();
-      Serial.println("[DNS] Config saved to NVS");
-    } else {
-      Serial.println("[DNS] Failed to open NVS for saving config");
-    }
+    // Persist (written behind by the config store)
+    saveDNSConfigToStorage();
+    eventPublishConfigChanged(CFG_DNS);
   } else {
     Serial.println("[DNS] updateDNSConfig called but no values changed");
   }
@@ -377,17 +390,16 @@ void updateDNSConfig(unsigned long failureThresholdMs,
 
 void loadDNSConfigFromStorage() {
   if (dnsConfigLoaded) return;
-  Preferences prefs;
-  if (!prefs.begin("dns_cfg", true)) {
-    Serial.println("[DNS] No stored DNS config (RO open failed), using defaults");
+  const DnsConfig& stored = deviceConfig.dns;
+  if (!stored.stored) {
+    Serial.println("[DNS] No stored DNS config, using defaults");
     dnsConfigLoaded = true;
     return;
   }
-  unsigned long f = prefs.getULong("fail_thr", DNS_DEFAULT_FAILURE_THRESHOLD_MS);
-  unsigned long i = prefs.getULong("alert_int", DNS_DEFAULT_ALERT_INTERVAL_MS);
-  unsigned long r = prefs.getULong("rec_thr", DNS_DEFAULT_RECOVERY_THRESHOLD_MS);
-  unsigned long m = prefs.getULong("min_rec", DNS_DEFAULT_MIN_FAILURE_FOR_RECOVERY_MS);
-  prefs.end();
+  unsigned long f = stored.failureThresholdMs;
+  unsigned long i = stored.alertIntervalMs;
+  unsigned long r = stored.recoveryThresholdMs;
+  unsigned long m = stored.minFailureForRecoveryMs;
   if (f == 0 || i == 0 || r == 0 || m == 0) {
     Serial.println("[DNS] Stored DNS config invalid (zero), reverting to defaults");
     f = DNS_DEFAULT_FAILURE_THRESHOLD_MS;
@@ -405,16 +417,20 @@ void loadDNSConfigFromStorage() {
 }
 
 void saveDNSConfigToStorage() {
-  // Provided for explicit save if needed elsewhere (currently updateDNSConfig persists automatically)
-  Preferences prefs; 
-  if (!prefs.begin("dns_cfg", false)) {
-    Serial.println("[DNS] Failed to open NVS for explicit save");
-    return;
-  }
-  prefs.putULong("fail_thr", dnsFailureThresholdMs);
-  prefs.putULong("alert_int", dnsAlertIntervalMs);
-  prefs.putULong("rec_thr", dnsRecoveryThresholdMs);
-  prefs.putULong("min_rec", dnsMinFailureDurationForRecoveryMs);
-  prefs.end();
-  Serial.println("[DNS] Explicit config save complete");
+  DnsConfig& stored = deviceConfig.dns;
+  stored.failureThresholdMs = dnsFailureThresholdMs;
+  stored.alertIntervalMs = dnsAlertIntervalMs;
+  stored.recoveryThresholdMs = dnsRecoveryThresholdMs;
+  stored.minFailureForRecoveryMs = dnsMinFailureDurationForRecoveryMs;
+  configStoreMarkDirty(CFG_DNS);
+  Serial.println("[DNS] Config queued for NVS write-behind");
+}
+
+const DNSOutageStats& getDNSOutageStats() {
+  outageStats.currentOutageMs = isDNSWorking ? 0 : millis() - outageStartMs;
+  return outageStats;
+}
+
+bool isDNSUsingFallback() {
+  return dnsUsingFallback;
 }
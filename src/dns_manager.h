@@ -47,6 +47,9 @@ void resumeAlerts();
 bool areAlertsPaused();
 unsigned long getAlertsPausedTimeRemaining();
 
+// Longest timed pause accepted from the web interface (one week)
+#define ALERT_PAUSE_MAX_MINUTES (7L * 24L * 60L)
+
 
 // Global DNS status variables (for MQTT and web integration)
 extern bool isDNSWorking;
@@ -55,4 +58,15 @@ extern unsigned long dnsFailureStartTime;
 extern bool alertsPaused;
 extern unsigned long alertsPausedUntil;
 
+// Complete-outage history (both primary and fallback down)
+struct DNSOutageStats {
+  unsigned long outages;         // outages that have ended
+  unsigned long lastOutageMs;    // duration of the most recent ended outage
+  unsigned long totalOutageMs;   // sum over ended outages
+  unsigned long currentOutageMs; // ongoing outage, 0 when DNS is up
+};
+
+const DNSOutageStats& getDNSOutageStats();
+bool isDNSUsingFallback();
+
 #endif
@@ -0,0 +1,125 @@
+#include "event_bus.h"
+#include <string.h>
+
+struct Subscriber {
+  uint32_t mask;
+  EventHandler handler;
+};
+
+static Event queue[EVENT_QUEUE_SIZE];
+static uint8_t queueHead = 0;   // next event to deliver
+static uint8_t queueCount = 0;
+
+static Subscriber subscribers[EVENT_MAX_SUBSCRIBERS];
+static uint8_t subscriberCount = 0;
+
+static EventBusStats stats = {0, 0, 0, 0};
+
+static const char* const TYPE_NAMES[EVT_TYPE_COUNT] = {
+  "reboot_requested", "dns_state_changed", "config_changed", "heartbeat_result", "wifi_role_changed",
+  "network_probe_result"
+};
+
+bool eventSubscribe(uint32_t mask, EventHandler handler) {
+  if (handler == nullptr || subscriberCount >= EVENT_MAX_SUBSCRIBERS) {
+    Serial.printf("[%10lu ms] [EVENT] Subscriber table full, handler not registered\r\n", millis());
+    return false;
+  }
+  subscribers[subscriberCount].mask = mask;
+  subscribers[subscriberCount].handler = handler;
+  subscriberCount++;
+  return true;
+}
+
+bool eventPublish(Event& event) {
+  if (event.type >= EVT_TYPE_COUNT) return false;
+  if (queueCount >= EVENT_QUEUE_SIZE) {
+    stats.dropped++;
+    return false;
+  }
+  event.timestampMs = millis();
+  queue[(queueHead + queueCount) % EVENT_QUEUE_SIZE] = event;
+  queueCount++;
+  stats.published++;
+  if (queueCount > stats.highWater) stats.highWater = queueCount;
+  return true;
+}
+
+bool eventPublishReboot(const char* reason) {
+  Event e;
+  e.type = EVT_REBOOT_REQUESTED;
+  strncpy(e.reboot.reason, reason ? reason : "", sizeof(e.reboot.reason) - 1);
+  e.reboot.reason[sizeof(e.reboot.reason) - 1] = '\0';
+  return eventPublish(e);
+}
+
+bool eventPublishDnsState(bool working, bool usingFallback) {
+  Event e;
+  e.type = EVT_DNS_STATE_CHANGED;
+  e.dns.working = working;
+  e.dns.usingFallback = usingFallback;
+  return eventPublish(e);
+}
+
+bool eventPublishConfigChanged(uint8_t section) {
+  Event e;
+  e.type = EVT_CONFIG_CHANGED;
+  e.config.section = section;
+  return eventPublish(e);
+}
+
+bool eventPublishHeartbeat(int code, bool changed, unsigned long totalMs) {
+  Event e;
+  e.type = EVT_HEARTBEAT_RESULT;
+  e.heartbeat.code = code;
+  e.heartbeat.ok = (code == 200);
+  e.heartbeat.changed = changed;
+  e.heartbeat.totalMs = totalMs;
+  return eventPublish(e);
+}
+
+bool eventPublishWiFiRole(int index, int previous) {
+  Event e;
+  e.type = EVT_WIFI_ROLE_CHANGED;
+  e.wifi.index = (int8_t)index;
+  e.wifi.previous = (int8_t)previous;
+  return eventPublish(e);
+}
+
+bool eventPublishNetworkProbe(bool ok, uint8_t successes, uint8_t attempts, uint8_t target) {
+  Event e;
+  e.type = EVT_NETWORK_PROBE_RESULT;
+  e.probe.ok = ok;
+  e.probe.successes = successes;
+  e.probe.attempts = attempts;
+  e.probe.target = target;
+  return eventPublish(e);
+}
+
+void eventBusDispatch() {
+  // Bound the pass to what was queued on entry so a handler that publishes
+  // cannot keep this loop pass busy
+  uint8_t pending = queueCount;
+  while (pending-- > 0 && queueCount > 0) {
+    // Copy out first: a handler may publish and reuse the slot
+    Event e = queue[queueHead];
+    queueHead = (queueHead + 1) % EVENT_QUEUE_SIZE;
+    queueCount--;
+
+    uint32_t bit = EVENT_MASK(e.type);
+    for (uint8_t i = 0; i < subscriberCount; i++) {
+      if (subscribers[i].mask & bit) {
+        subscribers[i].handler(e);
+        stats.delivered++;
+      }
+    }
+  }
+}
+
+const char* eventTypeName(EventType type) {
+  return type < EVT_TYPE_COUNT ? TYPE_NAMES[type] : "unknown";
+}
+
+const EventBusStats& getEventBusStats() {
+  return stats;
+}
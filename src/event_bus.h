@@ -0,0 +1,94 @@
+#ifndef EVENT_BUS_H
+#define EVENT_BUS_H
+
+#include <Arduino.h>
+
+// In-process publish/subscribe for state changes between modules.
+// Events are small fixed-size structs copied into a ring queue; publishing
+// never allocates and never calls subscribers directly. loop() drains the
+// queue once per pass, so a publisher (MQTT callback, web handler, heartbeat
+// completion) never re-enters another module. Loop context only.
+
+enum EventType : uint8_t {
+  EVT_REBOOT_REQUESTED = 0,  // remote reboot (web, MQTT); handled by main
+  EVT_DNS_STATE_CHANGED,     // overall DNS health flipped
+  EVT_CONFIG_CHANGED,        // a runtime config section was updated
+  EVT_HEARTBEAT_RESULT,      // a heartbeat completed (every cycle)
+  EVT_WIFI_ROLE_CHANGED,     // active network switched primary/secondary/none
+  EVT_NETWORK_PROBE_RESULT,  // a latency probe finished (every run)
+  EVT_TYPE_COUNT
+};
+
+#define EVENT_MASK(type) (1UL << (type))
+#define EVENT_MASK_ALL ((1UL << EVT_TYPE_COUNT) - 1)
+
+#define EVENT_QUEUE_SIZE 16
+#define EVENT_MAX_SUBSCRIBERS 12
+#define EVENT_REASON_LEN 48
+
+struct Event {
+  EventType type;
+  unsigned long timestampMs;
+  union {
+    struct {
+      char reason[EVENT_REASON_LEN];
+    } reboot;
+    struct {
+      bool working;
+      bool usingFallback;  // primary failed, fallback DNS assumed working
+    } dns;
+    struct {
+      uint8_t section;     // ConfigSection
+    } config;
+    struct {
+      int code;            // HTTP status or negative AsyncHttp error
+      bool ok;             // code == 200
+      bool changed;        // ok differs from the previous result
+      unsigned long totalMs;
+    } heartbeat;
+    struct {
+      int8_t index;        // WIFI_NET_* of the new active network
+      int8_t previous;
+    } wifi;
+    struct {
+      bool ok;             // at least one sample succeeded
+      uint8_t successes;
+      uint8_t attempts;
+      uint8_t target;      // probe target slot; 0 is the primary target
+    } probe;
+  };
+};
+
+typedef void (*EventHandler)(const Event& event);
+
+struct EventBusStats {
+  unsigned long published;
+  unsigned long delivered;     // handler invocations
+  unsigned long dropped;       // publishes rejected because the queue was full
+  uint8_t highWater;           // deepest queue depth seen
+};
+
+// Register handler for every type in mask. Returns false when the
+// subscriber table is full. Call from setup()/init functions.
+bool eventSubscribe(uint32_t mask, EventHandler handler);
+
+// Queue an event; timestampMs is filled in. Returns false (and counts a drop)
+// when the queue is full.
+bool eventPublish(Event& event);
+
+// Convenience publishers for the typed events
+bool eventPublishReboot(const char* reason);
+bool eventPublishDnsState(bool working, bool usingFallback);
+bool eventPublishConfigChanged(uint8_t section);
+bool eventPublishHeartbeat(int code, bool changed, unsigned long totalMs);
+bool eventPublishWiFiRole(int index, int previous);
+bool eventPublishNetworkProbe(bool ok, uint8_t successes, uint8_t attempts, uint8_t target);
+
+// Deliver queued events. Events published by handlers during this call are
+// delivered on the next pass.
+void eventBusDispatch();
+
+const char* eventTypeName(EventType type);
+const EventBusStats& getEventBusStats();
+
+#endif
@@ -0,0 +1,102 @@
+#include "heartbeat.h"
+#include "config.h"
+#include "telnet.h"
+#include "dns_manager.h"
+#include "wifi_manager.h"
+#include "event_bus.h"
+#include "log.h"
+
+// Global variables for tracking heartbeat status
+unsigned long lastSuccessfulHeartbeat = 0;
+int lastHeartbeatResponseCode = 0;
+
+static AsyncHttpRequest heartbeatReq = {};
+static AsyncHttpTimings lastTimings = {};
+static AsyncHttpPhase lastFailedPhase = AHTTP_IDLE;
+static HeartbeatStats stats = {0, 0, 0, 0};
+
+static void completeHeartbeat() {
+  const AsyncHttpRequest& req = heartbeatReq;
+  int httpCode = req.statusCode;
+  bool changed = (httpCode == 200) != (lastHeartbeatResponseCode == 200);
+  lastHeartbeatResponseCode = httpCode;
+  lastTimings = req.timings;
+  lastFailedPhase = (req.phase == AHTTP_FAILED) ? req.failedPhase : AHTTP_IDLE;
+  stats.attempts++;
+  if (httpCode == 200) {
+    stats.successes++;
+  } else {
+    stats.failures++;
+  }
+
+  if (httpCode > 0) {
+    LOG_D(LOG_MOD_HEARTBEAT, "Ping Response (%d): %s", httpCode, req.bodyPreview);
+
+    // Track successful heartbeat (200 OK)
+    if (httpCode == 200) {
+      lastSuccessfulHeartbeat = millis();
+    }
+  } else {
+    LOG_W(LOG_MOD_HEARTBEAT, "Ping failed during %s after %lu ms: %s",
+          asyncHttpPhaseName(req.failedPhase), req.timings.totalMs, asyncHttpErrorString(httpCode));
+
+    // If heartbeat fails, test DNS resolution
+    if (httpCode == AHTTP_ERR_CONNECTION_REFUSED) {
+      LOG_D(LOG_MOD_HEARTBEAT, "Heartbeat failed, testing DNS...");
+      testDNSResolution();
+    }
+  }
+
+  eventPublishHeartbeat(httpCode, changed, req.timings.totalMs);
+  asyncHttpAbort(heartbeatReq);
+}
+
+void startHeartbeat() {
+  if (!isWiFiConnected()) {
+    return;
+  }
+  if (asyncHttpBusy(heartbeatReq)) {
+    stats.skipped++;
+    return;
+  }
+  if (!asyncHttpBegin(heartbeatReq, apiEndpoint, HEARTBEAT_TIMEOUT_MS)) {
+    completeHeartbeat();
+  }
+}
+
+void handleHeartbeat() {
+  if (!asyncHttpBusy(heartbeatReq)) {
+    return;
+  }
+  AsyncHttpPhase phase = asyncHttpStep(heartbeatReq);
+  if (phase == AHTTP_DONE || phase == AHTTP_FAILED) {
+    completeHeartbeat();
+  }
+}
+
+bool isHeartbeatInFlight() {
+  return asyncHttpBusy(heartbeatReq);
+}
+
+const AsyncHttpTimings& getHeartbeatTimings() {
+  return lastTimings;
+}
+
+const char* getHeartbeatFailedPhase() {
+  return lastFailedPhase == AHTTP_IDLE ? "none" : asyncHttpPhaseName(lastFailedPhase);
+}
+
+void addHeartbeatPhaseJSON(JsonObject out) {
+  out["resolve"] = lastTimings.resolveMs;
+  out["connect"] = lastTimings.connectMs;
+  out["send"] = lastTimings.sendMs;
+  out["await_headers"] = lastTimings.awaitHeadersMs;
+  out["drain"] = lastTimings.drainMs;
+  out["total"] = lastTimings.totalMs;
+  out["failed_phase"] = getHeartbeatFailedPhase();
+  out["skipped_cycles"] = stats.skipped;
+}
+
+const HeartbeatStats& getHeartbeatStats() {
+  return stats;
+}
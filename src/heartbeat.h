@@ -0,0 +1,41 @@
+#ifndef HEARTBEAT_H
+#define HEARTBEAT_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include "async_http.h"
+
+// Total budget for one heartbeat across all phases
+#define HEARTBEAT_TIMEOUT_MS 10000UL
+
+// Heartbeat status (read by web / MQTT status)
+extern unsigned long lastSuccessfulHeartbeat;  // millis() of last HTTP 200, 0 = never
+extern int lastHeartbeatResponseCode;          // HTTP status or AHTTP_ERR_* of last attempt
+
+// Start a heartbeat cycle (scheduled). Skipped if the previous one is still in flight.
+void startHeartbeat();
+
+// Advance the in-flight heartbeat by one non-blocking step (call every loop pass)
+void handleHeartbeat();
+
+bool isHeartbeatInFlight();
+
+// Per-phase timing of the last completed attempt (successful or not)
+const AsyncHttpTimings& getHeartbeatTimings();
+
+// Phase name where the last attempt failed, or "none" if it succeeded
+const char* getHeartbeatFailedPhase();
+
+struct HeartbeatStats {
+  unsigned long attempts;   // completed cycles
+  unsigned long successes;  // HTTP 200
+  unsigned long failures;   // any other status or transport error
+  unsigned long skipped;    // cycles skipped while the previous one was in flight
+};
+
+const HeartbeatStats& getHeartbeatStats();
+
+// Append {resolve, connect, send, await_headers, drain, total, failed_phase}
+void addHeartbeatPhaseJSON(JsonObject out);
+
+#endif
@@ -0,0 +1,685 @@
+#include "history.h"
+#include "dns_manager.h"
+#include "heartbeat.h"
+#include "network_metrics.h"
+
+#ifdef ENABLE_MQTT
+#include "mqtt_manager.h"
+#endif
+
+#include <WiFi.h>
+
+static const uint8_t HISTORY_FREE_BLOCK = 0xFF;
+static const int32_t NOMINAL_INTERVAL_S = (int32_t)(HISTORY_SAMPLE_INTERVAL_MS / 1000UL);
+static const uint16_t BLOCK_BITS = HISTORY_BLOCK_BYTES * 8;
+
+struct HistoryBlock {
+  uint32_t startSec;   // first sample, stored raw
+  int32_t firstValue;
+  uint16_t count;      // samples, including the first and any trailing repeats
+  uint16_t bits;       // encoded length of the samples after the first
+  uint8_t metric;      // HISTORY_FREE_BLOCK when unused
+  uint8_t data[HISTORY_BLOCK_BYTES];
+};
+
+// Encoder state of a metric's open block
+struct HistorySeries {
+  int8_t block;        // -1 before the first sample
+  uint32_t lastSec;
+  int32_t lastDelta;   // seconds between the last two samples
+  int32_t lastValue;
+  uint16_t run;        // repeats counted in the block but not encoded yet
+};
+
+static const HistoryMetricInfo METRICS[HIST_METRIC_COUNT] = {
+  {"rssi",           "dBm",   1.0f},
+  {"free_heap",      "bytes", 64.0f},  // 64-byte steps: allocator noise below that is not kept
+  {"latency",        "ms",    0.1f},
+  {"jitter",         "ms",    0.1f},
+  {"probe_loss",     "%",     1.0f},
+  {"heartbeat_code", "",      1.0f},   // HTTP status; negative for transport errors
+  {"dns_up",         "",      1.0f},
+  {"mqtt_up",        "",      1.0f},
+};
+
+static HistoryBlock blocks[HISTORY_BLOCK_COUNT];
+static HistorySeries series[HIST_METRIC_COUNT];
+static bool initialized = false;
+
+// Rollup tiers
+
+static const uint8_t ROLLUP_TIER_COUNT = HIST_SOURCE_COUNT - 1;
+
+// Closed bucket; values clamped to int16 (every metric's fixed-point range fits)
+struct RollupBucket {
+  int16_t min;
+  int16_t max;
+  int16_t mean;
+  int16_t last;
+  uint16_t count;
+};
+
+// Bucket being filled, kept exact until it closes
+struct RollupOpen {
+  uint32_t start;
+  int32_t min;
+  int32_t max;
+  int32_t last;
+  int32_t sum;
+  uint16_t count;
+  bool active;
+};
+
+// Per metric and tier. Closed buckets are contiguous in time, so a slot's
+// start follows from its distance to the newest one.
+struct RollupRing {
+  uint16_t head;  // next slot to write
+  uint16_t size;  // closed buckets held
+  uint32_t newestStart;
+  RollupOpen open;
+};
+
+struct RollupTier {
+  const char* name;
+  uint32_t width;  // seconds
+  uint16_t capacity;
+  RollupBucket* buckets;  // [metric][capacity]
+};
+
+static RollupBucket quarterBuckets[HIST_METRIC_COUNT][96];
+static RollupBucket hourBuckets[HIST_METRIC_COUNT][168];
+static RollupRing rings[HIST_METRIC_COUNT][ROLLUP_TIER_COUNT];
+
+static const RollupTier TIERS[ROLLUP_TIER_COUNT] = {
+  {"15m", 900,  96,  &quarterBuckets[0][0]},
+  {"1h",  3600, 168, &hourBuckets[0][0]},
+};
+
+static HistoryStats stats = {0, 0, 0, sizeof(blocks) + sizeof(series),
+                             sizeof(quarterBuckets) + sizeof(hourBuckets) + sizeof(rings)};
+
+static void initStore() {
+  for (uint8_t i = 0; i < HISTORY_BLOCK_COUNT; i++) blocks[i].metric = HISTORY_FREE_BLOCK;
+  for (uint8_t m = 0; m < HIST_METRIC_COUNT; m++) series[m].block = -1;
+  initialized = true;
+}
+
+// Bit I/O, most significant bit first
+
+static void putBits(HistoryBlock& b, uint32_t value, uint8_t n) {
+  for (int8_t i = n - 1; i >= 0; i--) {
+    if ((value >> i) & 1U) b.data[b.bits >> 3] |= (uint8_t)(0x80 >> (b.bits & 7));
+    b.bits++;
+  }
+}
+
+struct BitReader {
+  const uint8_t* data;
+  uint16_t pos;
+};
+
+static uint32_t getBits(BitReader& r, uint8_t n) {
+  uint32_t value = 0;
+  for (uint8_t i = 0; i < n; i++) {
+    value = (value << 1) | ((r.data[r.pos >> 3] >> (7 - (r.pos & 7))) & 1U);
+    r.pos++;
+  }
+  return value;
+}
+
+static uint32_t zigzag(int32_t v) { return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31); }
+static int32_t unzigzag(uint32_t v) { return (int32_t)(v >> 1) ^ -(int32_t)(v & 1U); }
+
+// '0' | '10'+4 bits | '110'+8 | '1110'+16 | '1111'+32
+static uint8_t varBits(uint32_t z) {
+  if (z == 0) return 1;
+  if (z < (1UL << 4)) return 2 + 4;
+  if (z < (1UL << 8)) return 3 + 8;
+  if (z < (1UL << 16)) return 4 + 16;
+  return 4 + 32;
+}
+
+static void putUVar(HistoryBlock& b, uint32_t z) {
+  if (z == 0) {
+    putBits(b, 0x0, 1);
+  } else if (z < (1UL << 4)) {
+    putBits(b, 0x2, 2);
+    putBits(b, z, 4);
+  } else if (z < (1UL << 8)) {
+    putBits(b, 0x6, 3);
+    putBits(b, z, 8);
+  } else if (z < (1UL << 16)) {
+    putBits(b, 0xE, 4);
+    putBits(b, z, 16);
+  } else {
+    putBits(b, 0xF, 4);
+    putBits(b, z, 32);
+  }
+}
+
+static uint32_t getUVar(BitReader& r) {
+  static const uint8_t WIDTHS[] = {4, 8, 16, 32};
+  uint8_t ones = 0;
+  while (ones < 4 && getBits(r, 1) == 1) ones++;
+  if (ones == 0) return 0;
+  return getBits(r, WIDTHS[ones - 1]);
+}
+
+// A sample after the first is one of:
+//   value delta != 0: var(value delta) var(dod)
+//   value unchanged, off schedule: '0' '1' var(dod)
+//   run of n samples on schedule and unchanged: '0' '0' uvar(n - 1)
+// A run is only written once the next sample differs. Samples counted in
+// the block past the end of its bits are repeats.
+static uint16_t runBits(uint16_t run) {
+  return run > 0 ? 2 + varBits(run - 1U) : 0;
+}
+
+static void putRun(HistoryBlock& b, uint16_t run) {
+  if (run == 0) return;
+  putBits(b, 0x0, 2);
+  putUVar(b, run - 1U);
+}
+
+// A free block, or else a metric's oldest block: the one whose successor
+// started first, so the pool gives up the data that went stale earliest. A
+// block's end is not stored; with run-length coding a steady metric's block
+// can span a day, so its start says little about how old its data is.
+static uint8_t allocBlock() {
+  int16_t first[HIST_METRIC_COUNT];   // oldest block per metric
+  int16_t second[HIST_METRIC_COUNT];  // the one after it
+  for (uint8_t m = 0; m < HIST_METRIC_COUNT; m++) first[m] = second[m] = -1;
+
+  for (uint8_t i = 0; i < HISTORY_BLOCK_COUNT; i++) {
+    uint8_t m = blocks[i].metric;
+    if (m == HISTORY_FREE_BLOCK) {
+      stats.blocksInUse++;
+      return i;
+    }
+    uint32_t start = blocks[i].startSec;
+    if (first[m] < 0 || (int32_t)(start - blocks[first[m]].startSec) < 0) {
+      second[m] = first[m];
+      first[m] = i;
+    } else if (second[m] < 0 || (int32_t)(start - blocks[second[m]].startSec) < 0) {
+      second[m] = i;
+    }
+  }
+
+  // A metric with a second block is not writing its first
+  int8_t victim = -1;
+  for (uint8_t m = 0; m < HIST_METRIC_COUNT; m++) {
+    if (second[m] < 0) continue;
+    if (victim < 0 || (int32_t)(blocks[second[m]].startSec - blocks[second[victim]].startSec) < 0) {
+      victim = (int8_t)m;
+    }
+  }
+  stats.evictions++;
+  return (uint8_t)first[victim];
+}
+
+static void appendRaw(uint8_t metric, uint32_t sec, int32_t value) {
+  HistorySeries& s = series[metric];
+
+  if (s.block >= 0) {
+    HistoryBlock& b = blocks[s.block];
+    int32_t delta = (int32_t)(sec - s.lastSec);
+    uint32_t dod = zigzag(delta - s.lastDelta);
+    // Modular difference: wraps consistently for HISTORY_UNKNOWN and back
+    uint32_t change = zigzag((int32_t)((uint32_t)value - (uint32_t)s.lastValue));
+    if (b.count < UINT16_MAX && dod == 0 && change == 0) {
+      b.count++;
+      s.run++;
+      s.lastSec = sec;
+      return;
+    }
+    uint16_t need = runBits(s.run) + (change != 0 ? varBits(change) : 2) + varBits(dod);
+    if (b.count < UINT16_MAX && b.bits + need <= BLOCK_BITS) {
+      putRun(b, s.run);
+      if (change != 0) {
+        putUVar(b, change);
+      } else {
+        putBits(b, 0x1, 2);
+      }
+      putUVar(b, dod);
+      b.count++;
+      s.run = 0;
+      s.lastDelta = delta;
+      s.lastSec = sec;
+      s.lastValue = value;
+      return;
+    }
+  }
+
+  uint8_t id = allocBlock();
+  HistoryBlock& b = blocks[id];
+  b.metric = metric;
+  b.startSec = sec;
+  b.firstValue = value;
+  b.count = 1;
+  b.bits = 0;
+  memset(b.data, 0, sizeof(b.data));
+  s.block = (int8_t)id;
+  s.lastSec = sec;
+  s.lastDelta = NOMINAL_INTERVAL_S;
+  s.lastValue = value;
+  s.run = 0;
+}
+
+static int16_t clamp16(int32_t v) {
+  return v > INT16_MAX ? INT16_MAX : (v < -INT16_MAX ? -INT16_MAX : (int16_t)v);
+}
+
+static RollupBucket& rollupSlot(uint8_t metric, uint8_t tier, uint16_t index) {
+  const RollupTier& t = TIERS[tier];
+  return t.buckets[metric * t.capacity + index];
+}
+
+static void rollupPush(uint8_t metric, uint8_t tier, uint32_t start, const RollupOpen* agg) {
+  const RollupTier& t = TIERS[tier];
+  RollupRing& r = rings[metric][tier];
+  RollupBucket& b = rollupSlot(metric, tier, r.head);
+  b.count = agg != nullptr ? agg->count : 0;
+  if (b.count > 0) {
+    b.min = clamp16(agg->min);
+    b.max = clamp16(agg->max);
+    b.mean = clamp16((int32_t)lroundf((float)agg->sum / agg->count));
+    b.last = clamp16(agg->last);
+  }
+  r.head = (uint16_t)((r.head + 1) % t.capacity);
+  if (r.size < t.capacity) r.size++;
+  r.newestStart = start;
+}
+
+// Close the open bucket: store it, and leave empty buckets for any
+// intervals without samples before nextStart
+static void rollupClose(uint8_t metric, uint8_t tier, uint32_t nextStart) {
+  const RollupTier& t = TIERS[tier];
+  RollupRing& r = rings[metric][tier];
+  RollupOpen closed = r.open;
+  r.open.active = false;
+  rollupPush(metric, tier, closed.start, &closed);
+  uint16_t gaps = 0;
+  for (uint32_t s = closed.start + t.width; (int32_t)(nextStart - s) > 0 && gaps < t.capacity;
+       s += t.width, gaps++) {
+    rollupPush(metric, tier, s, nullptr);
+  }
+}
+
+// Add a sample to a tier's open bucket. Every tier takes each sample
+// directly, so all of them are current up to the last sample.
+static void rollupFold(uint8_t metric, uint8_t tier, uint32_t sec, const RollupOpen& in) {
+  const RollupTier& t = TIERS[tier];
+  RollupOpen& o = rings[metric][tier].open;
+  uint32_t start = sec - sec % t.width;
+  if (o.active && start != o.start) {
+    rollupClose(metric, tier, start);
+  }
+  if (!o.active) {
+    o = {start, 0, 0, 0, 0, 0, true};
+  }
+  if (in.count == 0) return;
+  if (o.count == 0 || in.min < o.min) o.min = in.min;
+  if (o.count == 0 || in.max > o.max) o.max = in.max;
+  o.sum += in.sum;
+  o.count += in.count;
+  o.last = in.last;
+}
+
+void historyAppend(uint8_t metric, uint32_t sec, int32_t value) {
+  if (metric >= HIST_METRIC_COUNT) return;
+  if (!initialized) initStore();
+  stats.samples++;
+  appendRaw(metric, sec, value);
+
+  RollupOpen sample = {sec, 0, 0, 0, 0, 0, true};
+  if (value != HISTORY_UNKNOWN) {
+    int32_t v = clamp16(value);
+    sample = {sec, v, v, v, v, 1, true};
+  }
+  for (uint8_t tier = 0; tier < ROLLUP_TIER_COUNT; tier++) rollupFold(metric, tier, sec, sample);
+}
+
+static int32_t tenths(float v) {
+  return v < 0.0f ? HISTORY_UNKNOWN : (int32_t)lroundf(v * 10.0f);
+}
+
+void sampleHistory() {
+  uint32_t sec = millis() / 1000UL;
+  historyAppend(HIST_RSSI, sec, WiFi.isConnected() ? WiFi.RSSI() : HISTORY_UNKNOWN);
+  historyAppend(HIST_FREE_HEAP, sec, (int32_t)(ESP.getFreeHeap() / 64));
+  historyAppend(HIST_LATENCY, sec, tenths(networkLatencyMs));
+  historyAppend(HIST_JITTER, sec, tenths(networkJitterMs));
+  historyAppend(HIST_PROBE_LOSS, sec,
+                networkProbeAttemptCount == 0
+                    ? HISTORY_UNKNOWN
+                    : (int32_t)((networkProbeAttemptCount - networkProbeSuccessCount) * 100 /
+                                networkProbeAttemptCount));
+  historyAppend(HIST_HEARTBEAT_CODE, sec,
+                getHeartbeatStats().attempts == 0 ? HISTORY_UNKNOWN : lastHeartbeatResponseCode);
+  historyAppend(HIST_DNS_UP, sec, isDNSWorking ? 1 : 0);
+#ifdef ENABLE_MQTT
+  historyAppend(HIST_MQTT_UP, sec, isMQTTConnected() ? 1 : 0);
+#else
+  historyAppend(HIST_MQTT_UP, sec, 0);
+#endif
+}
+
+// Block ids of metric in time order; returns how many
+static uint8_t seriesBlocks(uint8_t metric, uint8_t* ids) {
+  uint8_t n = 0;
+  for (uint8_t i = 0; i < HISTORY_BLOCK_COUNT; i++) {
+    if (blocks[i].metric != metric) continue;
+    uint8_t j = n++;
+    while (j > 0 && (int32_t)(blocks[ids[j - 1]].startSec - blocks[i].startSec) > 0) {
+      ids[j] = ids[j - 1];
+      j--;
+    }
+    ids[j] = i;
+  }
+  return n;
+}
+
+uint32_t historyForEach(uint8_t metric, uint32_t sinceSec, HistoryVisitor visit, void* ctx) {
+  if (metric >= HIST_METRIC_COUNT || !initialized) return 0;
+  uint8_t ids[HISTORY_BLOCK_COUNT];
+  uint8_t n = seriesBlocks(metric, ids);
+  uint32_t visited = 0;
+
+  for (uint8_t k = 0; k < n; k++) {
+    // Whole block before sinceSec: the next one starts no later than it
+    if (k + 1 < n && (int32_t)(blocks[ids[k + 1]].startSec - sinceSec) <= 0) continue;
+
+    const HistoryBlock& b = blocks[ids[k]];
+    BitReader r = {b.data, 0};
+    uint32_t sec = b.startSec;
+    int32_t value = b.firstValue;
+    int32_t delta = NOMINAL_INTERVAL_S;
+    uint32_t run = 0;  // repeats still to emit
+    for (uint16_t i = 0; i < b.count; i++) {
+      if (i > 0) {
+        if (run == 0 && r.pos < b.bits) {
+          uint32_t change = getUVar(r);
+          if (change != 0) {
+            value = (int32_t)((uint32_t)value + (uint32_t)unzigzag(change));
+            delta += unzigzag(getUVar(r));
+          } else if (getBits(r, 1) == 1) {
+            delta += unzigzag(getUVar(r));
+          } else {
+            run = getUVar(r) + 1;
+          }
+        }
+        if (run > 0) run--;
+        sec += (uint32_t)delta;
+      }
+      if ((int32_t)(sec - sinceSec) >= 0) {
+        visit(sec, value, ctx);
+        visited++;
+      }
+    }
+  }
+  return visited;
+}
+
+uint32_t historyOldestSec(uint8_t metric) {
+  if (metric >= HIST_METRIC_COUNT || !initialized) return 0;
+  uint8_t ids[HISTORY_BLOCK_COUNT];
+  return seriesBlocks(metric, ids) > 0 ? blocks[ids[0]].startSec : 0;
+}
+
+static HistoryBucket toBucket(uint32_t start, const RollupBucket& b) {
+  return {start, b.min, b.max, b.mean, b.last, b.count};
+}
+
+uint32_t historyForEachBucket(uint8_t metric, uint8_t source, uint32_t sinceSec,
+                              HistoryBucketVisitor visit, void* ctx) {
+  if (metric >= HIST_METRIC_COUNT || source == HIST_SOURCE_RAW || source >= HIST_SOURCE_COUNT) return 0;
+  uint8_t tier = source - 1;
+  const RollupTier& t = TIERS[tier];
+  const RollupRing& r = rings[metric][tier];
+  uint32_t visited = 0;
+
+  for (uint16_t age = r.size; age-- > 0;) {
+    uint32_t start = r.newestStart - age * t.width;
+    if ((int32_t)(start + t.width - sinceSec) <= 0) continue;
+    uint16_t index = (uint16_t)((r.head + t.capacity - 1 - age) % t.capacity);
+    visit(toBucket(start, rollupSlot(metric, tier, index)), ctx);
+    visited++;
+  }
+
+  const RollupOpen& o = r.open;
+  if (o.active && (int32_t)(o.start + t.width - sinceSec) > 0) {
+    HistoryBucket b = {o.start, o.min, o.max, 0, o.last, o.count};
+    if (o.count > 0) b.mean = (int32_t)lroundf((float)o.sum / o.count);
+    visit(b, ctx);
+    visited++;
+  }
+  return visited;
+}
+
+uint32_t historySourceWidth(uint8_t source) {
+  if (source == HIST_SOURCE_RAW || source >= HIST_SOURCE_COUNT) return HISTORY_SAMPLE_INTERVAL_MS / 1000UL;
+  return TIERS[source - 1].width;
+}
+
+const char* historySourceName(uint8_t source) {
+  if (source == HIST_SOURCE_RAW || source >= HIST_SOURCE_COUNT) return "raw";
+  return TIERS[source - 1].name;
+}
+
+// False when the source holds nothing for metric yet
+static bool sourceOldest(uint8_t metric, uint8_t source, uint32_t* oldest) {
+  if (source == HIST_SOURCE_RAW) {
+    uint8_t ids[HISTORY_BLOCK_COUNT];
+    if (!initialized || seriesBlocks(metric, ids) == 0) return false;
+    *oldest = blocks[ids[0]].startSec;
+    return true;
+  }
+  const RollupTier& t = TIERS[source - 1];
+  const RollupRing& r = rings[metric][source - 1];
+  if (r.size > 0) {
+    *oldest = r.newestStart - (uint32_t)(r.size - 1) * t.width;
+    return true;
+  }
+  if (r.open.active) {
+    *oldest = r.open.start;
+    return true;
+  }
+  return false;
+}
+
+uint32_t historySourceOldestSec(uint8_t metric, uint8_t source) {
+  uint32_t oldest = 0;
+  if (metric >= HIST_METRIC_COUNT || source >= HIST_SOURCE_COUNT) return 0;
+  return sourceOldest(metric, source, &oldest) ? oldest : 0;
+}
+
+uint8_t historyPickSource(uint8_t metric, uint32_t sinceSec, uint32_t stepSec) {
+  if (metric >= HIST_METRIC_COUNT) return HIST_SOURCE_RAW;
+  int8_t reaching = -1;  // widest source that covers sinceSec
+  int8_t furthest = -1;  // otherwise: the one with the oldest data
+  uint32_t furthestOldest = 0;
+  for (uint8_t source = HIST_SOURCE_RAW; source < HIST_SOURCE_COUNT; source++) {
+    if (source != HIST_SOURCE_RAW && historySourceWidth(source) > stepSec) break;
+    uint32_t oldest;
+    if (!sourceOldest(metric, source, &oldest)) continue;
+    if ((int32_t)(oldest - sinceSec) <= 0) reaching = (int8_t)source;
+    if (furthest < 0 || (int32_t)(oldest - furthestOldest) <= 0) {
+      furthest = (int8_t)source;
+      furthestOldest = oldest;
+    }
+  }
+  if (reaching >= 0) return (uint8_t)reaching;
+  return furthest >= 0 ? (uint8_t)furthest : (uint8_t)HIST_SOURCE_RAW;
+}
+
+const HistoryMetricInfo& historyMetricInfo(uint8_t metric) {
+  return METRICS[metric < HIST_METRIC_COUNT ? metric : 0];
+}
+
+int8_t historyFindMetric(const char* name) {
+  for (uint8_t m = 0; m < HIST_METRIC_COUNT; m++) {
+    if (strcmp(name, METRICS[m].name) == 0) return (int8_t)m;
+  }
+  return -1;
+}
+
+// JSON output. Built from print() pieces: Print::printf() heap-allocates
+// past 64 chars.
+
+static void printValue(Print& out, double value) {
+  char buf[24];
+  snprintf(buf, sizeof(buf), "%.7g", value);
+  out.print(buf);
+}
+
+// Merges source samples or buckets into one row per step
+struct RowWriter {
+  Print* out;
+  float scale;
+  uint32_t step;   // 0: raw points, one per sample
+  bool first;      // nothing written yet
+  bool open;       // row being merged
+  uint32_t start;
+  int32_t min;
+  int32_t max;
+  int32_t last;
+  int64_t sum;     // of mean * count
+  uint32_t count;
+};
+
+static void flushRow(RowWriter& w) {
+  if (!w.open) return;
+  Print& out = *w.out;
+  out.print(w.first ? "[" : ",[");
+  out.print((unsigned long)w.start);
+  if (w.count == 0) {
+    out.print(",null,null,null,null,0]");
+  } else {
+    out.print(',');
+    printValue(out, (double)w.sum / w.count * w.scale);
+    out.print(',');
+    printValue(out, w.min * (double)w.scale);
+    out.print(',');
+    printValue(out, w.max * (double)w.scale);
+    out.print(',');
+    printValue(out, w.last * (double)w.scale);
+    out.print(',');
+    out.print((unsigned long)w.count);
+    out.print(']');
+  }
+  w.first = false;
+  w.open = false;
+}
+
+static void visitBucketRow(const HistoryBucket& b, void* ctx) {
+  RowWriter& w = *static_cast<RowWriter*>(ctx);
+  uint32_t start = b.start - b.start % w.step;
+  if (w.open && start != w.start) flushRow(w);
+  if (!w.open) {
+    w.open = true;
+    w.start = start;
+    w.sum = 0;
+    w.count = 0;
+  }
+  if (b.count == 0) return;
+  if (w.count == 0 || b.min < w.min) w.min = b.min;
+  if (w.count == 0 || b.max > w.max) w.max = b.max;
+  w.sum += (int64_t)b.mean * b.count;
+  w.count += b.count;
+  w.last = b.last;
+}
+
+static void visitSampleRow(uint32_t sec, int32_t value, void* ctx) {
+  RowWriter& w = *static_cast<RowWriter*>(ctx);
+  if (w.step > 0) {
+    HistoryBucket b = {sec, value, value, value, value, (uint16_t)(value != HISTORY_UNKNOWN)};
+    visitBucketRow(b, ctx);
+    return;
+  }
+  w.out->print(w.first ? "[" : ",[");
+  w.out->print((unsigned long)sec);
+  w.out->print(',');
+  if (value == HISTORY_UNKNOWN) {
+    w.out->print("null");
+  } else {
+    printValue(*w.out, value * (double)w.scale);
+  }
+  w.out->print(']');
+  w.first = false;
+}
+
+void writeHistoryJSON(Print& out, uint8_t metric, uint32_t sinceSec, uint32_t stepSec) {
+  const HistoryMetricInfo& info = historyMetricInfo(metric);
+  uint8_t source = stepSec > 0 ? historyPickSource(metric, sinceSec, stepSec) : (uint8_t)HIST_SOURCE_RAW;
+  uint32_t width = historySourceWidth(source);
+  if (stepSec > 0 && stepSec < width) stepSec = width;
+
+  out.print("{\"metric\":\"");
+  out.print(info.name);
+  out.print("\",\"unit\":\"");
+  out.print(info.unit);
+  out.print("\",\"now\":");
+  out.print((unsigned long)(millis() / 1000UL));
+  out.print(",\"source\":\"");
+  out.print(historySourceName(source));
+  out.print("\",\"step\":");
+  out.print((unsigned long)(stepSec > 0 ? stepSec : width));
+  out.print(stepSec > 0 ? ",\"fields\":[\"t\",\"mean\",\"min\",\"max\",\"last\",\"count\"]"
+                        : ",\"fields\":[\"t\",\"value\"]");
+  out.print(",\"points\":[");
+  RowWriter w = {&out, info.scale, stepSec, true, false, 0, 0, 0, 0, 0, 0};
+  if (source == HIST_SOURCE_RAW) {
+    historyForEach(metric, sinceSec, visitSampleRow, &w);
+  } else {
+    historyForEachBucket(metric, source, sinceSec, visitBucketRow, &w);
+  }
+  flushRow(w);
+  out.print("]}");
+}
+
+void writeHistoryIndexJSON(Print& out) {
+  out.print("{\"interval\":");
+  out.print((unsigned long)(HISTORY_SAMPLE_INTERVAL_MS / 1000UL));
+  out.print(",\"now\":");
+  out.print((unsigned long)(millis() / 1000UL));
+  out.print(",\"tiers\":[");
+  for (uint8_t t = 0; t < ROLLUP_TIER_COUNT; t++) {
+    out.print(t > 0 ? ",{\"name\":\"" : "{\"name\":\"");
+    out.print(TIERS[t].name);
+    out.print("\",\"width\":");
+    out.print((unsigned long)TIERS[t].width);
+    out.print(",\"buckets\":");
+    out.print((unsigned)TIERS[t].capacity);
+    out.print('}');
+  }
+  out.print("],\"metrics\":[");
+  for (uint8_t m = 0; m < HIST_METRIC_COUNT; m++) {
+    out.print(m > 0 ? ",{\"name\":\"" : "{\"name\":\"");
+    out.print(METRICS[m].name);
+    out.print("\",\"unit\":\"");
+    out.print(METRICS[m].unit);
+    out.print("\",\"oldest\":{");
+    for (uint8_t source = HIST_SOURCE_RAW; source < HIST_SOURCE_COUNT; source++) {
+      out.print(source > 0 ? ",\"" : "\"");
+      out.print(historySourceName(source));
+      out.print("\":");
+      out.print((unsigned long)historySourceOldestSec(m, source));
+    }
+    out.print("}}");
+  }
+  out.print("],\"blocks\":");
+  out.print((unsigned)HISTORY_BLOCK_COUNT);
+  out.print(",\"blocks_in_use\":");
+  out.print((unsigned)stats.blocksInUse);
+  out.print(",\"bytes\":");
+  out.print((unsigned long)stats.bytes);
+  out.print(",\"rollup_bytes\":");
+  out.print((unsigned long)stats.rollupBytes);
+  out.print(",\"evictions\":");
+  out.print(stats.evictions);
+  out.print('}');
+}
+
+const HistoryStats& getHistoryStats() {
+  return stats;
+}
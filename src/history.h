@@ -0,0 +1,125 @@
+#ifndef HISTORY_H
+#define HISTORY_H
+
+#include <Arduino.h>
+
+// Compressed on-device telemetry history. Every HISTORY_SAMPLE_INTERVAL_MS
+// each metric is read as a fixed-point integer and appended to its series:
+// - values as the zigzag delta from the previous sample, with a prefix
+//   choosing 0, 4, 8, 16 or 32 payload bits
+// - timestamps (uptime seconds) as the delta-of-delta against the previous
+//   interval: one bit while sampling stays on schedule
+// - a run of samples that are on schedule and unchanged as one count, so a
+//   steady metric (heartbeat code, DNS, MQTT) costs a few bits per run
+// A series is a chain of blocks from one shared pool. Once the pool is full,
+// a metric's oldest block is reused, picking the block whose data went
+// stale first. All metrics therefore cover about the same time span, and
+// memory use is fixed.
+//
+// Budget: 56 x 256-byte blocks (14 KB). With the noise of the history.day
+// bench (RSSI and heap jittering every sample, latency and jitter moving with
+// each probe) the pool holds about 27 h of 30 s samples for all eight
+// metrics, so a full day fits with some room for noisier readings.
+//
+// Rollup tiers: each sample is also folded into a 15-minute and an hourly
+// bucket, so compaction is a few additions per sample and never a batch
+// pass. Buckets keep min, max, mean, last and count in 10 bytes. Each tier
+// is a ring per metric:
+//   15m x 96 = 24 h     1h x 168 = 7 days
+// That is 21 KB for all eight metrics, on top of the raw store. Day views
+// read the 15-minute tier, so they do not depend on how much the raw store
+// holds.
+
+#define HISTORY_SAMPLE_INTERVAL_MS 30000UL
+#define HISTORY_BLOCK_COUNT 56
+#define HISTORY_BLOCK_BYTES 240  // encoded samples; a 16-byte header comes on top
+#define HISTORY_UNKNOWN INT32_MIN  // no reading (e.g. latency before the first probe)
+
+// Sources for a query: raw samples, then the rollup tiers, finest first
+enum HistorySource : uint8_t {
+  HIST_SOURCE_RAW = 0,
+  HIST_SOURCE_15M,
+  HIST_SOURCE_1H,
+  HIST_SOURCE_COUNT
+};
+
+enum HistoryMetric : uint8_t {
+  HIST_RSSI = 0,
+  HIST_FREE_HEAP,
+  HIST_LATENCY,
+  HIST_JITTER,
+  HIST_PROBE_LOSS,
+  HIST_HEARTBEAT_CODE,
+  HIST_DNS_UP,
+  HIST_MQTT_UP,
+  HIST_METRIC_COUNT
+};
+
+struct HistoryMetricInfo {
+  const char* name;  // as used by /history?metric=
+  const char* unit;
+  float scale;       // reported value = stored integer * scale
+};
+
+struct HistoryStats {
+  unsigned long samples;    // appended since boot
+  unsigned long evictions;  // blocks reused while still holding samples
+  uint8_t blocksInUse;
+  size_t bytes;             // fixed RAM held by the raw store
+  size_t rollupBytes;       // fixed RAM held by the rollup tiers
+};
+
+// Aggregate over [start, start + width). min/max/mean/last are meaningless
+// when count is 0 (no sample with a reading).
+struct HistoryBucket {
+  uint32_t start;
+  int32_t min;
+  int32_t max;
+  int32_t mean;
+  int32_t last;
+  uint16_t count;
+};
+
+typedef void (*HistoryVisitor)(uint32_t sec, int32_t value, void* ctx);
+typedef void (*HistoryBucketVisitor)(const HistoryBucket& bucket, void* ctx);
+
+// Scheduler task: sample every metric once
+void sampleHistory();
+
+// Append one sample to a metric's series (sampleHistory() uses this)
+void historyAppend(uint8_t metric, uint32_t sec, int32_t value);
+
+// Call visit for each held sample of metric at or after sinceSec, oldest
+// first. Returns the number of samples visited.
+uint32_t historyForEach(uint8_t metric, uint32_t sinceSec, HistoryVisitor visit, void* ctx);
+
+// Uptime second of the oldest sample still held for metric (0 when empty)
+uint32_t historyOldestSec(uint8_t metric);
+
+// Buckets of a rollup tier (HIST_SOURCE_15M and up) ending after sinceSec,
+// oldest first. The bucket still being filled comes last.
+uint32_t historyForEachBucket(uint8_t metric, uint8_t source, uint32_t sinceSec,
+                              HistoryBucketVisitor visit, void* ctx);
+
+// Bucket width in seconds (the sample interval for HIST_SOURCE_RAW), the
+// oldest second held, and the name used in /history output
+uint32_t historySourceWidth(uint8_t source);
+uint32_t historySourceOldestSec(uint8_t metric, uint8_t source);
+const char* historySourceName(uint8_t source);
+
+// Source for a query with this step (seconds, > 0): the widest one no wider
+// than step that reaches back to sinceSec, or the one reaching furthest back
+uint8_t historyPickSource(uint8_t metric, uint32_t sinceSec, uint32_t stepSec);
+
+const HistoryMetricInfo& historyMetricInfo(uint8_t metric);
+int8_t historyFindMetric(const char* name);  // -1 when unknown
+
+// /history bodies: one metric's raw points ([sec, value]), or with stepSec > 0
+// one [start, mean, min, max, last, count] row per step from the cheapest
+// source; or the metric list when no metric is named
+void writeHistoryJSON(Print& out, uint8_t metric, uint32_t sinceSec, uint32_t stepSec);
+void writeHistoryIndexJSON(Print& out);
+
+const HistoryStats& getHistoryStats();
+
+#endif // HISTORY_H
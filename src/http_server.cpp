@@ -0,0 +1,949 @@
+#ifdef ENABLE_WEBSERVER
+
+#include "http_server.h"
+#include "log.h"
+#include <lwip/sockets.h>
+#include <errno.h>
+
+#ifdef MSG_NOSIGNAL
+#define HTTP_SEND_FLAGS (MSG_DONTWAIT | MSG_NOSIGNAL)
+#else
+#define HTTP_SEND_FLAGS MSG_DONTWAIT
+#endif
+
+static const char* statusText(int code) {
+  switch (code) {
+    case 101: return "Switching Protocols";
+    case 200: return "OK";
+    case 204: return "No Content";
+    case 301: return "Moved Permanently";
+    case 302: return "Found";
+    case 304: return "Not Modified";
+    case 400: return "Bad Request";
+    case 404: return "Not Found";
+    case 405: return "Method Not Allowed";
+    case 406: return "Not Acceptable";
+    case 408: return "Request Timeout";
+    case 413: return "Payload Too Large";
+    case 426: return "Upgrade Required";
+    case 429: return "Too Many Requests";
+    case 431: return "Request Header Fields Too Large";
+    case 500: return "Internal Server Error";
+    case 503: return "Service Unavailable";
+    default: return "";
+  }
+}
+
+static HTTPMethod parseMethod(const char* m) {
+  if (strcmp(m, "GET") == 0) return HTTP_GET;
+  if (strcmp(m, "HEAD") == 0) return HTTP_HEAD;
+  if (strcmp(m, "POST") == 0) return HTTP_POST;
+  if (strcmp(m, "PUT") == 0) return HTTP_PUT;
+  if (strcmp(m, "PATCH") == 0) return HTTP_PATCH;
+  if (strcmp(m, "DELETE") == 0) return HTTP_DELETE;
+  if (strcmp(m, "OPTIONS") == 0) return HTTP_OPTIONS;
+  return HTTP_ANY;
+}
+
+static void urlDecodeInto(String& out, const char* s, size_t len) {
+  for (size_t i = 0; i < len; i++) {
+    char c = s[i];
+    if (c == '+') {
+      out += ' ';
+    } else if (c == '%' && i + 2 < len && isxdigit((unsigned char)s[i + 1]) &&
+               isxdigit((unsigned char)s[i + 2])) {
+      char hex[3] = {s[i + 1], s[i + 2], 0};
+      out += (char)strtol(hex, nullptr, 16);
+      i += 2;
+    } else {
+      out += c;
+    }
+  }
+}
+
+// Offset just past the blank line that ends the header block, or 0 if it
+// has not arrived yet. Bare LF line endings are accepted.
+static size_t findHeaderEnd(const char* data, size_t len) {
+  for (size_t i = 0; i < len; i++) {
+    if (data[i] != '\n') continue;
+    size_t j = i + 1;
+    if (j < len && data[j] == '\r') j++;
+    if (j < len && data[j] == '\n') return j + 1;
+  }
+  return 0;
+}
+
+// Content-Length value: digits only. False for an empty, signed, malformed
+// or overflowing value.
+static bool parseContentLength(const char* value, size_t len, size_t* out) {
+  if (len == 0) return false;
+  size_t n = 0;
+  for (size_t i = 0; i < len; i++) {
+    if (value[i] < '0' || value[i] > '9') return false;
+    size_t digit = (size_t)(value[i] - '0');
+    if (n > (SIZE_MAX - digit) / 10) return false;
+    n = n * 10 + digit;
+  }
+  *out = n;
+  return true;
+}
+
+// Value of header `name` among the lines in [start, end); trimmed, not terminated
+static const char* findHeader(const char* start, const char* end, const char* name, size_t* valueLen) {
+  size_t nameLen = strlen(name);
+  const char* line = start;
+  while (line < end) {
+    const char* eol = static_cast<const char*>(memchr(line, '\n', end - line));
+    if (eol == nullptr) eol = end;
+    if ((size_t)(eol - line) > nameLen && line[nameLen] == ':' && strncasecmp(line, name, nameLen) == 0) {
+      const char* v = line + nameLen + 1;
+      const char* e = eol;
+      while (v < e && (*v == ' ' || *v == '\t')) v++;
+      while (e > v && (e[-1] == '\r' || e[-1] == ' ' || e[-1] == '\t')) e--;
+      *valueLen = e - v;
+      return v;
+    }
+    line = eol + 1;
+  }
+  return nullptr;
+}
+
+static bool headerHasToken(const char* value, size_t len, const char* token) {
+  size_t tokenLen = strlen(token);
+  for (size_t i = 0; i + tokenLen <= len; i++) {
+    if (strncasecmp(value + i, token, tokenLen) == 0) return true;
+  }
+  return false;
+}
+
+HttpServer::HttpServer(uint16_t port) : listener_(port, HTTP_MAX_CONNECTIONS) {
+  memset(&stats_, 0, sizeof(stats_));
+  for (uint8_t i = 0; i < HTTP_BUFFER_COUNT; i++) {
+    buffers_[i].inUse = false;
+  }
+  for (uint8_t i = 0; i < HTTP_MAX_CONNECTIONS; i++) {
+    HttpConnection& c = conns_[i];
+    c.state = HTTP_CONN_FREE;
+    c.req = nullptr;
+    c.resp = nullptr;
+    c.queuedCount = 0;
+  }
+}
+
+void HttpServer::begin() {
+  listener_.begin();
+  listener_.setNoDelay(true);
+}
+
+// ---------------------------------------------------------------------------
+// Routing
+// ---------------------------------------------------------------------------
+
+// FNV-1a
+static uint32_t pathHash(const char* path) {
+  uint32_t h = 2166136261u;
+  for (; *path; path++) {
+    h ^= (uint8_t)*path;
+    h *= 16777619u;
+  }
+  return h;
+}
+
+static uint16_t methodBits(HTTPMethod method) {
+  if (method == HTTP_ANY) return (1u << HTTP_GET) | (1u << HTTP_HEAD) | (1u << HTTP_POST);
+  return method < 16 ? (uint16_t)(1u << method) : 0;
+}
+
+void HttpServer::setRoutes(const HttpRoute* routes, uint8_t count) {
+  if (count > HTTP_MAX_ROUTES) {
+    LOG_W(LOG_MOD_WEB, "Route table has %u entries, only %u are served", (unsigned)count,
+          (unsigned)HTTP_MAX_ROUTES);
+    count = HTTP_MAX_ROUTES;
+  }
+  routes_ = routes;
+  routeCount_ = count;
+  literalCount_ = 0;
+  patternCount_ = 0;
+  for (uint8_t i = 0; i < count; i++) {
+    if (strchr(routes[i].pattern, '{') != nullptr) {
+      patternRoutes_[patternCount_++] = i;
+      continue;
+    }
+    // Insertion sort; equal hashes keep table order so the first entry wins
+    uint32_t h = pathHash(routes[i].pattern);
+    uint8_t pos = literalCount_++;
+    while (pos > 0 && literalIndex_[pos - 1].hash > h) {
+      literalIndex_[pos] = literalIndex_[pos - 1];
+      pos--;
+    }
+    literalIndex_[pos] = RouteHash{h, i};
+  }
+}
+
+// Match path_ against a pattern, capturing {name} segments into pathArgs_
+bool HttpServer::matchPattern(const char* pattern) {
+  const char* p = path_;
+  pathArgCount_ = 0;
+  while (*pattern) {
+    if (*pattern == '{') {
+      const char* close = strchr(pattern, '}');
+      if (close == nullptr || pathArgCount_ >= HTTP_MAX_PATH_ARGS) return false;
+      const char* segment = p;
+      while (*p && *p != '/') p++;
+      if (p == segment) return false;
+      pathArgs_[pathArgCount_] = segment;
+      pathArgLengths_[pathArgCount_++] = (uint8_t)(p - segment > 255 ? 255 : p - segment);
+      pattern = close + 1;
+    } else if (*pattern++ != *p++) {
+      return false;
+    }
+  }
+  return *p == '\0';
+}
+
+// First route for this path and method; literal paths win over patterns.
+// allowMask collects the methods of every CORS-enabled route on the path.
+const HttpRoute* HttpServer::matchRoute(HTTPMethod method, uint16_t* allowMask) {
+  const HttpRoute* found = nullptr;
+  *allowMask = 0;
+
+  uint32_t h = pathHash(path_);
+  uint8_t lo = 0, hi = literalCount_;
+  while (lo < hi) {
+    uint8_t mid = (lo + hi) / 2;
+    if (literalIndex_[mid].hash < h) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  for (uint8_t i = lo; i < literalCount_ && literalIndex_[i].hash == h; i++) {
+    const HttpRoute& r = routes_[literalIndex_[i].route];
+    if (strcmp(r.pattern, path_) != 0) continue;
+    if (r.cors == HTTP_CORS_PUBLIC) *allowMask |= methodBits(r.method);
+    if (found == nullptr && (r.method == HTTP_ANY || r.method == method)) found = &r;
+  }
+
+  const HttpRoute* foundPattern = nullptr;
+  for (uint8_t i = 0; i < patternCount_; i++) {
+    const HttpRoute& r = routes_[patternRoutes_[i]];
+    if (!matchPattern(r.pattern)) continue;
+    if (r.cors == HTTP_CORS_PUBLIC) *allowMask |= methodBits(r.method);
+    if (found == nullptr && foundPattern == nullptr && (r.method == HTTP_ANY || r.method == method)) {
+      foundPattern = &r;
+    }
+  }
+  if (found == nullptr && foundPattern != nullptr) {
+    matchPattern(foundPattern->pattern);  // a later pattern may have overwritten the args
+    return foundPattern;
+  }
+  pathArgCount_ = 0;
+  return found;
+}
+
+void HttpServer::sendPreflight(uint16_t allowMask) {
+  static const struct {
+    HTTPMethod method;
+    const char* name;
+  } METHOD_NAMES[] = {
+    {HTTP_GET, "GET"}, {HTTP_HEAD, "HEAD"}, {HTTP_POST, "POST"},
+    {HTTP_PUT, "PUT"}, {HTTP_PATCH, "PATCH"}, {HTTP_DELETE, "DELETE"},
+  };
+  char methods[48] = "";
+  for (const auto& m : METHOD_NAMES) {
+    if (allowMask & methodBits(m.method)) {
+      strcat(methods, m.name);
+      strcat(methods, ", ");
+    }
+  }
+  strcat(methods, "OPTIONS");
+
+  sendHeader("Access-Control-Allow-Origin", "*");
+  sendHeader("Access-Control-Allow-Methods", methods);
+  sendHeader("Access-Control-Allow-Headers", "Content-Type");
+  sendHeader("Access-Control-Max-Age", "86400");
+  send(204);
+}
+
+// ---------------------------------------------------------------------------
+// Buffer pool
+// ---------------------------------------------------------------------------
+
+HttpBuffer* HttpServer::acquireBuffer() {
+  for (uint8_t i = 0; i < HTTP_BUFFER_COUNT; i++) {
+    if (!buffers_[i].inUse) {
+      buffers_[i].inUse = true;
+      stats_.buffersInUse++;
+      if (stats_.buffersInUse > stats_.peakBuffersInUse) stats_.peakBuffersInUse = stats_.buffersInUse;
+      return &buffers_[i];
+    }
+  }
+  return nullptr;
+}
+
+void HttpServer::releaseBuffer(HttpBuffer*& buffer) {
+  if (buffer == nullptr) return;
+  buffer->inUse = false;
+  buffer = nullptr;
+  stats_.buffersInUse--;
+}
+
+void HttpServer::releaseQueued(HttpConnection& c) {
+  for (uint8_t i = 0; i < c.queuedCount; i++) releaseBuffer(c.queued[i]);
+  c.queuedCount = 0;
+}
+
+// ---------------------------------------------------------------------------
+// Connection lifecycle
+// ---------------------------------------------------------------------------
+
+void HttpServer::closeConnection(HttpConnection& c) {
+  releaseBuffer(c.req);
+  releaseBuffer(c.resp);
+  releaseQueued(c);
+  c.client.stop();
+  c.client = WiFiClient();
+  c.state = HTTP_CONN_FREE;
+  stats_.activeConnections--;
+}
+
+void HttpServer::acceptConnections() {
+  for (uint8_t n = 0; n < HTTP_MAX_CONNECTIONS && listener_.hasClient(); n++) {
+    HttpConnection* slot = nullptr;
+    HttpConnection* oldestIdle = nullptr;
+    for (uint8_t i = 0; i < HTTP_MAX_CONNECTIONS; i++) {
+      HttpConnection& c = conns_[i];
+      if (c.state == HTTP_CONN_FREE) {
+        slot = &c;
+        break;
+      }
+      if (c.state == HTTP_CONN_IDLE && (oldestIdle == nullptr || c.stateSinceMs < oldestIdle->stateSinceMs)) {
+        oldestIdle = &c;
+      }
+    }
+    if (slot == nullptr && oldestIdle != nullptr) {
+      // An idle keep-alive socket costs the browser one reconnect; a new client would get nothing
+      closeConnection(*oldestIdle);
+      slot = oldestIdle;
+    }
+
+    WiFiClient client = listener_.available();
+    if (slot == nullptr) {
+      static const char busy[] =
+          "HTTP/1.1 503 Service Unavailable\r\n"
+          "Content-Length: 0\r\n"
+          "Retry-After: 1\r\n"
+          "Connection: close\r\n"
+          "\r\n";
+      ::send(client.fd(), busy, sizeof(busy) - 1, HTTP_SEND_FLAGS);
+      client.stop();
+      stats_.rejected++;
+      continue;
+    }
+
+    slot->client = client;
+    slot->client.setNoDelay(true);
+    slot->state = HTTP_CONN_IDLE;  // buffers are taken when the first bytes arrive
+    slot->stateSinceMs = millis();
+    slot->requests = 0;
+    slot->reqLen = 0;
+    slot->reqConsumed = 0;
+    stats_.accepted++;
+    stats_.activeConnections++;
+    if (stats_.activeConnections > stats_.peakConnections) stats_.peakConnections = stats_.activeConnections;
+  }
+}
+
+void HttpServer::handleClient() {
+  acceptConnections();
+  for (uint8_t i = 0; i < HTTP_MAX_CONNECTIONS; i++) {
+    if (conns_[i].state != HTTP_CONN_FREE) {
+      service(conns_[i]);
+    }
+  }
+}
+
+void HttpServer::service(HttpConnection& c) {
+  if (c.state == HTTP_CONN_UPGRADED) {
+    return;  // owned by the protocol it was upgraded to
+  }
+  unsigned long now = millis();
+  int fd = c.client.fd();
+
+  if (c.state == HTTP_CONN_IDLE) {
+    char probe;
+    ssize_t n = ::recv(fd, &probe, 1, MSG_PEEK | MSG_DONTWAIT);
+    if (n == 0 || (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK)) {
+      closeConnection(c);  // peer closed
+      return;
+    }
+    if (n < 0) {
+      if (now - c.stateSinceMs >= HTTP_KEEPALIVE_TIMEOUT_MS) closeConnection(c);
+      return;
+    }
+    c.req = acquireBuffer();
+    if (c.req == nullptr) {
+      stats_.bufferWaits++;
+      return;  // the pool is busy; the bytes wait in the socket
+    }
+    c.reqLen = 0;
+    c.state = HTTP_CONN_READING;
+    c.stateSinceMs = now;
+  }
+
+  if (c.state == HTTP_CONN_READING) {
+    if (!readRequest(c)) {
+      closeConnection(c);
+      return;
+    }
+    if (c.state == HTTP_CONN_READING && now - c.stateSinceMs >= HTTP_REQUEST_TIMEOUT_MS) {
+      stats_.timeouts++;
+      closeConnection(c);
+      return;
+    }
+  }
+
+  if (c.state == HTTP_CONN_WRITING) {
+    if (!writeResponse(c)) {
+      closeConnection(c);
+    }
+  }
+}
+
+// Receive what is available and run the handler once the request is whole.
+// Returns false when the connection should be closed.
+bool HttpServer::readRequest(HttpConnection& c) {
+  size_t room = HTTP_BUFFER_SIZE - 1 - c.reqLen;
+  if (room > 0) {
+    ssize_t n = ::recv(c.client.fd(), c.req->data + c.reqLen, room, MSG_DONTWAIT);
+    if (n == 0) return false;
+    if (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK) return false;
+    if (n > 0) c.reqLen += (size_t)n;
+  }
+
+  size_t headerEnd = findHeaderEnd(c.req->data, c.reqLen);
+  if (headerEnd == 0) {
+    if (c.reqLen < HTTP_BUFFER_SIZE - 1) return true;  // headers still arriving
+    static const char tooLarge[] =
+        "HTTP/1.1 431 Request Header Fields Too Large\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+    ::send(c.client.fd(), tooLarge, sizeof(tooLarge) - 1, HTTP_SEND_FLAGS);
+    return false;
+  }
+  size_t bodyLength = 0;
+  size_t valueLen;
+  const char* v = findHeader(c.req->data, c.req->data + headerEnd, "Content-Length", &valueLen);
+  if (v != nullptr && !parseContentLength(v, valueLen, &bodyLength)) {
+    static const char badLength[] =
+        "HTTP/1.1 400 Bad Request\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+    ::send(c.client.fd(), badLength, sizeof(badLength) - 1, HTTP_SEND_FLAGS);
+    return false;
+  }
+  if (bodyLength > HTTP_BUFFER_SIZE - 1 - headerEnd) {
+    static const char tooLarge[] =
+        "HTTP/1.1 413 Payload Too Large\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+    ::send(c.client.fd(), tooLarge, sizeof(tooLarge) - 1, HTTP_SEND_FLAGS);
+    return false;
+  }
+  if (c.reqLen < headerEnd + bodyLength) {
+    return true;  // body still arriving
+  }
+
+  c.resp = acquireBuffer();
+  if (c.resp == nullptr) {
+    stats_.bufferWaits++;
+    return true;  // request stays parked until a buffer frees up
+  }
+  c.reqConsumed = headerEnd + bodyLength;
+  dispatch(c);
+  return true;
+}
+
+// Split the request line in place and locate headers and body
+bool HttpServer::parseRequest(HttpConnection& c) {
+  char* data = c.req->data;
+  size_t headerEnd = findHeaderEnd(data, c.reqConsumed);
+  if (headerEnd == 0) return false;
+  size_t valueLen;
+  const char* v;
+  body_ = data + headerEnd;
+  bodyLength_ = c.reqConsumed - headerEnd;
+
+  char* eol = static_cast<char*>(memchr(data, '\n', headerEnd));
+  if (eol == nullptr) return false;
+  headers_ = eol + 1;
+  headersEnd_ = data + headerEnd;
+  *eol = '\0';
+  if (eol > data && eol[-1] == '\r') eol[-1] = '\0';
+
+  char* sp1 = strchr(data, ' ');
+  if (sp1 == nullptr) return false;
+  *sp1 = '\0';
+  char* url = sp1 + 1;
+  char* sp2 = strchr(url, ' ');
+  if (sp2 == nullptr) return false;
+  *sp2 = '\0';
+  http10_ = strcmp(sp2 + 1, "HTTP/1.0") == 0;
+
+  method_ = parseMethod(data);
+  path_ = url;
+  char* q = strchr(url, '?');
+  if (q != nullptr) {
+    *q = '\0';
+    query_ = q + 1;
+  } else {
+    query_ = "";
+  }
+
+  v = findHeader(headers_, headersEnd_, "Content-Type", &valueLen);
+  formBody_ = v != nullptr && strncasecmp(v, "application/x-www-form-urlencoded", 33) == 0;
+
+  v = findHeader(headers_, headersEnd_, "Connection", &valueLen);
+  if (http10_) {
+    c.keepAlive = v != nullptr && headerHasToken(v, valueLen, "keep-alive");
+  } else {
+    c.keepAlive = v == nullptr || !headerHasToken(v, valueLen, "close");
+  }
+  if (c.requests >= HTTP_KEEPALIVE_MAX_REQUESTS) c.keepAlive = false;
+  return true;
+}
+
+void HttpServer::dispatch(HttpConnection& c) {
+  current_ = &c;
+  c.respLen = 0;
+  c.respSent = 0;
+  c.staticBody = nullptr;
+  c.staticLen = 0;
+  c.staticSent = 0;
+  c.lastProgressMs = millis();
+  handlerStartMs_ = c.lastProgressMs;
+  pendingLen_ = 0;
+  contentLength_ = CONTENT_LENGTH_NOT_SET;
+  headersSent_ = false;
+  chunked_ = false;
+  failed_ = false;
+
+  if (c.requests > 0) stats_.keepAliveReuses++;
+  c.requests++;
+  stats_.requests++;
+
+  if (!parseRequest(c)) {
+    c.keepAlive = false;
+    send(400, "text/plain", "Bad Request");
+  } else {
+    uint16_t allowMask;
+    const HttpRoute* route = matchRoute(method_, &allowMask);
+    if (method_ == HTTP_OPTIONS && allowMask != 0) {
+      sendPreflight(allowMask);
+    } else if (route != nullptr) {
+      if (route->cors == HTTP_CORS_PUBLIC) {
+        sendHeader("Access-Control-Allow-Origin", "*");
+      }
+      route->handler();
+    } else if (notFound_ != nullptr) {
+      notFound_();
+    } else {
+      send(404, "text/plain", String("Not found: ") + path_);
+    }
+  }
+  finishResponse(c);
+  current_ = nullptr;
+}
+
+void HttpServer::finishResponse(HttpConnection& c) {
+  if (c.state == HTTP_CONN_UPGRADED) {
+    return;
+  }
+  if (failed_) {
+    closeConnection(c);
+    return;
+  }
+  if (!headersSent_ && c.respLen == 0) {
+    // The handler kept client() (event stream) or sent nothing. Let go of
+    // the socket without closing it; the last copy of the client closes it.
+    releaseBuffer(c.req);
+    releaseBuffer(c.resp);
+    c.client = WiFiClient();
+    c.state = HTTP_CONN_FREE;
+    stats_.activeConnections--;
+    return;
+  }
+  if (chunked_) {
+    sendContent("", 0);  // handler did not terminate the body
+  }
+  c.state = HTTP_CONN_WRITING;
+  c.stateSinceMs = millis();
+  if (!writeResponse(c)) {
+    closeConnection(c);
+  }
+}
+
+// Push buffered output, then any flash body. Returns false to close.
+bool HttpServer::writeResponse(HttpConnection& c) {
+  if (!flushResponse(c, false)) return false;
+  if (c.queuedCount > 0 || c.respLen > 0) {
+    return millis() - c.lastProgressMs < HTTP_WRITE_STALL_MS;
+  }
+  while (c.staticSent < c.staticLen) {
+    ssize_t n = ::send(c.client.fd(), c.staticBody + c.staticSent, c.staticLen - c.staticSent, HTTP_SEND_FLAGS);
+    if (n > 0) {
+      c.staticSent += (size_t)n;
+      c.lastProgressMs = millis();
+      continue;
+    }
+    if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+      return millis() - c.lastProgressMs < HTTP_WRITE_STALL_MS;
+    }
+    return false;
+  }
+
+  // Response complete
+  if (!c.keepAlive) return false;
+  releaseBuffer(c.resp);
+  unsigned long now = millis();
+  size_t leftover = c.reqLen - c.reqConsumed;
+  if (leftover > 0) {
+    // Pipelined request already received
+    memmove(c.req->data, c.req->data + c.reqConsumed, leftover);
+    c.reqLen = leftover;
+    c.reqConsumed = 0;
+    c.state = HTTP_CONN_READING;
+  } else {
+    releaseBuffer(c.req);
+    c.reqLen = 0;
+    c.reqConsumed = 0;
+    c.state = HTTP_CONN_IDLE;
+  }
+  c.stateSinceMs = now;
+  return true;
+}
+
+// Send buffered output, queued buffers first. With wait, stay until all of
+// it is out; used inside a handler, and given up (failing the response) when
+// the client stalls or the handler has spent HTTP_HANDLER_WRITE_MS here.
+bool HttpServer::flushResponse(HttpConnection& c, bool wait) {
+  for (;;) {
+    const char* data = c.queuedCount > 0 ? c.queued[0]->data : c.resp->data;
+    size_t len = c.queuedCount > 0 ? HTTP_BUFFER_SIZE : c.respLen;
+    if (c.respSent == len) {
+      if (c.queuedCount == 0) break;
+      releaseBuffer(c.queued[0]);
+      c.queuedCount--;
+      memmove(c.queued, c.queued + 1, c.queuedCount * sizeof(c.queued[0]));
+      c.respSent = 0;
+      continue;
+    }
+    ssize_t n = ::send(c.client.fd(), data + c.respSent, len - c.respSent, HTTP_SEND_FLAGS);
+    if (n > 0) {
+      c.respSent += (size_t)n;
+      c.lastProgressMs = millis();
+      continue;
+    }
+    if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+      if (!wait) return true;
+      unsigned long now = millis();
+      if (now - c.lastProgressMs >= HTTP_WRITE_STALL_MS || now - handlerStartMs_ >= HTTP_HANDLER_WRITE_MS) {
+        failed_ = true;
+        return false;
+      }
+      delay(1);
+      continue;
+    }
+    failed_ = true;
+    return false;
+  }
+  c.respLen = 0;
+  c.respSent = 0;
+  return true;
+}
+
+// Move the full response buffer to the send queue and start a fresh one.
+// Leaves at least one pool buffer free so other requests can still be read.
+bool HttpServer::queueResponseBuffer(HttpConnection& c) {
+  if (c.queuedCount == HTTP_MAX_QUEUED_BUFFERS || stats_.buffersInUse + 1 >= HTTP_BUFFER_COUNT) {
+    return false;
+  }
+  HttpBuffer* next = acquireBuffer();
+  if (next == nullptr) return false;
+  c.queued[c.queuedCount++] = c.resp;
+  c.resp = next;
+  c.respLen = 0;
+  return true;
+}
+
+// ---------------------------------------------------------------------------
+// Request accessors
+// ---------------------------------------------------------------------------
+
+String HttpServer::uri() const {
+  return String(path_);
+}
+
+String HttpServer::pathArg(unsigned int i) const {
+  String value;
+  if (i < pathArgCount_) value.concat(pathArgs_[i], pathArgLengths_[i]);
+  return value;
+}
+
+WiFiClient& HttpServer::client() {
+  // Whatever the handler writes directly must follow what it already sent
+  if (current_ != nullptr && (current_->queuedCount > 0 || current_->respLen > 0)) {
+    flushResponse(*current_, true);
+  }
+  return current_ != nullptr ? current_->client : conns_[0].client;
+}
+
+// Walks query args, then form body args, then "plain" (the raw body).
+// Stops at the arg named `name`, or the index-th arg when name is null;
+// otherwise stores the number of args in *count.
+bool HttpServer::findArg(int index, const char* name, String* key, String* value, int* count) const {
+  int n = 0;
+  const char* regions[2] = {query_, formBody_ ? body_ : nullptr};
+  size_t lengths[2] = {strlen(query_), formBody_ ? bodyLength_ : 0};
+  for (uint8_t r = 0; r < 2; r++) {
+    const char* p = regions[r];
+    if (p == nullptr) continue;
+    const char* end = p + lengths[r];
+    while (p < end) {
+      const char* amp = static_cast<const char*>(memchr(p, '&', end - p));
+      if (amp == nullptr) amp = end;
+      if (amp > p) {
+        const char* eq = static_cast<const char*>(memchr(p, '=', amp - p));
+        const char* keyEnd = eq != nullptr ? eq : amp;
+        String k;
+        urlDecodeInto(k, p, keyEnd - p);
+        if (name != nullptr ? k == name : n == index) {
+          if (key != nullptr) *key = k;
+          if (value != nullptr && eq != nullptr) urlDecodeInto(*value, eq + 1, amp - eq - 1);
+          return true;
+        }
+        n++;
+      }
+      p = amp + 1;
+    }
+  }
+  if (bodyLength_ > 0) {
+    if (name != nullptr ? strcmp(name, "plain") == 0 : n == index) {
+      if (key != nullptr) *key = "plain";
+      if (value != nullptr) value->concat(body_, bodyLength_);
+      return true;
+    }
+    n++;
+  }
+  if (count != nullptr) *count = n;
+  return false;
+}
+
+String HttpServer::arg(const String& name) const {
+  String value;
+  findArg(-1, name.c_str(), nullptr, &value, nullptr);
+  return value;
+}
+
+String HttpServer::arg(int i) const {
+  String value;
+  if (i >= 0) findArg(i, nullptr, nullptr, &value, nullptr);
+  return value;
+}
+
+String HttpServer::argName(int i) const {
+  String key;
+  if (i >= 0) findArg(i, nullptr, &key, nullptr, nullptr);
+  return key;
+}
+
+int HttpServer::args() const {
+  int count = 0;
+  findArg(-1, nullptr, nullptr, nullptr, &count);
+  return count;
+}
+
+bool HttpServer::hasArg(const String& name) const {
+  return findArg(-1, name.c_str(), nullptr, nullptr, nullptr);
+}
+
+String HttpServer::header(const String& name) const {
+  String value;
+  size_t len;
+  const char* v = headers_ != nullptr ? findHeader(headers_, headersEnd_, name.c_str(), &len) : nullptr;
+  if (v != nullptr) value.concat(v, len);
+  return value;
+}
+
+bool HttpServer::hasHeader(const String& name) const {
+  size_t len;
+  return headers_ != nullptr && findHeader(headers_, headersEnd_, name.c_str(), &len) != nullptr;
+}
+
+// ---------------------------------------------------------------------------
+// Response
+// ---------------------------------------------------------------------------
+
+void HttpServer::append(const char* data, size_t length) {
+  HttpConnection& c = *current_;
+  while (length > 0 && !failed_) {
+    if (c.respLen == HTTP_BUFFER_SIZE) {
+      // Whatever the socket takes now, then queue; wait only when the pool is spent
+      if (!flushResponse(c, false)) return;
+      if (c.respLen == HTTP_BUFFER_SIZE && !queueResponseBuffer(c) && !flushResponse(c, true)) return;
+    }
+    size_t n = HTTP_BUFFER_SIZE - c.respLen;
+    if (n > length) n = length;
+    memcpy(c.resp->data + c.respLen, data, n);
+    c.respLen += n;
+    data += n;
+    length -= n;
+  }
+}
+
+void HttpServer::sendHeader(const char* name, const char* value, bool first) {
+  size_t nameLen = strlen(name);
+  size_t valueLen = strlen(value);
+  size_t lineLen = nameLen + valueLen + 4;
+  if (pendingLen_ + lineLen > HTTP_MAX_PENDING_HEADERS) {
+    LOG_W(LOG_MOD_WEB, "Header %s dropped (header buffer full)", name);
+    return;
+  }
+  char* line = pendingHeaders_ + pendingLen_;
+  if (first) {
+    memmove(pendingHeaders_ + lineLen, pendingHeaders_, pendingLen_);
+    line = pendingHeaders_;
+  }
+  memcpy(line, name, nameLen);
+  memcpy(line + nameLen, ": ", 2);
+  memcpy(line + nameLen + 2, value, valueLen);
+  memcpy(line + nameLen + 2 + valueLen, "\r\n", 2);
+  pendingLen_ += lineLen;
+}
+
+void HttpServer::writeHeaders(int code, const char* contentType, size_t length) {
+  HttpConnection& c = *current_;
+  if (contentLength_ != CONTENT_LENGTH_NOT_SET) length = contentLength_;
+  if (length == CONTENT_LENGTH_UNKNOWN) {
+    if (http10_) {
+      c.keepAlive = false;  // no chunked encoding in HTTP/1.0; close ends the body
+    } else {
+      chunked_ = true;
+    }
+  }
+
+  char line[96];
+  int n = snprintf(line, sizeof(line), "HTTP/1.1 %d %s\r\n", code, statusText(code));
+  append(line, (size_t)n);
+  if (contentType != nullptr && contentType[0] != '\0') {
+    n = snprintf(line, sizeof(line), "Content-Type: %s\r\n", contentType);
+    append(line, (size_t)n);
+  }
+  if (chunked_) {
+    append("Transfer-Encoding: chunked\r\n", 28);
+  } else if (length != CONTENT_LENGTH_UNKNOWN) {
+    n = snprintf(line, sizeof(line), "Content-Length: %lu\r\n", (unsigned long)length);
+    append(line, (size_t)n);
+  }
+  append(pendingHeaders_, pendingLen_);
+  pendingLen_ = 0;
+  if (c.keepAlive) {
+    n = snprintf(line, sizeof(line), "Connection: keep-alive\r\nKeep-Alive: timeout=%lu, max=%u\r\n\r\n",
+                 HTTP_KEEPALIVE_TIMEOUT_MS / 1000UL, (unsigned)(HTTP_KEEPALIVE_MAX_REQUESTS - c.requests));
+    append(line, (size_t)n);
+  } else {
+    append("Connection: close\r\n\r\n", 21);
+  }
+  headersSent_ = true;
+}
+
+void HttpServer::send(int code, const char* contentType, const char* content, size_t length) {
+  if (current_ == nullptr || headersSent_) return;
+  writeHeaders(code, contentType, length);
+  if (method_ == HTTP_HEAD || content == nullptr || length == CONTENT_LENGTH_UNKNOWN || length == 0) return;
+  if (chunked_) {
+    sendContent(content, length);
+  } else {
+    append(content, length);
+  }
+}
+
+void HttpServer::sendContent(const char* content, size_t length) {
+  if (current_ == nullptr || !headersSent_ || method_ == HTTP_HEAD) return;
+  if (!chunked_) {
+    append(content, length);
+    return;
+  }
+  char size[12];
+  int n = snprintf(size, sizeof(size), "%x\r\n", (unsigned)length);
+  append(size, (size_t)n);
+  append(content, length);
+  append("\r\n", 2);
+  if (length == 0) chunked_ = false;  // terminator sent
+}
+
+void HttpServer::sendStatic(int code, const char* contentType, const uint8_t* body, size_t length) {
+  if (current_ == nullptr || headersSent_) return;
+  contentLength_ = length;
+  writeHeaders(code, contentType, length);
+  if (method_ == HTTP_HEAD) return;
+  current_->staticBody = body;
+  current_->staticLen = length;
+  current_->staticSent = 0;
+}
+
+int8_t HttpServer::upgradeConnection() {
+  if (current_ == nullptr) return -1;
+  HttpConnection& c = *current_;
+  if (c.queuedCount > 0 || c.respLen > 0) flushResponse(c, true);
+  releaseBuffer(c.req);
+  releaseBuffer(c.resp);
+  releaseQueued(c);
+  c.state = HTTP_CONN_UPGRADED;
+  return (int8_t)(current_ - conns_);
+}
+
+void HttpServer::closeUpgraded(int8_t id) {
+  if (id >= 0 && id < HTTP_MAX_CONNECTIONS && conns_[id].state == HTTP_CONN_UPGRADED) {
+    closeConnection(conns_[id]);
+  }
+}
+
+const HttpServerStats& HttpServer::stats() {
+  return stats_;
+}
+
+// ---------------------------------------------------------------------------
+// SocketBacklog
+// ---------------------------------------------------------------------------
+
+bool SocketBacklog::flush(int fd) {
+  while (len_ > 0) {
+    ssize_t n = ::send(fd, data_, len_, HTTP_SEND_FLAGS);
+    if (n > 0) {
+      len_ -= (size_t)n;
+      memmove(data_, data_ + n, len_);
+      continue;
+    }
+    return n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK);
+  }
+  return true;
+}
+
+bool SocketBacklog::write(int fd, const void* data, size_t len) {
+  if (!flush(fd)) return false;
+  const uint8_t* p = static_cast<const uint8_t*>(data);
+  if (len_ == 0) {
+    // Nothing queued ahead of it: try the socket directly
+    while (len > 0) {
+      ssize_t n = ::send(fd, p, len, HTTP_SEND_FLAGS);
+      if (n > 0) {
+        p += n;
+        len -= (size_t)n;
+        continue;
+      }
+      if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+      return false;
+    }
+  }
+  if (len > sizeof(data_) - len_) return false;
+  memcpy(data_ + len_, p, len);
+  len_ += len;
+  return true;
+}
+
+#endif // ENABLE_WEBSERVER
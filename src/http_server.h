@@ -0,0 +1,250 @@
+#ifndef HTTP_SERVER_H
+#define HTTP_SERVER_H
+
+#ifdef ENABLE_WEBSERVER
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include <WebServer.h>  // HTTPMethod, CONTENT_LENGTH_UNKNOWN
+
+// Event-driven HTTP/1.1 server. handleClient() is called every loop pass
+// and never blocks on a slow client. Each connection has its own state
+// machine: read request -> run handler -> write response -> idle
+// (keep-alive) or close.
+//
+// - Up to HTTP_MAX_CONNECTIONS sockets at once. Past that, an idle
+//   keep-alive connection is evicted, or the newcomer gets a 503.
+// - Request and response buffers come from a fixed pool of
+//   HTTP_BUFFER_COUNT. Idle keep-alive connections hold none. A request
+//   that can't get a buffer waits for the next pass.
+// - Handlers use the same calls as the ESP32 core WebServer (send,
+//   sendHeader, sendContent, arg, header, ...). Output goes to the
+//   connection's response buffer and is sent from the loop. When it fills,
+//   the full buffer is queued behind the socket and another comes from the
+//   pool (up to HTTP_MAX_QUEUED_BUFFERS, always leaving one free for other
+//   requests). Only output beyond that is flushed from inside the handler,
+//   for at most HTTP_HANDLER_WRITE_MS per handler; past that the response
+//   is dropped.
+// - Routes come from one constant table (setRoutes). Patterns may hold
+//   {name} segments, read back with pathArg(). CORS preflight (OPTIONS) is
+//   answered for every route whose policy allows it.
+// - sendStatic() sends a body straight from flash without copying it.
+// - A handler that sends nothing has taken over client() (e.g. the /events
+//   stream). The slot is released without closing the socket. The owner
+//   writes through a SocketBacklog so a slow reader never blocks the loop.
+// - upgradeConnection() keeps a switched-protocol socket (WebSocket) in its
+//   slot, so it still counts toward HTTP_MAX_CONNECTIONS. The server stops
+//   reading it; the owner frees the slot with closeUpgraded().
+
+#define HTTP_MAX_CONNECTIONS 4
+#define HTTP_BUFFER_COUNT 6
+#define HTTP_BUFFER_SIZE 1536
+#define HTTP_MAX_ROUTES 24
+#define HTTP_MAX_PATH_ARGS 2
+#define HTTP_MAX_PENDING_HEADERS 384      // sendHeader() text for one response
+#define HTTP_REQUEST_TIMEOUT_MS 3000UL    // to receive a complete request
+#define HTTP_KEEPALIVE_TIMEOUT_MS 5000UL  // idle time before a kept-alive socket is closed
+#define HTTP_KEEPALIVE_MAX_REQUESTS 100
+#define HTTP_WRITE_STALL_MS 1000UL        // a response that makes no progress this long is dropped
+#define HTTP_MAX_QUEUED_BUFFERS 4         // full response buffers waiting behind the socket
+#define HTTP_HANDLER_WRITE_MS 250UL       // time one handler may spend flushing its own output
+#define HTTP_BACKLOG_SIZE 1024            // queued output per taken-over socket (SocketBacklog)
+
+typedef void (*HttpHandler)();
+
+enum HttpCors : uint8_t {
+  HTTP_CORS_NONE = 0,
+  HTTP_CORS_PUBLIC,  // any origin; preflight answered automatically
+};
+
+struct HttpRoute {
+  HTTPMethod method;    // HTTP_ANY matches every method
+  const char* pattern;  // literal path, or with {name} segments: "/alerts/pause/{minutes}"
+  HttpHandler handler;
+  HttpCors cors;
+};
+
+enum HttpConnState : uint8_t {
+  HTTP_CONN_FREE = 0,
+  HTTP_CONN_IDLE,      // open, waiting for the next request (no buffers held)
+  HTTP_CONN_READING,   // receiving request line, headers and body
+  HTTP_CONN_WRITING,   // handler done; response going out
+  HTTP_CONN_UPGRADED,  // handed to another protocol; see upgradeConnection()
+};
+
+struct HttpBuffer {
+  char data[HTTP_BUFFER_SIZE];
+  bool inUse;
+};
+
+struct HttpConnection {
+  WiFiClient client;
+  HttpConnState state;
+  HttpBuffer* req;
+  HttpBuffer* resp;
+  HttpBuffer* queued[HTTP_MAX_QUEUED_BUFFERS];  // full response buffers, sent before resp
+  uint8_t queuedCount;
+  size_t reqLen;          // bytes received into req
+  size_t reqConsumed;     // bytes of req belonging to the request being served
+  size_t respLen;
+  size_t respSent;        // into queued[0] while any are queued, else into resp
+  const uint8_t* staticBody;  // sendStatic(): sent after resp, straight from flash
+  size_t staticLen;
+  size_t staticSent;
+  unsigned long stateSinceMs;
+  unsigned long lastProgressMs;
+  uint16_t requests;
+  bool keepAlive;
+};
+
+struct HttpServerStats {
+  unsigned long accepted;
+  unsigned long requests;
+  unsigned long keepAliveReuses;  // requests served on an already-used connection
+  unsigned long rejected;         // 503: no connection slot
+  unsigned long timeouts;
+  unsigned long bufferWaits;      // passes a request waited for a pool buffer
+  uint8_t activeConnections;
+  uint8_t peakConnections;
+  uint8_t buffersInUse;
+  uint8_t peakBuffersInUse;
+};
+
+// Output queue for a socket a handler has taken over (/events, /ws). write()
+// never blocks: bytes the socket will not take now wait here and go out on
+// later flush() calls. Both return false once the socket has failed, and
+// write() also when the queue would overflow; the owner then drops the client.
+class SocketBacklog {
+ public:
+  bool write(int fd, const void* data, size_t len);
+  bool flush(int fd);
+  bool empty() const { return len_ == 0; }
+  void clear() { len_ = 0; }
+
+ private:
+  uint8_t data_[HTTP_BACKLOG_SIZE];
+  size_t len_ = 0;
+};
+
+class HttpServer {
+ public:
+  explicit HttpServer(uint16_t port = 80);
+
+  void begin();
+  void handleClient();
+
+  // Table must outlive the server (normally a static const array)
+  void setRoutes(const HttpRoute* routes, uint8_t count);
+  void onNotFound(HttpHandler handler) { notFound_ = handler; }
+
+  // Current request
+  String uri() const;
+  String pathArg(unsigned int i) const;  // i-th {name} segment of the matched pattern
+  HTTPMethod method() const { return method_; }
+  WiFiClient& client();
+  String arg(const String& name) const;
+  String arg(int i) const;
+  String argName(int i) const;
+  int args() const;
+  bool hasArg(const String& name) const;
+  String header(const String& name) const;  // any request header; nothing to collect up front
+  bool hasHeader(const String& name) const;
+
+  // Response
+  void sendHeader(const char* name, const char* value, bool first = false);
+  void sendHeader(const String& name, const String& value, bool first = false) {
+    sendHeader(name.c_str(), value.c_str(), first);
+  }
+  void setContentLength(size_t length) { contentLength_ = length; }
+  void send(int code) { send(code, nullptr, "", 0); }
+  void send(int code, const char* contentType, const String& content) {
+    send(code, contentType, content.c_str(), content.length());
+  }
+  void send(int code, const char* contentType, const char* content) {
+    send(code, contentType, content, strlen(content));
+  }
+  void send(int code, const char* contentType, const char* content, size_t length);
+  void send(int code, const char* contentType, const __FlashStringHelper* content) {
+    send(code, contentType, reinterpret_cast<const char*>(content));
+  }
+  void send_P(int code, const char* contentType, const char* content, size_t length) {
+    send(code, contentType, content, length);
+  }
+  void sendContent(const String& content) { sendContent(content.c_str(), content.length()); }
+  void sendContent(const char* content, size_t length);
+  void sendStatic(int code, const char* contentType, const uint8_t* body, size_t length);
+
+  // Call from a handler once its 101 response has been written to client().
+  // Returns the slot id for closeUpgraded().
+  int8_t upgradeConnection();
+  void closeUpgraded(int8_t id);
+
+  const HttpServerStats& stats();
+
+ private:
+  // Literal patterns, sorted by hash of the path
+  struct RouteHash {
+    uint32_t hash;
+    uint8_t route;
+  };
+
+  void acceptConnections();
+  void service(HttpConnection& c);
+  bool readRequest(HttpConnection& c);
+  void dispatch(HttpConnection& c);
+  const HttpRoute* matchRoute(HTTPMethod method, uint16_t* allowMask);
+  bool matchPattern(const char* pattern);
+  void sendPreflight(uint16_t allowMask);
+  bool parseRequest(HttpConnection& c);
+  bool writeResponse(HttpConnection& c);
+  void finishResponse(HttpConnection& c);
+  void closeConnection(HttpConnection& c);
+  void writeHeaders(int code, const char* contentType, size_t length);
+  void append(const char* data, size_t length);
+  bool queueResponseBuffer(HttpConnection& c);
+  bool flushResponse(HttpConnection& c, bool wait);
+  void releaseQueued(HttpConnection& c);
+  HttpBuffer* acquireBuffer();
+  void releaseBuffer(HttpBuffer*& buffer);
+  bool findArg(int index, const char* name, String* key, String* value, int* count) const;
+
+  WiFiServer listener_;
+  const HttpRoute* routes_ = nullptr;
+  uint8_t routeCount_ = 0;
+  RouteHash literalIndex_[HTTP_MAX_ROUTES];
+  uint8_t literalCount_ = 0;
+  uint8_t patternRoutes_[HTTP_MAX_ROUTES];  // routes with {name} segments
+  uint8_t patternCount_ = 0;
+  HttpHandler notFound_ = nullptr;
+  HttpConnection conns_[HTTP_MAX_CONNECTIONS];
+  HttpBuffer buffers_[HTTP_BUFFER_COUNT];
+  HttpServerStats stats_;
+
+  // Request being handled; points into its connection's request buffer
+  HttpConnection* current_ = nullptr;
+  HTTPMethod method_ = HTTP_GET;
+  const char* path_ = "";
+  const char* query_ = "";
+  const char* headers_ = nullptr;  // raw header lines, [headers_, headersEnd_)
+  const char* headersEnd_ = nullptr;
+  const char* body_ = "";
+  size_t bodyLength_ = 0;
+  const char* pathArgs_[HTTP_MAX_PATH_ARGS];
+  uint8_t pathArgLengths_[HTTP_MAX_PATH_ARGS];
+  uint8_t pathArgCount_ = 0;
+  bool formBody_ = false;
+  bool http10_ = false;
+
+  // Response being built
+  char pendingHeaders_[HTTP_MAX_PENDING_HEADERS];
+  size_t pendingLen_ = 0;
+  size_t contentLength_ = CONTENT_LENGTH_NOT_SET;
+  bool headersSent_ = false;
+  bool chunked_ = false;
+  bool failed_ = false;  // response could not be written; connection is dropped
+  unsigned long handlerStartMs_ = 0;
+};
+
+#endif // ENABLE_WEBSERVER
+
+#endif // HTTP_SERVER_H
@@ -0,0 +1,231 @@
+#include "icmp_echo.h"
+#include <IPAddress.h>
+#include <lwip/sockets.h>
+#include <lwip/dns.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <stddef.h>
+#include <string.h>
+
+#define ICMP_TYPE_ECHO_REPLY 0
+#define ICMP_TYPE_ECHO_REQUEST 8
+
+// Echo header as on the wire (RFC 792); multi-byte fields in network order
+struct IcmpEchoHeader {
+  uint8_t type;
+  uint8_t code;
+  uint16_t checksum;
+  uint16_t id;
+  uint16_t seq;
+};
+
+static uint16_t checksum(const uint8_t* data, size_t len) {
+  uint32_t sum = 0;
+  for (size_t i = 0; i + 1 < len; i += 2) {
+    sum += (uint32_t)(data[i] << 8 | data[i + 1]);
+  }
+  if (len & 1) {
+    sum += (uint32_t)data[len - 1] << 8;
+  }
+  while (sum >> 16) {
+    sum = (sum & 0xFFFF) + (sum >> 16);
+  }
+  return htons((uint16_t)~sum);
+}
+
+static void closeSocket(IcmpEchoBurst& burst) {
+  if (burst.sock >= 0) {
+    close(burst.sock);
+    burst.sock = -1;
+  }
+}
+
+static IcmpEchoPhase fail(IcmpEchoBurst& burst, int code) {
+  closeSocket(burst);
+  burst.error = code;
+  burst.phase = ICMP_FAILED;
+  return burst.phase;
+}
+
+// lwIP DNS completion (runs in the tcpip task). Lookups are not cancelled,
+// so drop an answer unless it is for the lookup this burst still waits on.
+static void dnsFoundCallback(const char* name, const ip_addr_t* ipaddr, void* arg) {
+  IcmpEchoBurst* burst = static_cast<IcmpEchoBurst*>(arg);
+  if (burst->phase != ICMP_RESOLVE || burst->dnsDone || name == nullptr || strcmp(name, burst->host) != 0) {
+    return;
+  }
+  burst->addr = ipaddr ? ip4_addr_get_u32(ip_2_ip4(ipaddr)) : 0;
+  burst->dnsDone = true;
+}
+
+bool icmpEchoBegin(IcmpEchoBurst& burst, const char* host, uint8_t count, uint16_t spacingMs,
+                   unsigned long timeoutMs) {
+  if (burst.phase != ICMP_IDLE) {
+    closeSocket(burst);
+  }
+  burst.sock = -1;
+  burst.addr = 0;
+  burst.dnsDone = false;
+  burst.count = count < ICMP_ECHO_MAX_BURST ? count : ICMP_ECHO_MAX_BURST;
+  burst.spacingMs = spacingMs;
+  burst.timeoutMs = timeoutMs;
+  burst.id = (uint16_t)(micros() ^ (micros() >> 16));
+  burst.sent = 0;
+  burst.error = 0;
+  burst.replied = 0;
+  burst.startMs = millis();
+  burst.host[0] = '\0';  // no late answer for the previous host matches
+  burst.phase = ICMP_RESOLVE;
+
+  size_t len = host ? strlen(host) : 0;
+  if (len == 0 || len >= sizeof(burst.host)) {
+    fail(burst, ICMP_ERR_RESOLVE);
+    return false;
+  }
+  memcpy(burst.host, host, len + 1);
+
+  IPAddress literal;
+  if (literal.fromString(burst.host)) {
+    burst.addr = (uint32_t)literal;
+    burst.dnsDone = true;
+    return true;
+  }
+  ip_addr_t cached;
+  err_t err = dns_gethostbyname(burst.host, &cached, dnsFoundCallback, &burst);
+  if (err == ERR_OK) {
+    burst.addr = ip4_addr_get_u32(ip_2_ip4(&cached));
+    burst.dnsDone = true;
+  } else if (err != ERR_INPROGRESS) {
+    fail(burst, ICMP_ERR_RESOLVE);
+    return false;
+  }
+  return true;
+}
+
+static IcmpEchoPhase stepResolve(IcmpEchoBurst& burst) {
+  if (!burst.dnsDone) {
+    return burst.phase;
+  }
+  if (burst.addr == 0) {
+    return fail(burst, ICMP_ERR_RESOLVE);
+  }
+  burst.sock = socket(AF_INET, SOCK_RAW, IPPROTO_ICMP);
+  if (burst.sock < 0) {
+    return fail(burst, ICMP_ERR_SOCKET);
+  }
+  fcntl(burst.sock, F_SETFL, fcntl(burst.sock, F_GETFL, 0) | O_NONBLOCK);
+  burst.phase = ICMP_SENDING;
+  return burst.phase;
+}
+
+static bool sendRequest(IcmpEchoBurst& burst) {
+  uint8_t packet[sizeof(IcmpEchoHeader) + ICMP_ECHO_PAYLOAD];
+  IcmpEchoHeader hdr = {ICMP_TYPE_ECHO_REQUEST, 0, 0, htons(burst.id), htons(burst.sent)};
+  memcpy(packet, &hdr, sizeof(hdr));
+  for (uint8_t i = 0; i < ICMP_ECHO_PAYLOAD; i++) {
+    packet[sizeof(hdr) + i] = (uint8_t)('a' + i % 26);
+  }
+  uint16_t sum = checksum(packet, sizeof(packet));
+  memcpy(packet + offsetof(IcmpEchoHeader, checksum), &sum, sizeof(sum));
+
+  struct sockaddr_in sa;
+  memset(&sa, 0, sizeof(sa));
+  sa.sin_family = AF_INET;
+  sa.sin_addr.s_addr = burst.addr;
+  burst.sentUs[burst.sent] = micros();
+  ssize_t n = sendto(burst.sock, packet, sizeof(packet), MSG_DONTWAIT, (struct sockaddr*)&sa, sizeof(sa));
+  if (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK) {
+    return false;
+  }
+  // A full send buffer just loses this request, which is what loss means
+  burst.lastSendMs = millis();
+  burst.sent++;
+  return true;
+}
+
+// Drain every datagram waiting on the socket. The raw socket sees all ICMP
+// traffic, IP header included; only our own echo replies count.
+static void receiveReplies(IcmpEchoBurst& burst) {
+  uint8_t buf[128];
+  for (;;) {
+    struct sockaddr_in from;
+    socklen_t fromLen = sizeof(from);
+    ssize_t n = recvfrom(burst.sock, buf, sizeof(buf), MSG_DONTWAIT, (struct sockaddr*)&from, &fromLen);
+    if (n <= 0) {
+      return;
+    }
+    uint32_t now = micros();
+    size_t ipLen = (size_t)(buf[0] & 0x0F) * 4;
+    if ((size_t)n < ipLen + sizeof(IcmpEchoHeader) || from.sin_addr.s_addr != burst.addr) {
+      continue;
+    }
+    IcmpEchoHeader hdr;
+    memcpy(&hdr, buf + ipLen, sizeof(hdr));
+    uint16_t seq = ntohs(hdr.seq);
+    if (hdr.type != ICMP_TYPE_ECHO_REPLY || ntohs(hdr.id) != burst.id || seq >= burst.sent ||
+        (burst.replied & (1UL << seq))) {
+      continue;
+    }
+    uint32_t rtt = now - burst.sentUs[seq];
+    if (rtt > burst.timeoutMs * 1000UL) {
+      continue;  // too late: counted as lost
+    }
+    burst.replied |= 1UL << seq;
+    burst.rttUs[seq] = rtt;
+  }
+}
+
+IcmpEchoPhase icmpEchoStep(IcmpEchoBurst& burst) {
+  switch (burst.phase) {
+    case ICMP_RESOLVE:
+      if (!burst.dnsDone) {
+        return millis() - burst.startMs >= burst.timeoutMs ? fail(burst, ICMP_ERR_RESOLVE) : burst.phase;
+      }
+      return stepResolve(burst);
+    case ICMP_SENDING:
+      receiveReplies(burst);
+      if (burst.sent == 0 || millis() - burst.lastSendMs >= burst.spacingMs) {
+        if (!sendRequest(burst)) {
+          return fail(burst, ICMP_ERR_SEND);
+        }
+        if (burst.sent >= burst.count) {
+          burst.phase = ICMP_WAITING;
+        }
+      }
+      return burst.phase;
+    case ICMP_WAITING: {
+      receiveReplies(burst);
+      if (burst.replied == (1UL << burst.count) - 1 || millis() - burst.lastSendMs >= burst.timeoutMs) {
+        closeSocket(burst);
+        burst.phase = ICMP_DONE;
+      }
+      return burst.phase;
+    }
+    default:
+      return burst.phase;
+  }
+}
+
+bool icmpEchoBusy(const IcmpEchoBurst& burst) {
+  return burst.phase != ICMP_IDLE && burst.phase != ICMP_DONE && burst.phase != ICMP_FAILED;
+}
+
+void icmpEchoAbort(IcmpEchoBurst& burst) {
+  // An idle burst holds no socket; a zero-initialised one has sock 0,
+  // which must not be closed
+  if (burst.phase == ICMP_IDLE) {
+    return;
+  }
+  closeSocket(burst);
+  burst.phase = ICMP_IDLE;
+}
+
+const char* icmpEchoErrorString(int code) {
+  switch (code) {
+    case ICMP_ERR_RESOLVE: return "resolve failed";
+    case ICMP_ERR_SOCKET:  return "no raw socket";
+    case ICMP_ERR_SEND:    return "send failed";
+  }
+  return "unknown error";
+}
@@ -0,0 +1,66 @@
+#ifndef ICMP_ECHO_H
+#define ICMP_ECHO_H
+
+#include <Arduino.h>
+
+// Non-blocking ICMP echo bursts over a raw socket, advanced from loop() like
+// async_http. A burst sends count echo requests spacingMs apart and collects
+// replies as they arrive, matched by identifier and sequence number. One
+// request is 36 bytes on the wire before IP, against a full TCP handshake
+// and HTTP exchange per HTTP sample, and a missing reply is a lost packet.
+
+enum IcmpEchoPhase : uint8_t {
+  ICMP_IDLE = 0,
+  ICMP_RESOLVE,
+  ICMP_SENDING,   // requests still going out; replies collected meanwhile
+  ICMP_WAITING,   // all sent; waiting out the timeout for late replies
+  ICMP_DONE,
+  ICMP_FAILED
+};
+
+#define ICMP_ECHO_MAX_BURST 20
+#define ICMP_ECHO_PAYLOAD 28   // 8-byte header + payload = 36 bytes
+
+#define ICMP_ERR_RESOLVE (-1)  // name did not resolve
+#define ICMP_ERR_SOCKET  (-2)  // raw socket unavailable
+#define ICMP_ERR_SEND    (-3)
+
+struct IcmpEchoBurst {
+  // Target
+  char host[64];
+  uint32_t addr;               // resolved IPv4, network byte order
+  uint8_t count;
+  uint16_t spacingMs;
+  unsigned long timeoutMs;     // resolve budget, and reply budget per request
+
+  // State machine
+  IcmpEchoPhase phase;
+  int sock;
+  volatile bool dnsDone;       // set from the lwIP DNS callback
+  unsigned long startMs;
+  uint16_t id;
+  uint8_t sent;
+  unsigned long lastSendMs;
+  uint32_t sentUs[ICMP_ECHO_MAX_BURST];
+
+  // Result: rttUs[i] for each reply, replied bit i set when it arrived
+  int error;                   // ICMP_ERR_* once ICMP_FAILED
+  uint32_t replied;
+  uint32_t rttUs[ICMP_ECHO_MAX_BURST];
+};
+
+// Start resolving host (name or dotted quad). count is capped at
+// ICMP_ECHO_MAX_BURST. Returns false (ICMP_FAILED) if it cannot start.
+bool icmpEchoBegin(IcmpEchoBurst& burst, const char* host, uint8_t count, uint16_t spacingMs,
+                   unsigned long timeoutMs);
+
+// Send what is due and read what has arrived, without blocking. Returns the
+// phase after the step; ICMP_DONE / ICMP_FAILED are terminal.
+IcmpEchoPhase icmpEchoStep(IcmpEchoBurst& burst);
+
+bool icmpEchoBusy(const IcmpEchoBurst& burst);
+void icmpEchoAbort(IcmpEchoBurst& burst);
+
+const char* icmpEchoErrorString(int code);
+
+#endif
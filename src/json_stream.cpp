@@ -0,0 +1,149 @@
+#include "json_stream.h"
+#include <stdarg.h>
+
+size_t BufferedStreamPrint::write(uint8_t c) {
+  if (len_ == sizeof(buf_)) flushBuffer();
+  buf_[len_++] = c;
+  return 1;
+}
+
+size_t BufferedStreamPrint::write(const uint8_t* data, size_t size) {
+  size_t remaining = size;
+  while (remaining > 0) {
+    if (len_ == sizeof(buf_)) flushBuffer();
+    size_t n = sizeof(buf_) - len_;
+    if (n > remaining) n = remaining;
+    memcpy(buf_ + len_, data, n);
+    len_ += n;
+    data += n;
+    remaining -= n;
+  }
+  return size;
+}
+
+bool BufferedStreamPrint::flushBuffer() {
+  if (len_ > 0) {
+    // Keep accepting bytes after a failure so the serializer runs to the end;
+    // callers check ok()
+    if (ok_ && !sink(buf_, len_)) ok_ = false;
+    len_ = 0;
+  }
+  return ok_;
+}
+
+size_t jsonEscapeChar(char c, char out[6]) {
+  switch (c) {
+    case '"':  out[0] = '\\'; out[1] = '"';  return 2;
+    case '\\': out[0] = '\\'; out[1] = '\\'; return 2;
+    case '\n': out[0] = '\\'; out[1] = 'n';  return 2;
+    case '\r': out[0] = '\\'; out[1] = 'r';  return 2;
+    case '\t': out[0] = '\\'; out[1] = 't';  return 2;
+    default:
+      if ((unsigned char)c < 0x20) {
+        static const char hex[] = "0123456789ABCDEF";
+        memcpy(out, "\\u00", 4);
+        out[4] = hex[(unsigned char)c >> 4];
+        out[5] = hex[c & 0x0F];
+        return 6;
+      }
+      out[0] = c;
+      return 1;
+  }
+}
+
+void printJsonString(Print& out, const char* str) {
+  char escaped[6];
+  out.write('"');
+  for (; *str; str++) {
+    out.write(reinterpret_cast<const uint8_t*>(escaped), jsonEscapeChar(*str, escaped));
+  }
+  out.write('"');
+}
+
+bool JsonMessageBuffer::appendf(const char* format, ...) {
+  va_list args;
+  va_start(args, format);
+  int n = vsnprintf(buf_ + len_, size_ - len_, format, args);
+  va_end(args);
+  if (n < 0 || (size_t)n >= size_ - len_) {
+    buf_[len_] = '\0';  // drop the partial write
+    return false;
+  }
+  len_ += (size_t)n;
+  return true;
+}
+
+void JsonMessageBuffer::appendString(const char* str, size_t reserve) {
+  // Both quotes, the caller's reserve and the terminating NUL
+  if (len_ + 2 + reserve + 1 > size_) return;
+  size_t limit = size_ - 1 - reserve - 1;  // latest position of the closing quote
+  char escaped[6];
+  buf_[len_++] = '"';
+  for (; *str; str++) {
+    size_t n = jsonEscapeChar(*str, escaped);
+    if (len_ + n > limit) break;
+    memcpy(buf_ + len_, escaped, n);
+    len_ += n;
+  }
+  buf_[len_++] = '"';
+  buf_[len_] = '\0';
+}
+
+#ifdef ENABLE_WEBSERVER
+
+bool HttpChunkedPrint::begin(int code, const char* contentType) {
+  server_.setContentLength(CONTENT_LENGTH_UNKNOWN);
+  server_.send(code, contentType, "");
+  return server_.method() != HTTP_HEAD;
+}
+
+void HttpChunkedPrint::end() {
+  flushBuffer();
+  server_.sendContent("", 0);  // terminating chunk
+}
+
+bool HttpChunkedPrint::sink(const uint8_t* data, size_t size) {
+  server_.sendContent(reinterpret_cast<const char*>(data), size);
+  return true;
+}
+
+void sendJsonChunked(HttpServer& server, int code, const JsonDocument& doc) {
+  HttpChunkedPrint out(server);
+  if (!out.begin(code, "application/json")) {
+    return;
+  }
+  serializeJson(doc, out);
+  out.end();
+}
+
+#endif // ENABLE_WEBSERVER
+
+#ifdef ENABLE_MQTT
+
+// beginPublish() payload bytes, batched into client.write() calls
+class MqttPayloadPrint : public BufferedStreamPrint {
+ public:
+  explicit MqttPayloadPrint(PubSubClient& client) : client_(client) {}
+
+ protected:
+  bool sink(const uint8_t* data, size_t size) override {
+    return client_.write(data, size) == size;
+  }
+
+ private:
+  PubSubClient& client_;
+};
+
+bool publishJson(PubSubClient& client, const char* topic, const JsonDocument& doc, bool retained) {
+  size_t length = measureJson(doc);
+  if (!client.beginPublish(topic, length, retained)) {
+    return false;
+  }
+  MqttPayloadPrint out(client);
+  serializeJson(doc, out);
+  bool written = out.flushBuffer();
+  // endPublish() must run either way to close out the packet
+  return client.endPublish() == 1 && written;
+}
+
+#endif // ENABLE_MQTT
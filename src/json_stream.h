@@ -0,0 +1,101 @@
+#ifndef JSON_STREAM_H
+#define JSON_STREAM_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+
+// Print adapters that pass serializeJson() output (or any Print output)
+// through a small fixed buffer straight to the transport, instead of
+// building the whole body in a String first. Peak memory per response is
+// JSON_STREAM_BUFFER_SIZE, whatever the document size.
+
+#define JSON_STREAM_BUFFER_SIZE 256
+
+class BufferedStreamPrint : public Print {
+ public:
+  size_t write(uint8_t c) override;
+  size_t write(const uint8_t* data, size_t size) override;
+  using Print::write;
+
+  // Push out whatever is buffered. Returns false once any write has failed.
+  bool flushBuffer();
+  bool ok() const { return ok_; }
+
+ protected:
+  virtual bool sink(const uint8_t* data, size_t size) = 0;
+
+ private:
+  uint8_t buf_[JSON_STREAM_BUFFER_SIZE];
+  size_t len_ = 0;
+  bool ok_ = true;
+};
+
+// Escape one character for a JSON string into out; returns its length
+// (1, 2, or 6 for \u00XX)
+size_t jsonEscapeChar(char c, char out[6]);
+
+// Write str as a quoted, escaped JSON string
+void printJsonString(Print& out, const char* str);
+
+// Hand-built JSON message (or SSE event) in a caller-owned buffer. Nothing is
+// ever written past the end: appendf() output that does not fit whole is
+// dropped, and appendString() shortens the string so the bytes the caller
+// still has to write after it (its closing "}" and framing) always fit.
+class JsonMessageBuffer {
+ public:
+  JsonMessageBuffer(char* buf, size_t size) : buf_(buf), size_(size) { clear(); }
+
+  bool appendf(const char* format, ...) __attribute__((format(printf, 2, 3)));
+  // Quoted and escaped; cut short to leave room for reserve more bytes
+  void appendString(const char* str, size_t reserve);
+
+  void clear() {
+    len_ = 0;
+    buf_[0] = '\0';
+  }
+  const char* data() const { return buf_; }
+  size_t length() const { return len_; }
+
+ private:
+  char* buf_;
+  size_t size_;
+  size_t len_;
+};
+
+#ifdef ENABLE_WEBSERVER
+
+#include "http_server.h"
+
+// Chunked HTTP body: begin() sends the headers with no Content-Length, each
+// buffer flush becomes one chunk, end() sends the terminating chunk.
+class HttpChunkedPrint : public BufferedStreamPrint {
+ public:
+  explicit HttpChunkedPrint(HttpServer& server) : server_(server) {}
+  // Returns false for HEAD requests, which get the headers only
+  bool begin(int code, const char* contentType);
+  void end();
+
+ protected:
+  bool sink(const uint8_t* data, size_t size) override;
+
+ private:
+  HttpServer& server_;
+};
+
+// Send doc as a chunked application/json response
+void sendJsonChunked(HttpServer& server, int code, const JsonDocument& doc);
+
+#endif // ENABLE_WEBSERVER
+
+#ifdef ENABLE_MQTT
+
+#include <PubSubClient.h>
+
+// Two-pass MQTT publish: measureJson() sizes the packet for beginPublish(),
+// then serializeJson() streams the payload. The payload never has to fit
+// the client's packet buffer.
+bool publishJson(PubSubClient& client, const char* topic, const JsonDocument& doc, bool retained);
+
+#endif // ENABLE_MQTT
+
+#endif // JSON_STREAM_H
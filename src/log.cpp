@@ -0,0 +1,88 @@
+#include "log.h"
+#include "telnet.h"
+#include <stdarg.h>
+#include <string.h>
+#include <strings.h>
+
+struct LogModuleInfo {
+  const char* name;  // MQTT command / JSON key
+  const char* tag;   // line prefix, matching the existing "[NET]" style
+};
+
+static const LogModuleInfo MODULES[LOG_MOD_COUNT] = {
+  {"app", nullptr},
+  {"system", "SYSTEM"},
+  {"wifi", "WiFi"},
+  {"dns", "DNS"},
+  {"net", "NET"},
+  {"heartbeat", "Heartbeat"},
+  {"mqtt", "MQTT"},
+  {"web", "WEB"},
+  {"ota", "OTA"},
+  {"config", "CFG"},
+};
+
+static const char* const LEVEL_NAMES[] = {"error", "warn", "info", "debug"};
+static const uint8_t LEVEL_COUNT = sizeof(LEVEL_NAMES) / sizeof(LEVEL_NAMES[0]);
+
+uint8_t logModuleLevels[LOG_MOD_COUNT] = {
+  LOG_LEVEL_DEFAULT, LOG_LEVEL_DEFAULT, LOG_LEVEL_DEFAULT, LOG_LEVEL_DEFAULT, LOG_LEVEL_DEFAULT,
+  LOG_LEVEL_DEFAULT, LOG_LEVEL_DEFAULT, LOG_LEVEL_DEFAULT, LOG_LEVEL_DEFAULT, LOG_LEVEL_DEFAULT,
+};
+
+static_assert(sizeof(logModuleLevels) / sizeof(logModuleLevels[0]) == LOG_MOD_COUNT,
+              "one default level per module");
+
+void logTagged(LogLevel level, LogModule module, const char* format, ...) {
+  if (module >= LOG_MOD_COUNT) module = LOG_MOD_APP;
+  va_list args;
+  va_start(args, format);
+  logWritev(level, module, MODULES[module].tag, format, args);
+  va_end(args);
+  telnetPumpSerial();
+}
+
+static int findLevel(const char* name) {
+  for (uint8_t i = 0; i < LEVEL_COUNT; i++) {
+    if (strcasecmp(name, LEVEL_NAMES[i]) == 0) return i;
+  }
+  return -1;
+}
+
+static int findModule(const char* name) {
+  for (uint8_t i = 0; i < LOG_MOD_COUNT; i++) {
+    if (strcasecmp(name, MODULES[i].name) == 0) return i;
+  }
+  return -1;
+}
+
+bool logSetModuleLevel(const char* moduleName, const char* levelName) {
+  if (moduleName == nullptr || levelName == nullptr) return false;
+  int level = findLevel(levelName);
+  if (level < 0) return false;
+
+  if (strcasecmp(moduleName, "all") == 0) {
+    for (uint8_t i = 0; i < LOG_MOD_COUNT; i++) {
+      logModuleLevels[i] = (uint8_t)level;
+    }
+    return true;
+  }
+  int module = findModule(moduleName);
+  if (module < 0) return false;
+  logModuleLevels[module] = (uint8_t)level;
+  return true;
+}
+
+void logResetLevels() {
+  for (uint8_t i = 0; i < LOG_MOD_COUNT; i++) {
+    logModuleLevels[i] = LOG_LEVEL_DEFAULT;
+  }
+}
+
+const char* logLevelName(uint8_t level) {
+  return level < LEVEL_COUNT ? LEVEL_NAMES[level] : "unknown";
+}
+
+const char* logModuleName(uint8_t module) {
+  return module < LOG_MOD_COUNT ? MODULES[module].name : "unknown";
+}
@@ -0,0 +1,61 @@
+#ifndef LOG_H
+#define LOG_H
+
+#include <Arduino.h>
+#include "log_ring.h"
+
+// Leveled, per-module logging on top of the log ring.
+//   LOG_I(LOG_MOD_NET, "Latency=%.1f ms", latency);
+// writes "[      1234 ms] [NET] Latency=..." to every sink.
+//
+// Two filters apply:
+// - Build time: calls above LOG_LEVEL_MAX are a constant-false branch, so
+//   the call, its arguments and its format string are dropped by the
+//   compiler. Set it with -DLOG_LEVEL_MAX=<0..3>.
+// - Run time: each module has a threshold (default LOG_LEVEL_DEFAULT),
+//   adjustable over MQTT with command/log_level. Arguments are only
+//   evaluated when the line will be written.
+
+#ifndef LOG_LEVEL_MAX
+#define LOG_LEVEL_MAX 2  // LOG_INFO
+#endif
+
+#define LOG_LEVEL_DEFAULT LOG_INFO
+
+template <uint8_t Level>
+struct LogBuildGate {
+  static constexpr bool enabled = Level <= LOG_LEVEL_MAX;
+};
+
+extern uint8_t logModuleLevels[LOG_MOD_COUNT];
+
+inline bool logEnabled(LogModule module, LogLevel level) {
+  return module < LOG_MOD_COUNT && level <= logModuleLevels[module];
+}
+
+#define LOG_AT(level, module, ...)                                        \
+  do {                                                                    \
+    if (LogBuildGate<(level)>::enabled && logEnabled((module), (level))) { \
+      logTagged((level), (module), __VA_ARGS__);                          \
+    }                                                                     \
+  } while (0)
+
+#define LOG_E(module, ...) LOG_AT(LOG_ERROR, module, __VA_ARGS__)
+#define LOG_W(module, ...) LOG_AT(LOG_WARN, module, __VA_ARGS__)
+#define LOG_I(module, ...) LOG_AT(LOG_INFO, module, __VA_ARGS__)
+#define LOG_D(module, ...) LOG_AT(LOG_DEBUG, module, __VA_ARGS__)
+
+// Write "[<millis> ms] [<TAG>] <text>" into the ring and kick the Serial sink.
+// Prefer the LOG_* macros, which apply both filters first.
+void logTagged(LogLevel level, LogModule module, const char* format, ...)
+    __attribute__((format(printf, 3, 4)));
+
+// Runtime thresholds. moduleName may be "all". Levels above LOG_LEVEL_MAX
+// are accepted but have no effect beyond it. Return false on unknown names.
+bool logSetModuleLevel(const char* moduleName, const char* levelName);
+void logResetLevels();
+
+const char* logLevelName(uint8_t level);
+const char* logModuleName(uint8_t module);
+
+#endif
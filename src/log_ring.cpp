@@ -0,0 +1,147 @@
+#include "log_ring.h"
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#define LOG_RING_MASK (LOG_RING_SLOTS - 1)
+
+static_assert((LOG_RING_SLOTS & LOG_RING_MASK) == 0, "LOG_RING_SLOTS must be a power of two");
+
+static LogRecord records[LOG_RING_SLOTS];
+// Per-slot sequence: 0 while a writer owns the slot, else the record's seq.
+// Readers check it before and after copying (seqlock).
+static std::atomic<uint32_t> slotSeq[LOG_RING_SLOTS];
+static std::atomic<uint32_t> headSeq(0);  // last sequence handed out
+static unsigned long truncatedCount = 0;
+static LogRingStats stats = {0, 0};
+
+static inline bool isLineBreak(char c) {
+  return c == '\r' || c == '\n';
+}
+
+void logWritev(LogLevel level, LogModule module, const char* tag, const char* format, va_list args) {
+  uint32_t seq = headSeq.fetch_add(1, std::memory_order_relaxed) + 1;
+  uint32_t idx = seq & LOG_RING_MASK;
+  LogRecord& r = records[idx];
+
+  slotSeq[idx].store(0, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+
+  uint32_t now = millis();
+  size_t prefix = 0;
+  if (tag != nullptr) {
+    int p = snprintf(r.text, sizeof(r.text), "[%10lu ms] [%s] ", (unsigned long)now, tag);
+    prefix = p > 0 ? (size_t)p : 0;
+  }
+  int n = vsnprintf(r.text + prefix, sizeof(r.text) - prefix, format, args);
+  size_t len = prefix;
+  if (n > 0) {
+    len += (size_t)n;
+    if (len >= sizeof(r.text)) {
+      len = sizeof(r.text) - 1;
+      truncatedCount++;
+    }
+  }
+  while (len > 0 && (isLineBreak(r.text[len - 1]) || r.text[len - 1] == ' ')) {
+    len--;
+  }
+  size_t start = 0;
+  while (start < len && isLineBreak(r.text[start])) {
+    start++;
+  }
+  if (start > 0) {
+    len -= start;
+    memmove(r.text, r.text + start, len);
+  }
+  r.text[len] = '\0';
+
+  r.seq = seq;
+  r.timestampMs = now;
+  r.level = level;
+  r.module = module;
+  r.len = (uint16_t)len;
+
+  slotSeq[idx].store(seq, std::memory_order_release);
+}
+
+void logWrite(LogLevel level, LogModule module, const char* format, ...) {
+  va_list args;
+  va_start(args, format);
+  logWritev(level, module, nullptr, format, args);
+  va_end(args);
+}
+
+static uint32_t oldestSeq(uint32_t head) {
+  return head >= LOG_RING_SLOTS ? head - LOG_RING_SLOTS + 1 : 1;
+}
+
+void logCursorAtHead(LogCursor& cursor) {
+  cursor.next = headSeq.load(std::memory_order_acquire) + 1;
+}
+
+void logCursorAtOldest(LogCursor& cursor) {
+  cursor.next = oldestSeq(headSeq.load(std::memory_order_acquire));
+}
+
+bool logRead(LogCursor& cursor, LogRecord& out) {
+  uint32_t head = headSeq.load(std::memory_order_acquire);
+  if (cursor.next == 0) {
+    cursor.next = oldestSeq(head);  // zero-initialized cursor starts at the oldest record
+  }
+
+  while ((int32_t)(head - cursor.next) >= 0) {
+    // Fell a full ring behind: everything before the oldest slot is gone
+    uint32_t oldest = oldestSeq(head);
+    if ((int32_t)(oldest - cursor.next) > 0) {
+      cursor.dropped += oldest - cursor.next;
+      cursor.next = oldest;
+    }
+
+    uint32_t idx = cursor.next & LOG_RING_MASK;
+    uint32_t before = slotSeq[idx].load(std::memory_order_acquire);
+    if (before != cursor.next) {
+      if (before == 0 || (int32_t)(before - cursor.next) < 0) {
+        return false;  // still being written; try again next pass
+      }
+      cursor.dropped++;  // overwritten by a newer record
+      cursor.next++;
+      continue;
+    }
+
+    const LogRecord& r = records[idx];
+    size_t len = r.len < LOG_TEXT_LEN ? r.len : LOG_TEXT_LEN - 1;
+    out.seq = before;
+    out.timestampMs = r.timestampMs;
+    out.level = r.level;
+    out.module = r.module;
+    out.len = (uint16_t)len;
+    memcpy(out.text, r.text, len);
+    out.text[len] = '\0';
+
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (slotSeq[idx].load(std::memory_order_relaxed) != before) {
+      cursor.dropped++;  // overwritten while copying
+      cursor.next++;
+      continue;
+    }
+    cursor.next++;
+    return true;
+  }
+  return false;
+}
+
+void logFormatClock(uint32_t timestampMs, char* buf, size_t size) {
+  // Wall time is derived at read time so the write path never calls time()
+  time_t now;
+  time(&now);
+  now -= (time_t)((millis() - timestampMs) / 1000UL);
+  struct tm timeinfo;
+  localtime_r(&now, &timeinfo);
+  strftime(buf, size, "%H:%M:%S", &timeinfo);
+}
+
+const LogRingStats& getLogRingStats() {
+  stats.written = headSeq.load(std::memory_order_relaxed);
+  stats.truncated = truncatedCount;
+  return stats;
+}
@@ -0,0 +1,80 @@
+#ifndef LOG_RING_H
+#define LOG_RING_H
+
+#include <Arduino.h>
+#include <stdarg.h>
+#include <atomic>
+
+// Fixed ring of log records behind telnetPrintf().
+// A write formats once, straight into the next slot, and publishes the slot
+// by storing its sequence number. Nothing is allocated and no sink is called
+// from the writer. Each sink (Serial, telnet, web, MQTT) owns a LogCursor
+// and drains at its own pace. A sink that falls more than LOG_RING_SLOTS
+// records behind loses the oldest ones and counts them as dropped.
+
+#define LOG_RING_SLOTS 32     // power of two
+#define LOG_TEXT_LEN 232      // longer lines are truncated
+
+enum LogLevel : uint8_t {
+  LOG_ERROR = 0,
+  LOG_WARN,
+  LOG_INFO,
+  LOG_DEBUG
+};
+
+// Source module of a record; names and tags live in log.cpp
+enum LogModule : uint8_t {
+  LOG_MOD_APP = 0,   // untagged telnetPrintf() lines
+  LOG_MOD_SYSTEM,
+  LOG_MOD_WIFI,
+  LOG_MOD_DNS,
+  LOG_MOD_NET,
+  LOG_MOD_HEARTBEAT,
+  LOG_MOD_MQTT,
+  LOG_MOD_WEB,
+  LOG_MOD_OTA,
+  LOG_MOD_CONFIG,
+  LOG_MOD_COUNT
+};
+
+struct LogRecord {
+  uint32_t seq;
+  uint32_t timestampMs;  // millis() at write
+  uint8_t level;         // LogLevel
+  uint8_t module;        // LogModule
+  uint16_t len;          // text length, excluding the terminator
+  char text[LOG_TEXT_LEN];
+};
+
+struct LogCursor {
+  uint32_t next;         // sequence number of the next record to read
+  unsigned long dropped; // records overwritten before this sink read them
+};
+
+struct LogRingStats {
+  uint32_t written;      // == last sequence number
+  unsigned long truncated;
+};
+
+// Append one record. Leading/trailing CR/LF are stripped; sinks add their own
+// line endings and wall-clock prefix. A non-null tag prefixes the text with
+// "[<millis> ms] [<tag>] " in the same pass.
+void logWritev(LogLevel level, LogModule module, const char* tag, const char* format, va_list args);
+void logWrite(LogLevel level, LogModule module, const char* format, ...)
+    __attribute__((format(printf, 3, 4)));
+
+// Position a cursor at the next record to be written (skips history), or at
+// the oldest record still held
+void logCursorAtHead(LogCursor& cursor);
+void logCursorAtOldest(LogCursor& cursor);
+
+// Copy the next record for this cursor into out. Returns false when the
+// cursor has caught up (or the next record is still being written).
+bool logRead(LogCursor& cursor, LogRecord& out);
+
+// Render "HH:MM:SS" wall-clock time for a record's millis() timestamp
+void logFormatClock(uint32_t timestampMs, char* buf, size_t size);
+
+const LogRingStats& getLogRingStats();
+
+#endif
@@ -0,0 +1,148 @@
+#include "loop_perf.h"
+#include "scheduler.h"
+#include <string.h>
+
+struct PerfStall {
+  uint32_t durationUs;
+  uint32_t culpritUs;
+  unsigned long atMs;
+  PerfSlot culprit;
+};
+
+static PerfStats stats[PERF_SLOT_COUNT];
+static PerfStall stalls[PERF_STALL_LOG_SIZE];
+static uint8_t stallCount = 0;
+
+// Current iteration
+static uint32_t loopStartUs = 0;
+static uint32_t iterCulpritUs = 0;
+static PerfSlot iterCulprit = PERF_SLOT_NONE;
+
+static const char* const SLOT_NAMES[PERF_SLOT_COUNT] = {
+  "ota", "telnet", "web", "mqtt_loop", "wifi", "dns", "heartbeat",
+  "events", "net_probe", "mqtt_publish", "config_flush", "history", "loop"
+};
+
+static inline uint8_t bucketFor(uint32_t us) {
+  if (us < 2) return 0;
+  uint8_t b = 31 - __builtin_clz(us);
+  return b < PERF_HIST_BUCKETS ? b : PERF_HIST_BUCKETS - 1;
+}
+
+static void account(PerfSlot slot, uint32_t us) {
+  PerfStats& s = stats[slot];
+  s.count++;
+  s.totalUs += us;
+  if (us > s.maxUs) s.maxUs = us;
+  s.hist[bucketFor(us)]++;
+}
+
+// Keep the PERF_STALL_LOG_SIZE longest iterations, sorted longest first
+static void logStall(uint32_t durationUs) {
+  if (stallCount == PERF_STALL_LOG_SIZE && durationUs <= stalls[stallCount - 1].durationUs) {
+    return;
+  }
+  uint8_t pos = (stallCount < PERF_STALL_LOG_SIZE) ? stallCount++ : stallCount - 1;
+  while (pos > 0 && stalls[pos - 1].durationUs < durationUs) {
+    stalls[pos] = stalls[pos - 1];
+    pos--;
+  }
+  stalls[pos].durationUs = durationUs;
+  stalls[pos].culpritUs = iterCulpritUs;
+  stalls[pos].culprit = iterCulprit;
+  stalls[pos].atMs = millis();
+}
+
+void perfLoopBegin() {
+  loopStartUs = micros();
+  iterCulpritUs = 0;
+  iterCulprit = PERF_SLOT_NONE;
+}
+
+void perfLoopEnd() {
+  uint32_t us = micros() - loopStartUs;
+  account(PERF_LOOP, us);
+  logStall(us);
+}
+
+void perfRecord(PerfSlot slot, uint32_t startUs) {
+  if (slot < 0 || slot >= PERF_LOOP) return;
+  uint32_t us = micros() - startUs;
+  account(slot, us);
+  if (us > iterCulpritUs) {
+    iterCulpritUs = us;
+    iterCulprit = slot;
+  }
+}
+
+void perfReset() {
+  memset(stats, 0, sizeof(stats));
+  memset(stalls, 0, sizeof(stalls));
+  stallCount = 0;
+}
+
+const char* perfSlotName(PerfSlot slot) {
+  if (slot < 0 || slot >= PERF_SLOT_COUNT) return "none";
+  return SLOT_NAMES[slot];
+}
+
+const PerfStats& perfGetStats(PerfSlot slot) {
+  return stats[slot];
+}
+
+void fillPerfJSON(JsonDocument& doc) {
+  doc["uptime_ms"] = millis();
+  doc["bucket_unit"] = "log2_us";
+
+  JsonObject handlers = doc["handlers"].to<JsonObject>();
+  for (int8_t i = 0; i < PERF_SLOT_COUNT; i++) {
+    const PerfStats& s = stats[i];
+    JsonObject h = handlers[SLOT_NAMES[i]].to<JsonObject>();
+    h["count"] = s.count;
+    h["max_us"] = s.maxUs;
+    h["mean_us"] = s.count ? (uint32_t)(s.totalUs / s.count) : 0;
+    // Trim trailing empty buckets to keep the payload small
+    int8_t last = PERF_HIST_BUCKETS - 1;
+    while (last >= 0 && s.hist[last] == 0) last--;
+    JsonArray hist = h["hist"].to<JsonArray>();
+    for (int8_t b = 0; b <= last; b++) {
+      hist.add(s.hist[b]);
+    }
+  }
+
+  JsonArray stallArr = doc["stalls"].to<JsonArray>();
+  for (uint8_t i = 0; i < stallCount; i++) {
+    JsonObject st = stallArr.add<JsonObject>();
+    st["at_ms"] = stalls[i].atMs;
+    st["us"] = stalls[i].durationUs;
+    st["culprit"] = perfSlotName(stalls[i].culprit);
+    st["culprit_us"] = stalls[i].culpritUs;
+  }
+
+  JsonArray tasks = doc["tasks"].to<JsonArray>();
+  for (uint8_t i = 0; i < schedulerTaskCount(); i++) {
+    const SchedulerTask* t = schedulerGetTask(i);
+    JsonObject jt = tasks.add<JsonObject>();
+    jt["name"] = t->name;
+    jt["period_ms"] = t->periodMs;
+    jt["runs"] = t->runCount;
+    jt["overruns"] = t->overrunCount;
+    jt["max_late_ms"] = t->maxLatenessMs;
+    jt["max_run_ms"] = t->maxRunMs;
+  }
+}
+
+void fillPerfCompactJSON(JsonDocument& doc) {
+  const PerfStats& loop = stats[PERF_LOOP];
+  doc["loops"] = loop.count;
+  doc["loop_max_ms"] = loop.maxUs / 1000;
+  doc["loop_mean_us"] = loop.count ? (uint32_t)(loop.totalUs / loop.count) : 0;
+  if (stallCount > 0) {
+    doc["worst_stall_ms"] = stalls[0].durationUs / 1000;
+    doc["worst_stall_culprit"] = perfSlotName(stalls[0].culprit);
+  }
+  JsonObject maxMs = doc["max_ms"].to<JsonObject>();
+  for (int8_t i = 0; i < PERF_LOOP; i++) {
+    maxMs[SLOT_NAMES[i]] = stats[i].maxUs / 1000;
+  }
+}
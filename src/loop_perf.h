@@ -0,0 +1,64 @@
+#ifndef LOOP_PERF_H
+#define LOOP_PERF_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+
+// Always-on loop latency instrumentation.
+// Each instrumented call costs two micros() reads, a count-leading-zeros and a
+// handful of integer updates; no allocation, no locking.
+
+enum PerfSlot : int8_t {
+  PERF_SLOT_NONE = -1,
+  PERF_OTA = 0,
+  PERF_TELNET,
+  PERF_WEB,
+  PERF_MQTT_LOOP,
+  PERF_WIFI,
+  PERF_DNS,
+  PERF_HEARTBEAT,
+  PERF_EVENTS,
+  PERF_NET_PROBE,
+  PERF_MQTT_PUBLISH,
+  PERF_CONFIG_FLUSH,
+  PERF_HISTORY,
+  PERF_LOOP,          // whole loop() iteration, excluding idle sleep
+  PERF_SLOT_COUNT
+};
+
+// Log2 buckets in microseconds: bucket 0 = <2 us, bucket i = [2^i, 2^(i+1)),
+// last bucket is open-ended (>= ~4.2 s).
+#define PERF_HIST_BUCKETS 23
+struct PerfStats {
+  uint32_t count;
+  uint32_t maxUs;
+  uint64_t totalUs;
+  uint32_t hist[PERF_HIST_BUCKETS];
+};
+
+// Longest loop iterations retained with their culprit
+#define PERF_STALL_LOG_SIZE 8
+
+// Time a single call: PERF_TIME(PERF_WEB, handleWebServer());
+#define PERF_TIME(slot, call) \
+  do { uint32_t _perfStart = micros(); call; perfRecord((slot), _perfStart); } while (0)
+
+void perfLoopBegin();
+void perfLoopEnd();
+
+// Record micros() - startUs against slot (and the current iteration's culprit)
+void perfRecord(PerfSlot slot, uint32_t startUs);
+
+void perfReset();
+const char* perfSlotName(PerfSlot slot);
+
+// Counters since boot or the last perfReset()
+const PerfStats& perfGetStats(PerfSlot slot);
+
+// Full breakdown for /perf
+void fillPerfJSON(JsonDocument& doc);
+
+// Compact summary for the MQTT perf attribute topic
+void fillPerfCompactJSON(JsonDocument& doc);
+
+#endif
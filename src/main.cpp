@@ -2,8 +2,6 @@
 #include <time.h>
 #include <sys/time.h>
 #include <WiFi.h>
-#include <HTTPClient.h>
-#include <Preferences.h>
 #include "config.h"
 #include "wifi_manager.h"
 #include "telnet.h"
@@ -11,6 +9,13 @@
 #include "dns_manager.h"
 #include "ota_manager.h"
 #include "system_utils.h"
+#include "network_metrics.h"
+#include "scheduler.h"
+#include "heartbeat.h"
+#include "loop_perf.h"
+#include "config_store.h"
+#include "event_bus.h"
+#include "history.h"
 
 #ifdef ENABLE_WEBSERVER
 #include "web_server.h"
@@ -20,13 +25,55 @@
 #include "mqtt_manager.h"
 #endif
 
-Preferences preferences;
+// Loop cadence (ms). Handlers that are not scheduled run every pass, and the
+// loop never sleeps longer than LOOP_SERVICE_INTERVAL_MS.
+static const unsigned long LOOP_SERVICE_INTERVAL_MS = 10;
+static const unsigned long OTA_POLL_INTERVAL_MS = 20;
+static const unsigned long WIFI_SUPERVISION_INTERVAL_MS = 1000;
+static const unsigned long HEARTBEAT_INTERVAL_MS = 5000;
+static const unsigned long DNS_TEST_INTERVAL_MS = 100000;     // was every 20 heartbeats
+static const unsigned long NETWORK_PROBE_POLL_MS = 1000;      // probe interval itself is runtime-configurable
+
+static void runDNSTest() {
+  if (isWiFiConnected()) {
+    testDNSResolution();
+  }
+}
 
-// Global variables for tracking heartbeat status
-unsigned long lastSuccessfulHeartbeat = 0;
-int lastHeartbeatResponseCode = 0;
+// Remote reboot (web interface / MQTT), delivered by the event bus
+static void onRebootRequested(const Event& event) {
+#ifdef ENABLE_MQTT
+  // Publish offline status before rebooting
+  publishAvailability(false);
+  delay(100);  // Give time for MQTT message to send
+#endif
+  rebootDevice(3000, event.reboot.reason);
+}
+
+static void registerLoopTasks() {
+  schedulerAddTask("ota", handleOTA, OTA_POLL_INTERVAL_MS, 0, PERF_OTA);
+  // Multi-SSID self-healing: reconnect, failover, recover to primary
+  schedulerAddTask("wifi", handleWiFi, WIFI_SUPERVISION_INTERVAL_MS, 0, PERF_WIFI);
+  schedulerAddTask("heartbeat", startHeartbeat, HEARTBEAT_INTERVAL_MS, 0, PERF_HEARTBEAT);
+  // setup() already ran a DNS test right after connecting
+  schedulerAddTask("dns_test", runDNSTest, DNS_TEST_INTERVAL_MS, DNS_TEST_INTERVAL_MS, PERF_DNS);
+  schedulerAddTask("net_probe", handleNetworkMetrics, NETWORK_PROBE_POLL_MS, NETWORK_PROBE_POLL_MS,
+                   PERF_NET_PROBE);
+  // Compressed telemetry history (/history)
+  schedulerAddTask("history", sampleHistory, HISTORY_SAMPLE_INTERVAL_MS, HISTORY_SAMPLE_INTERVAL_MS,
+                   PERF_HISTORY);
+  // Debounced NVS write-behind for config/state changes
+  schedulerAddTask("config_flush", handleConfigStore, CONFIG_FLUSH_POLL_MS, CONFIG_FLUSH_POLL_MS,
+                   PERF_CONFIG_FLUSH);
+#ifdef ENABLE_MQTT
+  schedulerAddTask("mqtt_publish", publishMQTTPeriodicStatus,
+                   MQTT_STATUS_PUBLISH_INTERVAL_MS, MQTT_STATUS_PUBLISH_INTERVAL_MS, PERF_MQTT_PUBLISH);
+#endif
+}
 
 void setup() {
+  // Room for a burst of log lines so the Serial log sink drains without blocking
+  Serial.setTxBufferSize(1024);
   Serial.begin(115200);
   delay(100);
   Serial.print("\r\n\033[2J\033[H");
@@ -34,14 +81,10 @@ void setup() {
   Serial.printf("[%10lu ms] === ESP32-C3 Booting ===\r\n", millis());
   Serial.printf("[%10lu ms] Firmware Version: %s\r\n", millis(), firmwareVersion);
 
-  // Initialize preferences with error handling
-  bool prefsOK = preferences.begin("firmware", false);
+  // Load all persisted config/state into RAM once; later changes are written behind
+  bool prefsOK = configStoreBegin();
   if (!prefsOK) {
-    Serial.printf("[%10lu ms] [ERROR] Failed to initialize preferences, clearing NVS...\r\n", millis());
-    preferences.clear();
-    preferences.end();
-    delay(100);
-    prefsOK = preferences.begin("firmware", false);
+    Serial.printf("[%10lu ms] [ERROR] NVS unavailable - running on defaults\r\n", millis());
   }
   
   // Check for rollback conditions before proceeding
@@ -51,58 +94,52 @@ void setup() {
     // Will not return if rollback succeeds
   }
   
-  // Increment boot failure counter at start of boot
-  Preferences bootPrefs;
-  bootPrefs.begin("ota_rollback", false);
-  int bootFailCount = bootPrefs.getInt("boot_fail_count", 0) + 1;
-  bootPrefs.putInt("boot_fail_count", bootFailCount);
-  bootPrefs.end();
+  // Increment boot failure counter at start of boot. Flushed immediately: a
+  // crash before the write-behind window closes must still count.
+  OtaRollbackState& rollback = deviceConfig.rollback;
+  rollback.bootFailCount++;
+  configStoreMarkDirty(CFG_OTA_ROLLBACK);
+  configStoreFlush();
   
-  Serial.printf("[%10lu ms] [OTA] Boot attempt #%d\r\n", millis(), bootFailCount);
+  Serial.printf("[%10lu ms] [OTA] Boot attempt #%d\r\n", millis(), rollback.bootFailCount);
   
   // Check if this boot followed a rollback
-  bootPrefs.begin("ota_rollback", true);
-  String lastRollbackFrom = bootPrefs.getString("last_rollback_from", "");
-  unsigned long rollbackTime = bootPrefs.getULong("rollback_time", 0);
-  bootPrefs.end();
-  
-  if (lastRollbackFrom != "" && rollbackTime > 0) {
+  if (rollback.lastRollbackFrom[0] != '\0' && rollback.rollbackTime > 0) {
     Serial.printf("[%10lu ms] [OTA] *** ROLLBACK RECOVERY DETECTED ***\r\n", millis());
-    Serial.printf("[%10lu ms] [OTA] Rolled back from version: %s\r\n", millis(), lastRollbackFrom.c_str());
+    Serial.printf("[%10lu ms] [OTA] Rolled back from version: %s\r\n", millis(), rollback.lastRollbackFrom);
     Serial.printf("[%10lu ms] [OTA] Current version: %s\r\n", millis(), firmwareVersion);
     
     // Clear rollback tracking since we've detected it
-    bootPrefs.begin("ota_rollback", false);
-    bootPrefs.remove("last_rollback_from");
-    bootPrefs.remove("rollback_time");
-    bootPrefs.end();
+    rollback.lastRollbackFrom[0] = '\0';
+    rollback.rollbackTime = 0;
+    configStoreMarkDirty(CFG_OTA_ROLLBACK);
   }
   
   if (prefsOK) {
-    String lastVersion = preferences.getString("lastVersion", "");
-    String currentVersion = String(firmwareVersion);
+    FirmwareState& fw = deviceConfig.firmware;
     
-    if (lastVersion != currentVersion) {
-      if (lastVersion != "" && lastVersion.length() > 0) {
+    if (strcmp(fw.lastVersion, firmwareVersion) != 0) {
+      if (fw.lastVersion[0] != '\0') {
         Serial.printf("[%10lu ms] [OTA] FIRMWARE UPDATED! Previous: %s -> Current: %s\r\n", 
-                      millis(), lastVersion.c_str(), currentVersion.c_str());
+                      millis(), fw.lastVersion, firmwareVersion);
         
-        preferences.putULong("updateTime", millis());
-        preferences.putString("updateFrom", lastVersion);
+        fw.updateTime = millis();
+        strncpy(fw.updateFrom, fw.lastVersion, sizeof(fw.updateFrom) - 1);
+        fw.updateFrom[sizeof(fw.updateFrom) - 1] = '\0';
       } else {
         Serial.printf("[%10lu ms] [BOOT] First boot with version tracking\r\n", millis());
       }
       
-      preferences.putString("lastVersion", currentVersion);
-      Serial.printf("[%10lu ms] [VERSION] Stored version: %s\r\n", millis(), currentVersion.c_str());
+      strncpy(fw.lastVersion, firmwareVersion, sizeof(fw.lastVersion) - 1);
+      fw.lastVersion[sizeof(fw.lastVersion) - 1] = '\0';
+      configStoreMarkDirty(CFG_FIRMWARE);
+      Serial.printf("[%10lu ms] [VERSION] Stored version: %s\r\n", millis(), fw.lastVersion);
     } else {
-      Serial.printf("[%10lu ms] [BOOT] Running known version: %s\r\n", millis(), currentVersion.c_str());
+      Serial.printf("[%10lu ms] [BOOT] Running known version: %s\r\n", millis(), firmwareVersion);
       
-      unsigned long lastUpdateTime = preferences.getULong("updateTime", 0);
-      String updateFrom = preferences.getString("updateFrom", "");
-      if (lastUpdateTime > 0 && updateFrom != "") {
+      if (fw.updateTime > 0 && fw.updateFrom[0] != '\0') {
         Serial.printf("[%10lu ms] [INFO] Last OTA update was from %s at boot time %lu ms\r\n", 
-                      millis(), updateFrom.c_str(), lastUpdateTime);
+                      millis(), fw.updateFrom, fw.updateTime);
       }
     }
   } else {
@@ -112,6 +149,12 @@ void setup() {
   // Load persisted DNS timing configuration (after preferences system ready)
   loadDNSConfigFromStorage();
 
+  eventSubscribe(EVENT_MASK(EVT_REBOOT_REQUESTED), onRebootRequested);
+
+  // Periodic work is registered before WiFi so supervision keeps retrying
+  // even when the initial connection fails below.
+  registerLoopTasks();
+
   // Connect to WiFi (primary, then optional secondary failover)
   if (initWiFi()) {
     Serial.printf("[%10lu ms] [WiFi] Active SSID: %s (%s)\r\n",
@@ -139,9 +182,13 @@ void setup() {
   initializeMQTT();  // Initialize MQTT for Home Assistant integration
 #endif
   
-  // Check if a reboot was requested before last boot
-  if (checkRebootFlag()) {
-    telnetPrintf("[%10lu ms] [SYSTEM] Device rebooted successfully\r\n", millis());
+  // Report a reboot recorded by rebootDevice() before the last restart
+  SystemState& sys = deviceConfig.system;
+  if (sys.lastReboot[0] != '\0') {
+    telnetPrintf("[%10lu ms] [SYSTEM] Device rebooted successfully (reason: %s)\r\n", millis(), sys.lastReboot);
+    sys.lastReboot[0] = '\0';
+    sys.rebootTime = 0;
+    configStoreMarkDirty(CFG_SYSTEM);
   }
   
   // Mark firmware as valid after successful module initialization
@@ -153,69 +200,33 @@ void setup() {
 }
 
 void loop() {
-  handleOTA();
-  handleTelnet();
+  perfLoopBegin();
+
+  // Latency-sensitive servicing runs on every pass
+  PERF_TIME(PERF_TELNET, handleTelnet());
+  PERF_TIME(PERF_HEARTBEAT, handleHeartbeat());  // one non-blocking step of an in-flight heartbeat
+  PERF_TIME(PERF_NET_PROBE, handleNetworkProbe());  // in-flight latency probe, as far as it goes
 
 #ifdef ENABLE_WEBSERVER
-  handleWebServer();
+  PERF_TIME(PERF_WEB, handleWebServer());
 #endif
 
 #ifdef ENABLE_MQTT
-  handleMQTTLoop();  // Handle MQTT connection and publishing
+  PERF_TIME(PERF_MQTT_LOOP, handleMQTTLoop());  // MQTT connection upkeep + mqttClient.loop()
 #endif
-  
-  // Check for reboot flag (set by web interface)
-  if (checkRebootFlag()) {
-#ifdef ENABLE_MQTT
-    // Publish offline status before rebooting
-    publishAvailability(false);
-    delay(100);  // Give time for MQTT message to send
-#endif
-    rebootDevice(3000, "Remote reboot request");
-  }
-  
-  unsigned long now = millis();
 
-  // Multi-SSID self-healing: reconnect, failover, recover to primary
-  handleWiFi();
-  if (!isWiFiConnected()) {
-    delay(2000);
-    return;
-  }
+  // Periodic work (heartbeat, DNS, probes, publishes, WiFi supervision, OTA)
+  schedulerRunDue();
 
-  // Test DNS every 20 heartbeats (100 seconds) - reduced frequency
-  static int heartbeatCount = 0;
-  if (heartbeatCount % 20 == 0) {
-    testDNSResolution();
-  }
-  heartbeatCount++;
+  // Deliver state changes raised above (reboot requests, DNS/WiFi/heartbeat transitions)
+  PERF_TIME(PERF_EVENTS, eventBusDispatch());
 
-  WiFiClient client;
-  HTTPClient http;
-  http.begin(client, apiEndpoint);
-  http.setTimeout(10000);
-  
-  int httpCode = http.GET();
-  lastHeartbeatResponseCode = httpCode;
+  perfLoopEnd();
 
-  if (httpCode > 0) {
-    String payload = http.getString();
-    telnetPrintf("[%10lu ms] [Heartbeat] Ping Response (%d): %s\r\n", millis(), httpCode, payload.c_str());
-    
-    // Track successful heartbeat (200 OK)
-    if (httpCode == 200) {
-      lastSuccessfulHeartbeat = millis();
-    }
-  } else {
-    telnetPrintf("[%10lu ms] [Heartbeat] Ping failed: %s\r\n", millis(), http.errorToString(httpCode).c_str());
-    
-    // If heartbeat fails, test DNS resolution
-    if (httpCode == HTTPC_ERROR_CONNECTION_REFUSED || httpCode == -1) {
-      telnetPrintf("[%10lu ms] [DEBUG] Heartbeat failed, testing DNS...\r\n", millis());
-      testDNSResolution();
-    }
+  // Sleep only until the earliest deadline; the cap keeps web/telnet/MQTT responsive
+  // A probe in flight shortens the sleep so its phase timings stay at 1 ms resolution
+  unsigned long idleMs = schedulerTimeUntilNextMs(isNetworkProbeInFlight() ? 1 : LOOP_SERVICE_INTERVAL_MS);
+  if (idleMs > 0) {
+    delay(idleMs);
   }
-
-  http.end();
-  delay(5000);
-}
\ No newline at end of file
+}
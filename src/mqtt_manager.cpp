@@ -7,6 +7,12 @@
 #include "network_metrics.h"
 #include "system_utils.h"
 #include "wifi_manager.h"
+#include "heartbeat.h"
+#include "loop_perf.h"
+#include "event_bus.h"
+#include "log.h"
+#include "config_store.h"
+#include "json_stream.h"
 #include <WiFi.h>
 #include <math.h>
 
@@ -20,6 +26,7 @@ const char* MQTT_STATUS_TOPIC = "homeassistant/sensor/poop_monitor/status";
 const char* MQTT_AVAILABILITY_TOPIC = "homeassistant/sensor/poop_monitor/availability";
 const char* MQTT_TELNET_TOPIC = "homeassistant/sensor/poop_monitor/telnet";
 const char* MQTT_COMMAND_TOPIC = "homeassistant/poop_monitor/command";
+const char* MQTT_PERF_TOPIC = "homeassistant/sensor/poop_monitor/perf";
 const char* MQTT_DISCOVERY_PREFIX = "homeassistant";
 
 // Home Assistant Device Info
@@ -32,7 +39,23 @@ const char* HA_MODEL = "ESP32-C3";
 unsigned long lastMQTTReconnectAttempt = 0;
 unsigned long lastStatusPublish = 0;
 const unsigned long MQTT_RECONNECT_INTERVAL = 5000;    // Try to reconnect every 5 seconds
-const unsigned long STATUS_PUBLISH_INTERVAL = 30000;   // Publish status every 30 seconds
+
+// Set by state events; the consolidated status JSON is republished once on the
+// next MQTT loop pass, however many events arrived together
+static bool statusPublishPending = false;
+// A /network_config command is waiting for its probe to finish
+static bool probePublishPending = false;
+
+// Log sink: this module's cursor into the shared log ring. Lines are batched
+// into one telnet-topic message per flush window; whatever does not fit the
+// window's byte budget is counted as dropped rather than queued.
+static LogCursor mqttLogCursor = {0, 0};
+static const unsigned long MQTT_LOG_FLUSH_MS = 2000;   // at most one log message per window
+static const size_t MQTT_LOG_MAX_PAYLOAD = 768;        // per message; leaves room in the 1024 byte client buffer
+static char mqttLogPayload[MQTT_LOG_MAX_PAYLOAD];
+static unsigned long lastLogFlush = 0;
+static unsigned long mqttLogCursorDropped = 0;        // cursor drops already folded into the stats
+static MQTTLogStats mqttLogStats = {0, 0, 0, 0};
 
 // Helper to format memory usage as "freeKB/totalKB"
 static String getMemoryUsage() {
@@ -43,7 +66,73 @@ static String getMemoryUsage() {
     return String(buf);
 }
 
+static void logDiscoveryResult(bool success, const char* object_id, const char* topic) {
+    if (success) {
+        LOG_D(LOG_MOD_MQTT, "Discovery OK: %s (%s)", object_id, topic);
+    } else {
+        LOG_W(LOG_MOD_MQTT, "Discovery FAILED: %s (%s)", object_id, topic);
+    }
+}
+
 // Publish all sensor states (not just discovery)
+// Extra probe targets get their own sensors: object id and state topic
+// probe_<name>_<metric>. The primary target keeps the network_* ones.
+struct TargetSensor {
+    const char* metric;
+    const char* label;
+    const char* unit;
+    const char* icon;
+};
+
+static const TargetSensor TARGET_SENSORS[] = {
+    {"latency", "Latency", "ms", "mdi:timer-outline"},
+    {"jitter", "Jitter", "ms", "mdi:chart-timeline-variant"},
+    {"loss", "Packet Loss", "%", "mdi:lan-disconnect"},
+};
+
+// "probe_" + target name + "_" + the longest metric ("latency")
+static const size_t TARGET_OBJECT_ID_LEN = 6 + (CONFIG_PROBE_NAME_LEN - 1) + 1 + 7 + 1;
+
+static void targetObjectId(char* out, size_t len, const char* name, const char* metric) {
+    snprintf(out, len, "probe_%.*s_%s", (int)(CONFIG_PROBE_NAME_LEN - 1), name, metric);
+}
+
+static void publishTargetSensors(uint8_t slot) {
+    const NetworkTargetResult& r = getNetworkTargetResult(slot);
+    const float values[] = {r.latencyMs, r.jitterMs, r.lossPct};
+    for (uint8_t i = 0; i < sizeof(TARGET_SENSORS) / sizeof(TARGET_SENSORS[0]); i++) {
+        if (values[i] < 0.0f) continue;
+        char objectId[TARGET_OBJECT_ID_LEN];
+        char topic[96];
+        targetObjectId(objectId, sizeof(objectId), networkProbeTargetName(slot), TARGET_SENSORS[i].metric);
+        snprintf(topic, sizeof(topic), "%s/%s", MQTT_DEVICE_TOPIC, objectId);
+        mqttClient.publish(topic, String(values[i], 1).c_str(), false);
+    }
+}
+
+static void publishTargetDiscovery(uint8_t slot) {
+    const char* name = networkProbeTargetName(slot);
+    for (const TargetSensor& s : TARGET_SENSORS) {
+        char objectId[TARGET_OBJECT_ID_LEN];
+        char topic[96];
+        char label[48];
+        targetObjectId(objectId, sizeof(objectId), name, s.metric);
+        snprintf(topic, sizeof(topic), "%s/%s", MQTT_DEVICE_TOPIC, objectId);
+        snprintf(label, sizeof(label), "Probe %s %s", name, s.label);
+        publishSensor("sensor", objectId, label, s.unit, nullptr, topic, s.icon);
+    }
+}
+
+// An empty retained config removes the entity from Home Assistant
+static void removeTargetDiscovery(const char* name) {
+    for (const TargetSensor& s : TARGET_SENSORS) {
+        char objectId[TARGET_OBJECT_ID_LEN];
+        targetObjectId(objectId, sizeof(objectId), name, s.metric);
+        String discoveryTopic = String(MQTT_DISCOVERY_PREFIX) + "/sensor/" + HA_DEVICE_ID + "/" + objectId + "/config";
+        mqttClient.publish(discoveryTopic.c_str(), "", true);
+    }
+}
+
 static void publishMetricsIndividual() {
     // WiFi Signal + active SSID
     mqttClient.publish("homeassistant/sensor/poop_monitor/wifi_signal", String(WiFi.RSSI()).c_str(), false);
@@ -62,8 +151,43 @@ static void publishMetricsIndividual() {
         mqttClient.publish("homeassistant/sensor/poop_monitor/network_jitter",
                            String(networkJitterMs, 1).c_str(), false);
     }
+    // Latency distribution across probes (omitted until known, like the mean)
+    NetworkLatencyStats latency;
+    getNetworkLatencyStats(latency);
+    const struct { const char* topic; float ms; } latencyTopics[] = {
+        {"homeassistant/sensor/poop_monitor/network_latency_p50", latency.p50Ms},
+        {"homeassistant/sensor/poop_monitor/network_latency_p95", latency.p95Ms},
+        {"homeassistant/sensor/poop_monitor/network_latency_p99", latency.p99Ms},
+        {"homeassistant/sensor/poop_monitor/network_latency_max_5m", latency.max5mMs},
+        {"homeassistant/sensor/poop_monitor/network_latency_max_1h", latency.max1hMs},
+        {"homeassistant/sensor/poop_monitor/network_latency_max_24h", latency.max24hMs},
+    };
+    for (const auto& t : latencyTopics) {
+        if (t.ms >= 0.0f) {
+            mqttClient.publish(t.topic, String(t.ms, 1).c_str(), false);
+        }
+    }
+    // Mean time per probe phase (dns, connect, ttfb, transfer)
+    for (uint8_t p = 0; p < NET_PHASE_COUNT; p++) {
+        const NetworkPhaseStats& phase = getNetworkPhaseStats(p);
+        if (phase.meanMs >= 0.0f) {
+            char topic[64];
+            snprintf(topic, sizeof(topic), "homeassistant/sensor/poop_monitor/network_%s", networkPhaseName(p));
+            mqttClient.publish(topic, String(phase.meanMs, 1).c_str(), false);
+        }
+    }
+    // Loss over the last probe's attempts and its longest run of misses
+    if (networkProbeLossPct >= 0.0f) {
+        mqttClient.publish("homeassistant/sensor/poop_monitor/network_loss",
+                           String(networkProbeLossPct, 1).c_str(), false);
+        mqttClient.publish("homeassistant/sensor/poop_monitor/network_loss_run_max",
+                           String(networkProbeLongestLossRun).c_str(), false);
+    }
     mqttClient.publish("homeassistant/sensor/poop_monitor/network_probe_target",
                        networkProbeTarget, false);
+    for (uint8_t slot = 1; slot < networkProbeTargetCount(); slot++) {
+        publishTargetSensors(slot);
+    }
     // Uptime seconds
     mqttClient.publish("homeassistant/sensor/poop_monitor/uptime", String(millis() / 1000).c_str(), false);
     // Free Memory
@@ -75,17 +199,72 @@ static void publishMetricsIndividual() {
     // Alerts
     extern bool areAlertsPaused();
     mqttClient.publish("homeassistant/sensor/poop_monitor/alerts", areAlertsPaused() ? "OFF" : "ON", false);
+    // Loop timing summary (full breakdown lives at /perf on the web server)
+    JsonDocument perfDoc;
+    fillPerfCompactJSON(perfDoc);
+    publishJson(mqttClient, MQTT_PERF_TOPIC, perfDoc, false);
 }
 
 void publishAllSensors() {
     // Publish consolidated device status JSON
-    String statusJson = getDeviceStatusJSON();
-    mqttClient.publish(MQTT_STATUS_TOPIC, statusJson.c_str(), false);
+    publishDeviceStatus();
     // Also publish individual topics for legacy consumers and debugging visibility
     publishMetricsIndividual();
 }
+// Push the topics a state change affects right away instead of waiting for
+// the periodic publish
+static void onStateEvent(const Event& event) {
+    switch (event.type) {
+        case EVT_DNS_STATE_CHANGED:
+            if (mqttClient.connected()) {
+                mqttClient.publish("homeassistant/sensor/poop_monitor/dns_status",
+                                   event.dns.working ? "ON" : "OFF", false);
+            }
+            statusPublishPending = true;
+            break;
+        case EVT_WIFI_ROLE_CHANGED:
+            if (mqttClient.connected()) {
+                mqttClient.publish("homeassistant/sensor/poop_monitor/wifi_ssid", getActiveSSID(), false);
+                mqttClient.publish("homeassistant/sensor/poop_monitor/wifi_network", getActiveNetworkRole(), false);
+            }
+            statusPublishPending = true;
+            break;
+        case EVT_HEARTBEAT_RESULT:
+            // Every heartbeat lands here; only ok <-> failing transitions matter to HA
+            if (event.heartbeat.changed) {
+                statusPublishPending = true;
+            }
+            break;
+        case EVT_NETWORK_PROBE_RESULT:
+            if (event.probe.target != 0) {
+                if (mqttClient.connected()) {
+                    publishTargetSensors(event.probe.target);
+                }
+                break;
+            }
+            // A /network_config command asked for fresh values
+            if (probePublishPending && mqttClient.connected()) {
+                probePublishPending = false;
+                publishAllSensors();
+            }
+            break;
+        case EVT_CONFIG_CHANGED:
+            if (event.config.section == CFG_NET_METRICS && mqttClient.connected()) {
+                mqttClient.publish("homeassistant/sensor/poop_monitor/network_probe_target",
+                                   networkProbeTarget, false);
+            }
+            statusPublishPending = true;
+            break;
+        default:
+            break;
+    }
+}
+
 void initializeMQTT() {
     Serial.println("Initializing MQTT...");
+    eventSubscribe(EVENT_MASK(EVT_DNS_STATE_CHANGED) | EVENT_MASK(EVT_WIFI_ROLE_CHANGED) |
+                   EVENT_MASK(EVT_HEARTBEAT_RESULT) | EVENT_MASK(EVT_CONFIG_CHANGED) |
+                   EVENT_MASK(EVT_NETWORK_PROBE_RESULT), onStateEvent);
     mqttClient.setServer(mqttServer, mqttPort);
     mqttClient.setKeepAlive(60);
     mqttClient.setSocketTimeout(30);
@@ -136,6 +315,8 @@ void connectToMQTT() {
         mqttClient.subscribe((String(MQTT_COMMAND_TOPIC) + "/alerts").c_str());
         mqttClient.subscribe((String(MQTT_COMMAND_TOPIC) + "/dns_config").c_str());
         mqttClient.subscribe((String(MQTT_COMMAND_TOPIC) + "/network_config").c_str());
+        mqttClient.subscribe((String(MQTT_COMMAND_TOPIC) + "/network_targets").c_str());
+        mqttClient.subscribe((String(MQTT_COMMAND_TOPIC) + "/log_level").c_str());
         
         // Publish that we're online
         publishAvailability(true);
@@ -190,10 +371,45 @@ void publishHomeAssistantDiscovery() {
         publishSensor("sensor", "network_jitter", "Network Jitter",
                   "ms", nullptr, "homeassistant/sensor/poop_monitor/network_jitter", "mdi:chart-timeline-variant");
     
+    // 5b. Network latency distribution (P-squared quantiles, windowed maxima)
+        publishSensor("sensor", "network_latency_p50", "Network Latency p50",
+                  "ms", nullptr, "homeassistant/sensor/poop_monitor/network_latency_p50", "mdi:timer-outline");
+        publishSensor("sensor", "network_latency_p95", "Network Latency p95",
+                  "ms", nullptr, "homeassistant/sensor/poop_monitor/network_latency_p95", "mdi:timer-alert-outline");
+        publishSensor("sensor", "network_latency_p99", "Network Latency p99",
+                  "ms", nullptr, "homeassistant/sensor/poop_monitor/network_latency_p99", "mdi:timer-alert-outline");
+        publishSensor("sensor", "network_latency_max_5m", "Network Latency Max 5m",
+                  "ms", nullptr, "homeassistant/sensor/poop_monitor/network_latency_max_5m", "mdi:arrow-collapse-up");
+        publishSensor("sensor", "network_latency_max_1h", "Network Latency Max 1h",
+                  "ms", nullptr, "homeassistant/sensor/poop_monitor/network_latency_max_1h", "mdi:arrow-collapse-up");
+        publishSensor("sensor", "network_latency_max_24h", "Network Latency Max 24h",
+                  "ms", nullptr, "homeassistant/sensor/poop_monitor/network_latency_max_24h", "mdi:arrow-collapse-up");
+    
+    // 5c. Network probe phases (mean of the last probe; min/max in the status JSON)
+        publishSensor("sensor", "network_dns", "Network DNS Time",
+                  "ms", nullptr, "homeassistant/sensor/poop_monitor/network_dns", "mdi:dns-outline");
+        publishSensor("sensor", "network_connect", "Network Connect Time",
+                  "ms", nullptr, "homeassistant/sensor/poop_monitor/network_connect", "mdi:lan-connect");
+        publishSensor("sensor", "network_ttfb", "Network Time to First Byte",
+                  "ms", nullptr, "homeassistant/sensor/poop_monitor/network_ttfb", "mdi:timer-sand");
+        publishSensor("sensor", "network_transfer", "Network Transfer Time",
+                  "ms", nullptr, "homeassistant/sensor/poop_monitor/network_transfer", "mdi:download-network-outline");
+    
+    // 5d. Probe loss (per attempt: echo requests or HTTP samples)
+        publishSensor("sensor", "network_loss", "Network Packet Loss",
+                  "%", nullptr, "homeassistant/sensor/poop_monitor/network_loss", "mdi:lan-disconnect");
+        publishSensor("sensor", "network_loss_run_max", "Network Longest Loss Run",
+                  nullptr, nullptr, "homeassistant/sensor/poop_monitor/network_loss_run_max", "mdi:transit-skip");
+    
     // 6. Network Probe Target (configured URL)
         publishSensor("sensor", "network_probe_target", "Network Probe Target",
                   nullptr, nullptr, "homeassistant/sensor/poop_monitor/network_probe_target", "mdi:target");
     
+    // 6b. Extra probe targets (latency, jitter, loss each)
+        for (uint8_t slot = 1; slot < networkProbeTargetCount(); slot++) {
+            publishTargetDiscovery(slot);
+        }
+    
     // 7. Uptime (reads from consolidated status topic)
         publishSensor("sensor", "uptime", "Uptime", 
                   "s", "duration", MQTT_STATUS_TOPIC, "mdi:clock");
@@ -218,6 +434,10 @@ void publishHomeAssistantDiscovery() {
         publishSensor("binary_sensor", "alerts", "Alerts Enabled", 
                   nullptr, nullptr, MQTT_STATUS_TOPIC, "mdi:bell");
     
+    // 12b. Loop timing (worst loop iteration; per-handler maxima as attributes)
+        publishSensor("sensor", "loop_perf", "Loop Max Latency",
+                  "ms", "duration", MQTT_PERF_TOPIC, "mdi:speedometer");
+    
     // 13. Telnet Log Sensor
         publishSensor("sensor", "telnet_log", "Telnet Log", 
                   nullptr, nullptr, MQTT_TELNET_TOPIC, "mdi:console");
@@ -285,11 +505,24 @@ void publishSensor(const char* component, const char* object_id, const char* nam
     } else if (strcmp(object_id, "network_latency") == 0) {
         configDoc["value_template"] = "{{ value | float }}";
         configDoc["state_class"] = "measurement";
-    } else if (strcmp(object_id, "network_jitter") == 0) {
+    } else if (strcmp(object_id, "network_jitter") == 0 ||
+               strncmp(object_id, "network_latency_", 16) == 0 ||
+               strcmp(object_id, "network_dns") == 0 || strcmp(object_id, "network_connect") == 0 ||
+               strcmp(object_id, "network_ttfb") == 0 || strcmp(object_id, "network_transfer") == 0 ||
+               strncmp(object_id, "network_loss", 12) == 0 || strncmp(object_id, "probe_", 6) == 0) {
         configDoc["value_template"] = "{{ value | float }}";
         configDoc["state_class"] = "measurement";
     } else if (strcmp(object_id, "network_probe_target") == 0) {
         configDoc["value_template"] = "{{ value | default('unknown') }}";
+    } else if (strcmp(object_id, "loop_perf") == 0) {
+        configDoc["json_attributes_topic"] = state_topic;
+        configDoc["value_template"] = "{{ value_json.loop_max_ms }}";
+        configDoc["state_class"] = "measurement";
+    } else if (strcmp(object_id, "telnet_log") == 0) {
+        // State is the newest line of the batch (HA caps states at 255 chars);
+        // the whole batch and the dropped count are attributes
+        configDoc["json_attributes_topic"] = state_topic;
+        configDoc["value_template"] = "{{ (value_json.log.split('\\n') | last)[:255] }}";
     } else if (strcmp(object_id, "uptime") == 0) {
         configDoc["value_template"] = "{{ (value_json.uptime_ms / 1000) | round(0) }}";
     } else if (strcmp(object_id, "free_memory") == 0) {
@@ -308,17 +541,11 @@ void publishSensor(const char* component, const char* object_id, const char* nam
         configDoc["payload_off"] = "OFF";
     }
     
-    // Serialize and publish
-    String configJson;
-    configJson.reserve(768);
-    serializeJson(configDoc, configJson);
-    
-    telnetPrintf("[MQTT] Publishing discovery for %s to topic: %s\nPayload: %s\n", object_id, discoveryTopic.c_str(), configJson.c_str());
-    bool success = mqttClient.publish(discoveryTopic.c_str(), configJson.c_str(), true);
-    Serial.printf("Discovery %s: %s (%s)\n", 
-                  success ? "OK" : "FAILED", 
-                  object_id, 
-                  discoveryTopic.c_str());
+    // Stream and publish
+    LOG_D(LOG_MOD_MQTT, "Publishing discovery for %s to %s (%u bytes)", object_id, discoveryTopic.c_str(),
+          (unsigned)measureJson(configDoc));
+    bool success = publishJson(mqttClient, discoveryTopic.c_str(), configDoc, true);
+    logDiscoveryResult(success, object_id, discoveryTopic.c_str());
 }
 
 void publishDeviceStatus() {
@@ -326,31 +553,29 @@ void publishDeviceStatus() {
         return;
     }
     
-    // Get comprehensive status JSON
-    String statusJson = getDeviceStatusJSON();
+    // Build comprehensive status JSON and stream it out (it exceeds the client's packet buffer)
+    JsonDocument statusDoc;
+    fillDeviceStatusJSON(statusDoc);
+    size_t bytes = measureJson(statusDoc);
     
     // Publish main status
-    telnetPrintf("[MQTT] Publishing device status to topic: %s\nPayload: %s\n", MQTT_STATUS_TOPIC, statusJson.c_str());
-    bool success = mqttClient.publish(MQTT_STATUS_TOPIC, statusJson.c_str(), false);
+    bool success = publishJson(mqttClient, MQTT_STATUS_TOPIC, statusDoc, false);
     if (success) {
-        Serial.println("Device status published to MQTT");
+        LOG_D(LOG_MOD_MQTT, "Device status published to %s (%u bytes)", MQTT_STATUS_TOPIC, (unsigned)bytes);
     } else {
-        Serial.println("Failed to publish device status to MQTT");
+        LOG_W(LOG_MOD_MQTT, "Failed to publish device status (%u bytes)", (unsigned)bytes);
     }
 }
 
 void publishAvailability(bool online) {
     if (mqttClient.connected()) {
         const char* status = online ? "online" : "offline";
-        telnetPrintf("[MQTT] Publishing availability to topic: %s\nPayload: %s\n", MQTT_AVAILABILITY_TOPIC, status);
         mqttClient.publish(MQTT_AVAILABILITY_TOPIC, status, true);
-        Serial.printf("MQTT availability: %s\n", status);
+        LOG_I(LOG_MOD_MQTT, "Availability: %s", status);
     }
 }
 
-String getDeviceStatusJSON() {
-    JsonDocument statusDoc;
-    
+void fillDeviceStatusJSON(JsonDocument& statusDoc) {
     // Basic device info
     statusDoc["device_name"] = deviceName;
     statusDoc["firmware_version"] = firmwareVersion;
@@ -398,6 +623,7 @@ String getDeviceStatusJSON() {
     statusDoc["network_probe_interval_ms"] = networkProbeIntervalMs;
     statusDoc["network_probe_samples"] = networkProbeSamples;
     statusDoc["network_probe_timeout_ms"] = networkProbeTimeoutMs;
+    statusDoc["network_probe_keep_alive"] = networkProbeKeepAlive;
     statusDoc["network_probe_ok"] = networkProbeOk;
     statusDoc["network_probe_success_count"] = networkProbeSuccessCount;
     statusDoc["network_probe_attempt_count"] = networkProbeAttemptCount;
@@ -412,11 +638,16 @@ String getDeviceStatusJSON() {
     } else {
         statusDoc["network_jitter_ms"] = nullptr;
     }
+    addNetworkLatencyStatsJSON(statusDoc["network_latency_stats_ms"].to<JsonObject>());
+    addNetworkPhaseJSON(statusDoc["network_phase_ms"].to<JsonObject>());
+    addNetworkProbeResultJSON(statusDoc["network_probe_result"].to<JsonObject>());
+    if (networkConnectSetupMs >= 0.0f) {
+        statusDoc["network_connect_setup_ms"] = roundf(networkConnectSetupMs * 10.0f) / 10.0f;
+    } else {
+        statusDoc["network_connect_setup_ms"] = nullptr;
+    }
     
-    // Heartbeat info (using external variables)
-    extern unsigned long lastSuccessfulHeartbeat;
-    extern int lastHeartbeatResponseCode;
-
+    // Heartbeat info
     statusDoc["last_heartbeat_uptime_ms"] = lastSuccessfulHeartbeat;
     if (lastSuccessfulHeartbeat > 0) {
         statusDoc["last_heartbeat_code"] = lastHeartbeatResponseCode;
@@ -425,6 +656,7 @@ String getDeviceStatusJSON() {
     } else {
         statusDoc["last_heartbeat_formatted"] = "Never";
     }
+    addHeartbeatPhaseJSON(statusDoc["heartbeat_phase_ms"].to<JsonObject>());
     
     // DNS configuration
     statusDoc["primary_dns"] = primaryDNS.toString();
@@ -452,29 +684,35 @@ String getDeviceStatusJSON() {
     // Timestamp
     statusDoc["timestamp"] = millis();
     
-    String jsonString;
-    serializeJson(statusDoc, jsonString);
-    return jsonString;
 }
 
 void handleMQTTLoop() {
     if (!mqttClient.connected()) {
+        logCursorAtHead(mqttLogCursor);  // lines logged while offline are not replayed
         connectToMQTT();
         return;
     }
     
     mqttClient.loop();
-    
-    // Publish status and free memory periodically
-    unsigned long now = millis();
-    if (now - lastStatusPublish >= STATUS_PUBLISH_INTERVAL) {
+    publishTelnetLog();
+
+    if (statusPublishPending) {
+        statusPublishPending = false;
         publishDeviceStatus();
-        mqttClient.publish("homeassistant/sensor/poop_monitor/memory", getMemoryUsage().c_str(), false);
-        publishMetricsIndividual();
-        lastStatusPublish = now;
     }
 }
 
+void publishMQTTPeriodicStatus() {
+    if (!mqttClient.connected()) {
+        return;
+    }
+    publishDeviceStatus();
+    mqttClient.publish("homeassistant/sensor/poop_monitor/memory", getMemoryUsage().c_str(), false);
+    publishMetricsIndividual();
+    lastStatusPublish = millis();
+    statusPublishPending = false;  // just published
+}
+
 bool isMQTTConnected() {
     return mqttClient.connected();
 }
@@ -508,16 +746,9 @@ void publishSwitch(const char* object_id, const char* name, const char* command_
     configDoc["device"]["model"] = HA_MODEL;
     configDoc["device"]["sw_version"] = firmwareVersion;
     
-    // Serialize and publish
-    String configJson;
-    configJson.reserve(384);
-    serializeJson(configDoc, configJson);
-    
-    bool success = mqttClient.publish(discoveryTopic.c_str(), configJson.c_str(), true);
-    Serial.printf("Discovery %s: %s (%s)\n", 
-                  success ? "OK" : "FAILED", 
-                  object_id, 
-                  discoveryTopic.c_str());
+    // Stream and publish
+    bool success = publishJson(mqttClient, discoveryTopic.c_str(), configDoc, true);
+    logDiscoveryResult(success, object_id, discoveryTopic.c_str());
 }
 
 void publishButton(const char* object_id, const char* name, const char* command_topic, 
@@ -545,30 +776,103 @@ void publishButton(const char* object_id, const char* name, const char* command_
     configDoc["device"]["model"] = HA_MODEL;
     configDoc["device"]["sw_version"] = firmwareVersion;
     
-    // Serialize and publish
-    String configJson;
-    serializeJson(configDoc, configJson);
-    
-    bool success = mqttClient.publish(discoveryTopic.c_str(), configJson.c_str(), true);
-    Serial.printf("Discovery %s: %s (%s)\n", 
-                  success ? "OK" : "FAILED", 
-                  object_id, 
-                  discoveryTopic.c_str());
+    // Stream and publish
+    bool success = publishJson(mqttClient, discoveryTopic.c_str(), configDoc, true);
+    logDiscoveryResult(success, object_id, discoveryTopic.c_str());
+}
+
+// Append src to buf as JSON string content. Returns false, leaving pos
+// unchanged, if it does not fit.
+static bool appendJsonEscaped(char* buf, size_t size, size_t& pos, const char* src) {
+    size_t p = pos;
+    for (; *src; src++) {
+        char c = *src;
+        char esc = 0;
+        if (c == '"' || c == '\\') esc = c;
+        else if (c == '\n') esc = 'n';
+        else if (c == '\t') esc = 't';
+        else if ((unsigned char)c < 0x20) continue;  // drop other control characters
+
+        size_t need = esc ? 2 : 1;
+        if (p + need + 1 >= size) return false;
+        if (esc) {
+            buf[p++] = '\\';
+            buf[p++] = esc;
+        } else {
+            buf[p++] = c;
+        }
+    }
+    pos = p;
+    return true;
 }
 
-void publishTelnetLog(const String& logMessage) {
+void publishTelnetLog() {
     if (!mqttClient.connected()) {
         return;
     }
-    
-    // Publish telnet log message to Home Assistant
-    // Avoid echoing telnet log publish back into telnet buffer to prevent recursion/amplification
-    bool success = mqttClient.publish(MQTT_TELNET_TOPIC, logMessage.c_str(), false);
-    if (!success) {
-        telnetPrintf("Failed to publish telnet log to MQTT\n");
+    if (millis() - lastLogFlush < MQTT_LOG_FLUSH_MS) {
+        return;  // the ring holds lines until the window closes
+    }
+    lastLogFlush = millis();
+
+    // {"log":"HH:MM:SS a\nHH:MM:SS b","lines":2,"dropped":0}
+    // Room for the closing fields is reserved up front so a full batch still closes cleanly
+    static const size_t TAIL_RESERVE = 40;
+    const size_t limit = MQTT_LOG_MAX_PAYLOAD - TAIL_RESERVE;
+    uint16_t lines = 0;
+    unsigned long skipped = 0;
+    bool full = false;
+    LogRecord rec;
+    char line[LOG_TEXT_LEN + 12];
+
+    size_t pos = (size_t)snprintf(mqttLogPayload, limit, "{\"log\":\"");
+    while (logRead(mqttLogCursor, rec)) {
+        if (rec.len == 0) continue;
+        if (full) {
+            skipped++;  // over this window's byte budget; keep draining so the sink stays current
+            continue;
+        }
+        char ts[12];
+        logFormatClock(rec.timestampMs, ts, sizeof(ts));
+        snprintf(line, sizeof(line), "%s %s", ts, rec.text);
+
+        size_t mark = pos;
+        if ((lines > 0 && !appendJsonEscaped(mqttLogPayload, limit, pos, "\n")) ||
+            !appendJsonEscaped(mqttLogPayload, limit, pos, line)) {
+            pos = mark;
+            full = true;
+            skipped++;
+            continue;
+        }
+        lines++;
+    }
+
+    unsigned long cursorDrops = mqttLogCursor.dropped - mqttLogCursorDropped;
+    mqttLogCursorDropped = mqttLogCursor.dropped;
+    mqttLogStats.dropped += skipped + cursorDrops;
+    if (lines == 0) {
+        return;
+    }
+
+    pos += snprintf(mqttLogPayload + pos, MQTT_LOG_MAX_PAYLOAD - pos,
+                    "\",\"lines\":%u,\"dropped\":%lu}", (unsigned)lines, mqttLogStats.dropped);
+
+    // Report failures on Serial only: a log line here would feed this sink again
+    if (mqttClient.publish(MQTT_TELNET_TOPIC, mqttLogPayload, false)) {
+        mqttLogStats.batches++;
+        mqttLogStats.lines += lines;
+    } else {
+        mqttLogStats.failed++;
+        mqttLogStats.dropped += lines;
+        Serial.printf("[%10lu ms] [MQTT] Failed to publish log batch (%u lines, %u bytes)\r\n",
+                      millis(), (unsigned)lines, (unsigned)pos);
     }
 }
 
+const MQTTLogStats& getMQTTLogStats() {
+    return mqttLogStats;
+}
+
 void onMQTTMessage(char* topic, byte* payload, unsigned int length) {
     // Convert payload to string
     String message;
@@ -577,16 +881,13 @@ void onMQTTMessage(char* topic, byte* payload, unsigned int length) {
     }
     
     String topicStr = String(topic);
-    Serial.printf("MQTT message received: %s -> %s\n", topic, message.c_str());
+    LOG_D(LOG_MOD_MQTT, "Message received: %s -> %s", topic, message.c_str());
     
     // Handle reboot command
     if (topicStr == String(MQTT_COMMAND_TOPIC) + "/reboot") {
         Serial.println("MQTT reboot command received");
-        publishAvailability(false);
-        delay(100);  // Give time for MQTT message to send
-        // Use system utils reboot function
-        extern void setRebootFlag(const char* reason);
-        setRebootFlag("MQTT reboot command");
+        // Availability goes offline from the reboot handler in main
+        requestReboot("MQTT reboot command");
     }
     // Handle alert control
     else if (topicStr == String(MQTT_COMMAND_TOPIC) + "/alerts") {
@@ -610,7 +911,7 @@ void onMQTTMessage(char* topic, byte* payload, unsigned int length) {
         JsonDocument doc;
         DeserializationError err = deserializeJson(doc, message);
         if (err) {
-            Serial.printf("Invalid DNS config JSON: %s\n", err.c_str());
+            LOG_W(LOG_MOD_MQTT, "Invalid DNS config JSON: %s", err.c_str());
             return;
         }
         unsigned long failure = doc["failure_threshold_ms"] | 0UL;
@@ -618,29 +919,84 @@ void onMQTTMessage(char* topic, byte* payload, unsigned int length) {
         unsigned long recovery = doc["recovery_threshold_ms"] | 0UL;
         unsigned long minRec = doc["min_failure_for_recovery_ms"] | 0UL;
         extern void updateDNSConfig(unsigned long, unsigned long, unsigned long, unsigned long);
+        // A change raises EVT_CONFIG_CHANGED, which republishes the status
         updateDNSConfig(failure, interval, recovery, minRec);
-        // Publish updated status after change
-        delay(50);
-        publishAllSensors();
     }
     // Handle network latency/jitter probe config (expects JSON)
     else if (topicStr == String(MQTT_COMMAND_TOPIC) + "/network_config") {
-        // Optional keys: probe_target, interval_ms, samples, timeout_ms
+        // Optional keys: probe_target, interval_ms, samples, timeout_ms, keep_alive, spacing_ms
         JsonDocument doc;
         DeserializationError err = deserializeJson(doc, message);
         if (err) {
-            Serial.printf("Invalid network config JSON: %s\n", err.c_str());
+            LOG_W(LOG_MOD_MQTT, "Invalid network config JSON: %s", err.c_str());
             return;
         }
         const char* target = doc["probe_target"] | "";
         unsigned long interval = doc["interval_ms"] | 0UL;
         uint8_t samples = (uint8_t)(doc["samples"] | 0);
         unsigned long timeout = doc["timeout_ms"] | 0UL;
-        updateNetworkMetricsConfig(target, interval, samples, timeout);
-        // Run an immediate probe with the new settings so HA sees fresh values
-        probeNetworkQuality();
-        delay(50);
-        publishAllSensors();
+        int8_t keepAlive = doc["keep_alive"].is<bool>() ? (doc["keep_alive"].as<bool>() ? 1 : 0) : -1;
+        uint16_t spacing = (uint16_t)(doc["spacing_ms"] | 0);
+        updateNetworkMetricsConfig(target, interval, samples, timeout, keepAlive, spacing);
+        // Probe with the new settings right away; sensors go out when it finishes
+        requestNetworkProbe();
+        probePublishPending = true;
+    }
+    // Extra probe targets (expects a JSON array, [] removes them all)
+    else if (topicStr == String(MQTT_COMMAND_TOPIC) + "/network_targets") {
+        // Entries: name, target; optional interval_ms, samples, timeout_ms
+        JsonDocument doc;
+        DeserializationError err = deserializeJson(doc, message);
+        if (err || !doc.is<JsonArray>()) {
+            LOG_W(LOG_MOD_MQTT, "Invalid network targets JSON: %s", err ? err.c_str() : "not an array");
+            return;
+        }
+        char oldNames[CONFIG_PROBE_TARGETS][CONFIG_PROBE_NAME_LEN];
+        uint8_t oldCount = networkProbeTargetCount();
+        for (uint8_t slot = 1; slot < oldCount; slot++) {
+            strcpy(oldNames[slot - 1], networkProbeTargetName(slot));
+        }
+        if (!updateNetworkProbeTargets(doc.as<JsonArrayConst>())) {
+            return;
+        }
+        // Drop the entities of removed targets, then (re)announce the current ones
+        uint8_t count = networkProbeTargetCount();
+        for (uint8_t i = 0; i + 1 < oldCount; i++) {
+            bool kept = false;
+            for (uint8_t slot = 1; slot < count && !kept; slot++) {
+                kept = strcmp(oldNames[i], networkProbeTargetName(slot)) == 0;
+            }
+            if (!kept) {
+                removeTargetDiscovery(oldNames[i]);
+            }
+        }
+        for (uint8_t slot = 1; slot < count; slot++) {
+            publishTargetDiscovery(slot);
+        }
+    }
+    // Runtime log thresholds (expects JSON object: module -> level),
+    // e.g. {"net":"debug"} or {"all":"info"}
+    else if (topicStr == String(MQTT_COMMAND_TOPIC) + "/log_level") {
+        JsonDocument doc;
+        DeserializationError err = deserializeJson(doc, message);
+        if (err || !doc.is<JsonObject>()) {
+            LOG_W(LOG_MOD_MQTT, "Invalid log level JSON: %s", err ? err.c_str() : "not an object");
+            return;
+        }
+        for (JsonPair kv : doc.as<JsonObject>()) {
+            const char* level = kv.value() | "";
+            if (!logSetModuleLevel(kv.key().c_str(), level)) {
+                LOG_W(LOG_MOD_MQTT, "Rejected log level %s=%s", kv.key().c_str(), level);
+            }
+        }
+        char summary[160];
+        size_t used = 0;
+        for (uint8_t i = 0; i < LOG_MOD_COUNT && used < sizeof(summary); i++) {
+            int n = snprintf(summary + used, sizeof(summary) - used, "%s%s=%s", i ? " " : "",
+                             logModuleName(i), logLevelName(logModuleLevels[i]));
+            if (n > 0) used += (size_t)n;
+        }
+        LOG_I(LOG_MOD_MQTT, "Log levels: %s", summary);
     }
 }
 
@@ -1,6 +1,9 @@
 #ifndef MQTT_MANAGER_H
 #define MQTT_MANAGER_H
 
+// Periodic status publish cadence (registered with the loop scheduler)
+#define MQTT_STATUS_PUBLISH_INTERVAL_MS 30000UL
+
 #ifdef ENABLE_MQTT
 
 #include <WiFiClient.h>
@@ -14,6 +17,7 @@ extern const char* MQTT_AVAILABILITY_TOPIC;
 extern const char* MQTT_DISCOVERY_PREFIX;
 extern const char* MQTT_TELNET_TOPIC;
 extern const char* MQTT_COMMAND_TOPIC;
+extern const char* MQTT_PERF_TOPIC;
 
 // Home Assistant Device Info
 extern const char* HA_DEVICE_NAME;
@@ -27,15 +31,25 @@ void connectToMQTT();
 void publishHomeAssistantDiscovery();
 void publishDeviceStatus();
 void publishAvailability(bool online = true);
-void publishTelnetLog(const String& logMessage);
+void publishTelnetLog();  // batch new log ring lines into one telnet topic message per window
 void handleMQTTLoop();
+void publishMQTTPeriodicStatus();  // Scheduled from loop() every MQTT_STATUS_PUBLISH_INTERVAL_MS
 bool isMQTTConnected();
 
+// Telnet topic log forwarding counters
+struct MQTTLogStats {
+  unsigned long batches;   // messages published
+  unsigned long lines;     // lines delivered in those messages
+  unsigned long dropped;   // lines skipped by the byte budget, lost in the ring, or in a failed publish
+  unsigned long failed;    // publish() calls that returned false
+};
+const MQTTLogStats& getMQTTLogStats();
+
 // MQTT command handling
 void onMQTTMessage(char* topic, byte* payload, unsigned int length);
 
 // Helper functions
-String getDeviceStatusJSON();
+void fillDeviceStatusJSON(JsonDocument& statusDoc);  // consolidated status topic payload
 void publishSensor(const char* component, const char* object_id, const char* name, 
                    const char* unit_of_measurement, const char* device_class, 
                    const char* state_topic, const char* icon = nullptr);
@@ -52,11 +66,12 @@ inline void connectToMQTT() {}
 inline void publishHomeAssistantDiscovery() {}
 inline void publishDeviceStatus() {}
 inline void publishAvailability(bool online = true) {}
-inline void publishTelnetLog(const String& logMessage) {}
+inline void publishTelnetLog() {}
 inline void handleMQTTLoop() {}
+inline void publishMQTTPeriodicStatus() {}
 inline bool isMQTTConnected() { return false; }
 inline void onMQTTMessage(char* topic, byte* payload, unsigned int length) {}
-inline String getDeviceStatusJSON() { return "{}"; }
+
 
 #endif // ENABLE_MQTT
 
@@ -1,10 +1,14 @@
 #include "network_metrics.h"
 #include "config.h"
 #include "telnet.h"
+#include "config_store.h"
+#include "event_bus.h"
+#include "log.h"
+#include "async_http.h"
+#include "icmp_echo.h"
 #include <WiFi.h>
-#include <HTTPClient.h>
-#include <Preferences.h>
 #include <math.h>
+#include <stdlib.h>
 #include <string.h>
 
 // Defaults: lightweight public HTTP endpoint used for connectivity checks
@@ -12,35 +16,258 @@ const char* NETWORK_DEFAULT_PROBE_TARGET = "http://httpbin.org/ip";
 const unsigned long NETWORK_DEFAULT_PROBE_INTERVAL_MS = 60UL * 1000UL;  // 60s
 const uint8_t NETWORK_DEFAULT_PROBE_SAMPLES = 4;
 const unsigned long NETWORK_DEFAULT_PROBE_TIMEOUT_MS = 3000UL;
+const uint16_t NETWORK_DEFAULT_PROBE_SPACING_MS = 50;
 
 char networkProbeTarget[128];
 unsigned long networkProbeIntervalMs = NETWORK_DEFAULT_PROBE_INTERVAL_MS;
 uint8_t networkProbeSamples = NETWORK_DEFAULT_PROBE_SAMPLES;
 unsigned long networkProbeTimeoutMs = NETWORK_DEFAULT_PROBE_TIMEOUT_MS;
+bool networkProbeKeepAlive = false;
+uint16_t networkProbeSpacingMs = NETWORK_DEFAULT_PROBE_SPACING_MS;
 
 float networkLatencyMs = -1.0f;
 float networkJitterMs = -1.0f;
+float networkConnectSetupMs = -1.0f;
 unsigned long lastNetworkProbeMs = 0;
 bool networkProbeOk = false;
 uint8_t networkProbeSuccessCount = 0;
 uint8_t networkProbeAttemptCount = 0;
+float networkRttMinMs = -1.0f;
+float networkRttMaxMs = -1.0f;
+float networkProbeLossPct = -1.0f;
+uint8_t networkProbeLossRuns = 0;
+uint8_t networkProbeLongestLossRun = 0;
+
+static NetworkPhaseStats phaseStats[NET_PHASE_COUNT] = {
+  {-1.0f, -1.0f, -1.0f}, {-1.0f, -1.0f, -1.0f}, {-1.0f, -1.0f, -1.0f}, {-1.0f, -1.0f, -1.0f},
+};
+static AsyncHttpRequest probeReq = {};
+static IcmpEchoBurst probeBurst = {};
 
 static bool configLoaded = false;
+static uint8_t probeRequestMask = 0;      // slots to probe as soon as the stagger allows
+static unsigned long lastProbeEndMs = 0;  // 0 = no probe finished yet
+static_assert(NETWORK_PROBE_MAX_TARGETS == CONFIG_PROBE_TARGETS + 1,
+              "extra probe targets are stored in deviceConfig.net.targets");
+static const NetworkTargetResult EMPTY_RESULT = {0, false, 0, 0, -1.0f, -1.0f, -1.0f, -1.0f, -1.0f, 0, 0};
+static NetworkTargetResult targetResults[NETWORK_PROBE_MAX_TARGETS] = {
+  EMPTY_RESULT, EMPTY_RESULT, EMPTY_RESULT, EMPTY_RESULT,
+};
+
+// P-squared estimate of one quantile. Marker positions are 1-based.
+struct P2Quantile {
+  float p;
+  float height[5];
+  int32_t pos[5];
+  float desired[5];
+  uint32_t count;
+};
+
+// Sliding-window maximum: one maximum per slot, tagged with its slot number
+// plus one (0: empty)
+struct WindowMax {
+  uint32_t slotMs;
+  uint8_t slots;
+  uint32_t tag[24];
+  float max[24];
+};
+
+static P2Quantile latencyQuantiles[3] = {
+  {0.50f, {}, {}, {}, 0},
+  {0.95f, {}, {}, {}, 0},
+  {0.99f, {}, {}, {}, 0},
+};
+static WindowMax latencyMax[3] = {
+  {30UL * 1000UL, 10, {}, {}},        // 5 min
+  {5UL * 60UL * 1000UL, 12, {}, {}},  // 1 h
+  {60UL * 60UL * 1000UL, 24, {}, {}}, // 24 h
+};
+static unsigned long latencySamples = 0;
+
+static void p2Reset(P2Quantile& q) {
+  float p = q.p;
+  memset(&q, 0, sizeof(q));
+  q.p = p;
+}
+
+static void p2Add(P2Quantile& q, float x) {
+  if (q.count < 5) {
+    // Warm-up: keep the first five samples sorted
+    uint8_t i = q.count++;
+    while (i > 0 && q.height[i - 1] > x) {
+      q.height[i] = q.height[i - 1];
+      i--;
+    }
+    q.height[i] = x;
+    if (q.count == 5) {
+      for (uint8_t m = 0; m < 5; m++) q.pos[m] = m + 1;
+      q.desired[0] = 1.0f;
+      q.desired[1] = 1.0f + 2.0f * q.p;
+      q.desired[2] = 1.0f + 4.0f * q.p;
+      q.desired[3] = 3.0f + 2.0f * q.p;
+      q.desired[4] = 5.0f;
+    }
+    return;
+  }
+  q.count++;
+
+  uint8_t k;
+  if (x < q.height[0]) {
+    q.height[0] = x;
+    k = 0;
+  } else if (x >= q.height[4]) {
+    q.height[4] = x;
+    k = 3;
+  } else {
+    k = 0;
+    while (x >= q.height[k + 1]) k++;
+  }
+  for (uint8_t m = k + 1; m < 5; m++) q.pos[m]++;
+  const float step[5] = {0.0f, q.p / 2.0f, q.p, (1.0f + q.p) / 2.0f, 1.0f};
+  for (uint8_t m = 0; m < 5; m++) q.desired[m] += step[m];
+
+  // Move the middle markers toward their desired positions
+  for (uint8_t m = 1; m < 4; m++) {
+    float d = q.desired[m] - q.pos[m];
+    if ((d >= 1.0f && q.pos[m + 1] - q.pos[m] > 1) || (d <= -1.0f && q.pos[m - 1] - q.pos[m] < -1)) {
+      int32_t s = d > 0.0f ? 1 : -1;
+      float below = (float)(q.pos[m] - q.pos[m - 1]);
+      float above = (float)(q.pos[m + 1] - q.pos[m]);
+      float h = q.height[m] + s / (float)(q.pos[m + 1] - q.pos[m - 1]) *
+                ((below + s) * (q.height[m + 1] - q.height[m]) / above +
+                 (above - s) * (q.height[m] - q.height[m - 1]) / below);
+      if (!(q.height[m - 1] < h && h < q.height[m + 1])) {
+        // Parabola overshoots a neighbour: fall back to linear
+        h = q.height[m] + s * (q.height[m + s] - q.height[m]) / (float)(q.pos[m + s] - q.pos[m]);
+      }
+      q.height[m] = h;
+      q.pos[m] += s;
+    }
+  }
+}
+
+static float p2Value(const P2Quantile& q) {
+  if (q.count == 0) return -1.0f;
+  if (q.count >= 5) return q.height[2];
+  // Warm-up samples are sorted: nearest rank
+  uint8_t rank = (uint8_t)ceilf(q.p * q.count);
+  return q.height[rank > 0 ? rank - 1 : 0];
+}
+
+static void windowMaxAdd(WindowMax& w, unsigned long now, float x) {
+  uint32_t tag = now / w.slotMs + 1;
+  uint8_t slot = tag % w.slots;
+  if (w.tag[slot] != tag) {
+    w.tag[slot] = tag;
+    w.max[slot] = x;
+  } else if (x > w.max[slot]) {
+    w.max[slot] = x;
+  }
+}
+
+static float windowMaxValue(const WindowMax& w, unsigned long now) {
+  uint32_t tag = now / w.slotMs + 1;
+  float result = -1.0f;
+  for (uint8_t i = 0; i < w.slots; i++) {
+    if (w.tag[i] != 0 && tag - w.tag[i] < w.slots && w.max[i] > result) result = w.max[i];
+  }
+  return result;
+}
+
+static void resetLatencyStats() {
+  for (P2Quantile& q : latencyQuantiles) p2Reset(q);
+  for (WindowMax& w : latencyMax) memset(w.tag, 0, sizeof(w.tag));
+  latencySamples = 0;
+}
+
+static void addLatencySample(float rttMs) {
+  unsigned long now = millis();
+  for (P2Quantile& q : latencyQuantiles) p2Add(q, rttMs);
+  for (WindowMax& w : latencyMax) windowMaxAdd(w, now, rttMs);
+  latencySamples++;
+}
+
+void getNetworkLatencyStats(NetworkLatencyStats& out) {
+  unsigned long now = millis();
+  out.samples = latencySamples;
+  out.p50Ms = p2Value(latencyQuantiles[0]);
+  out.p95Ms = p2Value(latencyQuantiles[1]);
+  out.p99Ms = p2Value(latencyQuantiles[2]);
+  out.max5mMs = windowMaxValue(latencyMax[0], now);
+  out.max1hMs = windowMaxValue(latencyMax[1], now);
+  out.max24hMs = windowMaxValue(latencyMax[2], now);
+}
+
+static void addMs(JsonObject out, const char* key, float ms) {
+  if (ms >= 0.0f) {
+    out[key] = roundf(ms * 10.0f) / 10.0f;
+  } else {
+    out[key] = nullptr;
+  }
+}
+
+void addNetworkLatencyStatsJSON(JsonObject out) {
+  NetworkLatencyStats stats;
+  getNetworkLatencyStats(stats);
+  addMs(out, "p50", stats.p50Ms);
+  addMs(out, "p95", stats.p95Ms);
+  addMs(out, "p99", stats.p99Ms);
+  addMs(out, "max_5m", stats.max5mMs);
+  addMs(out, "max_1h", stats.max1hMs);
+  addMs(out, "max_24h", stats.max24hMs);
+  out["samples"] = stats.samples;
+}
 
 static void setDefaultProbeTarget() {
   strncpy(networkProbeTarget, NETWORK_DEFAULT_PROBE_TARGET, sizeof(networkProbeTarget) - 1);
   networkProbeTarget[sizeof(networkProbeTarget) - 1] = '\0';
 }
 
-static bool isValidHttpUrl(const char* url) {
+NetworkProbeProtocol networkProbeProtocol(const char* target) {
+  if (strncmp(target, "icmp://", 7) == 0) return NET_PROTO_ICMP;
+  if (strncmp(target, "tcp://", 6) == 0) return NET_PROTO_TCP;
+  return NET_PROTO_HTTP;
+}
+
+const char* networkProbeProtocolName(NetworkProbeProtocol protocol) {
+  switch (protocol) {
+    case NET_PROTO_HTTP: return "http";
+    case NET_PROTO_ICMP: return "icmp";
+    case NET_PROTO_TCP:  return "tcp";
+  }
+  return "unknown";
+}
+
+// http://host[:port][/path], icmp://host or tcp://host:port
+static bool isValidProbeTarget(const char* url) {
   if (url == nullptr || url[0] == '\0') return false;
   size_t len = strlen(url);
-  if (len < 10 || len >= sizeof(networkProbeTarget)) return false;
-  // Only allow http:// to avoid TLS heap pressure on ESP32-C3 for background probes
-  if (strncmp(url, "http://", 7) != 0) return false;
-  // Basic sanity: host present after scheme
-  if (url[7] == '\0' || url[7] == '/') return false;
-  // Reject characters that break HTTPClient / storage
+  if (len < 7 || len >= sizeof(networkProbeTarget)) return false;
+  switch (networkProbeProtocol(url)) {
+    case NET_PROTO_ICMP:
+      // Host only; it must fit the echo engine's name buffer
+      if (len - 7 == 0 || len - 7 >= sizeof(probeBurst.host) || strchr(url + 7, '/') != nullptr ||
+          strchr(url + 7, ':') != nullptr) {
+        return false;
+      }
+      break;
+    case NET_PROTO_TCP: {
+      // Host and port, nothing after
+      const char* colon = strchr(url + 6, ':');
+      if (colon == nullptr || colon == url + 6 || strchr(url + 6, '/') != nullptr) return false;
+      char* end = nullptr;
+      long port = strtol(colon + 1, &end, 10);
+      if (port <= 0 || port > 65535 || *end != '\0') return false;
+      break;
+    }
+    default:
+      // Only allow http:// to avoid TLS heap pressure on ESP32-C3 for background probes
+      if (len < 10 || strncmp(url, "http://", 7) != 0) return false;
+      // Basic sanity: host present after scheme
+      if (url[7] == '/') return false;
+      break;
+  }
+  // Reject characters that break HTTP requests / storage
   for (size_t i = 0; i < len; i++) {
     char c = url[i];
     if (c < 32 || c > 126) return false;
@@ -49,6 +276,43 @@ static bool isValidHttpUrl(const char* url) {
   return true;
 }
 
+// Extra targets: [a-z0-9_] names (they end up in MQTT topics and entity ids)
+static bool isValidTargetName(const char* name) {
+  size_t len = strlen(name);
+  if (len == 0 || len >= CONFIG_PROBE_NAME_LEN || strcmp(name, "primary") == 0) return false;
+  for (size_t i = 0; i < len; i++) {
+    char c = name[i];
+    if (!((c >= 'a' && c <= 'z') || (c >= '0' && c <= '9') || c == '_')) return false;
+  }
+  return true;
+}
+
+static bool isValidTarget(const NetProbeTargetConfig& t) {
+  const unsigned long MAX_INTERVAL = 24UL * 60UL * 60UL * 1000UL;
+  return isValidTargetName(t.name) && isValidProbeTarget(t.url) &&
+         t.intervalMs >= 10000UL && t.intervalMs <= MAX_INTERVAL &&
+         t.samples >= 2 && t.samples <= NETWORK_PROBE_MAX_SAMPLES &&
+         t.timeoutMs >= 500UL && t.timeoutMs <= 15000UL;
+}
+
+// Drop stored entries this firmware would not accept, keeping the table packed
+static void loadProbeTargets() {
+  NetProbeTargetConfig* targets = deviceConfig.net.targets;
+  uint8_t kept = 0;
+  for (uint8_t i = 0; i < CONFIG_PROBE_TARGETS; i++) {
+    if (targets[i].url[0] == '\0') break;
+    if (!isValidTarget(targets[i])) {
+      LOG_W(LOG_MOD_NET, "Ignoring invalid stored probe target %s", targets[i].name);
+      continue;
+    }
+    if (kept != i) targets[kept] = targets[i];
+    kept++;
+  }
+  for (uint8_t i = kept; i < CONFIG_PROBE_TARGETS; i++) {
+    memset(&targets[i], 0, sizeof(targets[i]));
+  }
+}
+
 void loadNetworkMetricsConfigFromStorage() {
   if (configLoaded) return;
 
@@ -56,22 +320,23 @@ void loadNetworkMetricsConfigFromStorage() {
   networkProbeIntervalMs = NETWORK_DEFAULT_PROBE_INTERVAL_MS;
   networkProbeSamples = NETWORK_DEFAULT_PROBE_SAMPLES;
   networkProbeTimeoutMs = NETWORK_DEFAULT_PROBE_TIMEOUT_MS;
+  networkProbeKeepAlive = false;
+  networkProbeSpacingMs = NETWORK_DEFAULT_PROBE_SPACING_MS;
 
-  Preferences prefs;
-  if (!prefs.begin("net_metrics", true)) {
-    Serial.println("[NET] No stored network metrics config, using defaults");
+  const NetMetricsConfig& stored = deviceConfig.net;
+  if (!stored.stored) {
+    LOG_I(LOG_MOD_NET, "No stored network metrics config, using defaults");
     configLoaded = true;
     return;
   }
 
-  String target = prefs.getString("probe_tgt", NETWORK_DEFAULT_PROBE_TARGET);
-  unsigned long interval = prefs.getULong("interval", NETWORK_DEFAULT_PROBE_INTERVAL_MS);
-  uint8_t samples = (uint8_t)prefs.getUChar("samples", NETWORK_DEFAULT_PROBE_SAMPLES);
-  unsigned long timeout = prefs.getULong("timeout", NETWORK_DEFAULT_PROBE_TIMEOUT_MS);
-  prefs.end();
+  const char* target = stored.probeTarget;
+  unsigned long interval = stored.intervalMs;
+  uint8_t samples = stored.samples;
+  unsigned long timeout = stored.timeoutMs;
 
-  if (isValidHttpUrl(target.c_str())) {
-    strncpy(networkProbeTarget, target.c_str(), sizeof(networkProbeTarget) - 1);
+  if (isValidProbeTarget(target)) {
+    strncpy(networkProbeTarget, target, sizeof(networkProbeTarget) - 1);
     networkProbeTarget[sizeof(networkProbeTarget) - 1] = '\0';
   } else {
     setDefaultProbeTarget();
@@ -81,48 +346,57 @@ void loadNetworkMetricsConfigFromStorage() {
   if (interval >= 10000UL && interval <= MAX_INTERVAL) {
     networkProbeIntervalMs = interval;
   }
-  if (samples >= 2 && samples <= 10) {
+  if (samples >= 2 && samples <= NETWORK_PROBE_MAX_SAMPLES) {
     networkProbeSamples = samples;
   }
   if (timeout >= 500UL && timeout <= 15000UL) {
     networkProbeTimeoutMs = timeout;
   }
+  networkProbeKeepAlive = stored.keepAlive != 0;
+  if (stored.spacingMs >= 10 && stored.spacingMs <= 1000) {
+    networkProbeSpacingMs = stored.spacingMs;
+  }
+
+  loadProbeTargets();
 
   configLoaded = true;
-  Serial.printf("[NET] Loaded config: target=%s interval=%lu ms samples=%u timeout=%lu ms\r\n",
-                networkProbeTarget, networkProbeIntervalMs, networkProbeSamples, networkProbeTimeoutMs);
+  LOG_I(LOG_MOD_NET, "Loaded config: target=%s interval=%lu ms samples=%u timeout=%lu ms keep_alive=%d spacing=%u ms",
+        networkProbeTarget, networkProbeIntervalMs, networkProbeSamples, networkProbeTimeoutMs,
+        networkProbeKeepAlive, networkProbeSpacingMs);
 }
 
 void saveNetworkMetricsConfigToStorage() {
-  Preferences prefs;
-  if (!prefs.begin("net_metrics", false)) {
-    Serial.println("[NET] Failed to open NVS for network metrics save");
-    return;
-  }
-  prefs.putString("probe_tgt", networkProbeTarget);
-  prefs.putULong("interval", networkProbeIntervalMs);
-  prefs.putUChar("samples", networkProbeSamples);
-  prefs.putULong("timeout", networkProbeTimeoutMs);
-  prefs.end();
-  Serial.println("[NET] Network metrics config saved to NVS");
+  NetMetricsConfig& stored = deviceConfig.net;
+  strncpy(stored.probeTarget, networkProbeTarget, sizeof(stored.probeTarget) - 1);
+  stored.probeTarget[sizeof(stored.probeTarget) - 1] = '\0';
+  stored.intervalMs = networkProbeIntervalMs;
+  stored.samples = networkProbeSamples;
+  stored.timeoutMs = networkProbeTimeoutMs;
+  stored.keepAlive = networkProbeKeepAlive ? 1 : 0;
+  stored.spacingMs = networkProbeSpacingMs;
+  configStoreMarkDirty(CFG_NET_METRICS);
+  LOG_D(LOG_MOD_NET, "Network metrics config queued for NVS write-behind");
 }
 
 void updateNetworkMetricsConfig(const char* probeTarget,
                                 unsigned long intervalMs,
                                 uint8_t samples,
-                                unsigned long timeoutMs) {
+                                unsigned long timeoutMs,
+                                int8_t keepAlive,
+                                uint16_t spacingMs) {
   bool changed = false;
   const unsigned long MAX_INTERVAL = 24UL * 60UL * 60UL * 1000UL;
 
   if (probeTarget != nullptr && probeTarget[0] != '\0') {
-    if (isValidHttpUrl(probeTarget)) {
+    if (isValidProbeTarget(probeTarget)) {
       if (strncmp(networkProbeTarget, probeTarget, sizeof(networkProbeTarget)) != 0) {
         strncpy(networkProbeTarget, probeTarget, sizeof(networkProbeTarget) - 1);
         networkProbeTarget[sizeof(networkProbeTarget) - 1] = '\0';
+        resetLatencyStats();  // a new target has its own distribution
         changed = true;
       }
     } else {
-      Serial.printf("[NET] Rejected invalid probe target: %s\r\n", probeTarget);
+      LOG_W(LOG_MOD_NET, "Rejected invalid probe target: %s", probeTarget);
     }
   }
 
@@ -133,18 +407,18 @@ void updateNetworkMetricsConfig(const char* probeTarget,
         changed = true;
       }
     } else {
-      Serial.printf("[NET] Rejected invalid interval_ms: %lu\r\n", intervalMs);
+      LOG_W(LOG_MOD_NET, "Rejected invalid interval_ms: %lu", intervalMs);
     }
   }
 
   if (samples != 0) {
-    if (samples >= 2 && samples <= 10) {
+    if (samples >= 2 && samples <= NETWORK_PROBE_MAX_SAMPLES) {
       if (samples != networkProbeSamples) {
         networkProbeSamples = samples;
         changed = true;
       }
     } else {
-      Serial.printf("[NET] Rejected invalid samples: %u\r\n", samples);
+      LOG_W(LOG_MOD_NET, "Rejected invalid samples: %u", samples);
     }
   }
 
@@ -155,107 +429,484 @@ void updateNetworkMetricsConfig(const char* probeTarget,
         changed = true;
       }
     } else {
-      Serial.printf("[NET] Rejected invalid timeout_ms: %lu\r\n", timeoutMs);
+      LOG_W(LOG_MOD_NET, "Rejected invalid timeout_ms: %lu", timeoutMs);
+    }
+  }
+
+  if (keepAlive >= 0 && (keepAlive != 0) != networkProbeKeepAlive) {
+    networkProbeKeepAlive = keepAlive != 0;
+    changed = true;
+  }
+
+  if (spacingMs != 0) {
+    if (spacingMs >= 10 && spacingMs <= 1000) {
+      if (spacingMs != networkProbeSpacingMs) {
+        networkProbeSpacingMs = spacingMs;
+        changed = true;
+      }
+    } else {
+      LOG_W(LOG_MOD_NET, "Rejected invalid spacing_ms: %u", spacingMs);
     }
   }
 
   if (changed) {
-    Serial.printf("[NET] Updated config: target=%s interval=%lu ms samples=%u timeout=%lu ms\r\n",
-                  networkProbeTarget, networkProbeIntervalMs, networkProbeSamples, networkProbeTimeoutMs);
+    LOG_I(LOG_MOD_NET, "Updated config: target=%s interval=%lu ms samples=%u timeout=%lu ms keep_alive=%d spacing=%u ms",
+          networkProbeTarget, networkProbeIntervalMs, networkProbeSamples, networkProbeTimeoutMs,
+          networkProbeKeepAlive, networkProbeSpacingMs);
     saveNetworkMetricsConfigToStorage();
+    eventPublishConfigChanged(CFG_NET_METRICS);
   } else {
-    Serial.println("[NET] updateNetworkMetricsConfig called but no values changed");
+    LOG_D(LOG_MOD_NET, "updateNetworkMetricsConfig called but no values changed");
+  }
+}
+
+uint8_t networkProbeTargetCount() {
+  uint8_t count = 1;
+  while (count < NETWORK_PROBE_MAX_TARGETS && deviceConfig.net.targets[count - 1].url[0] != '\0') {
+    count++;
   }
+  return count;
+}
+
+const char* networkProbeTargetName(uint8_t slot) {
+  return slot == 0 ? "primary" : deviceConfig.net.targets[slot - 1].name;
 }
 
-// Single HTTP RTT sample in milliseconds; returns -1 on failure
-static float measureHttpRttMs(const char* url) {
-  WiFiClient client;
-  HTTPClient http;
+const char* networkProbeTargetUrl(uint8_t slot) {
+  return slot == 0 ? networkProbeTarget : deviceConfig.net.targets[slot - 1].url;
+}
 
-  unsigned long start = millis();
-  if (!http.begin(client, url)) {
-    return -1.0f;
+unsigned long networkProbeTargetIntervalMs(uint8_t slot) {
+  return slot == 0 ? networkProbeIntervalMs : deviceConfig.net.targets[slot - 1].intervalMs;
+}
+
+const NetworkTargetResult& getNetworkTargetResult(uint8_t slot) {
+  return slot < NETWORK_PROBE_MAX_TARGETS ? targetResults[slot] : EMPTY_RESULT;
+}
+
+void addNetworkTargetsJSON(JsonArray out) {
+  unsigned long now = millis();
+  for (uint8_t slot = 0; slot < networkProbeTargetCount(); slot++) {
+    const NetworkTargetResult& r = targetResults[slot];
+    JsonObject t = out.add<JsonObject>();
+    t["name"] = networkProbeTargetName(slot);
+    t["target"] = networkProbeTargetUrl(slot);
+    t["protocol"] = networkProbeProtocolName(networkProbeProtocol(networkProbeTargetUrl(slot)));
+    t["interval_ms"] = networkProbeTargetIntervalMs(slot);
+    if (r.lastProbeMs == 0) {
+      t["age_s"] = nullptr;
+    } else {
+      t["age_s"] = (now - r.lastProbeMs) / 1000UL;
+    }
+    t["ok"] = r.ok;
+    addMs(t, "latency_ms", r.latencyMs);
+    addMs(t, "jitter_ms", r.jitterMs);
+    addMs(t, "rtt_min_ms", r.rttMinMs);
+    addMs(t, "rtt_max_ms", r.rttMaxMs);
+    if (r.lossPct >= 0.0f) {
+      t["loss_pct"] = roundf(r.lossPct * 10.0f) / 10.0f;
+    } else {
+      t["loss_pct"] = nullptr;
+    }
+    t["longest_loss_run"] = r.longestLossRun;
+  }
+}
+
+struct ProbeSample {
+  float totalMs;    // what the sample reports as latency
+  float phaseMs[NET_PHASE_COUNT];
+  bool opened;      // this sample paid for a new connection (dns/connect valid)
+};
+
+// One probe run: one target's samples, stepped from loop() without
+// blocking. HTTP in fresh-connection mode and TCP connects leave
+// networkProbeSpacingMs between samples; in keep-alive mode (primary target
+// only) they go back to back on one connection. An icmp:// target sends the
+// samples as one echo burst, spaced the same way, with replies collected as
+// they arrive.
+enum ProbeRunState : uint8_t {
+  PROBE_IDLE = 0,
+  PROBE_SAMPLING,
+  PROBE_GAP
+};
+
+struct ProbeRun {
+  ProbeRunState state;
+  uint8_t slot;           // target being probed
+  NetworkProbeProtocol protocol;
+  bool keepAlive;
+  bool reused;            // current sample runs on the kept connection
+  uint8_t total;
+  uint8_t attempt;        // samples started
+  uint8_t okCount;
+  uint32_t okMask;        // bit per attempt that got an answer
+  unsigned long timeoutMs;
+  unsigned long gapStartMs;
+  char url[sizeof(networkProbeTarget)];  // the target with "gateway" resolved
+  ProbeSample samples[NETWORK_PROBE_MAX_SAMPLES];
+};
+
+static ProbeRun probeRun = {};
+
+static void startSample() {
+  ProbeRun& run = probeRun;
+  run.attempt++;
+  run.reused = run.keepAlive && asyncHttpReuse(probeReq, run.timeoutMs);
+  if (!run.reused) {
+    if (run.protocol == NET_PROTO_TCP) {
+      asyncHttpBeginConnect(probeReq, run.url, run.timeoutMs);
+    } else if (run.keepAlive) {
+      asyncHttpBeginKeepAlive(probeReq, run.url, run.timeoutMs);
+    } else {
+      asyncHttpBegin(probeReq, run.url, run.timeoutMs);
+    }
   }
-  http.setTimeout((int)networkProbeTimeoutMs);
-  http.setReuse(false);
+  run.state = PROBE_SAMPLING;
+}
 
-  int code = http.GET();
-  unsigned long elapsed = millis() - start;
-  http.end();
+// Latency (mean), jitter (mean absolute difference between consecutive
+// successful samples), RTT spread and loss over the run's attempts. A loss
+// run is a maximal stretch of consecutive unanswered attempts: one long run
+// is an outage, many short ones are random drops.
+static void summarizeRun(const ProbeRun& run, NetworkTargetResult& out) {
+  const uint8_t okCount = run.okCount;
+  const ProbeSample* samples = run.samples;
+  out.lastProbeMs = millis();
+  out.ok = okCount > 0;
+  out.successes = okCount;
+  out.attempts = run.attempt;
+
+  uint8_t runs = 0, longest = 0, current = 0;
+  for (uint8_t i = 0; i < run.attempt; i++) {
+    if (run.okMask & (1UL << i)) {
+      current = 0;
+      continue;
+    }
+    if (current++ == 0) runs++;
+    if (current > longest) longest = current;
+  }
+  out.lossRuns = runs;
+  out.longestLossRun = longest;
+  out.lossPct = run.attempt > 0 ? 100.0f * (run.attempt - okCount) / run.attempt : -1.0f;
 
-  // Any completed HTTP exchange counts for latency (including 4xx/5xx);
-  // connection/timeout failures return negative codes from HTTPClient.
-  if (code > 0) {
-    return (float)elapsed;
+  out.latencyMs = out.jitterMs = out.rttMinMs = out.rttMaxMs = -1.0f;
+  if (okCount == 0) {
+    return;
   }
-  return -1.0f;
+  float sum = 0.0f;
+  for (uint8_t i = 0; i < okCount; i++) {
+    float ms = samples[i].totalMs;
+    if (i == 0 || ms < out.rttMinMs) out.rttMinMs = ms;
+    if (i == 0 || ms > out.rttMaxMs) out.rttMaxMs = ms;
+    sum += ms;
+  }
+  out.latencyMs = sum / (float)okCount;
+  float jsum = 0.0f;
+  for (uint8_t i = 1; i < okCount; i++) {
+    jsum += fabsf(samples[i].totalMs - samples[i - 1].totalMs);
+  }
+  out.jitterMs = okCount >= 2 ? jsum / (float)(okCount - 1) : 0.0f;
 }
 
-bool probeNetworkQuality() {
-  if (WiFi.status() != WL_CONNECTED) {
-    networkProbeOk = false;
+// Fill out from the finished request. Any completed HTTP exchange counts
+// for latency (including 4xx/5xx), as does a completed TCP handshake;
+// connection/timeout failures do not.
+static bool readSample(bool keepAlive, bool reused, ProbeSample& out) {
+  if (probeReq.phase != AHTTP_DONE || (!probeReq.connectOnly && probeReq.statusCode <= 0)) {
     return false;
   }
+  const AsyncHttpTimings& t = probeReq.timings;
+  unsigned long ttfb = t.sendMs + t.firstByteMs;
+  unsigned long transfer = t.totalMs - t.resolveMs - t.connectMs - ttfb;
+  out.opened = !reused;
+  out.phaseMs[NET_PHASE_DNS] = (float)t.resolveMs;
+  out.phaseMs[NET_PHASE_CONNECT] = (float)t.connectMs;
+  out.phaseMs[NET_PHASE_TTFB] = (float)ttfb;
+  out.phaseMs[NET_PHASE_TRANSFER] = (float)transfer;
+  // Keep-alive mode reports the request round trip alone; setup is separate
+  out.totalMs = keepAlive ? (float)(ttfb + transfer) : (float)t.totalMs;
+  return true;
+}
 
-  if (networkProbeTarget[0] == '\0') {
-    setDefaultProbeTarget();
+// dns and connect only average over samples that opened a connection
+static void updatePhaseStats(const ProbeSample* samples, uint8_t count) {
+  for (uint8_t p = 0; p < NET_PHASE_COUNT; p++) {
+    NetworkPhaseStats& s = phaseStats[p];
+    bool setupPhase = (p == NET_PHASE_DNS || p == NET_PHASE_CONNECT);
+    float sum = 0.0f;
+    uint8_t used = 0;
+    for (uint8_t i = 0; i < count; i++) {
+      if (setupPhase && !samples[i].opened) continue;
+      float v = samples[i].phaseMs[p];
+      if (used == 0 || v < s.minMs) s.minMs = v;
+      if (used == 0 || v > s.maxMs) s.maxMs = v;
+      sum += v;
+      used++;
+    }
+    if (used == 0) {
+      s.meanMs = s.minMs = s.maxMs = -1.0f;
+    } else {
+      s.meanMs = sum / (float)used;
+    }
   }
+  networkConnectSetupMs = -1.0f;
+  if (phaseStats[NET_PHASE_CONNECT].meanMs >= 0.0f) {
+    networkConnectSetupMs = phaseStats[NET_PHASE_DNS].meanMs + phaseStats[NET_PHASE_CONNECT].meanMs;
+  }
+}
 
-  const uint8_t n = networkProbeSamples;
-  float samples[10];
-  uint8_t okCount = 0;
+const NetworkPhaseStats& getNetworkPhaseStats(uint8_t phase) {
+  return phaseStats[phase < NET_PHASE_COUNT ? phase : 0];
+}
 
-  Serial.printf("[%10lu ms] [NET] Probing latency/jitter target=%s samples=%u\r\n",
-                millis(), networkProbeTarget, n);
+const char* networkPhaseName(uint8_t phase) {
+  switch (phase) {
+    case NET_PHASE_DNS:      return "dns";
+    case NET_PHASE_CONNECT:  return "connect";
+    case NET_PHASE_TTFB:     return "ttfb";
+    case NET_PHASE_TRANSFER: return "transfer";
+  }
+  return "unknown";
+}
 
-  for (uint8_t i = 0; i < n && i < 10; i++) {
-    float rtt = measureHttpRttMs(networkProbeTarget);
-    networkProbeAttemptCount = i + 1;
-    if (rtt >= 0.0f) {
-      samples[okCount++] = rtt;
-      Serial.printf("[%10lu ms] [NET] Sample %u: %.0f ms\r\n", millis(), i + 1, rtt);
-    } else {
-      Serial.printf("[%10lu ms] [NET] Sample %u: failed\r\n", millis(), i + 1);
+void addNetworkPhaseJSON(JsonObject out) {
+  for (uint8_t p = 0; p < NET_PHASE_COUNT; p++) {
+    JsonObject phase = out[networkPhaseName(p)].to<JsonObject>();
+    addMs(phase, "mean", phaseStats[p].meanMs);
+    addMs(phase, "min", phaseStats[p].minMs);
+    addMs(phase, "max", phaseStats[p].maxMs);
+  }
+}
+
+void addNetworkProbeResultJSON(JsonObject out) {
+  out["engine"] = networkProbeProtocolName(networkProbeProtocol(networkProbeTarget));
+  addMs(out, "rtt_min_ms", networkRttMinMs);
+  addMs(out, "rtt_max_ms", networkRttMaxMs);
+  if (networkProbeLossPct >= 0.0f) {
+    out["loss_pct"] = roundf(networkProbeLossPct * 10.0f) / 10.0f;
+  } else {
+    out["loss_pct"] = nullptr;
+  }
+  out["loss_runs"] = networkProbeLossRuns;
+  out["longest_loss_run"] = networkProbeLongestLossRun;
+}
+
+static void finishProbe() {
+  ProbeRun& run = probeRun;
+  asyncHttpAbort(probeReq);  // drops a kept-alive connection too
+  icmpEchoAbort(probeBurst);
+  run.state = PROBE_IDLE;
+  lastProbeEndMs = millis();
+
+  NetworkTargetResult& res = targetResults[run.slot];
+  summarizeRun(run, res);
+  if (run.slot == 0) {
+    lastNetworkProbeMs = res.lastProbeMs;
+    networkProbeOk = res.ok;
+    networkProbeSuccessCount = res.successes;
+    networkProbeAttemptCount = res.attempts;
+    networkLatencyMs = res.latencyMs;
+    networkJitterMs = res.jitterMs;
+    networkRttMinMs = res.rttMinMs;
+    networkRttMaxMs = res.rttMaxMs;
+    networkProbeLossPct = res.lossPct;
+    networkProbeLossRuns = res.lossRuns;
+    networkProbeLongestLossRun = res.longestLossRun;
+    // Echo replies have no phases
+    updatePhaseStats(run.samples, run.protocol == NET_PROTO_ICMP ? 0 : run.okCount);
+  }
+
+  const char* name = networkProbeTargetName(run.slot);
+  if (!res.ok) {
+    LOG_W(LOG_MOD_NET, "Probe %s failed — no successful samples", name);
+  } else if (run.protocol == NET_PROTO_ICMP) {
+    LOG_I(LOG_MOD_NET, "%s: RTT min/avg/max=%.1f/%.1f/%.1f ms Jitter=%.1f ms loss=%.0f%% (%u runs, longest %u)",
+          name, res.rttMinMs, res.latencyMs, res.rttMaxMs, res.jitterMs, res.lossPct, res.lossRuns,
+          res.longestLossRun);
+  } else if (run.keepAlive) {
+    LOG_I(LOG_MOD_NET, "%s: Latency=%.1f ms Jitter=%.1f ms Setup=%.1f ms (%u/%u samples, keep-alive)",
+          name, res.latencyMs, res.jitterMs, networkConnectSetupMs, res.successes, res.attempts);
+  } else {
+    LOG_I(LOG_MOD_NET, "%s: Latency=%.1f ms Jitter=%.1f ms (%u/%u samples)",
+          name, res.latencyMs, res.jitterMs, res.successes, res.attempts);
+  }
+  eventPublishNetworkProbe(res.ok, res.successes, res.attempts, run.slot);
+}
+
+static void abortProbe() {
+  asyncHttpAbort(probeReq);
+  icmpEchoAbort(probeBurst);
+  probeRun.state = PROBE_IDLE;
+  lastProbeEndMs = millis();
+}
+
+static void completeSample() {
+  ProbeRun& run = probeRun;
+  ProbeSample& sample = run.samples[run.okCount];
+  if (readSample(run.keepAlive, run.reused, sample)) {
+    run.okMask |= 1UL << (run.attempt - 1);
+    run.okCount++;
+    if (run.slot == 0) {
+      addLatencySample(sample.totalMs);
+    }
+    LOG_D(LOG_MOD_NET, "Sample %u: %.0f ms (dns %.0f, connect %.0f, ttfb %.0f, transfer %.0f)%s", run.attempt,
+          sample.totalMs, sample.phaseMs[NET_PHASE_DNS], sample.phaseMs[NET_PHASE_CONNECT],
+          sample.phaseMs[NET_PHASE_TTFB], sample.phaseMs[NET_PHASE_TRANSFER], run.reused ? " reused" : "");
+  } else if (run.reused && !probeReq.firstByte) {
+    // The server dropped the idle kept connection: not a network failure,
+    // repeat the sample on a new one
+    LOG_D(LOG_MOD_NET, "Sample %u: kept connection closed by server, reconnecting", run.attempt);
+    run.attempt--;
+    asyncHttpAbort(probeReq);
+    startSample();
+    return;
+  } else {
+    LOG_D(LOG_MOD_NET, "Sample %u: failed during %s", run.attempt, asyncHttpPhaseName(probeReq.failedPhase));
+  }
+
+  if (run.attempt >= run.total) {
+    finishProbe();
+  } else if (run.keepAlive) {
+    startSample();
+  } else {
+    run.gapStartMs = millis();
+    run.state = PROBE_GAP;
+  }
+}
+
+// Every request of the burst is an attempt; each reply a sample
+static void completeBurst() {
+  ProbeRun& run = probeRun;
+  const IcmpEchoBurst& burst = probeBurst;
+  if (burst.phase == ICMP_FAILED) {
+    LOG_D(LOG_MOD_NET, "Echo burst failed: %s", icmpEchoErrorString(burst.error));
+  }
+  run.attempt = burst.sent > 0 ? burst.sent : run.total;
+  run.okMask = burst.replied;
+  for (uint8_t i = 0; i < burst.sent; i++) {
+    if (!(burst.replied & (1UL << i))) {
+      LOG_D(LOG_MOD_NET, "Echo %u: lost", i + 1);
+      continue;
     }
-    // Small gap between samples to avoid hammering the target
-    if (i + 1 < n) {
-      delay(50);
+    ProbeSample& sample = run.samples[run.okCount++];
+    sample.totalMs = burst.rttUs[i] / 1000.0f;
+    sample.opened = false;
+    if (run.slot == 0) {
+      addLatencySample(sample.totalMs);
     }
+    LOG_D(LOG_MOD_NET, "Echo %u: %.2f ms", i + 1, sample.totalMs);
   }
+  finishProbe();
+}
 
-  networkProbeSuccessCount = okCount;
-  lastNetworkProbeMs = millis();
+// Advance the run as far as it goes without waiting on the network
+static void stepProbe() {
+  ProbeRun& run = probeRun;
+  if (run.protocol == NET_PROTO_ICMP) {
+    // One step sends what is due and drains every waiting reply
+    IcmpEchoPhase phase = icmpEchoStep(probeBurst);
+    if (phase == ICMP_DONE || phase == ICMP_FAILED) {
+      completeBurst();
+    }
+    return;
+  }
+  if (run.state == PROBE_GAP) {
+    if (millis() - run.gapStartMs < networkProbeSpacingMs) return;
+    startSample();
+  }
+  while (run.state == PROBE_SAMPLING) {
+    AsyncHttpPhase before = probeReq.phase;
+    AsyncHttpPhase after = asyncHttpStep(probeReq);
+    if (after == AHTTP_DONE || after == AHTTP_FAILED) {
+      completeSample();
+    } else if (after == before) {
+      return;  // waiting on the network
+    }
+  }
+}
 
-  if (okCount == 0) {
-    networkProbeOk = false;
-    networkLatencyMs = -1.0f;
-    networkJitterMs = -1.0f;
-    Serial.printf("[%10lu ms] [NET] Probe failed — no successful samples\r\n", millis());
+// "gateway" as the host stands for the current default gateway, so a LAN
+// target survives a change of network
+static void resolveTargetUrl(const char* target, char* out, size_t outLen) {
+  const char* host = strstr(target, "://");
+  if (host != nullptr) {
+    host += 3;
+    if (strncmp(host, "gateway", 7) == 0 && (host[7] == '\0' || host[7] == ':' || host[7] == '/')) {
+      snprintf(out, outLen, "%.*s%s%s", (int)(host - target), target, WiFi.gatewayIP().toString().c_str(),
+               host + 7);
+      return;
+    }
+  }
+  snprintf(out, outLen, "%s", target);
+}
+
+static bool startProbe(uint8_t slot) {
+  if (WiFi.status() != WL_CONNECTED) {
+    if (slot == 0) {
+      networkProbeOk = false;
+    }
     return false;
   }
+  if (probeRun.state != PROBE_IDLE) {
+    return true;
+  }
+  if (networkProbeTarget[0] == '\0') {
+    setDefaultProbeTarget();
+  }
 
-  // Mean latency
-  float sum = 0.0f;
-  for (uint8_t i = 0; i < okCount; i++) {
-    sum += samples[i];
+  ProbeRun& run = probeRun;
+  const NetProbeTargetConfig* extra = slot == 0 ? nullptr : &deviceConfig.net.targets[slot - 1];
+  uint8_t samples = extra ? extra->samples : networkProbeSamples;
+  run.slot = slot;
+  resolveTargetUrl(networkProbeTargetUrl(slot), run.url, sizeof(run.url));
+  run.protocol = networkProbeProtocol(run.url);
+  run.keepAlive = slot == 0 && networkProbeKeepAlive && run.protocol == NET_PROTO_HTTP;
+  run.timeoutMs = extra ? extra->timeoutMs : networkProbeTimeoutMs;
+  run.total = samples < NETWORK_PROBE_MAX_SAMPLES ? samples : NETWORK_PROBE_MAX_SAMPLES;
+  run.attempt = 0;
+  run.okCount = 0;
+  run.okMask = 0;
+  LOG_D(LOG_MOD_NET, "Probing %s target=%s samples=%u%s", networkProbeTargetName(slot), run.url, run.total,
+        run.keepAlive ? " keep-alive" : "");
+  if (run.protocol == NET_PROTO_ICMP) {
+    icmpEchoBegin(probeBurst, run.url + 7, run.total, networkProbeSpacingMs, run.timeoutMs);
+    run.state = PROBE_SAMPLING;
+  } else {
+    startSample();
   }
-  networkLatencyMs = sum / (float)okCount;
+  stepProbe();
+  return true;
+}
 
-  // Jitter: mean absolute difference between consecutive successful samples
-  if (okCount >= 2) {
-    float jsum = 0.0f;
-    for (uint8_t i = 1; i < okCount; i++) {
-      jsum += fabsf(samples[i] - samples[i - 1]);
+bool probeNetworkQuality() {
+  if (!startProbe(0)) {
+    return false;
+  }
+  while (probeRun.state != PROBE_IDLE) {
+    stepProbe();
+    if (probeRun.state != PROBE_IDLE) {
+      delay(1);
     }
-    networkJitterMs = jsum / (float)(okCount - 1);
-  } else {
-    networkJitterMs = 0.0f;
   }
+  return networkProbeOk;
+}
 
-  networkProbeOk = true;
-  Serial.printf("[%10lu ms] [NET] Latency=%.1f ms Jitter=%.1f ms (%u/%u samples)\r\n",
-                millis(), networkLatencyMs, networkJitterMs, okCount, n);
+// How long slot has been due; false while it is not. A requested probe is
+// due at once. A first run comes 5 s after boot, with each slot offset by a
+// share of its interval so the targets do not start together; after that a
+// target is due an interval after its last probe ended.
+static bool probeOverdue(uint8_t slot, unsigned long now, unsigned long& lateMs) {
+  if (probeRequestMask & (1U << slot)) {
+    lateMs = ~0UL;
+    return true;
+  }
+  unsigned long interval = networkProbeTargetIntervalMs(slot);
+  unsigned long last = targetResults[slot].lastProbeMs;
+  unsigned long due = last == 0 ? 5000UL + slot * (interval / NETWORK_PROBE_MAX_TARGETS) : last + interval;
+  if ((long)(now - due) < 0) {
+    return false;
+  }
+  lateMs = now - due;
   return true;
 }
 
@@ -264,17 +915,98 @@ void handleNetworkMetrics() {
     loadNetworkMetricsConfigFromStorage();
   }
 
-  if (WiFi.status() != WL_CONNECTED) {
+  if (WiFi.status() != WL_CONNECTED || probeRun.state != PROBE_IDLE) {
     return;
   }
 
+  // One probe at a time, with a quiet gap between them
   unsigned long now = millis();
-  // First run soon after boot (after 5s), then on interval
-  bool due = (lastNetworkProbeMs == 0)
-             ? (now >= 5000UL)
-             : ((now - lastNetworkProbeMs) >= networkProbeIntervalMs);
+  if (lastProbeEndMs != 0 && now - lastProbeEndMs < NETWORK_PROBE_STAGGER_MS) {
+    return;
+  }
 
-  if (due) {
-    probeNetworkQuality();
+  // The most overdue target goes next; the rest wait for the following gap
+  int8_t next = -1;
+  unsigned long nextLateMs = 0;
+  uint8_t count = networkProbeTargetCount();
+  for (uint8_t slot = 0; slot < count; slot++) {
+    unsigned long lateMs;
+    if (probeOverdue(slot, now, lateMs) && (next < 0 || lateMs > nextLateMs)) {
+      next = (int8_t)slot;
+      nextLateMs = lateMs;
+    }
+  }
+  if (next >= 0) {
+    probeRequestMask &= ~(1U << next);
+    startProbe((uint8_t)next);
+  }
+}
+
+void handleNetworkProbe() {
+  if (probeRun.state != PROBE_IDLE) {
+    stepProbe();
+  }
+}
+
+bool isNetworkProbeInFlight() {
+  return probeRun.state != PROBE_IDLE;
+}
+
+void requestNetworkProbe() {
+  probeRequestMask |= 1U << 0;
+}
+
+bool updateNetworkProbeTargets(JsonArrayConst targets) {
+  if (targets.size() > CONFIG_PROBE_TARGETS) {
+    LOG_W(LOG_MOD_NET, "Rejected probe targets: at most %u", CONFIG_PROBE_TARGETS);
+    return false;
+  }
+  NetProbeTargetConfig parsed[CONFIG_PROBE_TARGETS];
+  memset(parsed, 0, sizeof(parsed));
+  uint8_t count = 0;
+  for (JsonObjectConst entry : targets) {
+    NetProbeTargetConfig& t = parsed[count];
+    const char* name = entry["name"] | "";
+    const char* url = entry["target"] | "";
+    bool fits = strlen(name) < sizeof(t.name) && strlen(url) < sizeof(t.url);
+    if (fits) {
+      strcpy(t.name, name);
+      strcpy(t.url, url);
+    }
+    t.intervalMs = entry["interval_ms"] | NETWORK_DEFAULT_PROBE_INTERVAL_MS;
+    int samples = entry["samples"] | (int)NETWORK_DEFAULT_PROBE_SAMPLES;
+    t.samples = samples > 0 && samples <= 255 ? (uint8_t)samples : 0;
+    t.timeoutMs = entry["timeout_ms"] | NETWORK_DEFAULT_PROBE_TIMEOUT_MS;
+    if (!fits || !isValidTarget(t)) {
+      LOG_W(LOG_MOD_NET, "Rejected probe target %s=%s", name, url);
+      return false;
+    }
+    for (uint8_t i = 0; i < count; i++) {
+      if (strcmp(parsed[i].name, t.name) == 0) {
+        LOG_W(LOG_MOD_NET, "Rejected probe targets: duplicate name %s", t.name);
+        return false;
+      }
+    }
+    count++;
   }
+
+  // A probe of a slot being replaced reports into the new table; drop it
+  if (probeRun.state != PROBE_IDLE && probeRun.slot != 0) {
+    abortProbe();
+  }
+  NetProbeTargetConfig* stored = deviceConfig.net.targets;
+  for (uint8_t i = 0; i < CONFIG_PROBE_TARGETS; i++) {
+    bool same = memcmp(&stored[i], &parsed[i], sizeof(parsed[i])) == 0;
+    if (!same) {
+      stored[i] = parsed[i];
+      targetResults[i + 1] = EMPTY_RESULT;
+    }
+    if (i < count && !same) {
+      probeRequestMask |= 1U << (i + 1);
+    }
+  }
+  LOG_I(LOG_MOD_NET, "Probe targets updated: %u extra", count);
+  configStoreMarkDirty(CFG_NET_METRICS);
+  eventPublishConfigChanged(CFG_NET_METRICS);
+  return true;
 }
@@ -2,42 +2,180 @@
 #define NETWORK_METRICS_H
 
 #include <Arduino.h>
+#include <ArduinoJson.h>
 
-// Default probe target (lightweight HTTP endpoint; override via MQTT/NVS)
+// Default probe target (lightweight HTTP endpoint; override via MQTT/NVS).
+// A target is an http:// URL, icmp://host or tcp://host:port. icmp:// sends
+// each probe as a burst of ICMP echo requests instead of HTTP GETs; tcp://
+// times the TCP handshake alone. The host "gateway" stands for the current
+// default gateway.
 extern const char* NETWORK_DEFAULT_PROBE_TARGET;
 extern const unsigned long NETWORK_DEFAULT_PROBE_INTERVAL_MS;
 extern const uint8_t NETWORK_DEFAULT_PROBE_SAMPLES;
 extern const unsigned long NETWORK_DEFAULT_PROBE_TIMEOUT_MS;
+extern const uint16_t NETWORK_DEFAULT_PROBE_SPACING_MS;
+
+#define NETWORK_PROBE_MAX_SAMPLES 20
+
+// Probe targets: the primary one (configured below, slot 0, name "primary")
+// plus up to NETWORK_PROBE_MAX_TARGETS - 1 more, each with its own interval,
+// sample count and timeout. Only one probe runs at a time, and a probe
+// starts at least NETWORK_PROBE_STAGGER_MS after the previous one ended.
+// First runs are spread over each target's interval.
+#define NETWORK_PROBE_MAX_TARGETS 4
+#define NETWORK_PROBE_STAGGER_MS 2000UL
+
+enum NetworkProbeProtocol : uint8_t {
+  NET_PROTO_HTTP = 0,
+  NET_PROTO_ICMP,
+  NET_PROTO_TCP
+};
 
 // Runtime configuration
 extern char networkProbeTarget[128];
 extern unsigned long networkProbeIntervalMs;
 extern uint8_t networkProbeSamples;
 extern unsigned long networkProbeTimeoutMs;
+// Gap between samples: between echo requests, and between fresh-connection
+// HTTP samples
+extern uint16_t networkProbeSpacingMs;
+// Keep-alive mode: one connection per probe, samples sent back to back on
+// it. Latency is then the request round trip alone, and the connection
+// setup (dns + connect) is reported separately.
+extern bool networkProbeKeepAlive;
 
 // Latest measurements (-1 means unknown / no successful sample yet)
 extern float networkLatencyMs;
 extern float networkJitterMs;
+extern float networkConnectSetupMs;  // dns + connect of the last probe's new connections
 extern unsigned long lastNetworkProbeMs;
 extern bool networkProbeOk;
 extern uint8_t networkProbeSuccessCount;
 extern uint8_t networkProbeAttemptCount;
 
+// Loss over the last probe's attempts, and the RTT spread of its successful
+// samples. A loss run is a stretch of consecutive failed attempts: one long
+// run reads as an outage, many short ones as random drops.
+extern float networkRttMinMs;
+extern float networkRttMaxMs;
+extern float networkProbeLossPct;
+extern uint8_t networkProbeLossRuns;
+extern uint8_t networkProbeLongestLossRun;
+
+// RTT distribution across probes, fed with every successful sample. The
+// quantiles are P-squared estimates (Jain & Chlamtac): five markers each,
+// O(1) per sample, exact until the fifth sample. They cover every sample
+// since boot or the last probe target change. The maxima are over sliding
+// windows kept as rings of per-slot maxima, so a window ends on a slot
+// boundary (30 s, 5 min, 1 h). -1 means no sample.
+struct NetworkLatencyStats {
+  unsigned long samples;
+  float p50Ms;
+  float p95Ms;
+  float p99Ms;
+  float max5mMs;
+  float max1hMs;
+  float max24hMs;
+};
+
+void getNetworkLatencyStats(NetworkLatencyStats& out);
+
+// Outcome of a target's last probe (-1 / 0 when unknown). The primary
+// target's result mirrors the globals above.
+struct NetworkTargetResult {
+  unsigned long lastProbeMs;  // 0 = not probed yet
+  bool ok;
+  uint8_t successes;
+  uint8_t attempts;
+  float latencyMs;
+  float jitterMs;
+  float rttMinMs;
+  float rttMaxMs;
+  float lossPct;
+  uint8_t lossRuns;
+  uint8_t longestLossRun;
+};
+
+uint8_t networkProbeTargetCount();  // the primary target included
+const char* networkProbeTargetName(uint8_t slot);
+const char* networkProbeTargetUrl(uint8_t slot);
+unsigned long networkProbeTargetIntervalMs(uint8_t slot);
+const NetworkTargetResult& getNetworkTargetResult(uint8_t slot);
+
+NetworkProbeProtocol networkProbeProtocol(const char* target);
+const char* networkProbeProtocolName(NetworkProbeProtocol protocol);
+
+// Replace the extra targets with an array of
+// {"name","target","interval_ms","samples","timeout_ms"} (name and target
+// required; names are [a-z0-9_], unique and not "primary"). An empty array
+// removes them all. Returns false, changing nothing, if any entry is invalid.
+bool updateNetworkProbeTargets(JsonArrayConst targets);
+
+// One object per target: name, target, protocol, interval_ms and the last
+// result (ms, null when unknown)
+void addNetworkTargetsJSON(JsonArray out);
+
+// Where a probe sample's time went. Each sample is a raw-socket GET
+// (async_http) timed per phase:
+//   dns       name lookup (0 for an IP literal or a cached name)
+//   connect   TCP handshake
+//   ttfb      request write until the first response byte
+//   transfer  first response byte until the body is complete
+enum NetworkProbePhase : uint8_t {
+  NET_PHASE_DNS = 0,
+  NET_PHASE_CONNECT,
+  NET_PHASE_TTFB,
+  NET_PHASE_TRANSFER,
+  NET_PHASE_COUNT
+};
+
+// Per-phase aggregate over the successful samples of the last probe (ms,
+// -1 when no sample succeeded)
+struct NetworkPhaseStats {
+  float meanMs;
+  float minMs;
+  float maxMs;
+};
+
+const NetworkPhaseStats& getNetworkPhaseStats(uint8_t phase);
+const char* networkPhaseName(uint8_t phase);
+
+// {"engine","rtt_min_ms","rtt_max_ms","loss_pct","loss_runs","longest_loss_run"}
+void addNetworkProbeResultJSON(JsonObject out);
+
+// {"dns":{"mean","min","max"},...} (ms, null when unknown)
+void addNetworkPhaseJSON(JsonObject out);
+
+// p50/p95/p99, max_5m/max_1h/max_24h (ms, null when unknown) and samples
+void addNetworkLatencyStatsJSON(JsonObject out);
+
 // Lifecycle
 void loadNetworkMetricsConfigFromStorage();
 void saveNetworkMetricsConfigToStorage();
 
-// Update config; empty/null probeTarget leaves target unchanged; 0 leaves numeric fields unchanged
+// Update config; empty/null probeTarget leaves target unchanged; 0 leaves numeric fields unchanged;
+// keepAlive -1 leaves the mode unchanged
 void updateNetworkMetricsConfig(const char* probeTarget,
                                 unsigned long intervalMs,
                                 uint8_t samples,
-                                unsigned long timeoutMs);
+                                unsigned long timeoutMs,
+                                int8_t keepAlive = -1,
+                                uint16_t spacingMs = 0);
 
-// Run a multi-sample HTTP RTT probe; updates latency/jitter globals
-// Returns true if at least one sample succeeded
+// Run a whole multi-sample RTT probe before returning (benches and
+// tools; the loop uses the non-blocking path). Updates latency/jitter/phase
+// globals. Returns true if at least one sample succeeded.
 bool probeNetworkQuality();
 
-// Call from main loop — probes on interval when WiFi is up
+// Scheduler task: starts a probe on interval when WiFi is up
 void handleNetworkMetrics();
 
+// Advance an in-flight probe without blocking (call every loop pass)
+void handleNetworkProbe();
+bool isNetworkProbeInFlight();
+
+// Probe on the next handleNetworkMetrics() pass instead of waiting for the
+// interval (safe to call from a request handler)
+void requestNetworkProbe();
+
 #endif
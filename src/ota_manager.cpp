@@ -4,10 +4,10 @@
 #include "notifications.h"
 #include "ota_crypto.h"
 #include "ota_signing_config.h"
+#include "config_store.h"
 
 #include <ArduinoOTA.h>
 #include <ESPmDNS.h>
-#include <Preferences.h>
 #include <Update.h>
 #include <WiFi.h>
 #include <esp_ota_ops.h>
@@ -17,7 +17,6 @@
 #include "mbedtls/sha256.h"
 #include "mbedtls/aes.h"
 
-Preferences otaPrefs;
 
 // Track OTA stream size so we can verify the appended signature trailer.
 static size_t g_otaStreamTotal = 0;
@@ -120,6 +119,7 @@ void initOTA() {
     // flash/sketch images require signature verification.
     if (ArduinoOTA.getCommand() != U_FLASH) {
       logOta("Filesystem OTA complete — rebooting");
+      telnetFlushLog();
       delay(1500);
       ESP.restart();
       return;
@@ -128,6 +128,7 @@ void initOTA() {
     if (finalizeSignedArduinoOta()) {
       Serial.printf("[%10lu ms] [OTA] *** UPDATE ACCEPTED ***\r\n", millis());
       Serial.printf("[%10lu ms] [OTA] Device will restart in 2 seconds...\r\n", millis());
+      telnetFlushLog();
       delay(2000);
       ESP.restart();
     } else {
@@ -440,6 +441,7 @@ static void handleSignedHttpClient(WiFiClient& client) {
   client.stop();
 
   logOta("Signed HTTP OTA applied successfully — rebooting");
+  telnetFlushLog();
   delay(1500);
   ESP.restart();
 }
@@ -464,11 +466,7 @@ void handleOTA() {
 }
 
 bool checkRollbackCondition() {
-  otaPrefs.begin("ota_rollback", true);
-  int bootFailCount = otaPrefs.getInt("boot_fail_count", 0);
-  otaPrefs.end();
-
-  return bootFailCount >= 10;
+  return deviceConfig.rollback.bootFailCount >= 10;
 }
 
 void markFirmwareValid() {
@@ -513,11 +511,13 @@ void handleOTARollback() {
   // Clear boot failure count before rollback
   resetBootFailureCount();
 
-  // Save rollback event to preferences for post-rollback logging
-  otaPrefs.begin("ota_rollback", false);
-  otaPrefs.putString("last_rollback_from", firmwareVersion);
-  otaPrefs.putULong("rollback_time", millis());
-  otaPrefs.end();
+  // Save rollback event for post-rollback logging; must reach NVS before the reboot
+  OtaRollbackState& rollback = deviceConfig.rollback;
+  strncpy(rollback.lastRollbackFrom, firmwareVersion, sizeof(rollback.lastRollbackFrom) - 1);
+  rollback.lastRollbackFrom[sizeof(rollback.lastRollbackFrom) - 1] = '\0';
+  rollback.rollbackTime = millis();
+  configStoreMarkDirty(CFG_OTA_ROLLBACK);
+  configStoreFlush();
 
   delay(2000); // Give time for alert to send
 
@@ -531,21 +531,18 @@ void handleOTARollback() {
   // If we reach here, rollback failed - reboot anyway to try recovery
   Serial.printf("[%10lu ms] [OTA] Manual reboot after rollback failure\r\n", millis());
   telnetPrintf("[%10lu ms] [OTA] Manual reboot after rollback failure\r\n", millis());
+  telnetFlushLog();
   delay(1000);
   ESP.restart();
 }
 
 int getBootFailureCount() {
-  otaPrefs.begin("ota_rollback", true);
-  int count = otaPrefs.getInt("boot_fail_count", 0);
-  otaPrefs.end();
-  return count;
+  return deviceConfig.rollback.bootFailCount;
 }
 
 void resetBootFailureCount() {
-  otaPrefs.begin("ota_rollback", false);
-  otaPrefs.putInt("boot_fail_count", 0);
-  otaPrefs.end();
+  deviceConfig.rollback.bootFailCount = 0;
+  configStoreMarkDirty(CFG_OTA_ROLLBACK);
 
   Serial.printf("[%10lu ms] [OTA] Boot failure counter reset\r\n", millis());
 }
@@ -0,0 +1,269 @@
+#ifdef ENABLE_WEBSERVER
+
+#include "prometheus.h"
+#include "web_server.h"
+#include "dns_manager.h"
+#include "network_metrics.h"
+#include "heartbeat.h"
+#include "wifi_manager.h"
+#include "loop_perf.h"
+#include "web_events.h"
+
+#ifdef ENABLE_MQTT
+#include "mqtt_manager.h"
+#endif
+
+#include <WiFi.h>
+
+void PromWriter::family(const char* name, const char* type, const char* help) {
+  out_.print("# HELP ");
+  out_.print(name);
+  out_.print(' ');
+  out_.print(help);
+  out_.print("\n# TYPE ");
+  out_.print(name);
+  out_.print(' ');
+  out_.print(type);
+  out_.print('\n');
+}
+
+void PromWriter::labels(const char* label, const char* labelValue) {
+  out_.print('{');
+  out_.print(label);
+  out_.print("=\"");
+  for (const char* p = labelValue; *p; p++) {
+    if (*p == '"' || *p == '\\') {
+      out_.print('\\');
+      out_.print(*p);
+    } else if (*p == '\n') {
+      out_.print("\\n");
+    } else {
+      out_.print(*p);
+    }
+  }
+  out_.print("\"}");
+}
+
+void PromWriter::value(double value) {
+  char buf[32];
+  snprintf(buf, sizeof(buf), " %.9g\n", value);
+  out_.print(buf);
+}
+
+void PromWriter::value(uint64_t value) {
+  char buf[24];
+  snprintf(buf, sizeof(buf), " %llu\n", (unsigned long long)value);
+  out_.print(buf);
+}
+
+void PromWriter::sample(const char* name, double v) {
+  out_.print(name);
+  value(v);
+}
+
+void PromWriter::sample(const char* name, uint64_t v) {
+  out_.print(name);
+  value(v);
+}
+
+void PromWriter::sample(const char* name, const char* label, const char* labelValue, double v) {
+  out_.print(name);
+  labels(label, labelValue);
+  value(v);
+}
+
+void PromWriter::sample(const char* name, const char* label, const char* labelValue, uint64_t v) {
+  out_.print(name);
+  labels(label, labelValue);
+  value(v);
+}
+
+// Gauge or counter with a single unlabeled sample
+static void metric(PromWriter& w, const char* name, const char* type, const char* help, uint64_t v) {
+  w.family(name, type, help);
+  w.sample(name, v);
+}
+
+static void metric(PromWriter& w, const char* name, const char* type, const char* help, double v) {
+  w.family(name, type, help);
+  w.sample(name, v);
+}
+
+static void writeSystem(PromWriter& w) {
+  metric(w, "esp32_uptime_seconds", "gauge", "Time since boot.", (uint64_t)(millis() / 1000UL));
+  metric(w, "esp32_heap_free_bytes", "gauge", "Free heap.", (uint64_t)ESP.getFreeHeap());
+  metric(w, "esp32_heap_min_free_bytes", "gauge", "Lowest free heap since boot.",
+         (uint64_t)ESP.getMinFreeHeap());
+  metric(w, "esp32_heap_largest_free_block_bytes", "gauge", "Largest allocatable heap block.",
+         (uint64_t)ESP.getMaxAllocHeap());
+}
+
+static void writeWiFi(PromWriter& w) {
+  bool connected = WiFi.isConnected();
+  metric(w, "esp32_wifi_connected", "gauge", "1 when associated with an access point.", (uint64_t)connected);
+  if (connected) {
+    metric(w, "esp32_wifi_rssi_dbm", "gauge", "Received signal strength.", (double)WiFi.RSSI());
+  }
+  w.family("esp32_wifi_network", "gauge", "Configured network in use (primary, secondary or none).");
+  w.sample("esp32_wifi_network", "role", getActiveNetworkRole(), (uint64_t)1);
+}
+
+static void writeDNS(PromWriter& w) {
+  const DNSOutageStats& s = getDNSOutageStats();
+  metric(w, "esp32_dns_up", "gauge", "1 when the primary or fallback resolver answers.", (uint64_t)isDNSWorking);
+  metric(w, "esp32_dns_using_fallback", "gauge", "1 when only the fallback resolver answers.",
+         (uint64_t)isDNSUsingFallback());
+  metric(w, "esp32_dns_outage_seconds", "gauge", "Length of the ongoing complete outage, 0 when up.",
+         s.currentOutageMs / 1000.0);
+  metric(w, "esp32_dns_last_outage_seconds", "gauge", "Length of the most recent ended outage.",
+         s.lastOutageMs / 1000.0);
+  metric(w, "esp32_dns_outages_total", "counter", "Complete outages that have ended.", (uint64_t)s.outages);
+  metric(w, "esp32_dns_outage_seconds_total", "counter", "Time spent in ended outages.",
+         s.totalOutageMs / 1000.0);
+}
+
+static void writeNetworkProbe(PromWriter& w) {
+  metric(w, "esp32_network_probe_ok", "gauge", "1 when the last probe had a successful sample.",
+         (uint64_t)networkProbeOk);
+  metric(w, "esp32_network_probe_samples", "gauge", "Samples attempted in the last probe.",
+         (uint64_t)networkProbeAttemptCount);
+  metric(w, "esp32_network_probe_successful_samples", "gauge", "Samples that succeeded in the last probe.",
+         (uint64_t)networkProbeSuccessCount);
+  // Unknown until a probe succeeds; absent rather than a fake value
+  if (networkLatencyMs >= 0.0f) {
+    metric(w, "esp32_network_latency_seconds", "gauge", "Mean round trip of the last probe.",
+           networkLatencyMs / 1000.0);
+  }
+  if (networkJitterMs >= 0.0f) {
+    metric(w, "esp32_network_jitter_seconds", "gauge", "Mean deviation between samples of the last probe.",
+           networkJitterMs / 1000.0);
+  }
+  if (getNetworkPhaseStats(NET_PHASE_DNS).meanMs >= 0.0f) {
+    w.family("esp32_network_phase_seconds", "gauge", "Mean time per phase over the last probe.");
+    for (uint8_t p = 0; p < NET_PHASE_COUNT; p++) {
+      w.sample("esp32_network_phase_seconds", "phase", networkPhaseName(p),
+               getNetworkPhaseStats(p).meanMs / 1000.0);
+    }
+  }
+  if (networkProbeLossPct >= 0.0f) {
+    metric(w, "esp32_network_probe_loss_ratio", "gauge", "Share of the last probe's attempts that failed.",
+           networkProbeLossPct / 100.0);
+    metric(w, "esp32_network_probe_longest_loss_run", "gauge", "Longest run of consecutive failed attempts in the last probe.",
+           (uint64_t)networkProbeLongestLossRun);
+  }
+  if (lastNetworkProbeMs != 0) {
+    metric(w, "esp32_network_probe_age_seconds", "gauge", "Time since the last probe.",
+           (millis() - lastNetworkProbeMs) / 1000.0);
+  }
+
+  // Every probe target, the primary one included, by name
+  uint8_t targets = networkProbeTargetCount();
+  w.family("esp32_network_target_ok", "gauge", "1 when the target's last probe had a successful sample.");
+  for (uint8_t slot = 0; slot < targets; slot++) {
+    w.sample("esp32_network_target_ok", "target", networkProbeTargetName(slot),
+             (uint64_t)getNetworkTargetResult(slot).ok);
+  }
+  w.family("esp32_network_target_latency_seconds", "gauge", "Mean round trip of the target's last probe.");
+  for (uint8_t slot = 0; slot < targets; slot++) {
+    const NetworkTargetResult& r = getNetworkTargetResult(slot);
+    if (r.latencyMs >= 0.0f) {
+      w.sample("esp32_network_target_latency_seconds", "target", networkProbeTargetName(slot), r.latencyMs / 1000.0);
+    }
+  }
+  w.family("esp32_network_target_loss_ratio", "gauge", "Share of the target's last probe attempts that failed.");
+  for (uint8_t slot = 0; slot < targets; slot++) {
+    const NetworkTargetResult& r = getNetworkTargetResult(slot);
+    if (r.lossPct >= 0.0f) {
+      w.sample("esp32_network_target_loss_ratio", "target", networkProbeTargetName(slot), r.lossPct / 100.0);
+    }
+  }
+}
+
+static void writeHeartbeat(PromWriter& w) {
+  const HeartbeatStats& s = getHeartbeatStats();
+  metric(w, "esp32_heartbeat_attempts_total", "counter", "Completed heartbeat cycles.", (uint64_t)s.attempts);
+  metric(w, "esp32_heartbeat_successes_total", "counter", "Heartbeats answered with HTTP 200.",
+         (uint64_t)s.successes);
+  metric(w, "esp32_heartbeat_failures_total", "counter", "Heartbeats with another status or a transport error.",
+         (uint64_t)s.failures);
+  metric(w, "esp32_heartbeat_skipped_total", "counter", "Cycles skipped while the previous one was in flight.",
+         (uint64_t)s.skipped);
+  metric(w, "esp32_heartbeat_last_code", "gauge", "HTTP status of the last attempt; negative for transport errors.",
+         (double)lastHeartbeatResponseCode);
+  metric(w, "esp32_heartbeat_duration_seconds", "gauge", "Total time of the last attempt.",
+         getHeartbeatTimings().totalMs / 1000.0);
+  if (lastSuccessfulHeartbeat != 0) {
+    metric(w, "esp32_heartbeat_last_success_age_seconds", "gauge", "Time since the last HTTP 200.",
+           (millis() - lastSuccessfulHeartbeat) / 1000.0);
+  }
+}
+
+static void writeMQTT(PromWriter& w) {
+#ifdef ENABLE_MQTT
+  metric(w, "esp32_mqtt_connected", "gauge", "1 when connected to the broker.", (uint64_t)isMQTTConnected());
+  const MQTTLogStats& s = getMQTTLogStats();
+  metric(w, "esp32_mqtt_log_lines_total", "counter", "Log lines published over MQTT.", (uint64_t)s.lines);
+  metric(w, "esp32_mqtt_log_dropped_total", "counter", "Log lines not published over MQTT.", (uint64_t)s.dropped);
+#else
+  metric(w, "esp32_mqtt_connected", "gauge", "1 when connected to the broker.", (uint64_t)0);
+#endif
+}
+
+static void writeHttp(PromWriter& w) {
+  const HttpServerStats& s = server.stats();
+  metric(w, "esp32_http_connections", "gauge", "Open HTTP connections.", (uint64_t)s.activeConnections);
+  metric(w, "esp32_http_requests_total", "counter", "HTTP requests handled.", (uint64_t)s.requests);
+  metric(w, "esp32_http_keepalive_reuses_total", "counter", "Requests served on a kept-alive connection.",
+         (uint64_t)s.keepAliveReuses);
+  metric(w, "esp32_http_rejected_total", "counter", "Connections refused with 503 (no free slot).",
+         (uint64_t)s.rejected);
+  metric(w, "esp32_event_stream_clients", "gauge", "Open /events streams.", (uint64_t)getWebEventsClientCount());
+}
+
+// Per-handler totals plus the whole-iteration histogram; the log2 buckets of
+// loop_perf map onto cumulative le= buckets (upper bound 2^(i+1) us)
+static void writeLoop(PromWriter& w) {
+  w.family("esp32_loop_handler_calls_total", "counter", "Timed calls per loop handler.");
+  for (int8_t i = 0; i < PERF_LOOP; i++) {
+    w.sample("esp32_loop_handler_calls_total", "handler", perfSlotName((PerfSlot)i),
+             (uint64_t)perfGetStats((PerfSlot)i).count);
+  }
+  w.family("esp32_loop_handler_seconds_total", "counter", "Time spent per loop handler.");
+  for (int8_t i = 0; i < PERF_LOOP; i++) {
+    w.sample("esp32_loop_handler_seconds_total", "handler", perfSlotName((PerfSlot)i),
+             perfGetStats((PerfSlot)i).totalUs / 1e6);
+  }
+  w.family("esp32_loop_handler_max_seconds", "gauge", "Longest single call per loop handler.");
+  for (int8_t i = 0; i < PERF_LOOP; i++) {
+    w.sample("esp32_loop_handler_max_seconds", "handler", perfSlotName((PerfSlot)i),
+             perfGetStats((PerfSlot)i).maxUs / 1e6);
+  }
+
+  const PerfStats& loop = perfGetStats(PERF_LOOP);
+  w.family("esp32_loop_duration_seconds", "histogram", "loop() iteration time, excluding idle sleep.");
+  uint64_t cumulative = 0;
+  char le[16];
+  for (uint8_t b = 0; b < PERF_HIST_BUCKETS - 1; b++) {
+    cumulative += loop.hist[b];
+    snprintf(le, sizeof(le), "%.7g", (double)(2UL << b) / 1e6);
+    w.sample("esp32_loop_duration_seconds_bucket", "le", le, cumulative);
+  }
+  w.sample("esp32_loop_duration_seconds_bucket", "le", "+Inf", (uint64_t)loop.count);
+  w.sample("esp32_loop_duration_seconds_sum", loop.totalUs / 1e6);
+  w.sample("esp32_loop_duration_seconds_count", (uint64_t)loop.count);
+  metric(w, "esp32_loop_max_seconds", "gauge", "Longest loop() iteration.", loop.maxUs / 1e6);
+}
+
+void writePrometheusMetrics(Print& out) {
+  PromWriter w(out);
+  writeSystem(w);
+  writeWiFi(w);
+  writeDNS(w);
+  writeNetworkProbe(w);
+  writeHeartbeat(w);
+  writeMQTT(w);
+  writeHttp(w);
+  writeLoop(w);
+}
+
+#endif // ENABLE_WEBSERVER
@@ -0,0 +1,35 @@
+#ifndef PROMETHEUS_H
+#define PROMETHEUS_H
+
+#ifdef ENABLE_WEBSERVER
+
+#include <Arduino.h>
+
+// Prometheus text exposition (format 0.0.4), written straight to a Print.
+// Numbers are formatted into a stack buffer, so a scrape allocates nothing.
+class PromWriter {
+ public:
+  explicit PromWriter(Print& out) : out_(out) {}
+
+  // "# HELP" and "# TYPE" lines; call once before a family's samples
+  void family(const char* name, const char* type, const char* help);
+
+  void sample(const char* name, double value);
+  void sample(const char* name, uint64_t value);
+  void sample(const char* name, const char* label, const char* labelValue, double value);
+  void sample(const char* name, const char* label, const char* labelValue, uint64_t value);
+
+ private:
+  void labels(const char* label, const char* labelValue);
+  void value(double value);
+  void value(uint64_t value);
+
+  Print& out_;
+};
+
+// Every device metric; served at /metrics
+void writePrometheusMetrics(Print& out);
+
+#endif // ENABLE_WEBSERVER
+
+#endif // PROMETHEUS_H
@@ -0,0 +1,120 @@
+#include "scheduler.h"
+
+static SchedulerTask tasks[SCHEDULER_MAX_TASKS];
+static uint8_t taskCount = 0;
+
+// Wrap-safe "deadline has passed" check for millis() timestamps
+static inline bool deadlineReached(unsigned long deadline, unsigned long now) {
+  return (long)(now - deadline) >= 0;
+}
+
+static bool validTask(int taskId) {
+  return taskId >= 0 && taskId < (int)taskCount;
+}
+
+int schedulerAddTask(const char* name, SchedulerTaskFn fn,
+                     unsigned long periodMs, unsigned long initialDelayMs,
+                     PerfSlot perfSlot) {
+  if (fn == nullptr || periodMs == 0 || taskCount >= SCHEDULER_MAX_TASKS) {
+    Serial.printf("[%10lu ms] [SCHED] Cannot register task '%s'\r\n",
+                  millis(), name ? name : "?");
+    return SCHEDULER_INVALID_TASK;
+  }
+
+  SchedulerTask& t = tasks[taskCount];
+  t.name = name;
+  t.fn = fn;
+  t.periodMs = periodMs;
+  t.nextDeadline = millis() + initialDelayMs;
+  t.runCount = 0;
+  t.overrunCount = 0;
+  t.maxLatenessMs = 0;
+  t.lastRunMs = 0;
+  t.maxRunMs = 0;
+  t.perfSlot = perfSlot;
+  t.enabled = true;
+  return taskCount++;
+}
+
+void schedulerSetPeriod(int taskId, unsigned long periodMs) {
+  if (!validTask(taskId) || periodMs == 0) return;
+  tasks[taskId].periodMs = periodMs;
+}
+
+void schedulerTriggerNow(int taskId) {
+  if (!validTask(taskId)) return;
+  tasks[taskId].nextDeadline = millis();
+}
+
+void schedulerSetEnabled(int taskId, bool enabled) {
+  if (!validTask(taskId)) return;
+  SchedulerTask& t = tasks[taskId];
+  if (enabled && !t.enabled) {
+    // Re-enabled tasks start a fresh period instead of reporting lateness
+    t.nextDeadline = millis() + t.periodMs;
+  }
+  t.enabled = enabled;
+}
+
+uint8_t schedulerRunDue() {
+  uint8_t ran = 0;
+  for (uint8_t i = 0; i < taskCount; i++) {
+    SchedulerTask& t = tasks[i];
+    unsigned long now = millis();
+    if (!t.enabled || !deadlineReached(t.nextDeadline, now)) {
+      continue;
+    }
+
+    unsigned long lateness = now - t.nextDeadline;
+    if (lateness > t.maxLatenessMs) {
+      t.maxLatenessMs = lateness;
+    }
+
+    uint32_t startUs = micros();
+    t.fn();
+    perfRecord(t.perfSlot, startUs);
+
+    unsigned long finished = millis();
+    t.lastRunMs = finished - now;
+    if (t.lastRunMs > t.maxRunMs) {
+      t.maxRunMs = t.lastRunMs;
+    }
+    t.runCount++;
+
+    // Keep the cadence anchored to the original deadline; if we already
+    // missed the following slot, count an overrun and restart from now.
+    t.nextDeadline += t.periodMs;
+    if (deadlineReached(t.nextDeadline, finished)) {
+      t.overrunCount++;
+      t.nextDeadline = finished + t.periodMs;
+    }
+    ran++;
+  }
+  return ran;
+}
+
+unsigned long schedulerTimeUntilNextMs(unsigned long maxWaitMs) {
+  unsigned long now = millis();
+  unsigned long wait = maxWaitMs;
+  for (uint8_t i = 0; i < taskCount; i++) {
+    const SchedulerTask& t = tasks[i];
+    if (!t.enabled) continue;
+    if (deadlineReached(t.nextDeadline, now)) {
+      return 0;
+    }
+    unsigned long remaining = t.nextDeadline - now;
+    if (remaining < wait) {
+      wait = remaining;
+    }
+  }
+  return wait;
+}
+
+uint8_t schedulerTaskCount() {
+  return taskCount;
+}
+
+const SchedulerTask* schedulerGetTask(uint8_t index) {
+  if (index >= taskCount) return nullptr;
+  return &tasks[index];
+}
@@ -0,0 +1,59 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <Arduino.h>
+#include "loop_perf.h"
+
+// Cooperative deadline scheduler for periodic loop() work.
+// Each task runs to completion from loop(). When a run finishes after the
+// task's following slot was already due (late start or long run), it counts
+// as an overrun and is rescheduled from "now" instead of being replayed
+// back-to-back to catch up.
+
+#define SCHEDULER_MAX_TASKS 12
+#define SCHEDULER_INVALID_TASK (-1)
+
+typedef void (*SchedulerTaskFn)();
+
+struct SchedulerTask {
+  const char* name;
+  SchedulerTaskFn fn;
+  unsigned long periodMs;
+  unsigned long nextDeadline;   // millis() at which the task is next due
+  unsigned long runCount;
+  unsigned long overrunCount;   // runs that spilled past the following slot
+  unsigned long maxLatenessMs;  // worst start delay past the deadline
+  unsigned long lastRunMs;      // duration of the most recent run
+  unsigned long maxRunMs;       // longest run observed
+  PerfSlot perfSlot;            // latency histogram slot (PERF_SLOT_NONE = untracked)
+  bool enabled;
+};
+
+// Register a periodic task. First run is due initialDelayMs from now; run
+// durations are recorded against perfSlot. Returns the task id, or
+// SCHEDULER_INVALID_TASK if the table is full.
+int schedulerAddTask(const char* name, SchedulerTaskFn fn,
+                     unsigned long periodMs, unsigned long initialDelayMs = 0,
+                     PerfSlot perfSlot = PERF_SLOT_NONE);
+
+// Change a task's period (takes effect from the next deadline)
+void schedulerSetPeriod(int taskId, unsigned long periodMs);
+
+// Make a task due immediately (e.g. after a config change)
+void schedulerTriggerNow(int taskId);
+
+// Enable / disable a task without removing it from the table
+void schedulerSetEnabled(int taskId, bool enabled);
+
+// Run every task whose deadline has passed; returns the number of tasks run
+uint8_t schedulerRunDue();
+
+// Milliseconds until the earliest enabled deadline (0 when something is due),
+// capped at maxWaitMs so latency-sensitive handlers are still polled.
+unsigned long schedulerTimeUntilNextMs(unsigned long maxWaitMs);
+
+// Introspection (for status / diagnostics)
+uint8_t schedulerTaskCount();
+const SchedulerTask* schedulerGetTask(uint8_t index);
+
+#endif
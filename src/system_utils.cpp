@@ -1,9 +1,14 @@
 #include "system_utils.h"
 #include "config.h"
 #include "telnet.h"
-#include <Preferences.h>
+#include "config_store.h"
+#include "event_bus.h"
+#include <string.h>
 
-Preferences rebootPrefs;
+static void copyReason(char* dst, size_t dstSize, const char* reason) {
+  strncpy(dst, reason ? reason : "", dstSize - 1);
+  dst[dstSize - 1] = '\0';
+}
 
 void rebootDevice(unsigned long delayMs, const char* reason) {
   telnetPrintf("\r\n[%10lu ms] *** REBOOT INITIATED ***\r\n", millis());
@@ -12,45 +17,31 @@ void rebootDevice(unsigned long delayMs, const char* reason) {
   telnetPrintf("[%10lu ms] Rebooting in %lu ms...\r\n", millis(), delayMs);
   
   // Flush any pending telnet/serial output
+  telnetFlushLog();
   delay(100);
   
-  // Optional: Save reboot reason to preferences for post-reboot logging
-  rebootPrefs.begin("system", false);
-  rebootPrefs.putString("last_reboot", reason);
-  rebootPrefs.putULong("reboot_time", millis());
-  rebootPrefs.end();
+  // Save reboot reason for post-reboot logging, along with any pending config
+  copyReason(deviceConfig.system.lastReboot, sizeof(deviceConfig.system.lastReboot), reason);
+  deviceConfig.system.rebootTime = millis();
+  configStoreMarkDirty(CFG_SYSTEM);
+  configStoreFlush();
   
   delay(delayMs);
   
   telnetPrintf("[%10lu ms] *** REBOOTING NOW ***\r\n", millis());
+  telnetFlushLog();
   delay(100);
   
   ESP.restart();
 }
 
-bool checkRebootFlag() {
-  rebootPrefs.begin("system", true);
-  bool shouldReboot = rebootPrefs.getBool("reboot_flag", false);
-  rebootPrefs.end();
-  
-  if (shouldReboot) {
-    // Clear the flag
-    rebootPrefs.begin("system", false);
-    rebootPrefs.remove("reboot_flag");
-    rebootPrefs.end();
-    return true;
+void requestReboot(const char* reason) {
+  // Nothing is written here: the only flash write is the reason rebootDevice()
+  // records, which has to survive the restart
+  telnetPrintf("[%10lu ms] [SYSTEM] Reboot requested: %s\r\n", millis(), reason);
+  if (!eventPublishReboot(reason)) {
+    rebootDevice(3000, reason);  // queue full; don't lose the request
   }
-  
-  return false;
-}
-
-void setRebootFlag(const char* reason) {
-  rebootPrefs.begin("system", false);
-  rebootPrefs.putBool("reboot_flag", true);
-  rebootPrefs.putString("reboot_reason", reason);
-  rebootPrefs.end();
-  
-  telnetPrintf("[%10lu ms] [SYSTEM] Reboot flag set: %s\r\n", millis(), reason);
 }
 
 String formatUptime(unsigned long uptimeMs) {
@@ -1,12 +1,9 @@
 #include "telnet.h"
-#include <time.h>
 #include "config.h"
 #include "wifi_manager.h"
-#include "web_server.h" // For addToTelnetLogBuffer
-
-#ifdef ENABLE_MQTT
-#include "mqtt_manager.h" // For publishTelnetLog
-#endif
+#include "config_store.h"
+#include "event_bus.h"
+#include "log.h"
 
 #include <stdarg.h>
 
@@ -14,17 +11,101 @@
 WiFiServer telnetServer(23);
 WiFiClient telnetClient;
 
+// State transitions are logged once here so the console, web log and MQTT
+// log topic see them as they happen (several modules only log to Serial)
+static void onStateEvent(const Event& event) {
+  switch (event.type) {
+    case EVT_DNS_STATE_CHANGED:
+      telnetPrintf("[%10lu ms] [EVENT] DNS %s\r\n", event.timestampMs,
+                   !event.dns.working ? "down" : (event.dns.usingFallback ? "degraded (fallback)" : "up"));
+      break;
+    case EVT_WIFI_ROLE_CHANGED:
+      telnetPrintf("[%10lu ms] [EVENT] WiFi network %s -> %s\r\n", event.timestampMs,
+                   networkRoleName(event.wifi.previous), networkRoleName(event.wifi.index));
+      break;
+    case EVT_HEARTBEAT_RESULT:
+      if (event.heartbeat.changed) {
+        telnetPrintf("[%10lu ms] [EVENT] Heartbeat %s (code %d)\r\n", event.timestampMs,
+                     event.heartbeat.ok ? "recovered" : "failing", event.heartbeat.code);
+      }
+      break;
+    case EVT_CONFIG_CHANGED:
+      telnetPrintf("[%10lu ms] [EVENT] Config '%s' updated\r\n", event.timestampMs,
+                   configSectionName((ConfigSection)event.config.section));
+      break;
+    default:
+      break;
+  }
+}
+
 void initTelnet() {
+  eventSubscribe(EVENT_MASK(EVT_DNS_STATE_CHANGED) | EVENT_MASK(EVT_WIFI_ROLE_CHANGED) |
+                 EVENT_MASK(EVT_HEARTBEAT_RESULT) | EVENT_MASK(EVT_CONFIG_CHANGED), onStateEvent);
   telnetServer.begin();
   Serial.printf("[%10lu ms] [TELNET] Server started on port 23\r\n", millis());
   Serial.printf("[%10lu ms] [TELNET] Connect via: telnet %s 23\r\n", millis(), WiFi.localIP().toString().c_str());
 }
 
+// Console sinks: Serial is drained inline as far as its TX buffer allows,
+// the telnet client from handleTelnet(); each keeps its own ring cursor
+static LogCursor serialCursor = {0, 0};
+static LogCursor telnetCursor = {0, 0};
+static char serialLine[LOG_TEXT_LEN + 16];  // record being written to Serial
+static size_t serialLineLen = 0;
+static size_t serialLineSent = 0;
+static int serialTxCapacity = 0;  // largest availableForWrite() seen: the TX buffer size
+
+static const uint8_t TELNET_LOG_BATCH = 8;  // records written to the client per loop pass
+
+// "[HH:MM:SS] " + text + "\r\n"; returns the length
+static size_t formatConsoleLine(const LogRecord& rec, char* out, size_t size) {
+  char ts[12];
+  logFormatClock(rec.timestampMs, ts, sizeof(ts));
+  int n = snprintf(out, size, "[%s] %.*s\r\n", ts, (int)rec.len, rec.text);
+  if (n < 0) return 0;
+  return (size_t)n < size ? (size_t)n : size - 1;
+}
+
+// Write queued records to Serial, never more than availableForWrite() takes.
+// Lines go out whole, so direct Serial output never lands mid-line; only a
+// line longer than the whole TX buffer is written in pieces.
+static void drainSerial() {
+  for (;;) {
+    if (serialLineSent == serialLineLen) {
+      LogRecord rec;
+      if (!logRead(serialCursor, rec)) return;
+      serialLineLen = formatConsoleLine(rec, serialLine, sizeof(serialLine));
+      serialLineSent = 0;
+    }
+    int room = Serial.availableForWrite();
+    if (room > serialTxCapacity) serialTxCapacity = room;
+    size_t remaining = serialLineLen - serialLineSent;
+    bool split = serialLineSent > 0 || serialLineLen > (size_t)serialTxCapacity;
+    if (room <= 0 || (remaining > (size_t)room && !split)) return;
+    size_t n = remaining < (size_t)room ? remaining : (size_t)room;
+    serialLineSent += Serial.write(reinterpret_cast<const uint8_t*>(serialLine + serialLineSent), n);
+    if (serialLineSent < serialLineLen) return;
+  }
+}
+
+static void drainTelnet(uint8_t maxRecords) {
+  if (!telnetClient || !telnetClient.connected()) {
+    logCursorAtHead(telnetCursor);  // no backlog for the next client
+    return;
+  }
+  LogRecord rec;
+  char line[LOG_TEXT_LEN + 16];
+  for (uint8_t i = 0; i < maxRecords && logRead(telnetCursor, rec); i++) {
+    telnetClient.write(reinterpret_cast<const uint8_t*>(line), formatConsoleLine(rec, line, sizeof(line)));
+  }
+}
+
 void handleTelnet() {
   // Handle telnet connections
   if (telnetServer.hasClient()) {
     if (telnetClient) telnetClient.stop();
     telnetClient = telnetServer.available();
+    logCursorAtHead(telnetCursor);
     Serial.printf("[%10lu ms] [TELNET] Client connected from %s\r\n", millis(), telnetClient.remoteIP().toString().c_str());
     telnetClient.println("=== ESP32 Telnet Console ===");
     telnetClient.printf("Device: %s | Version: %s\r\n", deviceName, firmwareVersion);
@@ -35,45 +116,29 @@ void handleTelnet() {
     }
     telnetClient.println("============================");
   }
+
+  drainSerial();
+  drainTelnet(TELNET_LOG_BATCH);
+}
+
+void telnetFlushLog() {
+  do {
+    drainSerial();
+  } while (serialLineSent < serialLineLen);  // stopped short only while the TX buffer is full
+  drainTelnet(LOG_RING_SLOTS);
+  Serial.flush();
+}
+
+void telnetPumpSerial() {
+  // Keep Serial in step with direct Serial.printf output when there is room
+  drainSerial();
 }
 
 void telnetPrintf(const char* format, ...) {
-  char buffer[512];
+  if (!logEnabled(LOG_MOD_APP, LOG_INFO)) return;
   va_list args;
   va_start(args, format);
-  vsnprintf(buffer, sizeof(buffer), format, args);
+  logWritev(LOG_INFO, LOG_MOD_APP, nullptr, format, args);
   va_end(args);
-  
-  // Get local time (timezone set by configTzTime in setup)
-  time_t now;
-  time(&now);
-  struct tm timeinfo;
-  localtime_r(&now, &timeinfo);
-  char ts[20];
-  strftime(ts, sizeof(ts), "%H:%M:%S", &timeinfo);
-  // Prepend timestamp
-  char finalBuf[600];
-  snprintf(finalBuf, sizeof(finalBuf), "[%s] %s", ts, buffer);
-  // Print to serial
-  Serial.print(finalBuf);
-  
-  // Print to telnet client if connected
-  if (telnetClient && telnetClient.connected()) {
-    telnetClient.print(finalBuf);
-  }
-  
-  // Add to web log buffer for streaming (remove trailing \r\n for cleaner web display)
-  String logEntry;
-  logEntry.reserve(600);
-  logEntry = String(buffer);
-  logEntry.trim(); // Remove trailing whitespace
-  if (logEntry.length() > 0) {
-    addToTelnetLogBuffer(logEntry);
-    
-#ifdef ENABLE_MQTT
-    // Publish to MQTT for Home Assistant (with timestamp)
-    String mqttLogEntry = String(ts) + " " + logEntry;
-    publishTelnetLog(mqttLogEntry);
-#endif
-  }
+  telnetPumpSerial();
 }
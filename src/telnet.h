@@ -11,7 +11,14 @@ void initTelnet();
 // Handle telnet connections
 void handleTelnet();
 
-// Custom print function that outputs to both Serial and Telnet
+// Log a line to Serial, telnet, the web log and MQTT. Formats once into the
+// log ring (log_ring.h); sinks drain it from the loop.
 void telnetPrintf(const char* format, ...);
 
+// Drain the ring to Serial and the telnet client now (before a reboot)
+void telnetFlushLog();
+
+// Write pending log lines to Serial as far as its TX buffer allows
+void telnetPumpSerial();
+
 #endif
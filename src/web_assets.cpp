@@ -0,0 +1,89 @@
+#ifdef ENABLE_WEBSERVER
+
+#include "web_assets.h"
+#include "web_server.h"
+
+// Generated into the build directory before compiling; a build without it
+// (no pre-script) falls back to the stub landing page
+#if __has_include("web_assets_data.h")
+#include "web_assets_data.h"
+#define WEB_ASSET_COUNT (sizeof(WEB_ASSETS) / sizeof(WEB_ASSETS[0]))
+#else
+static const WebAsset* const WEB_ASSETS = nullptr;
+#define WEB_ASSET_COUNT 0
+#endif
+
+static const WebAsset* findWebAsset(const String& uri) {
+  const char* path = uri == "/" ? "/index.html" : uri.c_str();
+  for (size_t i = 0; i < WEB_ASSET_COUNT; i++) {
+    if (strcmp(path, WEB_ASSETS[i].path) == 0) {
+      return &WEB_ASSETS[i];
+    }
+  }
+  return nullptr;
+}
+
+// Whether the client takes the gzip body. No Accept-Encoding at all means
+// any coding is acceptable (RFC 9110 section 12.5.3); "gzip;q=0" refuses it,
+// and a listed gzip outranks "*".
+static bool acceptsGzip() {
+  if (!server.hasHeader("Accept-Encoding")) {
+    return true;
+  }
+  String value = server.header("Accept-Encoding");
+  value.toLowerCase();
+  const char* p = value.c_str();
+  bool any = false;
+  while (*p) {
+    while (*p == ' ' || *p == ',') p++;
+    const char* name = p;
+    while (*p && *p != ',' && *p != ';' && *p != ' ') p++;
+    size_t nameLen = (size_t)(p - name);
+    const char* params = p;
+    while (*p && *p != ',') p++;
+    bool gzip = nameLen == 4 && strncmp(name, "gzip", 4) == 0;
+    bool star = nameLen == 1 && *name == '*';
+    if (!gzip && !star) continue;
+    const char* q = strstr(params, "q=");
+    bool ok = q == nullptr || q > p || strtof(q + 2, nullptr) > 0.0f;
+    if (gzip) return ok;
+    any = ok;
+  }
+  return any;
+}
+
+bool serveWebAsset(const String& uri) {
+  const WebAsset* asset = findWebAsset(uri);
+  if (asset == nullptr) {
+    return false;
+  }
+
+  // Only a gzip body exists; caches must key on the client's encodings
+  server.sendHeader("Vary", "Accept-Encoding");
+  server.sendHeader("ETag", asset->etag);
+  // Hashed names never change content; the rest (index.html, sw.js) must
+  // revalidate so a firmware update picks up the new hashed names
+  server.sendHeader("Cache-Control", asset->immutable ? "public, max-age=31536000, immutable" : "no-cache");
+
+  if (strstr(server.header("If-None-Match").c_str(), asset->etag) != nullptr) {
+    server.send(304);
+    return true;
+  }
+
+  if (!acceptsGzip()) {
+    server.send(406, "text/plain", "This dashboard is only served gzip-encoded");
+    return true;
+  }
+
+  server.sendHeader("Content-Encoding", "gzip");
+  // Flash is memory-mapped: the socket copies straight from it as the
+  // client drains, with no RAM staging buffer
+  server.sendStatic(200, asset->contentType, asset->body, asset->length);
+  return true;
+}
+
+size_t getWebAssetCount() {
+  return WEB_ASSET_COUNT;
+}
+
+#endif // ENABLE_WEBSERVER
@@ -0,0 +1,28 @@
+#ifndef WEB_ASSETS_H
+#define WEB_ASSETS_H
+
+#ifdef ENABLE_WEBSERVER
+
+#include <Arduino.h>
+
+// Dashboard files embedded at build time by scripts/embed_web_assets.py,
+// gzipped, and served straight from flash
+struct WebAsset {
+  const char* path;         // "/app.<hash>.js", "/index.html", ...
+  const char* contentType;
+  const uint8_t* body;      // gzip data in flash
+  size_t length;
+  const char* etag;         // quoted strong ETag of the gzip body
+  bool immutable;           // content-hashed name: cache for a year
+};
+
+// Serve uri ("/" means /index.html) if it is an embedded asset. Returns
+// false when it is not, so the caller can fall through to its own handling.
+bool serveWebAsset(const String& uri);
+
+// Number of embedded assets (0 when the firmware was built without them)
+size_t getWebAssetCount();
+
+#endif // ENABLE_WEBSERVER
+
+#endif // WEB_ASSETS_H
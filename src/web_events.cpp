@@ -0,0 +1,245 @@
+#ifdef ENABLE_WEBSERVER
+
+#include "web_events.h"
+#include "config.h"
+#include "dns_manager.h"
+#include "heartbeat.h"
+#include "event_bus.h"
+#include "log.h"
+#include "json_stream.h"
+
+#ifdef ENABLE_MQTT
+#include "mqtt_manager.h"
+#endif
+
+#include "web_server.h"
+
+#include <WiFi.h>
+
+static const uint8_t EVENTS_LOG_BATCH = 8;  // log records written per client per loop pass
+static const size_t EVENT_BUFFER_SIZE = 640;  // one record: 232 chars, escaped, plus framing
+
+// Telemetry pushed as "status" events; keys match /status
+struct TelemetrySnapshot {
+  unsigned long uptimeSeconds;
+  int rssi;
+  bool wifiConnected;
+  uint32_t freeHeapKB;
+  bool dnsWorking;
+  bool mqttConnected;
+  bool alertsPaused;
+  unsigned long alertsRemainingSeconds;
+  unsigned long lastHeartbeatSuccess;
+  int lastHeartbeatCode;
+};
+
+struct EventsClient {
+  WiFiClient client;
+  bool active;
+  bool sentSnapshot;       // first status event carries every field
+  LogCursor cursor;
+  TelemetrySnapshot last;  // as last sent to this client
+  SocketBacklog out;
+  unsigned long lastWriteMs;
+};
+
+static EventsClient clients[WEB_EVENTS_MAX_CLIENTS];
+static char eventBuffer[EVENT_BUFFER_SIZE];
+static JsonMessageBuffer event(eventBuffer, sizeof(eventBuffer));
+static unsigned long lastStatusCheck = 0;
+static bool statusDirty = false;  // a state event arrived; diff on the next pass
+
+static void onStateEvent(const Event& event) {
+  (void)event;
+  statusDirty = true;
+}
+
+void initWebEvents() {
+  eventSubscribe(EVENT_MASK(EVT_DNS_STATE_CHANGED) | EVENT_MASK(EVT_WIFI_ROLE_CHANGED) |
+                 EVENT_MASK(EVT_HEARTBEAT_RESULT), onStateEvent);
+}
+
+static void takeSnapshot(TelemetrySnapshot& s) {
+  s.uptimeSeconds = millis() / 1000;
+  s.rssi = WiFi.RSSI();
+  s.wifiConnected = WiFi.isConnected();
+  s.freeHeapKB = ESP.getFreeHeap() / 1024;
+  s.dnsWorking = isDNSWorking;
+#ifdef ENABLE_MQTT
+  s.mqttConnected = isMQTTConnected();
+#else
+  s.mqttConnected = false;
+#endif
+  s.alertsPaused = areAlertsPaused();
+  s.alertsRemainingSeconds = getAlertsPausedTimeRemaining();
+  s.lastHeartbeatSuccess = lastSuccessfulHeartbeat;
+  s.lastHeartbeatCode = lastHeartbeatResponseCode;
+}
+
+static void dropClient(EventsClient& c) {
+  c.client.stop();
+  c.active = false;
+  LOG_I(LOG_MOD_WEB, "Event stream closed");
+}
+
+// Queue the event; a client whose backlog overflows is disconnected
+static bool writeEvent(EventsClient& c) {
+  if (!c.out.write(c.client.fd(), event.data(), event.length())) {
+    dropClient(c);
+    return false;
+  }
+  c.lastWriteMs = millis();
+  return true;
+}
+
+// "event: status" with the fields that differ from what this client last saw
+static bool sendStatusDiff(EventsClient& c, const TelemetrySnapshot& now) {
+  const TelemetrySnapshot& was = c.last;
+  bool all = !c.sentSnapshot;
+  event.clear();
+  event.appendf("event: status\ndata: {\"uptime\":%lu", now.uptimeSeconds * 1000UL);
+  size_t base = event.length();
+
+  if (all || now.rssi != was.rssi) event.appendf(",\"wifi_rssi\":%d", now.rssi);
+  if (all || now.wifiConnected != was.wifiConnected)
+    event.appendf(",\"wifi_connected\":%s", now.wifiConnected ? "true" : "false");
+  if (all || now.freeHeapKB != was.freeHeapKB)
+    event.appendf(",\"free_heap\":%lu", (unsigned long)now.freeHeapKB * 1024UL);
+  if (all || now.dnsWorking != was.dnsWorking)
+    event.appendf(",\"dns_working\":%s", now.dnsWorking ? "true" : "false");
+  if (all || now.mqttConnected != was.mqttConnected)
+    event.appendf(",\"mqtt_connected\":%s", now.mqttConnected ? "true" : "false");
+  if (all || now.alertsPaused != was.alertsPaused)
+    event.appendf(",\"alerts_paused\":%s", now.alertsPaused ? "true" : "false");
+  if (all || now.alertsRemainingSeconds != was.alertsRemainingSeconds)
+    event.appendf(",\"alerts_paused_time_remaining_seconds\":%lu", now.alertsRemainingSeconds);
+  if (all || now.lastHeartbeatSuccess != was.lastHeartbeatSuccess)
+    event.appendf(",\"last_heartbeat_success\":%lu", now.lastHeartbeatSuccess);
+  if (all || now.lastHeartbeatCode != was.lastHeartbeatCode)
+    event.appendf(",\"last_heartbeat_code\":%d", now.lastHeartbeatCode);
+
+  // Uptime alone is not worth an event; the dashboard keeps its own clock
+  if (event.length() == base && now.uptimeSeconds - was.uptimeSeconds < 60) {
+    return true;
+  }
+  event.appendf("}\n\n");
+  if (!writeEvent(c)) return false;
+  c.last = now;
+  c.sentSnapshot = true;
+  return true;
+}
+
+static bool sendLogRecords(EventsClient& c) {
+  LogRecord rec;
+  for (uint8_t i = 0; i < EVENTS_LOG_BATCH && logRead(c.cursor, rec); i++) {
+    event.clear();
+    if (c.cursor.dropped > 0) {
+      event.appendf("event: dropped\ndata: %lu\n\n", c.cursor.dropped);
+      c.cursor.dropped = 0;
+    }
+    event.appendf("event: log\nid: %lu\ndata: {\"seq\":%lu,\"ms\":%lu,\"level\":\"%s\",\"module\":\"%s\",\"text\":",
+                  (unsigned long)rec.seq, (unsigned long)rec.seq, (unsigned long)rec.timestampMs,
+                  logLevelName(rec.level), logModuleName(rec.module));
+    event.appendString(rec.text, 3);  // "}\n\n"
+    event.appendf("}\n\n");
+    if (!writeEvent(c)) return false;
+  }
+  return true;
+}
+
+void handleEventsStream() {
+  EventsClient* slot = nullptr;
+  for (uint8_t i = 0; i < WEB_EVENTS_MAX_CLIENTS; i++) {
+    if (!clients[i].active) {
+      slot = &clients[i];
+      break;
+    }
+  }
+  if (slot == nullptr) {
+    // EventSource retries on its own; the dashboard falls back to polling
+    server.sendHeader("Retry-After", "10");
+    server.send(503, "text/plain", "Too many event streams");
+    return;
+  }
+
+  // Resume the log after the last record a reconnecting client saw
+  uint32_t head = getLogRingStats().written;
+  uint32_t resume = strtoul(server.header("Last-Event-ID").c_str(), nullptr, 10);
+  slot->cursor.dropped = 0;
+  if (resume > 0 && resume <= head) {
+    slot->cursor.next = resume + 1;
+  } else {
+    logCursorAtHead(slot->cursor);
+  }
+
+  // Headers go out by hand: the stream has no length and must not be chunked
+  // or closed by the server once this handler returns
+  WiFiClient& client = server.client();
+  client.setNoDelay(true);
+  static const char headers[] =
+      "HTTP/1.1 200 OK\r\n"
+      "Content-Type: text/event-stream\r\n"
+      "Cache-Control: no-cache\r\n"
+      "Access-Control-Allow-Origin: *\r\n"
+      "Connection: keep-alive\r\n"
+      "\r\n"
+      "retry: 3000\n\n";
+  slot->out.clear();
+  if (!slot->out.write(client.fd(), headers, sizeof(headers) - 1)) {
+    return;  // nothing sent through the server: it lets go of the socket
+  }
+
+  slot->client = client;  // copies share the socket, so it outlives the request
+  slot->active = true;
+  slot->sentSnapshot = false;
+  slot->lastWriteMs = millis();
+  statusDirty = true;  // full snapshot on the next pass
+
+  LOG_I(LOG_MOD_WEB, "Event stream opened (%u/%u)", (unsigned)getWebEventsClientCount(),
+        (unsigned)WEB_EVENTS_MAX_CLIENTS);
+}
+
+void handleWebEvents() {
+  uint8_t count = getWebEventsClientCount();
+  if (count == 0) {
+    statusDirty = false;
+    return;
+  }
+
+  unsigned long now = millis();
+  bool statusDue = statusDirty || now - lastStatusCheck >= WEB_EVENTS_STATUS_INTERVAL_MS;
+  TelemetrySnapshot snapshot;
+  if (statusDue) {
+    takeSnapshot(snapshot);
+    lastStatusCheck = now;
+    statusDirty = false;
+  }
+
+  for (uint8_t i = 0; i < WEB_EVENTS_MAX_CLIENTS; i++) {
+    EventsClient& c = clients[i];
+    if (!c.active) continue;
+    if (!c.client.connected() || !c.out.flush(c.client.fd())) {
+      dropClient(c);
+      continue;
+    }
+    // Log records wait in the ring while the client catches up; status and
+    // pings still queue, so one that never drains overflows and is dropped
+    if (c.out.empty() && !sendLogRecords(c)) continue;
+    if (statusDue && !sendStatusDiff(c, snapshot)) continue;
+    if (now - c.lastWriteMs >= WEB_EVENTS_PING_INTERVAL_MS) {
+      event.clear();
+      event.appendf(": ping\n\n");
+      writeEvent(c);
+    }
+  }
+}
+
+uint8_t getWebEventsClientCount() {
+  uint8_t count = 0;
+  for (uint8_t i = 0; i < WEB_EVENTS_MAX_CLIENTS; i++) {
+    if (clients[i].active) count++;
+  }
+  return count;
+}
+
+#endif // ENABLE_WEBSERVER
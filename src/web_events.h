@@ -0,0 +1,38 @@
+#ifndef WEB_EVENTS_H
+#define WEB_EVENTS_H
+
+#ifdef ENABLE_WEBSERVER
+
+#include <Arduino.h>
+
+// Server-Sent Events stream at /events. A client holds one connection open
+// and receives:
+//   event: log     id: <seq>   data: {"seq","ms","level","module","text"}
+//   event: status              data: only the telemetry fields that changed
+// plus a ": ping" comment when idle. A reconnecting EventSource resumes the
+// log from its Last-Event-ID.
+
+#define WEB_EVENTS_MAX_CLIENTS 2
+#define WEB_EVENTS_STATUS_INTERVAL_MS 1000UL  // telemetry diff cadence (state events push sooner)
+#define WEB_EVENTS_PING_INTERVAL_MS 15000UL
+
+// Subscribe to state events (called from initWebServer)
+void initWebEvents();
+
+// /events route handler: takes over the request's connection
+void handleEventsStream();
+
+// Push pending log records and telemetry changes (call every loop pass)
+void handleWebEvents();
+
+uint8_t getWebEventsClientCount();
+
+#else
+
+inline void initWebEvents() {}
+inline void handleWebEvents() {}
+inline uint8_t getWebEventsClientCount() { return 0; }
+
+#endif // ENABLE_WEBSERVER
+
+#endif // WEB_EVENTS_H
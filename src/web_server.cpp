@@ -6,38 +6,43 @@
 #include "system_utils.h"
 #include "dns_manager.h"
 #include "ota_manager.h"
+#include "heartbeat.h"
+#include "network_metrics.h"
+#include "loop_perf.h"
+#include "log.h"
+#include "web_events.h"
+#include "web_socket.h"
+#include "event_bus.h"
+#include "json_stream.h"
+#include "web_assets.h"
+#include "prometheus.h"
+#include "history.h"
 
 #ifdef ENABLE_MQTT
 #include "mqtt_manager.h"
 #endif
 
-#include <WebServer.h>
 #include <ArduinoJson.h>
 
-WebServer server(80);
+HttpServer server(80);
 
-// Telnet log streaming variables
-String telnetLogBuffer = "";
+// Telnet log streaming. Readers are stateless: each /telnet/output request
+// carries its own position (?since=<seq>) into the shared log ring.
 bool telnetStreamActive = false;
-const size_t MAX_LOG_BUFFER_SIZE = 8192; // 8KB buffer
+static const uint8_t TELNET_OUTPUT_MAX_RECORDS = LOG_RING_SLOTS;
 
-// External variables for tracking heartbeat status
-extern unsigned long lastSuccessfulHeartbeat;
-extern int lastHeartbeatResponseCode;
-
-// CORS helper
+// CORS for responses outside the route table (routes get it from their policy)
 static void addCORS() {
   server.sendHeader("Access-Control-Allow-Origin", "*");
   server.sendHeader("Access-Control-Allow-Methods", "GET, HEAD, OPTIONS");
   server.sendHeader("Access-Control-Allow-Headers", "Content-Type");
 }
 
-static void handleOptions() {
-  addCORS();
-  server.send(204);
-}
-
 void handleRoot() {
+  // Embedded dashboard when the build has it
+  if (serveWebAsset(server.uri())) {
+    return;
+  }
   // Minimal HTML landing page (UI is hosted externally)
   // Minified HTML for landing page
   const char html[] PROGMEM = "<html><head><title>ESP32</title></head><body><h1>ESP32</h1><p><a href='/status'>Status JSON</a> | <a href='/reboot'>Reboot</a></p><script>fetch('/status').then(r=>r.json()).then(d=>document.body.innerHTML+='<p>Version: '+d.version+'</p>');</script></body></html>";
@@ -46,19 +51,20 @@ void handleRoot() {
 
 void handleReboot() {
   // Simple confirmation page
-  addCORS();
   server.send(200, "text/html", 
     "<html><head><meta http-equiv='refresh' content='10;url=/'></head>"
     "<body><h1>Rebooting...</h1><p>Page will refresh in 10 seconds.</p></body></html>");
   
   telnetPrintf("[%10lu ms] [WEB] Reboot requested via web interface\r\n", millis());
-  // Schedule reboot after a short delay to allow the response to be sent
-  setRebootFlag("Web interface reboot request");
+  // Rebooted from the event dispatch, after this response has been sent
+  requestReboot("Web interface reboot request");
 }
 
-void handleStatus() {
-  // Build JSON using ArduinoJson to avoid String concatenation fragmentation
-  JsonDocument doc;
+// /status snapshot counters (see refreshStatusSnapshot)
+static unsigned long statusBuilds = 0;
+static unsigned long statusNotModified = 0;
+
+static void fillStatusJSON(JsonDocument& doc) {
   doc["device"] = deviceName;
   doc["version"] = firmwareVersion;
   doc["ip"] = WiFi.localIP().toString();
@@ -79,6 +85,7 @@ void handleStatus() {
   doc["last_heartbeat_success"] = lastSuccessfulHeartbeat;
   doc["last_heartbeat_code"] = lastHeartbeatResponseCode;
   doc["heartbeat_endpoint"] = apiEndpoint;
+  addHeartbeatPhaseJSON(doc["heartbeat_phase_ms"].to<JsonObject>());
 
   unsigned long timeSinceLastSuccessMs = millis() - lastSuccessfulHeartbeat;
   doc["time_since_last_success_ms"] = timeSinceLastSuccessMs;
@@ -92,6 +99,18 @@ void handleStatus() {
     doc["last_heartbeat_uptime_formatted"] = "Never";
   }
 
+  // Network latency distribution across probes, and the last probe by phase
+  addNetworkLatencyStatsJSON(doc["network_latency_stats_ms"].to<JsonObject>());
+  addNetworkPhaseJSON(doc["network_phase_ms"].to<JsonObject>());
+  addNetworkProbeResultJSON(doc["network_probe_result"].to<JsonObject>());
+  addNetworkTargetsJSON(doc["network_targets"].to<JsonArray>());
+  doc["network_probe_keep_alive"] = networkProbeKeepAlive;
+  if (networkConnectSetupMs >= 0.0f) {
+    doc["network_connect_setup_ms"] = roundf(networkConnectSetupMs * 10.0f) / 10.0f;
+  } else {
+    doc["network_connect_setup_ms"] = nullptr;
+  }
+
   // Current time
   doc["current_uptime"] = millis();
   doc["current_uptime_formatted"] = formatUptime(millis());
@@ -103,38 +122,220 @@ void handleStatus() {
   // MQTT
 #ifdef ENABLE_MQTT
   doc["mqtt_connected"] = isMQTTConnected();
+  const MQTTLogStats& mqttLog = getMQTTLogStats();
+  doc["mqtt_log_batches"] = mqttLog.batches;
+  doc["mqtt_log_dropped"] = mqttLog.dropped;
 #else
   doc["mqtt_connected"] = false;
 #endif
+  doc["event_stream_clients"] = getWebEventsClientCount();
+  doc["websocket_clients"] = getWebSocketClientCount();
+  doc["status_builds"] = statusBuilds;
+  doc["status_not_modified"] = statusNotModified;
+  const HttpServerStats& http = server.stats();
+  doc["http_connections"] = http.activeConnections;
+  doc["http_requests"] = http.requests;
+  doc["http_keepalive_reuses"] = http.keepAliveReuses;
+  doc["http_rejected"] = http.rejected;
 
-  String out;
-  serializeJson(doc, out);
-  addCORS();
-  server.send(200, "application/json", out);
+  // Runtime log thresholds (set via MQTT command/log_level)
+  JsonObject logLevels = doc["log_levels"].to<JsonObject>();
+  for (uint8_t i = 0; i < LOG_MOD_COUNT; i++) {
+    logLevels[logModuleName(i)] = logLevelName(logModuleLevels[i]);
+  }
+
+}
+
+// /status revalidation and cached body. The ETag is a version number that
+// moves when a tracked value changes (connectivity, heartbeat result code,
+// alert pause to the minute, a probe result, log levels, a config section)
+// and at least every STATUS_VERSION_MAX_AGE_MS, which refreshes the
+// untracked readings (RSSI, free heap, last heartbeat time). A matching If-None-Match gets a 304 before anything is
+// built. The free-running fields (uptime, request counters) do not move the
+// version, so the tag is weak. A 200 reuses the cached body while its
+// version is current and it is younger than STATUS_SNAPSHOT_MAX_AGE_MS. A body too big for the buffer (long probe
+// target URLs) is streamed instead, uncached.
+static const size_t STATUS_SNAPSHOT_SIZE = 3072;
+static const unsigned long STATUS_SNAPSHOT_MAX_AGE_MS = 5000;
+static const unsigned long STATUS_VERSION_MAX_AGE_MS = 60000;
+
+struct StatusFingerprint {
+  bool wifiConnected;
+  bool dnsWorking;
+  bool alertsPaused;
+  bool mqttConnected;
+  uint8_t eventClients;
+  int lastHeartbeatCode;
+  unsigned long alertsRemainingMinutes;
+  unsigned long lastProbeMs;
+  uint8_t logLevels[LOG_MOD_COUNT];
+};
+
+static char statusSnapshot[STATUS_SNAPSHOT_SIZE];
+static size_t statusSnapshotLen = 0;
+static uint32_t statusSnapshotVersion = 0;
+static unsigned long statusBuiltAt = 0;
+static uint32_t statusVersion = 0;
+static unsigned long statusVersionAt = 0;
+static uint32_t statusBootId = 0;  // keeps tags from an earlier boot from matching
+static char statusETag[24] = "";
+static bool statusConfigChanged = true;  // also forces the first version
+static StatusFingerprint statusFingerprint;
+
+static void onConfigChanged(const Event& event) {
+  (void)event;
+  statusConfigChanged = true;
+}
+
+static void takeStatusFingerprint(StatusFingerprint& f) {
+  memset(&f, 0, sizeof(f));  // padding too, so memcmp is meaningful
+  f.wifiConnected = WiFi.isConnected();
+  f.dnsWorking = isDNSWorking;
+  f.alertsPaused = areAlertsPaused();
+#ifdef ENABLE_MQTT
+  f.mqttConnected = isMQTTConnected();
+#endif
+  f.eventClients = getWebEventsClientCount();
+  f.lastHeartbeatCode = lastHeartbeatResponseCode;
+  f.alertsRemainingMinutes = getAlertsPausedTimeRemaining() / 60;
+  f.lastProbeMs = lastNetworkProbeMs;
+  memcpy(f.logLevels, logModuleLevels, sizeof(f.logLevels));
+}
+
+// Move to a new version when a tracked value changed; cheap enough for
+// every request
+static void updateStatusVersion() {
+  StatusFingerprint now;
+  takeStatusFingerprint(now);
+  if (!statusConfigChanged && statusVersion != 0 && millis() - statusVersionAt < STATUS_VERSION_MAX_AGE_MS &&
+      memcmp(&now, &statusFingerprint, sizeof(now)) == 0) {
+    return;
+  }
+  if (statusBootId == 0) statusBootId = (uint32_t)random(1, 0x7FFFFFFF);
+  statusFingerprint = now;
+  statusConfigChanged = false;
+  statusVersion++;
+  statusVersionAt = millis();
+  snprintf(statusETag, sizeof(statusETag), "W/\"%08lx-%lu\"", (unsigned long)statusBootId,
+           (unsigned long)statusVersion);
+}
+
+// Returns false when the status does not fit the snapshot buffer; doc then
+// holds it, to be streamed
+static bool refreshStatusSnapshot(JsonDocument& doc) {
+  if (statusSnapshotLen > 0 && statusSnapshotVersion == statusVersion &&
+      millis() - statusBuiltAt < STATUS_SNAPSHOT_MAX_AGE_MS) {
+    return true;
+  }
+
+  fillStatusJSON(doc);
+  statusBuilds++;
+  size_t len = measureJson(doc);
+  if (len >= STATUS_SNAPSHOT_SIZE) {
+    LOG_D(LOG_MOD_WEB, "Status JSON (%u bytes) exceeds snapshot buffer, streaming it", (unsigned)len);
+    statusSnapshotLen = 0;  // rebuild on the next request
+    return false;
+  }
+  statusSnapshotLen = serializeJson(doc, statusSnapshot, len + 1);
+  statusSnapshotVersion = statusVersion;
+  statusBuiltAt = millis();
+  return true;
+}
+
+void handleStatus() {
+  updateStatusVersion();
+  server.sendHeader("ETag", statusETag);
+  server.sendHeader("Cache-Control", "no-cache");  // always revalidate; 304s are cheap
+
+  if (strstr(server.header("If-None-Match").c_str(), statusETag) != nullptr) {
+    statusNotModified++;
+    server.send(304);
+    return;
+  }
+
+  JsonDocument doc;
+  if (!refreshStatusSnapshot(doc)) {
+    sendJsonChunked(server, 200, doc);
+    return;
+  }
+  if (server.method() == HTTP_HEAD) {
+    server.setContentLength(statusSnapshotLen);
+    server.send(200, "application/json", "");
+    return;
+  }
+  server.send_P(200, "application/json", statusSnapshot, statusSnapshotLen);
 }
 
+void handlePerf() {
+  JsonDocument doc;
+  fillPerfJSON(doc);
+  // ?reset=1 returns the current numbers, then starts a fresh measurement window
+  if (server.hasArg("reset")) {
+    perfReset();
+  }
+
+  sendJsonChunked(server, 200, doc);
+}
+
+void handleMetrics() {
+  // Streamed through HttpChunkedPrint's fixed buffer: nothing is allocated per scrape
+  HttpChunkedPrint out(server);
+  if (!out.begin(200, "text/plain; version=0.0.4; charset=utf-8")) {
+    return;
+  }
+  writePrometheusMetrics(out);
+  out.end();
+}
+
+// /history?metric=<name>&since=<s>&step=<s>. since is an uptime second, or
+// negative for "that many seconds ago"; step > 0 reports the mean of each
+// step-wide bucket instead of every sample. Without metric: the metric list.
+void handleHistory() {
+  int8_t metric = -1;
+  if (server.hasArg("metric")) {
+    metric = historyFindMetric(server.arg("metric").c_str());
+    if (metric < 0) {
+      server.send(404, "text/plain", "Unknown metric");
+      return;
+    }
+  }
+  uint32_t now = millis() / 1000UL;
+  long since = server.hasArg("since") ? strtol(server.arg("since").c_str(), nullptr, 10) : 0;
+  uint32_t sinceSec = since >= 0 ? (uint32_t)since : ((uint32_t)-since >= now ? 0 : now + since);
+  uint32_t stepSec = server.hasArg("step") ? strtoul(server.arg("step").c_str(), nullptr, 10) : 0;
+
+  HttpChunkedPrint out(server);
+  if (!out.begin(200, "application/json")) {
+    return;  // HEAD
+  }
+  if (metric < 0) {
+    writeHistoryIndexJSON(out);
+  } else {
+    writeHistoryJSON(out, (uint8_t)metric, sinceSec, stepSec);
+  }
+  out.end();
+}
+
+// /alerts/pause/{minutes}: whole minutes (1 to ALERT_PAUSE_MAX_MINUTES) or "indefinite"
 void handleAlertPause() {
-  String path = server.uri();
-  
-  if (path == "/alerts/pause/30") {
-    pauseAlertsForMinutes(30);
-  } else if (path == "/alerts/pause/60") {
-    pauseAlertsForMinutes(60);
-  } else if (path == "/alerts/pause/180") {
-    pauseAlertsForMinutes(180);
-  } else if (path == "/alerts/pause/indefinite") {
+  String minutes = server.pathArg(0);
+
+  if (minutes == "indefinite") {
     pauseAlertsIndefinitely();
   } else {
-    addCORS();
-    server.send(400, "text/plain", "Invalid pause duration");
-    return;
+    char* end;
+    long value = strtol(minutes.c_str(), &end, 10);
+    if (!isdigit((unsigned char)minutes[0]) || *end != '\0' || value < 1 || value > ALERT_PAUSE_MAX_MINUTES) {
+      server.send(400, "text/plain", "Invalid pause duration");
+      return;
+    }
+    pauseAlertsForMinutes((int)value);
   }
   
   telnetPrintf("[%10lu ms] [WEB] Alert pause requested via web interface\r\n", millis());
   
   // Send JSON response for API call
   String json = "{\"status\":\"success\",\"message\":\"Alerts paused\"}";
-  addCORS();
   server.send(200, "application/json", json);
 }
 
@@ -145,16 +346,17 @@ void handleAlertResume() {
   
   // Send JSON response for API call
   String json = "{\"status\":\"success\",\"message\":\"Alerts resumed\"}";
-  addCORS();
   server.send(200, "application/json", json);
 }
 
 void handleTelnetStart() {
   telnetStreamActive = true;
-  telnetLogBuffer = ""; // Clear existing buffer
-  
-  String json = "{\"status\":\"started\",\"message\":\"Telnet log streaming started\"}";
-  addCORS();
+
+  // "last" is where a new viewer starts: pass it back as ?since= to get only newer lines
+  char json[112];
+  snprintf(json, sizeof(json),
+           "{\"status\":\"started\",\"message\":\"Telnet log streaming started\",\"last\":%lu}",
+           (unsigned long)getLogRingStats().written);
   server.send(200, "application/json", json);
   
   telnetPrintf("[%10lu ms] [WEB] Telnet log streaming started\r\n", millis());
@@ -164,72 +366,73 @@ void handleTelnetStop() {
   telnetStreamActive = false;
   
   String json = "{\"status\":\"stopped\",\"message\":\"Telnet log streaming stopped\"}";
-  addCORS();
   server.send(200, "application/json", json);
   
   telnetPrintf("[%10lu ms] [WEB] Telnet log streaming stopped\r\n", millis());
 }
 
 void handleTelnetOutput() {
-  String json = "{";
-  json += "\"output\":\"" + escapeJsonString(telnetLogBuffer) + "\",";
-  json += "\"timestamp\":" + String(millis()) + ",";
-  json += "\"active\":" + String(telnetStreamActive ? "true" : "false");
-  json += "}";
-  
-  addCORS();
-  server.send(200, "application/json", json);
-  
-  // Clear buffer after sending
-  telnetLogBuffer = "";
-}
+  // Records newer than ?since=<seq> (everything still held when omitted).
+  // Nothing is consumed, so any number of viewers can poll independently.
+  //   {"since":10,"records":[{"seq":11,"ms":5153,"level":"info","module":"net","text":"..."}],
+  //    "last":11,"dropped":0,"timestamp":...,"active":true}
+  // Poll again with since=<last>. "dropped" counts records that were
+  // overwritten before this poll reached them.
+  uint32_t head = getLogRingStats().written;
+  uint32_t since = server.hasArg("since") ? strtoul(server.arg("since").c_str(), nullptr, 10) : 0;
+  LogCursor cursor = {0, 0};
+  if (since == 0 || since > head) {
+    since = 0;  // first poll, or a sequence from before a reboot
+    logCursorAtOldest(cursor);
+  } else {
+    cursor.next = since + 1;
+  }
 
-// Helper function to escape strings for JSON
-String escapeJsonString(const String& input) {
-  String result;
-  result.reserve(input.length() + 20);
-  
-  for (size_t i = 0; i < input.length(); i++) {
-    char c = input.charAt(i);
-    switch (c) {
-      case '"':  result += "\\\""; break;
-      case '\\': result += "\\\\"; break;
-      case '\b': result += "\\b"; break;
-      case '\f': result += "\\f"; break;
-      case '\n': result += "\\n"; break;
-      case '\r': result += "\\r"; break;
-      case '\t': result += "\\t"; break;
-      default:
-        if (c < 0x20) {
-          char buf[7];
-          snprintf(buf, sizeof(buf), "\\u%04X", static_cast<unsigned char>(c));
-          result += buf;
-        } else {
-          result += c;
-        }
-        break;
-    }
+  HttpChunkedPrint out(server);
+  if (!out.begin(200, "application/json")) {
+    return;  // HEAD
   }
-  return result;
-}
 
-// Function to add log entry to buffer (called from telnet module)
-void addToTelnetLogBuffer(const String& logEntry) {
-  if (!telnetStreamActive) return;
-  
-  // Add timestamp and log entry
-  telnetLogBuffer += logEntry + "\n";
-  
-  // Trim buffer if it gets too large
-  if (telnetLogBuffer.length() > MAX_LOG_BUFFER_SIZE) {
-    // Keep only the last 75% of the buffer
-    size_t keepSize = MAX_LOG_BUFFER_SIZE * 3 / 4;
-    size_t removeSize = telnetLogBuffer.length() - keepSize;
-    telnetLogBuffer.remove(0, removeSize);
+  // Built from print() pieces: Print::printf() heap-allocates past 64 chars
+  out.print("{\"since\":");
+  out.print((unsigned long)since);
+  out.print(",\"records\":[");
+
+  uint32_t last = since;
+  LogRecord rec;
+  uint8_t count = 0;
+  while (count < TELNET_OUTPUT_MAX_RECORDS && logRead(cursor, rec)) {
+    if (count > 0) out.write(',');
+    out.print("{\"seq\":");
+    out.print((unsigned long)rec.seq);
+    out.print(",\"ms\":");
+    out.print((unsigned long)rec.timestampMs);
+    out.print(",\"level\":\"");
+    out.print(logLevelName(rec.level));
+    out.print("\",\"module\":\"");
+    out.print(logModuleName(rec.module));
+    out.print("\",\"text\":");
+    printJsonString(out, rec.text);
+    out.write('}');
+    last = rec.seq;
+    count++;
   }
+  out.print("],\"last\":");
+  out.print((unsigned long)last);
+  out.print(",\"dropped\":");
+  out.print(cursor.dropped);
+  out.print(",\"timestamp\":");
+  out.print(millis());
+  out.print(",\"active\":");
+  out.print(telnetStreamActive ? "true}" : "false}");
+  out.end();
 }
 
 void handleNotFound() {
+  if ((server.method() == HTTP_GET || server.method() == HTTP_HEAD) && serveWebAsset(server.uri())) {
+    return;
+  }
+
   String message = "File Not Found\n\n";
   message += "URI: " + server.uri() + "\n";
   message += "Method: " + String((server.method() == HTTP_GET) ? "GET" : "POST") + "\n";
@@ -243,50 +446,48 @@ void handleNotFound() {
   server.send(404, "text/plain", message);
 }
 
+// Every route, matched by HttpServer: literal paths by hash, then patterns.
+// CORS_PUBLIC routes get Access-Control-Allow-Origin and an automatic
+// OPTIONS preflight.
+static const HttpRoute ROUTES[] = {
+  {HTTP_ANY, "/",                       handleRoot,         HTTP_CORS_NONE},
+  {HTTP_ANY, "/reboot",                 handleReboot,       HTTP_CORS_PUBLIC},
+  {HTTP_ANY, "/status",                 handleStatus,       HTTP_CORS_PUBLIC},  // GET and HEAD
+  {HTTP_ANY, "/perf",                   handlePerf,         HTTP_CORS_PUBLIC},
+  {HTTP_GET, "/metrics",                handleMetrics,      HTTP_CORS_NONE},
+  {HTTP_ANY, "/history",                handleHistory,      HTTP_CORS_PUBLIC},
+  {HTTP_ANY, "/alerts/pause/{minutes}", handleAlertPause,   HTTP_CORS_PUBLIC},
+  {HTTP_ANY, "/alerts/resume",          handleAlertResume,  HTTP_CORS_PUBLIC},
+  {HTTP_ANY, "/telnet/start",           handleTelnetStart,  HTTP_CORS_PUBLIC},
+  {HTTP_ANY, "/telnet/stop",            handleTelnetStop,   HTTP_CORS_PUBLIC},
+  {HTTP_ANY, "/telnet/output",          handleTelnetOutput, HTTP_CORS_PUBLIC},
+  {HTTP_GET, "/events",                 handleEventsStream, HTTP_CORS_PUBLIC},  // Server-Sent Events
+  {HTTP_GET, "/ws",                     handleWebSocketUpgrade, HTTP_CORS_NONE},  // WebSocket
+};
+
 void initWebServer() {
-  // UI is hosted externally; no SPIFFS mount required
-  
-  // Main routes
-  server.on("/", handleRoot);
-  server.on("/reboot", handleReboot);
-  server.on("/status", handleStatus);
-  server.on("/status", HTTP_HEAD, [](){ addCORS(); server.send(200); });
-  
-  // Alert control routes
-  server.on("/alerts/pause/30", handleAlertPause);
-  server.on("/alerts/pause/60", handleAlertPause);
-  server.on("/alerts/pause/180", handleAlertPause);
-  server.on("/alerts/pause/indefinite", handleAlertPause);
-  server.on("/alerts/resume", handleAlertResume);
-  
-  // Telnet streaming routes
-  server.on("/telnet/start", handleTelnetStart);
-  server.on("/telnet/stop", handleTelnetStop);
-  server.on("/telnet/output", handleTelnetOutput);
-  
-  // Preflight handlers
-  server.on("/status", HTTP_OPTIONS, handleOptions);
-  server.on("/alerts/pause/30", HTTP_OPTIONS, handleOptions);
-  server.on("/alerts/pause/60", HTTP_OPTIONS, handleOptions);
-  server.on("/alerts/pause/180", HTTP_OPTIONS, handleOptions);
-  server.on("/alerts/pause/indefinite", HTTP_OPTIONS, handleOptions);
-  server.on("/alerts/resume", HTTP_OPTIONS, handleOptions);
-  server.on("/telnet/start", HTTP_OPTIONS, handleOptions);
-  server.on("/telnet/stop", HTTP_OPTIONS, handleOptions);
-  server.on("/telnet/output", HTTP_OPTIONS, handleOptions);
-  server.on("/reboot", HTTP_OPTIONS, handleOptions);
+  // The dashboard is embedded in flash (web_assets); no filesystem mount required
   
+  server.setRoutes(ROUTES, sizeof(ROUTES) / sizeof(ROUTES[0]));
   server.onNotFound(handleNotFound);
+
+  // Live log + telemetry: Server-Sent Events and the WebSocket channel
+  initWebEvents();
+  initWebSocket();
+  eventSubscribe(EVENT_MASK(EVT_CONFIG_CHANGED), onConfigChanged);
   
   server.begin();
   telnetPrintf("[%10lu ms] [WEB] HTTP server started on port 80\r\n", millis());
-  telnetPrintf("[%10lu ms] [WEB] API endpoints ready (UI hosted externally)\r\n", millis());
+  telnetPrintf("[%10lu ms] [WEB] API endpoints ready (%u embedded dashboard files)\r\n", millis(),
+               (unsigned)getWebAssetCount());
   telnetPrintf("[%10lu ms] [WEB] Access via: http://%s or http://%s.local\r\n", 
                millis(), WiFi.localIP().toString().c_str(), deviceName);
 }
 
 void handleWebServer() {
   server.handleClient();
+  handleWebEvents();
+  handleWebSocket();
 }
 
 #endif // ENABLE_WEBSERVER
@@ -5,7 +5,9 @@
 
 #include <Arduino.h>
 #include <WiFi.h>
-#include <WebServer.h>
+#include "http_server.h"
+
+extern HttpServer server;
 
 // Initialize web server for remote commands
 void initWebServer();
@@ -17,6 +19,9 @@ void handleWebServer();
 void handleRoot();
 void handleReboot();
 void handleStatus();
+void handlePerf();
+void handleMetrics();
+void handleHistory();
 void handleAlertPause();
 void handleAlertResume();
 void handleNotFound();
@@ -26,16 +31,11 @@ void handleTelnetStart();
 void handleTelnetStop();
 void handleTelnetOutput();
 
-// Utility functions
-String escapeJsonString(const String& input);
-void addToTelnetLogBuffer(const String& logEntry);
-
 #else
 
 // Stub functions when webserver is disabled
 inline void initWebServer() {}
 inline void handleWebServer() {}
-inline void addToTelnetLogBuffer(const String& logEntry) {}
 
 #endif // ENABLE_WEBSERVER
 
@@ -0,0 +1,541 @@
+#ifdef ENABLE_WEBSERVER
+
+#include "web_socket.h"
+#include "web_server.h"
+#include "dns_manager.h"
+#include "heartbeat.h"
+#include "network_metrics.h"
+#include "system_utils.h"
+#include "telnet.h"
+#include "event_bus.h"
+#include "log.h"
+#include "json_stream.h"
+
+#ifdef ENABLE_MQTT
+#include "mqtt_manager.h"
+#endif
+
+#include <ArduinoJson.h>
+#include <WiFi.h>
+#include "mbedtls/version.h"
+#include "mbedtls/sha1.h"
+#include "mbedtls/base64.h"
+
+static const char WS_GUID[] = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+static const size_t WS_MAX_RX_PAYLOAD = 125;  // client frames: no extended lengths, no fragments
+static const size_t WS_RX_BUFFER_SIZE = 2 + 4 + WS_MAX_RX_PAYLOAD;
+static const size_t WS_FRAME_HEADER = 4;      // room for a 16-bit extended length
+static const size_t WS_PAYLOAD_SIZE = 640;    // one log record: 232 chars, escaped, plus framing
+static const uint8_t WS_LOG_BATCH = 8;        // log records written per client per loop pass
+
+enum WsOpcode : uint8_t {
+  WS_OP_CONTINUATION = 0x0,
+  WS_OP_TEXT = 0x1,
+  WS_OP_BINARY = 0x2,
+  WS_OP_CLOSE = 0x8,
+  WS_OP_PING = 0x9,
+  WS_OP_PONG = 0xA,
+};
+
+// Close status codes (RFC 6455 section 7.4.1)
+static const uint16_t WS_CLOSE_PROTOCOL_ERROR = 1002;
+static const uint16_t WS_CLOSE_UNSUPPORTED = 1003;
+static const uint16_t WS_CLOSE_TOO_BIG = 1009;
+static const uint16_t WS_CLOSE_GOING_AWAY = 1001;
+
+enum WsGroup : uint8_t {
+  WS_GROUP_SYS = 0,
+  WS_GROUP_WIFI,
+  WS_GROUP_DNS,
+  WS_GROUP_NET,
+  WS_GROUP_HB,
+  WS_GROUP_ALERTS,
+  WS_GROUP_MQTT,
+  WS_GROUP_LOG,  // log records rather than fields
+  WS_GROUP_COUNT
+};
+
+static const char* const GROUP_NAMES[WS_GROUP_COUNT] = {
+  "sys", "wifi", "dns", "net", "hb", "alerts", "mqtt", "log",
+};
+
+enum WsFieldKind : uint8_t {
+  WS_FIELD_UINT,
+  WS_FIELD_INT,
+  WS_FIELD_BOOL,
+  WS_FIELD_TENTHS,  // one decimal; WS_UNKNOWN is sent as null
+};
+
+static const int32_t WS_UNKNOWN = INT32_MIN;
+
+struct WsField {
+  WsGroup group;
+  WsFieldKind kind;
+  const char* key;
+  int32_t (*read)();
+};
+
+// Values are quantized where the raw reading would change every pass
+static int32_t readUptime() { return (int32_t)(millis() / 10000UL * 10000UL); }
+static int32_t readFreeHeap() { return (int32_t)(ESP.getFreeHeap() / 1024 * 1024); }
+static int32_t readWiFiConnected() { return WiFi.isConnected(); }
+static int32_t readRSSI() { return WiFi.RSSI(); }
+static int32_t readDNSWorking() { return isDNSWorking; }
+static int32_t readDNSFallback() { return isDNSUsingFallback(); }
+static int32_t readDNSOutage() { return (int32_t)(getDNSOutageStats().currentOutageMs / 1000UL); }
+static int32_t readProbeOk() { return networkProbeOk; }
+static int32_t tenths(float v) { return v < 0.0f ? WS_UNKNOWN : (int32_t)lroundf(v * 10.0f); }
+static int32_t readLatency() { return tenths(networkLatencyMs); }
+static int32_t readJitter() { return tenths(networkJitterMs); }
+static int32_t readHeartbeatSuccess() { return (int32_t)lastSuccessfulHeartbeat; }
+static int32_t readHeartbeatCode() { return lastHeartbeatResponseCode; }
+static int32_t readAlertsPaused() { return areAlertsPaused(); }
+static int32_t readAlertsRemaining() { return (int32_t)getAlertsPausedTimeRemaining(); }
+#ifdef ENABLE_MQTT
+static int32_t readMQTTConnected() { return isMQTTConnected(); }
+#else
+static int32_t readMQTTConnected() { return 0; }
+#endif
+
+// Ordered by group: a delta opens each group's object once
+static const WsField FIELDS[] = {
+  {WS_GROUP_SYS,    WS_FIELD_UINT,   "uptime",                               readUptime},
+  {WS_GROUP_SYS,    WS_FIELD_UINT,   "free_heap",                            readFreeHeap},
+  {WS_GROUP_WIFI,   WS_FIELD_BOOL,   "wifi_connected",                       readWiFiConnected},
+  {WS_GROUP_WIFI,   WS_FIELD_INT,    "wifi_rssi",                            readRSSI},
+  {WS_GROUP_DNS,    WS_FIELD_BOOL,   "dns_working",                          readDNSWorking},
+  {WS_GROUP_DNS,    WS_FIELD_BOOL,   "dns_using_fallback",                   readDNSFallback},
+  {WS_GROUP_DNS,    WS_FIELD_UINT,   "dns_outage_seconds",                   readDNSOutage},
+  {WS_GROUP_NET,    WS_FIELD_BOOL,   "network_probe_ok",                     readProbeOk},
+  {WS_GROUP_NET,    WS_FIELD_TENTHS, "network_latency_ms",                   readLatency},
+  {WS_GROUP_NET,    WS_FIELD_TENTHS, "network_jitter_ms",                    readJitter},
+  {WS_GROUP_HB,     WS_FIELD_UINT,   "last_heartbeat_success",               readHeartbeatSuccess},
+  {WS_GROUP_HB,     WS_FIELD_INT,    "last_heartbeat_code",                  readHeartbeatCode},
+  {WS_GROUP_ALERTS, WS_FIELD_BOOL,   "alerts_paused",                        readAlertsPaused},
+  {WS_GROUP_ALERTS, WS_FIELD_UINT,   "alerts_paused_time_remaining_seconds", readAlertsRemaining},
+  {WS_GROUP_MQTT,   WS_FIELD_BOOL,   "mqtt_connected",                       readMQTTConnected},
+};
+static const uint8_t WS_FIELD_COUNT = sizeof(FIELDS) / sizeof(FIELDS[0]);
+
+static const uint8_t WS_TELEMETRY_GROUPS = (uint8_t)~(1U << WS_GROUP_LOG);
+static const uint8_t WS_DEFAULT_GROUPS = WS_TELEMETRY_GROUPS;  // until the first {"sub":...}
+
+struct WsClient {
+  WiFiClient client;
+  int8_t slot;       // HttpServer connection id
+  bool active;
+  uint8_t groups;    // subscribed WsGroup bits
+  uint8_t pending;   // groups owed every field on the next delta
+  LogCursor cursor;
+  int32_t last[WS_FIELD_COUNT];  // as last sent to this client
+  uint8_t rx[WS_RX_BUFFER_SIZE];
+  uint8_t rxLen;
+  SocketBacklog out;
+  unsigned long lastPingMs;
+  unsigned long lastReadMs;  // pings are answered, so a live client is never silent for long
+};
+
+static WsClient clients[WEB_SOCKET_MAX_CLIENTS];
+static uint8_t frameBuffer[WS_FRAME_HEADER + WS_PAYLOAD_SIZE];
+static JsonMessageBuffer message(reinterpret_cast<char*>(frameBuffer + WS_FRAME_HEADER), WS_PAYLOAD_SIZE);
+static int32_t values[WS_FIELD_COUNT];
+static unsigned long lastDeltaCheck = 0;
+static bool deltaDirty = false;  // a state event or subscription change; diff on the next pass
+
+static void onStateEvent(const Event& event) {
+  (void)event;
+  deltaDirty = true;
+}
+
+void initWebSocket() {
+  eventSubscribe(EVENT_MASK(EVT_DNS_STATE_CHANGED) | EVENT_MASK(EVT_WIFI_ROLE_CHANGED) |
+                 EVENT_MASK(EVT_HEARTBEAT_RESULT) | EVENT_MASK(EVT_CONFIG_CHANGED), onStateEvent);
+}
+
+static void dropClient(WsClient& c) {
+  c.client.stop();
+  server.closeUpgraded(c.slot);
+  c.active = false;
+  LOG_I(LOG_MOD_WEB, "WebSocket closed");
+}
+
+// Unmasked control frame (server to client); payload at most 125 bytes
+static bool writeControl(WsClient& c, uint8_t opcode, const uint8_t* data, size_t len) {
+  uint8_t frame[2 + WS_MAX_RX_PAYLOAD];
+  frame[0] = 0x80 | opcode;
+  frame[1] = (uint8_t)len;
+  if (len > 0) memcpy(frame + 2, data, len);
+  if (!c.out.write(c.client.fd(), frame, 2 + len)) {
+    dropClient(c);
+    return false;
+  }
+  return true;
+}
+
+static void closeClient(WsClient& c, uint16_t code) {
+  uint8_t status[2] = {(uint8_t)(code >> 8), (uint8_t)(code & 0xFF)};
+  if (writeControl(c, WS_OP_CLOSE, status, sizeof(status))) {
+    dropClient(c);
+  }
+}
+
+// Queue the message as one text frame; a client whose backlog overflows is
+// disconnected
+static bool writeText(WsClient& c) {
+  size_t len = message.length();
+  uint8_t* start;
+  if (len < 126) {
+    start = frameBuffer + 2;
+    start[1] = (uint8_t)len;
+  } else {
+    start = frameBuffer;
+    start[1] = 126;
+    start[2] = (uint8_t)(len >> 8);
+    start[3] = (uint8_t)(len & 0xFF);
+  }
+  start[0] = 0x80 | WS_OP_TEXT;
+  size_t total = len + (size_t)(frameBuffer + WS_FRAME_HEADER - start);
+  if (!c.out.write(c.client.fd(), start, total)) {
+    dropClient(c);
+    return false;
+  }
+  return true;
+}
+
+static void appendValue(const WsField& f, int32_t v) {
+  switch (f.kind) {
+    case WS_FIELD_UINT:
+      message.appendf("\"%s\":%lu", f.key, (unsigned long)(uint32_t)v);
+      break;
+    case WS_FIELD_INT:
+      message.appendf("\"%s\":%ld", f.key, (long)v);
+      break;
+    case WS_FIELD_BOOL:
+      message.appendf("\"%s\":%s", f.key, v ? "true" : "false");
+      break;
+    case WS_FIELD_TENTHS:
+      if (v == WS_UNKNOWN) {
+        message.appendf("\"%s\":null", f.key);
+      } else {
+        message.appendf("\"%s\":%.1f", f.key, v / 10.0);
+      }
+      break;
+  }
+}
+
+// {"t":"delta","<group>":{...},...} with the fields this client has not seen
+static bool sendDelta(WsClient& c) {
+  message.clear();
+  message.appendf("{\"t\":\"delta\"");
+  size_t base = message.length();
+  int8_t open = -1;
+  for (uint8_t i = 0; i < WS_FIELD_COUNT; i++) {
+    const WsField& f = FIELDS[i];
+    uint8_t bit = 1U << f.group;
+    if (!(c.groups & bit)) continue;
+    if (!(c.pending & bit) && values[i] == c.last[i]) continue;
+    if (open != (int8_t)f.group) {
+      message.appendf("%s,\"%s\":{", open >= 0 ? "}" : "", GROUP_NAMES[f.group]);
+      open = (int8_t)f.group;
+    } else {
+      message.appendf(",");
+    }
+    appendValue(f, values[i]);
+  }
+  c.pending = 0;
+  if (message.length() == base) return true;
+
+  message.appendf("}}");
+  if (!writeText(c)) return false;
+  memcpy(c.last, values, sizeof(values));
+  return true;
+}
+
+static bool sendLogRecords(WsClient& c) {
+  if (!(c.groups & (1U << WS_GROUP_LOG))) return true;
+  LogRecord rec;
+  for (uint8_t i = 0; i < WS_LOG_BATCH && logRead(c.cursor, rec); i++) {
+    message.clear();
+    if (c.cursor.dropped > 0) {
+      message.appendf("{\"t\":\"dropped\",\"n\":%lu}", c.cursor.dropped);
+      c.cursor.dropped = 0;
+      if (!writeText(c)) return false;
+      message.clear();
+    }
+    message.appendf("{\"t\":\"log\",\"seq\":%lu,\"ms\":%lu,\"level\":\"%s\",\"module\":\"%s\",\"text\":",
+            (unsigned long)rec.seq, (unsigned long)rec.timestampMs, logLevelName(rec.level),
+            logModuleName(rec.module));
+    message.appendString(rec.text, 1);  // "}"
+    message.appendf("}");
+    if (!writeText(c)) return false;
+  }
+  return true;
+}
+
+static bool sendHello(WsClient& c) {
+  message.clear();
+  message.appendf("{\"t\":\"hello\",\"groups\":[");
+  for (uint8_t g = 0; g < WS_GROUP_COUNT; g++) {
+    message.appendf("%s\"%s\"", g > 0 ? "," : "", GROUP_NAMES[g]);
+  }
+  message.appendf("]}");
+  return writeText(c);
+}
+
+static void subscribe(WsClient& c, JsonArray names) {
+  uint8_t groups = 0;
+  for (JsonVariant name : names) {
+    const char* s = name | "";
+    for (uint8_t g = 0; g < WS_GROUP_COUNT; g++) {
+      if (strcmp(s, GROUP_NAMES[g]) == 0) groups |= 1U << g;
+    }
+  }
+  uint8_t added = groups & ~c.groups;
+  if (added & (1U << WS_GROUP_LOG)) {
+    logCursorAtHead(c.cursor);
+  }
+  c.groups = groups;
+  c.pending |= added & WS_TELEMETRY_GROUPS;
+  deltaDirty = true;
+}
+
+// Returns nullptr on success, otherwise the error for the ack
+static const char* runCommand(const char* cmd, JsonDocument& doc) {
+  if (strcmp(cmd, "pause") == 0) {
+    JsonVariant minutes = doc["minutes"];
+    if (minutes.is<const char*>() && strcmp(minutes.as<const char*>(), "indefinite") == 0) {
+      pauseAlertsIndefinitely();
+    } else {
+      long value = minutes | 0L;
+      if (!minutes.is<long>() || value < 1 || value > ALERT_PAUSE_MAX_MINUTES) {
+        return "invalid pause duration";
+      }
+      pauseAlertsForMinutes((int)value);
+    }
+    telnetPrintf("[%10lu ms] [WEB] Alert pause requested via WebSocket\r\n", millis());
+  } else if (strcmp(cmd, "resume") == 0) {
+    resumeAlerts();
+    telnetPrintf("[%10lu ms] [WEB] Alert resume requested via WebSocket\r\n", millis());
+  } else if (strcmp(cmd, "reboot") == 0) {
+    telnetPrintf("[%10lu ms] [WEB] Reboot requested via WebSocket\r\n", millis());
+    // Rebooted from the event dispatch, after the ack has gone out
+    requestReboot("WebSocket reboot request");
+  } else if (strcmp(cmd, "probe") == 0) {
+    requestNetworkProbe();
+  } else {
+    return "unknown command";
+  }
+  deltaDirty = true;  // alerts group reflects the change without waiting
+  return nullptr;
+}
+
+static void handleMessage(WsClient& c, const char* text, size_t len) {
+  JsonDocument doc;
+  DeserializationError err = deserializeJson(doc, text, len);
+  if (err || !doc.is<JsonObject>()) {
+    message.clear();
+    message.appendf("{\"t\":\"ack\",\"ok\":false,\"error\":\"invalid JSON\"}");
+    writeText(c);
+    return;
+  }
+
+  if (doc["sub"].is<JsonArray>()) {
+    subscribe(c, doc["sub"].as<JsonArray>());
+  }
+
+  const char* cmd = doc["cmd"] | (const char*)nullptr;
+  if (cmd == nullptr) return;
+  const char* error = runCommand(cmd, doc);
+
+  message.clear();
+  message.appendf("{\"t\":\"ack\",\"cmd\":");
+  message.appendString(cmd, 0);
+  if (doc["id"].is<long>()) {
+    message.appendf(",\"id\":%ld", doc["id"].as<long>());
+  }
+  message.appendf(",\"ok\":%s", error == nullptr ? "true" : "false");
+  if (error != nullptr) {
+    message.appendf(",\"error\":\"%s\"", error);
+  }
+  message.appendf("}");
+  writeText(c);
+}
+
+// Parse every complete frame in the receive buffer. Returns false once the
+// client has been dropped.
+static bool readFrames(WsClient& c) {
+  int available = c.client.available();
+  while (available > 0 && c.rxLen < WS_RX_BUFFER_SIZE) {
+    int n = c.client.read(c.rx + c.rxLen, WS_RX_BUFFER_SIZE - c.rxLen);
+    if (n <= 0) break;
+    c.rxLen += (uint8_t)n;
+    available -= n;
+    c.lastReadMs = millis();
+  }
+
+  while (c.active && c.rxLen >= 2) {
+    uint8_t opcode = c.rx[0] & 0x0F;
+    bool fin = c.rx[0] & 0x80;
+    bool masked = c.rx[1] & 0x80;
+    size_t len = c.rx[1] & 0x7F;
+    if ((c.rx[0] & 0x70) != 0 || !masked) {
+      closeClient(c, WS_CLOSE_PROTOCOL_ERROR);
+      return false;
+    }
+    if (len > WS_MAX_RX_PAYLOAD || !fin) {
+      closeClient(c, WS_CLOSE_TOO_BIG);
+      return false;
+    }
+    size_t total = 2 + 4 + len;
+    if (c.rxLen < total) return true;
+
+    const uint8_t* mask = c.rx + 2;
+    uint8_t* data = c.rx + 6;
+    for (size_t i = 0; i < len; i++) data[i] ^= mask[i & 3];
+
+    switch (opcode) {
+      case WS_OP_TEXT:
+        handleMessage(c, reinterpret_cast<const char*>(data), len);
+        break;
+      case WS_OP_PING:
+        writeControl(c, WS_OP_PONG, data, len);
+        break;
+      case WS_OP_PONG:
+        break;
+      case WS_OP_CLOSE:
+        // Echo the status code, then close our side
+        if (writeControl(c, WS_OP_CLOSE, data, len < 2 ? len : 2)) dropClient(c);
+        return false;
+      case WS_OP_BINARY:
+        closeClient(c, WS_CLOSE_UNSUPPORTED);
+        return false;
+      default:
+        closeClient(c, WS_CLOSE_PROTOCOL_ERROR);
+        return false;
+    }
+    if (!c.active) return false;
+    memmove(c.rx, c.rx + total, c.rxLen - total);
+    c.rxLen -= (uint8_t)total;
+  }
+  return c.active;
+}
+
+void handleWebSocketUpgrade() {
+  String key = server.header("Sec-WebSocket-Key");
+  if (!server.header("Upgrade").equalsIgnoreCase("websocket") || key.length() != 24) {
+    server.sendHeader("Upgrade", "websocket");
+    server.send(426, "text/plain", "WebSocket upgrade required");
+    return;
+  }
+  if (server.header("Sec-WebSocket-Version") != "13") {
+    server.sendHeader("Sec-WebSocket-Version", "13");
+    server.send(426, "text/plain", "Unsupported WebSocket version");
+    return;
+  }
+
+  WsClient* slot = nullptr;
+  for (uint8_t i = 0; i < WEB_SOCKET_MAX_CLIENTS; i++) {
+    if (!clients[i].active) {
+      slot = &clients[i];
+      break;
+    }
+  }
+  if (slot == nullptr) {
+    // The dashboard falls back to /events or polling
+    server.sendHeader("Retry-After", "10");
+    server.send(503, "text/plain", "Too many WebSocket clients");
+    return;
+  }
+
+  // Sec-WebSocket-Accept: base64(SHA-1(key + GUID))
+  char keyGuid[24 + sizeof(WS_GUID)];
+  memcpy(keyGuid, key.c_str(), 24);
+  memcpy(keyGuid + 24, WS_GUID, sizeof(WS_GUID));
+  uint8_t digest[20];
+#if MBEDTLS_VERSION_MAJOR >= 3
+  mbedtls_sha1(reinterpret_cast<const uint8_t*>(keyGuid), sizeof(keyGuid) - 1, digest);
+#else
+  mbedtls_sha1_ret(reinterpret_cast<const uint8_t*>(keyGuid), sizeof(keyGuid) - 1, digest);
+#endif
+  unsigned char accept[32];
+  size_t acceptLen = 0;
+  mbedtls_base64_encode(accept, sizeof(accept), &acceptLen, digest, sizeof(digest));
+  accept[acceptLen] = '\0';
+
+  // The 101 goes out by hand: after it the socket no longer speaks HTTP
+  char response[160];
+  int n = snprintf(response, sizeof(response),
+                   "HTTP/1.1 101 Switching Protocols\r\n"
+                   "Upgrade: websocket\r\n"
+                   "Connection: Upgrade\r\n"
+                   "Sec-WebSocket-Accept: %s\r\n"
+                   "\r\n",
+                   reinterpret_cast<const char*>(accept));
+  WiFiClient& client = server.client();
+  client.setNoDelay(true);
+  slot->out.clear();
+  if (!slot->out.write(client.fd(), response, (size_t)n)) {
+    return;  // nothing sent through the server: it lets go of the socket
+  }
+
+  slot->client = client;  // copies share the socket
+  slot->slot = server.upgradeConnection();
+  slot->active = true;
+  slot->groups = WS_DEFAULT_GROUPS;
+  slot->pending = WS_DEFAULT_GROUPS;
+  slot->rxLen = 0;
+  slot->lastPingMs = millis();
+  slot->lastReadMs = millis();
+  deltaDirty = true;  // full snapshot on the next pass
+
+  LOG_I(LOG_MOD_WEB, "WebSocket opened (%u/%u)", (unsigned)getWebSocketClientCount(),
+        (unsigned)WEB_SOCKET_MAX_CLIENTS);
+  sendHello(*slot);
+}
+
+void handleWebSocket() {
+  if (getWebSocketClientCount() == 0) {
+    deltaDirty = false;
+    return;
+  }
+
+  unsigned long now = millis();
+  bool deltaDue = deltaDirty || now - lastDeltaCheck >= WEB_SOCKET_DELTA_INTERVAL_MS;
+  if (deltaDue) {
+    for (uint8_t i = 0; i < WS_FIELD_COUNT; i++) values[i] = FIELDS[i].read();
+    lastDeltaCheck = now;
+    deltaDirty = false;
+  }
+
+  for (uint8_t i = 0; i < WEB_SOCKET_MAX_CLIENTS; i++) {
+    WsClient& c = clients[i];
+    if (!c.active) continue;
+    if (!c.client.connected() || !c.out.flush(c.client.fd())) {
+      dropClient(c);
+      continue;
+    }
+    if (!readFrames(c)) continue;
+    if (now - c.lastReadMs >= WEB_SOCKET_IDLE_TIMEOUT_MS) {
+      closeClient(c, WS_CLOSE_GOING_AWAY);
+      continue;
+    }
+    // Log records wait in the ring while the client catches up; deltas and
+    // pings still queue, so one that never drains overflows and is dropped
+    if (c.out.empty() && !sendLogRecords(c)) continue;
+    if (deltaDue && !sendDelta(c)) continue;
+    if (now - c.lastPingMs >= WEB_SOCKET_PING_INTERVAL_MS) {
+      c.lastPingMs = now;
+      writeControl(c, WS_OP_PING, nullptr, 0);
+    }
+  }
+}
+
+uint8_t getWebSocketClientCount() {
+  uint8_t count = 0;
+  for (uint8_t i = 0; i < WEB_SOCKET_MAX_CLIENTS; i++) {
+    if (clients[i].active) count++;
+  }
+  return count;
+}
+
+#endif // ENABLE_WEBSERVER
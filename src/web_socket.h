@@ -0,0 +1,49 @@
+#ifndef WEB_SOCKET_H
+#define WEB_SOCKET_H
+
+#ifdef ENABLE_WEBSERVER
+
+#include <Arduino.h>
+
+// Two-way telemetry channel at /ws (RFC 6455). Every message is a text frame
+// holding compact JSON.
+//
+// Client -> device:
+//   {"sub":["sys","net","log"]}            groups to receive (replaces the set)
+//   {"cmd":"pause","minutes":30,"id":1}    minutes may also be "indefinite"
+//   {"cmd":"resume"}  {"cmd":"reboot"}  {"cmd":"probe"}
+// Device -> client:
+//   {"t":"hello","groups":[...]}                   on connect
+//   {"t":"delta","sys":{...},"alerts":{...}}       only fields that changed
+//   {"t":"log","seq","ms","level","module","text"} with the "log" group
+//   {"t":"ack","cmd","id","ok"[,"error"]}
+//
+// Field names match /status. A newly subscribed group gets every field once.
+// The socket keeps its HttpServer connection slot, so it shares the
+// HTTP_MAX_CONNECTIONS budget with ordinary requests.
+
+#define WEB_SOCKET_MAX_CLIENTS 2
+#define WEB_SOCKET_DELTA_INTERVAL_MS 1000UL  // telemetry diff cadence (state events push sooner)
+#define WEB_SOCKET_PING_INTERVAL_MS 15000UL
+#define WEB_SOCKET_IDLE_TIMEOUT_MS 45000UL   // nothing from the client (not even a pong): dropped
+
+// Subscribe to state events (called from initWebServer)
+void initWebSocket();
+
+// /ws route handler: answers the upgrade and takes over the connection
+void handleWebSocketUpgrade();
+
+// Read client frames, push deltas and log records (call every loop pass)
+void handleWebSocket();
+
+uint8_t getWebSocketClientCount();
+
+#else
+
+inline void initWebSocket() {}
+inline void handleWebSocket() {}
+inline uint8_t getWebSocketClientCount() { return 0; }
+
+#endif // ENABLE_WEBSERVER
+
+#endif // WEB_SOCKET_H
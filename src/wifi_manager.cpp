@@ -1,11 +1,23 @@
 #include "wifi_manager.h"
 #include "config.h"
 #include "telnet.h"
+#include "event_bus.h"
 #include <WiFi.h>
 #include <string.h>
 
 // Active network tracking
 static int activeNetworkIndex = WIFI_NET_NONE;
+
+// All role changes go through here so subscribers see each transition once
+static void setActiveNetwork(int index) {
+  if (index == activeNetworkIndex) {
+    return;
+  }
+  int previous = activeNetworkIndex;
+  activeNetworkIndex = index;
+  eventPublishWiFiRole(index, previous);
+}
+
 static unsigned long lastReconnectAttempt = 0;
 static unsigned long lastPrimaryRecoveryAttempt = 0;
 
@@ -46,7 +58,7 @@ static const char* networkPassword(int index) {
   return "";
 }
 
-static const char* networkRoleName(int index) {
+const char* networkRoleName(int index) {
   if (index == WIFI_NET_PRIMARY) return "primary";
   if (index == WIFI_NET_SECONDARY) return "secondary";
   return "none";
@@ -85,7 +97,7 @@ static bool tryConnect(int index, unsigned long timeoutMs) {
   Serial.println();
 
   if (WiFi.status() == WL_CONNECTED) {
-    activeNetworkIndex = index;
+    setActiveNetwork(index);
     Serial.printf("[%10lu ms] [WiFi] Connected to '%s' (%s) | IP: %s | RSSI: %d dBm\r\n",
                   millis(), netSsid, networkRoleName(index),
                   WiFi.localIP().toString().c_str(), WiFi.RSSI());
@@ -114,7 +126,7 @@ bool initWiFi() {
     }
   }
 
-  activeNetworkIndex = WIFI_NET_NONE;
+  setActiveNetwork(WIFI_NET_NONE);
   Serial.printf("[%10lu ms] [ERROR] WiFi connection failed (all networks)!\r\n", millis());
   return false;
 }
@@ -162,7 +174,7 @@ const char* getActiveNetworkRole() {
 
 static void syncActiveIndexFromSSID() {
   if (WiFi.status() != WL_CONNECTED) {
-    activeNetworkIndex = WIFI_NET_NONE;
+    setActiveNetwork(WIFI_NET_NONE);
     return;
   }
   if (activeNetworkIndex >= 0) {
@@ -170,9 +182,9 @@ static void syncActiveIndexFromSSID() {
   }
   String current = WiFi.SSID();
   if (isNetworkConfigured(WIFI_NET_PRIMARY) && current == String(ssid)) {
-    activeNetworkIndex = WIFI_NET_PRIMARY;
+    setActiveNetwork(WIFI_NET_PRIMARY);
   } else if (isNetworkConfigured(WIFI_NET_SECONDARY) && current == String(ssidSecondary)) {
-    activeNetworkIndex = WIFI_NET_SECONDARY;
+    setActiveNetwork(WIFI_NET_SECONDARY);
   }
 }
 
@@ -205,7 +217,7 @@ static void attemptReconnectOrFailover() {
     return;
   }
 
-  activeNetworkIndex = WIFI_NET_NONE;
+  setActiveNetwork(WIFI_NET_NONE);
   telnetPrintf("[%10lu ms] [WiFi] All networks failed this cycle\r\n", millis());
 }
 
@@ -233,7 +245,7 @@ static void attemptPrimaryRecovery() {
   // Restore secondary if primary is still down
   telnetPrintf("[%10lu ms] [WiFi] Primary still unavailable; restoring secondary\r\n", millis());
   if (!tryConnect(WIFI_NET_SECONDARY, RECONNECT_TIMEOUT_MS)) {
-    activeNetworkIndex = WIFI_NET_NONE;
+    setActiveNetwork(WIFI_NET_NONE);
     telnetPrintf("[%10lu ms] [WiFi] Failed to restore secondary after primary probe\r\n", millis());
   }
 }
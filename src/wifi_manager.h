@@ -23,6 +23,7 @@ bool isOnPrimaryNetwork();
 const char* getActiveSSID();
 int getActiveNetworkIndex();
 const char* getActiveNetworkRole();  // "primary", "secondary", or "none"
+const char* networkRoleName(int index);
 
 // Re-apply custom DNS after (re)connect
 void applyWiFiDNS();
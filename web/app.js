@@ -6,10 +6,18 @@ class ESP32ControlPanel {
         this.consoleVisible = false;
         this.autoScroll = true;
         this.telnetSocket = null;
+        this.telnetLastSeq = 0; // last log record seen; polls ask only for newer ones
+        this.socket = null; // /ws channel: telemetry deltas, log records and commands
+        this.socketConnected = false;
+        this.socketCommands = new Map(); // command id -> { resolve, reject } until its ack
+        this.socketCommandId = 0;
+        this.eventSource = null; // /events stream; used when the WebSocket is unavailable
+        this.eventsConnected = false;
         this.connectionCheckInterval = null;
         this.deferredPrompt = null; // For PWA installation
-        // Base URL: always use device mDNS directly
-        this.base = 'http://poop-monitor.local';
+        // Base URL: same origin when the device serves this page itself,
+        // otherwise the device's mDNS name
+        this.base = document.querySelector('meta[name="device-hosted"]') ? '' : 'http://poop-monitor.local';
         this.init();
     }
 
@@ -24,6 +32,7 @@ class ESP32ControlPanel {
         
         await this.initPWA();
         await this.loadDeviceStatus();
+        this.startSocket();
         this.startAutoRefresh();
         this.startConnectionCheck();
         this.setupEventListeners();
@@ -286,7 +295,7 @@ class ESP32ControlPanel {
 
     updateAlertStatus() {
         const alertStatusDiv = document.getElementById('alert-status');
-        const alertsPaused = this.deviceData.alerts_paused === 'true';
+        const alertsPaused = [true, 'true'].includes(this.deviceData.alerts_paused);
         
         if (alertsPaused) {
             const timeRemaining = parseInt(this.deviceData.alerts_paused_time_remaining_seconds) || 0;
@@ -322,7 +331,7 @@ class ESP32ControlPanel {
 
     updateAlertControls() {
         const controlsDiv = document.getElementById('alert-controls');
-        const alertsPaused = this.deviceData.alerts_paused === 'true';
+        const alertsPaused = [true, 'true'].includes(this.deviceData.alerts_paused);
         
         if (alertsPaused) {
             controlsDiv.innerHTML = `
@@ -365,15 +374,19 @@ class ESP32ControlPanel {
         if (!result) return;
         
         try {
-            const response = await fetch(this.api('/reboot'));
-            if (response.ok) {
-                this.showToast('Device is rebooting... Page will refresh in 15 seconds.', 'success');
-                setTimeout(() => {
-                    window.location.reload();
-                }, 15000);
+            const viaSocket = this.socketCommand('reboot');
+            if (viaSocket) {
+                await viaSocket;
             } else {
-                throw new Error('Reboot request failed');
+                const response = await fetch(this.api('/reboot'));
+                if (!response.ok) {
+                    throw new Error('Reboot request failed');
+                }
             }
+            this.showToast('Device is rebooting... Page will refresh in 15 seconds.', 'success');
+            setTimeout(() => {
+                window.location.reload();
+            }, 15000);
         } catch (error) {
             this.showToast('Failed to reboot device: ' + error.message, 'error');
         }
@@ -389,13 +402,19 @@ class ESP32ControlPanel {
         if (!result) return;
         
         try {
-            const response = await fetch(this.api(`/alerts/pause/${duration}`));
-            if (response.ok) {
-                this.showToast('Alerts paused successfully', 'success');
-                setTimeout(() => this.loadDeviceStatus(), 500);
+            const minutes = duration === 'indefinite' ? duration : Number(duration);
+            const viaSocket = this.socketCommand('pause', { minutes });
+            if (viaSocket) {
+                // The alerts delta follows the ack
+                await viaSocket;
             } else {
-                throw new Error('Pause request failed');
+                const response = await fetch(this.api(`/alerts/pause/${duration}`));
+                if (!response.ok) {
+                    throw new Error('Pause request failed');
+                }
+                setTimeout(() => this.loadDeviceStatus(), 500);
             }
+            this.showToast('Alerts paused successfully', 'success');
         } catch (error) {
             this.showToast('Failed to pause alerts: ' + error.message, 'error');
         }
@@ -406,18 +425,37 @@ class ESP32ControlPanel {
         if (!result) return;
         
         try {
-            const response = await fetch(this.api('/alerts/resume'));
-            if (response.ok) {
-                this.showToast('Alerts resumed successfully', 'success');
-                setTimeout(() => this.loadDeviceStatus(), 500);
+            const viaSocket = this.socketCommand('resume');
+            if (viaSocket) {
+                await viaSocket;
             } else {
-                throw new Error('Resume request failed');
+                const response = await fetch(this.api('/alerts/resume'));
+                if (!response.ok) {
+                    throw new Error('Resume request failed');
+                }
+                setTimeout(() => this.loadDeviceStatus(), 500);
             }
+            this.showToast('Alerts resumed successfully', 'success');
         } catch (error) {
             this.showToast('Failed to resume alerts: ' + error.message, 'error');
         }
     }
 
+    // Only available over the WebSocket; the result arrives as a "net" delta
+    async probeNetwork() {
+        const viaSocket = this.socketCommand('probe');
+        if (!viaSocket) {
+            this.showToast('Network probe needs the live connection', 'error');
+            return;
+        }
+        try {
+            await viaSocket;
+            this.showToast('Network probe started', 'success');
+        } catch (error) {
+            this.showToast('Failed to start network probe: ' + error.message, 'error');
+        }
+    }
+
     // Console/Telnet Functions
     toggleTelnetLog() {
         this.consoleVisible = !this.consoleVisible;
@@ -430,12 +468,15 @@ class ESP32ControlPanel {
             container.style.display = 'none';
             this.stopTelnetStream();
         }
+        this.sendSubscription();
     }
 
     async startTelnetStream() {
         try {
             const response = await fetch(this.api('/telnet/start'));
             if (response.ok) {
+                const data = await response.json();
+                this.telnetLastSeq = data.last || 0;
                 this.pollTelnetOutput();
                 this.showToast('Console stream started', 'success');
             }
@@ -455,16 +496,23 @@ class ESP32ControlPanel {
     async pollTelnetOutput() {
         if (!this.consoleVisible) return;
         
-        try {
-            const response = await fetch(this.api('/telnet/output'));
-            if (response.ok) {
-                const data = await response.json();
-                if (data.output) {
-                    this.appendToConsole(data.output);
+        // Log records arrive on the WebSocket or event stream while one is connected
+        if (!this.eventsConnected) {
+            try {
+                const response = await fetch(this.api(`/telnet/output?since=${this.telnetLastSeq}`));
+                if (response.ok) {
+                    const data = await response.json();
+                    if (data.dropped > 0) {
+                        this.appendToConsole(`... ${data.dropped} line(s) missed ...`);
+                    }
+                    for (const record of data.records || []) {
+                        this.appendToConsole(record.text);
+                    }
+                    this.telnetLastSeq = data.last;
                 }
+            } catch (error) {
+                console.error('Error polling telnet output:', error);
             }
-        } catch (error) {
-            console.error('Error polling telnet output:', error);
         }
         
         // Continue polling if console is still visible
@@ -611,14 +659,168 @@ class ESP32ControlPanel {
         });
     }
 
+    // Live telemetry, logs and commands over /ws. If the device refuses or
+    // cannot be reached before the socket opens, the Server-Sent Events
+    // stream (and behind it, polling) takes over for this page load.
+    startSocket() {
+        if (!window.WebSocket || this.socket) {
+            this.startEventStream();
+            return;
+        }
+
+        const origin = this.base || window.location.origin;
+        const socket = new WebSocket(origin.replace(/^http/, 'ws') + '/ws');
+        this.socket = socket;
+        let opened = false;
+
+        socket.onopen = () => {
+            opened = true;
+            this.socketConnected = true;
+            this.eventsConnected = true;
+            this.updateConnectionStatus(true);
+            this.sendSubscription();
+        };
+
+        socket.onmessage = (e) => this.handleSocketMessage(JSON.parse(e.data));
+
+        socket.onclose = () => {
+            this.socket = null;
+            this.socketConnected = false;
+            this.eventsConnected = false;
+            for (const pending of this.socketCommands.values()) {
+                pending.reject(new Error('Connection closed'));
+            }
+            this.socketCommands.clear();
+            if (opened) {
+                setTimeout(() => this.startSocket(), 3000);
+            } else {
+                this.startEventStream();
+            }
+        };
+    }
+
+    // Metric groups to receive; log records only while the console is open
+    sendSubscription() {
+        if (!this.socketConnected) return;
+        const groups = ['sys', 'wifi', 'dns', 'net', 'hb', 'alerts', 'mqtt'];
+        if (this.consoleVisible) groups.push('log');
+        this.socket.send(JSON.stringify({ sub: groups }));
+    }
+
+    handleSocketMessage(msg) {
+        switch (msg.t) {
+            case 'delta': {
+                // {"t":"delta","<group>":{field: value}}; fields use /status names
+                for (const [group, fields] of Object.entries(msg)) {
+                    if (group === 't') continue;
+                    Object.assign(this.deviceData, fields);
+                    if ('uptime' in fields) {
+                        delete this.deviceData.current_uptime_formatted;
+                    }
+                }
+                this.cacheDeviceStatus();
+                this.updateInterface();
+                break;
+            }
+            case 'log':
+                this.telnetLastSeq = msg.seq;
+                if (this.consoleVisible) {
+                    this.appendToConsole(msg.text);
+                }
+                break;
+            case 'dropped':
+                if (this.consoleVisible) {
+                    this.appendToConsole(`... ${msg.n} line(s) missed ...`);
+                }
+                break;
+            case 'ack': {
+                const pending = this.socketCommands.get(msg.id);
+                if (!pending) break;
+                this.socketCommands.delete(msg.id);
+                if (msg.ok) {
+                    pending.resolve(msg);
+                } else {
+                    pending.reject(new Error(msg.error || 'Command failed'));
+                }
+                break;
+            }
+        }
+    }
+
+    // Send a command over the WebSocket. Returns a promise settled by the
+    // device's ack, or null when the socket is not open (callers use HTTP).
+    socketCommand(cmd, args = {}) {
+        if (!this.socketConnected) return null;
+        const id = ++this.socketCommandId;
+        return new Promise((resolve, reject) => {
+            this.socketCommands.set(id, { resolve, reject });
+            this.socket.send(JSON.stringify({ cmd, id, ...args }));
+            setTimeout(() => {
+                if (this.socketCommands.delete(id)) {
+                    reject(new Error('No reply from device'));
+                }
+            }, 5000);
+        });
+    }
+
+    // Live logs and telemetry over Server-Sent Events. Falls back to the
+    // polling timers below while the stream is unavailable.
+    startEventStream() {
+        if (!window.EventSource || this.eventSource) return;
+
+        const source = new EventSource(this.api('/events'));
+        this.eventSource = source;
+
+        source.onopen = () => {
+            this.eventsConnected = true;
+            this.updateConnectionStatus(true);
+        };
+
+        source.addEventListener('status', (e) => {
+            const changes = JSON.parse(e.data);
+            Object.assign(this.deviceData, changes);
+            if ('uptime' in changes) {
+                delete this.deviceData.current_uptime_formatted;
+            }
+            this.cacheDeviceStatus();
+            this.updateInterface();
+        });
+
+        source.addEventListener('log', (e) => {
+            const record = JSON.parse(e.data);
+            this.telnetLastSeq = record.seq;
+            if (this.consoleVisible) {
+                this.appendToConsole(record.text);
+            }
+        });
+
+        source.addEventListener('dropped', (e) => {
+            if (this.consoleVisible) {
+                this.appendToConsole(`... ${e.data} line(s) missed ...`);
+            }
+        });
+
+        source.onerror = () => {
+            this.eventsConnected = false;
+            // EventSource retries by itself unless the server refused the stream
+            if (source.readyState === EventSource.CLOSED) {
+                this.eventSource = null;
+                setTimeout(() => this.startEventStream(), 60000);
+            }
+        };
+    }
+
     startAutoRefresh() {
         this.autoRefreshInterval = setInterval(() => {
-            this.loadDeviceStatus();
+            if (!this.eventsConnected) {
+                this.loadDeviceStatus();
+            }
         }, 30000);
     }
 
     startConnectionCheck() {
         this.connectionCheckInterval = setInterval(async () => {
+            if (this.eventsConnected) return;
             try {
                 const response = await fetch(this.api('/status'), { 
                     method: 'HEAD',
@@ -665,6 +867,10 @@ function resumeAlerts() {
     controlPanel.resumeAlerts();
 }
 
+function probeNetwork() {
+    controlPanel.probeNetwork();
+}
+
 function toggleTelnetLog() {
     controlPanel.toggleTelnetLog();
 }
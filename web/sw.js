@@ -63,6 +63,9 @@ self.addEventListener('fetch', (event) => {
   
   // Only handle requests to our origin
   if (url.origin !== location.origin) return;
+
+  // Leave the long-lived event stream to the browser
+  if (url.pathname === '/events') return;
   
   event.respondWith(
     (async () => {
@@ -127,8 +130,8 @@ self.addEventListener('push', (event) => {
     const data = event.data.json();
     const options = {
       body: data.body,
-      icon: '/icon-192.png',
-      badge: '/icon-192.png',
+      icon: '/icon-192.svg',
+      badge: '/icon-192.svg',
       vibrate: [100, 50, 100],
       data: {
         dateOfArrival: Date.now(),
@@ -138,12 +141,12 @@ self.addEventListener('push', (event) => {
         {
           action: 'explore',
           title: 'View Device',
-          icon: '/icon-192.png'
+          icon: '/icon-192.svg'
         },
         {
           action: 'close',
           title: 'Close',
-          icon: '/icon-192.png'
+          icon: '/icon-192.svg'
         }
       ]
     };